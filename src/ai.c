@@ -1,6 +1,6 @@
 #include "ai.h"
 #include "tile.h"
-#include "chaos_arena.h"
+#include "rng.h"
 #include "warrior.h"
 #include "game.h"
 
@@ -77,7 +77,7 @@ tDirection aiProcess(tAi *pAi) {
 				)
 			) {
 				// Skip odd directions to prevent oging diagonally
-				pAi->eNextMovementDirection = randUw(&g_sRandManager) & 0b110;
+				pAi->eNextMovementDirection = rngNext(RNG_STREAM_AI) & 0b110;
 				pAi->ubMovementCooldown = AI_MOVEMENT_COOLDOWN;
 			}
 			else {
@@ -5,6 +5,8 @@
 #ifndef INCLUDE_ANIM_H
 #define INCLUDE_ANIM_H
 
+#include <ace/types.h>
+
 typedef enum tAnimDirection {
 	ANIM_DIRECTION_S,
 	ANIM_DIRECTION_SE,
@@ -26,4 +28,24 @@ typedef enum tAnim {
 	ANIM_COUNT,
 } tAnim;
 
+typedef enum tAnimFlag {
+	ANIM_FLAG_PUSH = BV(0), ///< Move by push delta, ignoring steer.
+	ANIM_FLAG_STRIKE = BV(1), ///< Hit warrior in front.
+	ANIM_FLAG_FALL = BV(2), ///< Drop down until out of arena.
+} tAnimFlag;
+
+/**
+ * @brief Single animation frame, as compiled from res/warrior.anim.
+ */
+typedef struct tAnimFrameDef {
+	UBYTE ubSheetFrame; ///< Index within direction row of warrior sheet.
+	UBYTE ubDuration; ///< In game ticks.
+	UBYTE ubFlags; ///< Combination of tAnimFlag.
+} tAnimFrameDef;
+
+typedef struct tAnimDef {
+	UBYTE ubFirstFrame; ///< Index of first frame in the frame table.
+	UBYTE ubFrameCount;
+} tAnimDef;
+
 #endif // INCLUDE_ANIM_H
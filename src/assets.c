@@ -5,6 +5,13 @@
 #include "assets.h"
 #include <ace/macros.h>
 #include "display.h"
+#include "frame_cache.h"
+#include "bitmap_pack.h"
+#include "loader.h"
+#include "text_atlas.h"
+#include "warrior_frames.h" // generated by frameDedup
+
+#define WARRIOR_FRAME_SIZE 16
 
 tBitMap *g_pWarriorFrames;
 tBitMap *g_pWarriorMasks;
@@ -15,7 +22,6 @@ tBitMap *g_pTilesetMask;
 
 tFont *g_pFontBig;
 tFont *g_pFontSmall;
-tTextBitMap *g_pTextBitmap;
 
 tBitMap *g_pCountdownMask;
 tBitMap *g_pCountdownFrames;
@@ -39,64 +45,126 @@ tPtplayerMod *g_pModMenu;
 tPtplayerSamplePack *g_pModSamples = 0;
 static ULONG s_ulSampleSize;
 
-void assetsGlobalCreate(void) {
-	g_pWarriorFrames = bitmapCreateFromPath("data/warrior.bm", 0);
-	g_pWarriorMasks = bitmapCreateFromPath("data/warrior_mask.bm", 0);
-	g_pCountdownFrames = bitmapCreateFromPath("data/countdown.bm", 0);
-	g_pCountdownMask = bitmapCreateFromPath("data/countdown_mask.bm", 0);
-	g_pFightBitmap = bitmapCreateFromPath("data/fight.bm", 0);
-	g_pFightMask = bitmapCreateFromPath("data/fight_mask.bm", 0);
-	g_pTitleBitmap = bitmapCreateFromPath("data/title.bm", 0);
-	g_pTitleMask = bitmapCreateFromPath("data/title_mask.bm", 0);
-
-	g_pChaos = bitmapCreateFromPath("data/chaos.bm", 0);
-	g_pTileset = bitmapCreateFromPath("data/tiles.bm", 0);
-	g_pTilesetMask = bitmapCreateFromPath("data/tiles_mask.bm", 0);
-	g_pFramesThunder[0] = bitmapCreateFromPath("data/thunder_0.bm", 0);
-	g_pFramesThunder[1] = bitmapCreateFromPath("data/thunder_1.bm", 0);
-	g_pFramesCross = bitmapCreateFromPath("data/cross.bm", 0);
-
-	g_pFontBig = fontCreateFromPath("data/menu.fnt");
-	g_pFontSmall = fontCreateFromPath("data/uni54.fnt");
-	g_pTextBitmap = fontCreateTextBitMap(320, g_pFontBig->uwHeight);
-
-	g_pSfxCrumble = ptplayerSfxCreateFromPath("data/crumble.sfx", 0);
-	g_pSfxNo = ptplayerSfxCreateFromPath("data/noo.sfx", 0);
-	g_pSfxSwipes[0] = ptplayerSfxCreateFromPath("data/swipe1.sfx", 0);
-	g_pSfxSwipes[1] = ptplayerSfxCreateFromPath("data/swipe2.sfx", 0);
-	g_pSfxSwipeHit = ptplayerSfxCreateFromPath("data/swipeHit.sfx", 0);
-	g_pSfxCountdown[2] = ptplayerSfxCreateFromPath("data/cd3.sfx", 0);
-	g_pSfxCountdown[1] = ptplayerSfxCreateFromPath("data/cd2.sfx", 0);
-	g_pSfxCountdown[0] = ptplayerSfxCreateFromPath("data/cd1.sfx", 0);
-	g_pSfxCountdownFight = ptplayerSfxCreateFromPath("data/cdfight.sfx", 0);
-	g_pSfxThunder = ptplayerSfxCreateFromPath("data/thunder.sfx", 0);
-
-	g_pModCombat = ptplayerModCreateFromPath("data/charena_game.mod");
-	g_pModMenu = ptplayerModCreateFromPath("data/charena_menu.mod");
-
-	g_pModSamples = ptplayerSampleDataCreateFromPath("data/samples.samplepack");
+//------------------------------------------------------------------ PRIVATE FNS
+
+static UWORD reverseWord(UWORD uwWord) {
+	uwWord = ((uwWord >> 1) & 0x5555) | ((uwWord & 0x5555) << 1);
+	uwWord = ((uwWord >> 2) & 0x3333) | ((uwWord & 0x3333) << 2);
+	uwWord = ((uwWord >> 4) & 0x0F0F) | ((uwWord & 0x0F0F) << 4);
+	return (uwWord >> 8) | (uwWord << 8);
+}
+
+static void warriorFramesMirror(tBitMap *pFrames) {
+	// Interleaved 16px wide frames: each frame is a continuous run of words
+	UWORD uwWordsPerFrame = WARRIOR_FRAME_SIZE * pFrames->Depth;
+	for(UBYTE i = 0; i < WARRIOR_FRAME_MIRRORED_COUNT; ++i) {
+		const UWORD *pSrc = (UWORD*)&pFrames->Planes[0][
+			s_pWarriorMirrorSources[i] * uwWordsPerFrame * sizeof(UWORD)
+		];
+		UWORD *pDst = (UWORD*)&pFrames->Planes[0][
+			(WARRIOR_FRAME_STORED_COUNT + i) * uwWordsPerFrame * sizeof(UWORD)
+		];
+		for(UWORD uwWord = 0; uwWord < uwWordsPerFrame; ++uwWord) {
+			pDst[uwWord] = reverseWord(pSrc[uwWord]);
+		}
+	}
+}
+
+static tBitMap *packedCreate(const char *szPath, UBYTE *pIsOk) {
+	tBitMap *pBitmap = bitmapPackCreateFromPath(szPath, 0);
+	if(!pBitmap) {
+		*pIsOk = 0;
+	}
+	return pBitmap;
+}
+
+static void packedDestroy(tBitMap *pBitmap) {
+	// Left null if loading failed
+	if(pBitmap) {
+		bitmapDestroy(pBitmap);
+	}
+}
+
+static tBitMap *warriorFramesCreate(const char *szPath) {
+	tBitMap *pFrames = bitmapCreate(
+		WARRIOR_FRAME_SIZE,
+		WARRIOR_FRAME_SIZE * (WARRIOR_FRAME_STORED_COUNT + WARRIOR_FRAME_MIRRORED_COUNT),
+		DISPLAY_BPP, BMF_INTERLEAVED
+	);
+	bitmapLoadFromFd(pFrames, loaderFileOpen(szPath), 0, 0);
+	warriorFramesMirror(pFrames);
+	return pFrames;
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+UBYTE assetsGlobalCreate(void) {
+	UBYTE isOk = 1;
+	g_pWarriorFrames = warriorFramesCreate("data/warrior.bm");
+	g_pWarriorMasks = warriorFramesCreate("data/warrior_mask.bm");
+#if defined(GAME_WARRIOR_SHIFT_PHASES)
+	frameCacheCreate(g_pWarriorFrames, g_pWarriorMasks, GAME_WARRIOR_SHIFT_PHASES);
+#endif
+	g_pCountdownFrames = packedCreate("data/countdown.pbm", &isOk);
+	g_pCountdownMask = packedCreate("data/countdown_mask.pbm", &isOk);
+	g_pFightBitmap = packedCreate("data/fight.pbm", &isOk);
+	g_pFightMask = packedCreate("data/fight_mask.pbm", &isOk);
+	g_pTitleBitmap = packedCreate("data/title.pbm", &isOk);
+	g_pTitleMask = packedCreate("data/title_mask.pbm", &isOk);
+
+	g_pChaos = packedCreate("data/chaos.pbm", &isOk);
+	g_pTileset = packedCreate("data/tiles.pbm", &isOk);
+	g_pTilesetMask = packedCreate("data/tiles_mask.pbm", &isOk);
+	g_pFramesThunder[0] = bitmapCreateFromFd(loaderFileOpen("data/thunder_0.bm"), 0);
+	g_pFramesThunder[1] = bitmapCreateFromFd(loaderFileOpen("data/thunder_1.bm"), 0);
+	g_pFramesCross = bitmapCreateFromFd(loaderFileOpen("data/cross.bm"), 0);
+
+	g_pFontBig = fontCreateFromFd(loaderFileOpen("data/menu.fnt"));
+	g_pFontSmall = fontCreateFromFd(loaderFileOpen("data/uni54.fnt"));
+	tFont *pAtlasFonts[] = {g_pFontSmall, g_pFontBig};
+	textAtlasCreate("data/menu_text.atl", pAtlasFonts, ARRAY_SIZE(pAtlasFonts));
+
+	g_pSfxCrumble = ptplayerSfxCreateFromFd(loaderFileOpen("data/crumble.sfx"), 0);
+	g_pSfxNo = ptplayerSfxCreateFromFd(loaderFileOpen("data/noo.sfx"), 0);
+	g_pSfxSwipes[0] = ptplayerSfxCreateFromFd(loaderFileOpen("data/swipe1.sfx"), 0);
+	g_pSfxSwipes[1] = ptplayerSfxCreateFromFd(loaderFileOpen("data/swipe2.sfx"), 0);
+	g_pSfxSwipeHit = ptplayerSfxCreateFromFd(loaderFileOpen("data/swipeHit.sfx"), 0);
+	g_pSfxCountdown[2] = ptplayerSfxCreateFromFd(loaderFileOpen("data/cd3.sfx"), 0);
+	g_pSfxCountdown[1] = ptplayerSfxCreateFromFd(loaderFileOpen("data/cd2.sfx"), 0);
+	g_pSfxCountdown[0] = ptplayerSfxCreateFromFd(loaderFileOpen("data/cd1.sfx"), 0);
+	g_pSfxCountdownFight = ptplayerSfxCreateFromFd(loaderFileOpen("data/cdfight.sfx"), 0);
+	g_pSfxThunder = ptplayerSfxCreateFromFd(loaderFileOpen("data/thunder.sfx"), 0);
+
+	g_pModCombat = ptplayerModCreateFromFd(loaderFileOpen("data/charena_game.mod"));
+	g_pModMenu = ptplayerModCreateFromFd(loaderFileOpen("data/charena_menu.mod"));
+
+	g_pModSamples = ptplayerSampleDataCreateFromFd(loaderFileOpen("data/samples.samplepack"));
+	return isOk;
 }
 
 void assetsGlobalDestroy(void) {
 	bitmapDestroy(g_pWarriorFrames);
 	bitmapDestroy(g_pWarriorMasks);
-	bitmapDestroy(g_pCountdownMask);
-	bitmapDestroy(g_pCountdownFrames);
-	bitmapDestroy(g_pFightBitmap);
-	bitmapDestroy(g_pFightMask);
-	bitmapDestroy(g_pTitleBitmap);
-	bitmapDestroy(g_pTitleMask);
-
-	bitmapDestroy(g_pChaos);
-	bitmapDestroy(g_pTileset);
-	bitmapDestroy(g_pTilesetMask);
+#if defined(GAME_WARRIOR_SHIFT_PHASES)
+	frameCacheDestroy();
+#endif
+	packedDestroy(g_pCountdownMask);
+	packedDestroy(g_pCountdownFrames);
+	packedDestroy(g_pFightBitmap);
+	packedDestroy(g_pFightMask);
+	packedDestroy(g_pTitleBitmap);
+	packedDestroy(g_pTitleMask);
+
+	packedDestroy(g_pChaos);
+	packedDestroy(g_pTileset);
+	packedDestroy(g_pTilesetMask);
 	bitmapDestroy(g_pFramesThunder[0]);
 	bitmapDestroy(g_pFramesThunder[1]);
 	bitmapDestroy(g_pFramesCross);
 
+	textAtlasDestroy();
 	fontDestroy(g_pFontBig);
 	fontDestroy(g_pFontSmall);
-	fontDestroyTextBitMap(g_pTextBitmap);
 
 	ptplayerSfxDestroy(g_pSfxCrumble);
 	ptplayerSfxDestroy(g_pSfxNo);
@@ -9,7 +9,12 @@
 #include <ace/utils/font.h>
 #include <ace/managers/ptplayer.h>
 
-void assetsGlobalCreate(void);
+/**
+ * @brief Loads assets used through whole game.
+ * @return 0 if any packed bitmap failed to load, 1 on success.
+ * Either way, assetsGlobalDestroy() frees what got loaded.
+ */
+UBYTE assetsGlobalCreate(void);
 
 void assetsGlobalDestroy(void);
 
@@ -31,7 +36,6 @@ extern tBitMap *g_pFramesCross;
 
 extern tFont *g_pFontBig;
 extern tFont *g_pFontSmall;
-extern tTextBitMap *g_pTextBitmap;
 
 extern tPtplayerSfx *g_pSfxNo;
 extern tPtplayerSfx *g_pSfxSwipes[2];
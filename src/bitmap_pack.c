@@ -0,0 +1,210 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "bitmap_pack.h"
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include "loader.h"
+#include "mem_track.h"
+
+#define BITMAP_PACK_MAGIC 0x43415042 // "CAPB"
+#define BITMAP_PACK_FLAG_INTERLEAVED 1
+
+typedef struct tPlaneWriter {
+	UBYTE *pDst;
+	LONG lDelta; ///< Offset to same byte in previous plane, 0 if not used.
+	UWORD uwRowBytes;
+	UWORD uwRowSkip;
+	UWORD uwRowLeft;
+	UWORD uwRowsLeft;
+} tPlaneWriter;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static void writerNextRow(tPlaneWriter *pWriter) {
+	pWriter->pDst += pWriter->uwRowSkip;
+	pWriter->uwRowLeft = pWriter->uwRowBytes;
+	--pWriter->uwRowsLeft;
+}
+
+static UBYTE writerCopy(tPlaneWriter *pWriter, const UBYTE *pSrc, ULONG ulCount) {
+	while(ulCount) {
+		if(!pWriter->uwRowsLeft) {
+			return 0;
+		}
+		UWORD uwChunk = MIN(ulCount, pWriter->uwRowLeft);
+		ulCount -= uwChunk;
+		pWriter->uwRowLeft -= uwChunk;
+		UBYTE *pDst = pWriter->pDst;
+		pWriter->pDst += uwChunk;
+		if(pWriter->lDelta) {
+			const UBYTE *pPrev = pDst + pWriter->lDelta;
+			do {
+				*(pDst++) = *(pSrc++) ^ *(pPrev++);
+			} while(--uwChunk);
+		}
+		else {
+			do {
+				*(pDst++) = *(pSrc++);
+			} while(--uwChunk);
+		}
+		if(!pWriter->uwRowLeft) {
+			writerNextRow(pWriter);
+		}
+	}
+	return 1;
+}
+
+static UBYTE writerFill(tPlaneWriter *pWriter, UBYTE ubValue, UWORD uwCount) {
+	while(uwCount) {
+		if(!pWriter->uwRowsLeft) {
+			return 0;
+		}
+		UWORD uwChunk = MIN(uwCount, pWriter->uwRowLeft);
+		uwCount -= uwChunk;
+		pWriter->uwRowLeft -= uwChunk;
+		UBYTE *pDst = pWriter->pDst;
+		pWriter->pDst += uwChunk;
+		if(pWriter->lDelta) {
+			const UBYTE *pPrev = pDst + pWriter->lDelta;
+			do {
+				*(pDst++) = ubValue ^ *(pPrev++);
+			} while(--uwChunk);
+		}
+		else {
+			do {
+				*(pDst++) = ubValue;
+			} while(--uwChunk);
+		}
+		if(!pWriter->uwRowLeft) {
+			writerNextRow(pWriter);
+		}
+	}
+	return 1;
+}
+
+static UBYTE unpackPlane(
+	tBitMap *pBitmap, UBYTE ubPlane, UBYTE ubMethod,
+	const UBYTE *pSrc, ULONG ulSize
+) {
+	tPlaneWriter sWriter = {
+		.pDst = pBitmap->Planes[ubPlane],
+		.lDelta = 0,
+		.uwRowBytes = bitmapGetByteWidth(pBitmap),
+		.uwRowSkip = pBitmap->BytesPerRow - bitmapGetByteWidth(pBitmap),
+		.uwRowLeft = bitmapGetByteWidth(pBitmap),
+		.uwRowsLeft = pBitmap->Rows
+	};
+	if(ubMethod & BITMAP_PACK_METHOD_DELTA) {
+		if(!ubPlane) {
+			return 0;
+		}
+		sWriter.lDelta = pBitmap->Planes[ubPlane - 1] - pBitmap->Planes[ubPlane];
+	}
+
+	if(!(ubMethod & BITMAP_PACK_METHOD_RLE)) {
+		return writerCopy(&sWriter, pSrc, ulSize) && !sWriter.uwRowsLeft;
+	}
+
+	const UBYTE *pEnd = pSrc + ulSize;
+	while(pSrc < pEnd) {
+		UBYTE ubCtl = *(pSrc++);
+		if(ubCtl < 128) {
+			UWORD uwCount = ubCtl + 1;
+			if(pSrc + uwCount > pEnd || !writerCopy(&sWriter, pSrc, uwCount)) {
+				return 0;
+			}
+			pSrc += uwCount;
+		}
+		else if(ubCtl > 128) {
+			if(pSrc >= pEnd || !writerFill(&sWriter, *(pSrc++), 257 - ubCtl)) {
+				return 0;
+			}
+		}
+	}
+	return !sWriter.uwRowsLeft;
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+tBitMap *bitmapPackCreateFromPath(const char *szPath, UBYTE isFast) {
+	logBlockBegin(
+		"bitmapPackCreateFromPath(szPath: '%s', isFast: %hhu)", szPath, isFast
+	);
+	tFile *pFile = loaderFileOpen(szPath);
+	if(!pFile) {
+		logWrite("ERR: File doesn't exist: '%s'\n", szPath);
+		logBlockEnd("bitmapPackCreateFromPath()");
+		return 0;
+	}
+
+	ULONG ulMagic;
+	UWORD uwWidth, uwHeight;
+	UBYTE ubDepth, ubFlags;
+	fileRead(pFile, &ulMagic, sizeof(ulMagic));
+	fileRead(pFile, &uwWidth, sizeof(uwWidth));
+	fileRead(pFile, &uwHeight, sizeof(uwHeight));
+	fileRead(pFile, &ubDepth, sizeof(ubDepth));
+	fileRead(pFile, &ubFlags, sizeof(ubFlags));
+	if(ulMagic != BITMAP_PACK_MAGIC || !ubDepth || ubDepth > 8) {
+		logWrite("ERR: Not a packed bitmap: '%s'\n", szPath);
+		fileClose(pFile);
+		logBlockEnd("bitmapPackCreateFromPath()");
+		return 0;
+	}
+
+	UBYTE pMethods[8];
+	ULONG pSizes[8];
+	ULONG ulPackedSize = 0;
+	for(UBYTE ubPlane = 0; ubPlane < ubDepth; ++ubPlane) {
+		UBYTE ubReserved;
+		fileRead(pFile, &pMethods[ubPlane], sizeof(pMethods[ubPlane]));
+		fileRead(pFile, &ubReserved, sizeof(ubReserved));
+		fileRead(pFile, &pSizes[ubPlane], sizeof(pSizes[ubPlane]));
+		ulPackedSize += pSizes[ubPlane];
+	}
+
+	// Whole packed data in one read, floppy likes big reads
+	UBYTE *pPacked = memTrackAllocFast(MEM_TAG_ASSETS, ulPackedSize);
+	if(!pPacked) {
+		logWrite("ERR: No memory for %lu packed bytes of '%s'\n", ulPackedSize, szPath);
+		fileClose(pFile);
+		logBlockEnd("bitmapPackCreateFromPath()");
+		return 0;
+	}
+	fileRead(pFile, pPacked, ulPackedSize);
+	fileClose(pFile);
+
+	UBYTE ubBitmapFlags = (
+		((ubFlags & BITMAP_PACK_FLAG_INTERLEAVED) ? BMF_INTERLEAVED : 0) |
+		(isFast ? BMF_FASTMEM : 0)
+	);
+	tBitMap *pBitmap = bitmapCreate(uwWidth, uwHeight, ubDepth, ubBitmapFlags);
+	if(!pBitmap) {
+		logWrite("ERR: No memory for %hux%hux%hhu bitmap of '%s'\n", uwWidth, uwHeight, ubDepth, szPath);
+		memTrackFreeFast(MEM_TAG_ASSETS, pPacked, ulPackedSize);
+		logBlockEnd("bitmapPackCreateFromPath()");
+		return 0;
+	}
+	const UBYTE *pSrc = pPacked;
+	for(UBYTE ubPlane = 0; ubPlane < ubDepth; ++ubPlane) {
+		if(!unpackPlane(pBitmap, ubPlane, pMethods[ubPlane], pSrc, pSizes[ubPlane])) {
+			logWrite("ERR: Malformed plane %hhu in '%s'\n", ubPlane, szPath);
+			bitmapDestroy(pBitmap);
+			pBitmap = 0;
+			break;
+		}
+		pSrc += pSizes[ubPlane];
+	}
+	memTrackFreeFast(MEM_TAG_ASSETS, pPacked, ulPackedSize);
+
+	if(pBitmap) {
+		logWrite(
+			"Unpacked %hux%hux%hhu from %lu bytes\n", uwWidth, uwHeight, ubDepth,
+			ulPackedSize
+		);
+	}
+	logBlockEnd("bitmapPackCreateFromPath()");
+	return pBitmap;
+}
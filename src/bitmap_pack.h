@@ -0,0 +1,37 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_BITMAP_PACK_H
+#define INCLUDE_BITMAP_PACK_H
+
+#include <ace/utils/bitmap.h>
+
+/**
+ * @brief Packed bitmap container, produced by tools/bitmap_pack.c.
+ *
+ * Big endian layout:
+ * - ULONG magic "CAPB", UWORD width, UWORD height, UBYTE depth, UBYTE flags,
+ * - per plane: UBYTE method, UBYTE reserved, ULONG packed size,
+ * - packed plane streams, one after another.
+ *
+ * Plane stream is plane's rows put together. Method is combination of:
+ * - BITMAP_PACK_METHOD_RLE: PackBits - control byte n < 128 is followed by
+ *   n + 1 literals, n > 128 by single byte repeated 257 - n times,
+ * - BITMAP_PACK_METHOD_DELTA: plane is XOR-ed with previous one, which makes
+ *   masks and planes sharing shapes pack into long runs.
+ */
+
+#define BITMAP_PACK_METHOD_RLE 1
+#define BITMAP_PACK_METHOD_DELTA 2
+
+/**
+ * @brief Creates bitmap and unpacks data straight into it.
+ *
+ * @param szPath Path to packed bitmap.
+ * @param isFast Set to 1 to allocate bitmap in FAST memory.
+ * @return Created bitmap, 0 on failure.
+ */
+tBitMap *bitmapPackCreateFromPath(const char *szPath, UBYTE isFast);
+
+#endif // INCLUDE_BITMAP_PACK_H
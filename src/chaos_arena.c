@@ -10,31 +10,50 @@
 #include "menu.h"
 #include "tile.h"
 #include "debug.h"
+#include "rng.h"
+#include "loader.h"
+#include "trace.h"
+#include "mem_track.h"
+#include "latency.h"
+#include "sfx.h"
 
 tStateManager *g_pStateMachineDisplay;
-tRandManager g_sRandManager;
 
 void genericCreate(void) {
+	memTrackCreate();
+	memTrackScopeBegin(MEM_TAG_LOADER);
+	loaderCreate();
+	memTrackScopeEnd();
 	g_pStateMachineDisplay = stateManagerCreate();
 	keyCreate();
 	joyOpen();
 	joyEnableParallel();
 	ptplayerCreate(1);
-	randInit(&g_sRandManager, 0x2184, 0x1911);
+	rngInit(0x21841911);
 	statePush(g_pStateMachineDisplay, &g_sStateLogo);
 }
 
 void genericProcess(void) {
 	debugSetColor(0x333);
+	traceNextFrame();
+	latencyNextFrame();
 	ptplayerProcess();
 	keyProcess();
 	joyProcess();
 
 	if (keyUse(KEY_F1)) {
 		debugToggle();
+		// Latency is probed only in debug mode, each session reported separately
+		if(debugIsEnabled()) {
+			latencyReset();
+		}
+		else {
+			latencyReport();
+		}
 	}
 
 	stateProcess(g_pStateMachineDisplay);
+	sfxProcess();
 }
 
 void genericDestroy(void) {
@@ -44,4 +63,9 @@ void genericDestroy(void) {
 	ptplayerDestroy();
 	keyDestroy();
 	joyClose();
+	memTrackScopeBegin(MEM_TAG_LOADER);
+	loaderDestroy();
+	memTrackScopeEnd();
+	memTrackReport();
+	traceDrain();
 }
@@ -5,14 +5,12 @@
 #ifndef INCLDE_CHAOS_ARENA_H
 #define INCLDE_CHAOS_ARENA_H
 
-#include <ace/managers/rand.h>
 #include <ace/managers/state.h>
 
 #define PLAYER_MAX_COUNT 6
 
 extern tStateManager *g_pStateMachineDisplay;
 extern tStateManager *g_pStateMachineGame;
-extern tRandManager g_sRandManager;
 
 // Display states
 extern tState g_sStateLogo;
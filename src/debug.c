@@ -21,6 +21,10 @@ void debugEnable(UBYTE isEnabled) {
 	s_isDebug = isEnabled;
 }
 
+UBYTE debugIsEnabled(void) {
+	return s_isDebug;
+}
+
 void debugReset(void) {
 	g_pCustom->color[0] = s_uwBaseColor;
 }
@@ -31,4 +35,10 @@ void debugSetColor(UWORD uwColor) {
 	}
 }
 
+UWORD debugGetBeamLine(void) {
+	// VPOSR and VHPOSR read at once, so that line can't change between them
+	ULONG ulPos = *(volatile ULONG*)&g_pCustom->vposr;
+	return (ulPos >> 8) & 0x1FF;
+}
+
 
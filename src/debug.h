@@ -13,9 +13,16 @@ void debugToggle(void);
 
 void debugEnable(UBYTE isEnabled);
 
+UBYTE debugIsEnabled(void);
+
 void debugReset(void);
 
 void debugSetColor(UWORD uwColor);
 
+/**
+ * @brief Returns raster line the beam is currently at, 0..312 on PAL.
+ */
+UWORD debugGetBeamLine(void);
+
 
 #endif // INCLUDE_DEBUG_H
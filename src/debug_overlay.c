@@ -0,0 +1,202 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "debug_overlay.h"
+
+#if !defined(GAME_WARRIOR_SPRITES)
+
+#include <ace/managers/sprite.h>
+#include "debug.h"
+#include "display.h"
+#include "tile.h"
+#include "warrior.h"
+
+#define OVERLAY_GRID_WIDTH (MAP_TILE_WIDTH_MAX * MAP_TILE_SIZE / WARRIOR_LOOKUP_CELL_SIZE)
+#define OVERLAY_GRID_HEIGHT (MAP_TILE_HEIGHT_MAX * MAP_TILE_SIZE / WARRIOR_LOOKUP_CELL_SIZE)
+#define OVERLAY_CHANNEL_COUNT (OVERLAY_GRID_WIDTH / 16)
+#define OVERLAY_WIDTH (OVERLAY_CHANNEL_COUNT * 16)
+#define OVERLAY_BAR_HEIGHT 2
+#define OVERLAY_BAR_SPACING 1
+#define OVERLAY_HEIGHT (OVERLAY_GRID_HEIGHT + OVERLAY_BAR_COUNT * (OVERLAY_BAR_SPACING + OVERLAY_BAR_HEIGHT))
+// Full lookup scan would cost more than rest of the overlay
+#define OVERLAY_LOOKUP_ROWS_PER_FRAME 8
+#define OVERLAY_FRAME_LINES 313
+#define OVERLAY_RASTER_COLOR 0xF0F
+
+typedef enum tOverlayBar {
+	OVERLAY_BAR_REDRAW_QUEUE, ///< Color 1, 2px per entry.
+	OVERLAY_BAR_CRUMBLES, ///< Color 2, 2px per tile.
+	OVERLAY_BAR_COST, ///< Color 3, 1px per raster line.
+	OVERLAY_BAR_COUNT
+} tOverlayBar;
+
+typedef UWORD tOverlayRow[OVERLAY_CHANNEL_COUNT];
+
+static tSprite *s_pSprites[OVERLAY_CHANNEL_COUNT];
+static tBitMap *s_pBuffers[2][OVERLAY_CHANNEL_COUNT]; ///< [buffer][channel]
+static tOverlayRow s_pLookupRows[OVERLAY_GRID_HEIGHT]; ///< Kept between frames.
+static tOverlayRow s_pCrumbleRows[OVERLAY_GRID_HEIGHT];
+static tOverlayRow s_pAiRows[OVERLAY_GRID_HEIGHT];
+static UBYTE s_pBars[OVERLAY_BAR_COUNT];
+static UBYTE s_ubNextLookupRow;
+static UBYTE s_ubBufferIndex;
+static UBYTE s_isShown;
+static UWORD s_uwCost; ///< Of previous frame, in raster lines.
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static void overlayPlot(tOverlayRow *pRows, UWORD uwMapX, UWORD uwMapY) {
+	// Positions off the map's left or top edge wrap around and get rejected too
+	UWORD uwCellX = uwMapX / WARRIOR_LOOKUP_CELL_SIZE;
+	UWORD uwCellY = uwMapY / WARRIOR_LOOKUP_CELL_SIZE;
+	if(uwCellX >= OVERLAY_GRID_WIDTH || uwCellY >= OVERLAY_GRID_HEIGHT) {
+		return;
+	}
+	pRows[uwCellY][uwCellX / 16] |= BV(15 - (uwCellX & 15));
+}
+
+static void overlayClearRows(tOverlayRow *pRows) {
+	UWORD *pWords = &pRows[0][0];
+	for(UWORD i = OVERLAY_GRID_HEIGHT * OVERLAY_CHANNEL_COUNT; i--;) {
+		*(pWords++) = 0;
+	}
+}
+
+static void overlayScanLookup(void) {
+	UBYTE ubRowCount = tileGetMapHeight() * (MAP_TILE_SIZE / WARRIOR_LOOKUP_CELL_SIZE);
+	for(UBYTE i = 0; i < OVERLAY_LOOKUP_ROWS_PER_FRAME; ++i) {
+		if(s_ubNextLookupRow >= ubRowCount) {
+			s_ubNextLookupRow = 0;
+		}
+		warriorsGetLookupRow(s_ubNextLookupRow, s_pLookupRows[s_ubNextLookupRow]);
+		++s_ubNextLookupRow;
+	}
+}
+
+static void overlayDrawMarks(void) {
+	overlayClearRows(s_pCrumbleRows);
+	tUbCoordYX pCrumbles[TILE_CRUMBLES_MAX];
+	UBYTE ubCrumbleCount = tileGetCrumbles(pCrumbles);
+	for(UBYTE i = 0; i < ubCrumbleCount; ++i) {
+		// Tile spans 2x2 cells
+		UWORD uwX = pCrumbles[i].ubX * MAP_TILE_SIZE;
+		UWORD uwY = pCrumbles[i].ubY * MAP_TILE_SIZE;
+		overlayPlot(s_pCrumbleRows, uwX, uwY);
+		overlayPlot(s_pCrumbleRows, uwX + HALF_TILE_SIZE, uwY);
+		overlayPlot(s_pCrumbleRows, uwX, uwY + HALF_TILE_SIZE);
+		overlayPlot(s_pCrumbleRows, uwX + HALF_TILE_SIZE, uwY + HALF_TILE_SIZE);
+	}
+
+	overlayClearRows(s_pAiRows);
+	tUwCoordYX pIntents[STEER_SET_SIZE];
+	UBYTE ubIntentCount = warriorsGetAiIntents(pIntents);
+	for(UBYTE i = 0; i < ubIntentCount; ++i) {
+		overlayPlot(s_pAiRows, pIntents[i].uwX, pIntents[i].uwY);
+	}
+
+	s_pBars[OVERLAY_BAR_REDRAW_QUEUE] = MIN(tileGetRedrawQueueDepth() * 2, OVERLAY_WIDTH);
+	s_pBars[OVERLAY_BAR_CRUMBLES] = MIN(ubCrumbleCount * 2, OVERLAY_WIDTH);
+	s_pBars[OVERLAY_BAR_COST] = MIN(s_uwCost, OVERLAY_WIDTH);
+}
+
+static void overlayCompose(void) {
+	// Interleaved 2bpp rows, past the control words
+	UWORD *pWrite[OVERLAY_CHANNEL_COUNT];
+	for(UBYTE ubChannel = 0; ubChannel < OVERLAY_CHANNEL_COUNT; ++ubChannel) {
+		pWrite[ubChannel] = (UWORD*)s_pBuffers[s_ubBufferIndex][ubChannel]->Planes[0] + 2;
+	}
+
+	for(UBYTE ubY = 0; ubY < OVERLAY_GRID_HEIGHT; ++ubY) {
+		for(UBYTE ubChannel = 0; ubChannel < OVERLAY_CHANNEL_COUNT; ++ubChannel) {
+			UWORD uwAi = s_pAiRows[ubY][ubChannel];
+			*(pWrite[ubChannel]++) = s_pLookupRows[ubY][ubChannel] | uwAi;
+			*(pWrite[ubChannel]++) = s_pCrumbleRows[ubY][ubChannel] | uwAi;
+		}
+	}
+
+	for(tOverlayBar eBar = 0; eBar < OVERLAY_BAR_COUNT; ++eBar) {
+		UBYTE ubColor = eBar + 1;
+		UBYTE ubLength = s_pBars[eBar];
+		for(UBYTE ubChannel = 0; ubChannel < OVERLAY_CHANNEL_COUNT; ++ubChannel) {
+			UWORD uwBits = (ubLength >= 16) ? 0xFFFF : (UWORD)~(0xFFFF >> ubLength);
+			ubLength = (ubLength >= 16) ? ubLength - 16 : 0;
+			// Spacing rows stay blank since buffers are cleared on creation
+			UWORD *pRow = pWrite[ubChannel] + OVERLAY_BAR_SPACING * 2;
+			for(UBYTE ubRow = 0; ubRow < OVERLAY_BAR_HEIGHT; ++ubRow) {
+				*(pRow++) = (ubColor & BV(0)) ? uwBits : 0;
+				*(pRow++) = (ubColor & BV(1)) ? uwBits : 0;
+			}
+			pWrite[ubChannel] = pRow;
+		}
+	}
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void debugOverlayCreate(void) {
+	for(UBYTE ubChannel = 0; ubChannel < OVERLAY_CHANNEL_COUNT; ++ubChannel) {
+		for(UBYTE ubBuffer = 0; ubBuffer < 2; ++ubBuffer) {
+			// Control words + data + end of sprite
+			s_pBuffers[ubBuffer][ubChannel] = bitmapCreate(
+				16, 1 + OVERLAY_HEIGHT + 1, 2, BMF_CLEAR | BMF_INTERLEAVED
+			);
+		}
+		tSprite *pSprite = spriteAdd(
+			DISPLAY_SPRITE_CHANNEL_OVERLAY_FIRST + ubChannel, s_pBuffers[0][ubChannel]
+		);
+		pSprite->wX = SCREEN_PAL_WIDTH - OVERLAY_WIDTH + 16 * ubChannel;
+		pSprite->wY = 0;
+		spriteSetEnabled(pSprite, 0);
+		s_pSprites[ubChannel] = pSprite;
+	}
+	overlayClearRows(s_pLookupRows);
+	s_ubNextLookupRow = 0;
+	s_ubBufferIndex = 0;
+	s_isShown = 0;
+	s_uwCost = 0;
+}
+
+void debugOverlayDestroy(void) {
+	for(UBYTE ubChannel = 0; ubChannel < OVERLAY_CHANNEL_COUNT; ++ubChannel) {
+		spriteRemove(s_pSprites[ubChannel]);
+		bitmapDestroy(s_pBuffers[0][ubChannel]);
+		bitmapDestroy(s_pBuffers[1][ubChannel]);
+	}
+}
+
+void debugOverlayProcess(void) {
+	UBYTE isDebug = debugIsEnabled();
+	if(isDebug != s_isShown) {
+		s_isShown = isDebug;
+		for(UBYTE ubChannel = 0; ubChannel < OVERLAY_CHANNEL_COUNT; ++ubChannel) {
+			spriteSetEnabled(s_pSprites[ubChannel], isDebug);
+		}
+	}
+	if(!isDebug) {
+		return;
+	}
+
+	UWORD uwStartLine = debugGetBeamLine();
+	debugSetColor(OVERLAY_RASTER_COLOR);
+	overlayScanLookup();
+	overlayDrawMarks();
+
+	// Write to buffers which aren't displayed right now
+	s_ubBufferIndex = !s_ubBufferIndex;
+	overlayCompose();
+	for(UBYTE ubChannel = 0; ubChannel < OVERLAY_CHANNEL_COUNT; ++ubChannel) {
+		tSprite *pSprite = s_pSprites[ubChannel];
+		spriteSetBitmap(pSprite, s_pBuffers[s_ubBufferIndex][ubChannel]);
+		spriteRequestMetadataUpdate(pSprite);
+		spriteProcess(pSprite);
+	}
+
+	UWORD uwEndLine = debugGetBeamLine();
+	s_uwCost = (
+		uwEndLine >= uwStartLine ?
+		uwEndLine - uwStartLine : uwEndLine + OVERLAY_FRAME_LINES - uwStartLine
+	);
+}
+
+#endif // !GAME_WARRIOR_SPRITES
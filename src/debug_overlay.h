@@ -0,0 +1,48 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_DEBUG_OVERLAY_H
+#define INCLUDE_DEBUG_OVERLAY_H
+
+#include <ace/types.h>
+
+/**
+ * @brief Debug minimap shown on sprite channels 4-7 while debug mode is on.
+ *
+ * Each pixel is one warrior lookup cell, so whole map fits in 64px wide strip
+ * in top right corner. It never touches playfield buffers, so bob manager's
+ * restore stays intact. Colors:
+ * - 1: cell registered in warrior lookup, rescanned few rows per frame,
+ * - 2: crumbling tile,
+ * - 3: cell AI warrior moves to or strikes at.
+ *
+ * Bars below map show tile redraw queue depth, crumbling tile count
+ * and overlay's own cost in raster lines, measured in previous frame.
+ * Overlay time also shows as magenta raster bar.
+ *
+ * Channels 4-7 are used by sprite mux, so with GAME_WARRIOR_SPRITES
+ * all calls compile to nothing.
+ */
+
+#if !defined(GAME_WARRIOR_SPRITES)
+
+void debugOverlayCreate(void);
+
+void debugOverlayDestroy(void);
+
+/**
+ * @brief Shows or hides overlay according to debug mode and redraws it.
+ * Call once per frame, after bobs are drawn.
+ */
+void debugOverlayProcess(void);
+
+#else
+
+#define debugOverlayCreate()
+#define debugOverlayDestroy()
+#define debugOverlayProcess()
+
+#endif // !GAME_WARRIOR_SPRITES
+
+#endif // INCLUDE_DEBUG_OVERLAY_H
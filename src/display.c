@@ -4,18 +4,22 @@
 
 #include "display.h"
 #include <ace/managers/viewport/simplebuffer.h>
+#include <ace/managers/viewport/scrollbuffer.h>
 #include <ace/managers/system.h>
 #include <ace/managers/sprite.h>
 #include <ace/utils/palette.h>
 #include "tile.h"
 #include "debug.h"
+#include "loader.h"
 
 #define GAME_COLORS (1 << DISPLAY_BPP)
 #define FADE_SPEED 50
+// Streamed row must get drawn before camera scrolls past the margin, see tile.c
+#define CAMERA_SPEED 1
 
 static tView *s_pView;
 static tVPort *s_pVp;
-static tSimpleBufferManager *s_pVpManager;
+static tScrollBufferManager *s_pVpManager;
 static UWORD s_pPaletteThunder[8];
 static tFade *s_pFade;
 static UWORD s_pPaletteRef[GAME_COLORS];
@@ -23,8 +27,12 @@ static UWORD s_pPaletteRef[GAME_COLORS];
 void displayCreate(void) {
 	// Dear reader - don't EVER do one global display manager, unless you're
 	// 500% sure you won't need different BPP or copperlist mode along the way.
-	UWORD uwDisplayCopperInstructions = simpleBufferGetRawCopperlistInstructionCount(DISPLAY_BPP);
+	UWORD uwDisplayCopperInstructions = scrollBufferGetRawCopperlistInstructionCount(DISPLAY_BPP);
 	UWORD uwSpriteCopperInstructions = 8 * 2;
+	// Break block goes after the start one, which is same as simple buffer's.
+	UWORD uwBreakCopperOffset = (
+		uwSpriteCopperInstructions + simpleBufferGetRawCopperlistInstructionCount(DISPLAY_BPP)
+	);
 	s_pView = viewCreate(0,
 		TAG_VIEW_COPLIST_MODE, VIEW_COPLIST_MODE_RAW,
 		TAG_VIEW_COPLIST_RAW_COUNT, uwDisplayCopperInstructions + uwSpriteCopperInstructions + 2,
@@ -36,31 +44,46 @@ void displayCreate(void) {
 		TAG_VPORT_VIEW, s_pView,
 	TAG_DONE);
 
-	s_pVpManager = simpleBufferCreate(0,
-		TAG_SIMPLEBUFFER_BITMAP_FLAGS, BMF_CLEAR | BMF_INTERLEAVED,
-		TAG_SIMPLEBUFFER_IS_DBLBUF, 1,
-		TAG_SIMPLEBUFFER_USE_X_SCROLLING, 0,
-		TAG_SIMPLEBUFFER_BOUND_WIDTH, DISPLAY_WIDTH,
-		TAG_SIMPLEBUFFER_BOUND_HEIGHT, DISPLAY_HEIGHT,
-		TAG_SIMPLEBUFFER_VPORT, s_pVp,
-		TAG_SIMPLEBUFFER_COPLIST_OFFSET, uwSpriteCopperInstructions,
+	// Buffer is full map width, but only screen + margin rows high - those
+	// wrap around and tile.c streams in map rows as the camera moves.
+	s_pVpManager = scrollBufferCreate(0,
+		TAG_SCROLLBUFFER_BITMAP_FLAGS, BMF_CLEAR | BMF_INTERLEAVED,
+		TAG_SCROLLBUFFER_IS_DBLBUF, 1,
+		TAG_SCROLLBUFFER_MARGIN_WIDTH, MAP_TILE_SIZE,
+		TAG_SCROLLBUFFER_BOUND_WIDTH, DISPLAY_BOUND_WIDTH,
+		TAG_SCROLLBUFFER_BOUND_HEIGHT, DISPLAY_BOUND_HEIGHT,
+		TAG_SCROLLBUFFER_VPORT, s_pVp,
+		TAG_SCROLLBUFFER_COPLIST_OFFSET_START, uwSpriteCopperInstructions,
+		TAG_SCROLLBUFFER_COPLIST_OFFSET_BREAK, uwBreakCopperOffset,
 	TAG_DONE);
 
-	cameraSetCoord(
-		s_pVpManager->pCamera, DISPLAY_MARGIN_SIZE, DISPLAY_MARGIN_SIZE
-	);
+	displayCameraReset();
 
-	paletteLoadFromPath("data/palette.plt", s_pPaletteRef, GAME_COLORS);
-	paletteLoadFromPath("data/thunder.plt", s_pPaletteThunder, ARRAY_SIZE(s_pPaletteThunder));
+	paletteLoadFromFd(loaderFileOpen("data/palette.plt"), s_pPaletteRef, GAME_COLORS);
+	paletteLoadFromFd(loaderFileOpen("data/thunder.plt"), s_pPaletteThunder, ARRAY_SIZE(s_pPaletteThunder));
 	s_pVp->pPalette[16] = 0xF0F; // transparent
 	s_pVp->pPalette[17] = 0xFF0; // unused
 	s_pVp->pPalette[18] = 0xFF0; // unused
-	s_pVp->pPalette[19] = s_pPaletteThunder[0];
+	s_pVp->pPalette[DISPLAY_COLOR_THUNDER] = s_pPaletteThunder[0];
 	displaySetThunderColor(0);
 	s_pVp->pPalette[20] = 0xF0F; // transparent
 	s_pVp->pPalette[21] = 0x511;
 	s_pVp->pPalette[22] = 0xA00;
 	s_pVp->pPalette[23] = 0xF11;
+#if defined(GAME_WARRIOR_SPRITES)
+	// Attached sprites use colors 16-31 regardless of channel, so warrior colors
+	// take over thunder and cursor ones.
+	for(UBYTE i = 1; i < GAME_COLORS; ++i) {
+		s_pVp->pPalette[16 + i] = s_pPaletteRef[i];
+	}
+#else
+	// Debug overlay, channels 4-5 use colors 25-27 and 6-7 use 29-31
+	for(UBYTE ubColor = 25; ubColor < 32; ubColor += 4) {
+		s_pVp->pPalette[ubColor + 0] = 0x0C0; // lookup
+		s_pVp->pPalette[ubColor + 1] = 0xF80; // crumble
+		s_pVp->pPalette[ubColor + 2] = 0xFFF; // AI intent
+	}
+#endif
 
 	s_pFade = fadeCreate(s_pView, s_pPaletteRef, GAME_COLORS);
 	fadeStart(s_pFade, FADE_STATE_IN, FADE_SPEED, 1, 0);
@@ -91,6 +114,10 @@ void displayDestroy(void) {
 void displayProcess(void) {
 	spriteProcessChannel(DISPLAY_SPRITE_CHANNEL_CURSOR);
 	spriteProcessChannel(DISPLAY_SPRITE_CHANNEL_THUNDER);
+	// Sprite mux or debug overlay, depending on build
+	for(UBYTE ubChannel = DISPLAY_SPRITE_CHANNEL_MUX_FIRST; ubChannel < 8; ++ubChannel) {
+		spriteProcessChannel(ubChannel);
+	}
 	viewProcessManagers(s_pView);
 	copProcessBlocks();
 	debugReset();
@@ -108,9 +135,45 @@ void displayOff(void) {
 }
 
 void displaySetThunderColor(UBYTE ubColorIndex) {
-	g_pCustom->color[19] = s_pPaletteThunder[ubColorIndex];
+#if !defined(GAME_WARRIOR_SPRITES)
+	g_pCustom->color[DISPLAY_COLOR_THUNDER] = s_pPaletteThunder[ubColorIndex];
+#endif
 }
 
-tSimpleBufferManager *displayGetManager(void) {
+tScrollBufferManager *displayGetManager(void) {
 	return s_pVpManager;
 }
+
+void displayCameraFollow(tUwCoordYX sTarget, UBYTE isInstant) {
+	tCameraManager *pCamera = s_pVpManager->pCamera;
+	WORD wMaxX = MAX(
+		DISPLAY_MARGIN_SIZE,
+		tileGetMapWidth() * MAP_TILE_SIZE - SCREEN_PAL_WIDTH - DISPLAY_MARGIN_SIZE
+	);
+	WORD wMaxY = MAX(
+		DISPLAY_MARGIN_SIZE,
+		tileGetMapHeight() * MAP_TILE_SIZE - SCREEN_PAL_HEIGHT - DISPLAY_MARGIN_SIZE
+	);
+	WORD wDestX = CLAMP(
+		(WORD)sTarget.uwX - SCREEN_PAL_WIDTH / 2, DISPLAY_MARGIN_SIZE, wMaxX
+	);
+	WORD wDestY = CLAMP(
+		(WORD)sTarget.uwY - SCREEN_PAL_HEIGHT / 2, DISPLAY_MARGIN_SIZE, wMaxY
+	);
+	if(isInstant) {
+		cameraSetCoord(pCamera, wDestX, wDestY);
+		return;
+	}
+
+	WORD wDeltaX = CLAMP(wDestX - pCamera->uPos.uwX, -CAMERA_SPEED, CAMERA_SPEED);
+	WORD wDeltaY = CLAMP(wDestY - pCamera->uPos.uwY, -CAMERA_SPEED, CAMERA_SPEED);
+	if(wDeltaX || wDeltaY) {
+		cameraMoveBy(pCamera, wDeltaX, wDeltaY);
+	}
+}
+
+void displayCameraReset(void) {
+	cameraSetCoord(
+		s_pVpManager->pCamera, DISPLAY_MARGIN_SIZE, DISPLAY_MARGIN_SIZE
+	);
+}
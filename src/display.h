@@ -6,7 +6,7 @@
 #define INCLUDE_DISPLAY_H
 
 #include <ace/generic/screen.h>
-#include <ace/managers/viewport/simplebuffer.h>
+#include <ace/managers/viewport/scrollbuffer.h>
 #include "fade.h"
 #include "tile.h"
 
@@ -15,9 +15,16 @@
 #define DISPLAY_WIDTH (SCREEN_PAL_WIDTH + 2 * DISPLAY_TILE_MARGIN * 16)
 #define DISPLAY_HEIGHT (SCREEN_PAL_HEIGHT + 2 * DISPLAY_TILE_MARGIN * 16)
 #define DISPLAY_MARGIN_SIZE (DISPLAY_TILE_MARGIN * MAP_TILE_SIZE)
+#define DISPLAY_BOUND_WIDTH (MAP_TILE_WIDTH_MAX * MAP_TILE_SIZE)
+#define DISPLAY_BOUND_HEIGHT (MAP_TILE_HEIGHT_MAX * MAP_TILE_SIZE)
 
 #define DISPLAY_SPRITE_CHANNEL_THUNDER 0
 #define DISPLAY_SPRITE_CHANNEL_CURSOR 2
+#define DISPLAY_SPRITE_CHANNEL_MUX_FIRST 4 // 4-5 and 6-7 as attached pairs
+#define DISPLAY_SPRITE_CHANNEL_OVERLAY_FIRST 4 // 4-7 side by side, only without mux
+// Thunder sprite's color 3, reserved for its flash. With GAME_WARRIOR_SPRITES
+// attached warrior sprites own colors 17-31, so it's left to them.
+#define DISPLAY_COLOR_THUNDER 19
 
 void displayCreate(void);
 
@@ -33,8 +40,23 @@ void displayOn(void);
 
 void displayOff(void);
 
-tSimpleBufferManager *displayGetManager(void);
+tScrollBufferManager *displayGetManager(void);
 
+/**
+ * @brief Moves camera towards given map pos, limited by scroll speed
+ * and map bounds. Instant move is only for when the buffers get fully redrawn.
+ */
+void displayCameraFollow(tUwCoordYX sTarget, UBYTE isInstant);
+
+/**
+ * @brief Moves camera back to menu position, i.e. top left of the map.
+ */
+void displayCameraReset(void);
+
+/**
+ * @brief Sets DISPLAY_COLOR_THUNDER to given thunder palette entry.
+ * Does nothing with GAME_WARRIOR_SPRITES.
+ */
 void displaySetThunderColor(UBYTE ubColorIndex);
 
 #endif // INCLUDE_DISPLAY_H
@@ -0,0 +1,69 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "event.h"
+#include "trace.h"
+
+// Whole frame of 12 warriors hitting, falling and dying fits with room to spare
+#define EVENT_QUEUE_SIZE 32
+
+static tEvent s_pEvents[EVENT_QUEUE_SIZE];
+static UBYTE s_ubEventCount;
+static UWORD s_uwFrameMask;
+static UWORD s_pTotals[EVENT_TYPE_COUNT];
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void eventsReset(void) {
+	s_ubEventCount = 0;
+	s_uwFrameMask = 0;
+	for(tEventType eType = 0; eType < EVENT_TYPE_COUNT; ++eType) {
+		s_pTotals[eType] = 0;
+	}
+}
+
+void eventPush(
+	tEventType eType, UBYTE ubWarrior, UBYTE ubTarget, UBYTE ubFlags, tUwCoordYX sPos
+) {
+	if(s_ubEventCount >= EVENT_QUEUE_SIZE) {
+		traceWrite(TRACE_EVENT_QUEUE_OVERFLOW, eType);
+		return;
+	}
+	tEvent *pEvent = &s_pEvents[s_ubEventCount++];
+	pEvent->sPos.ulYX = sPos.ulYX;
+	pEvent->ubType = eType;
+	pEvent->ubWarrior = ubWarrior;
+	pEvent->ubTarget = ubTarget;
+	pEvent->ubFlags = ubFlags;
+	s_uwFrameMask |= BV(eType);
+}
+
+UBYTE eventsGetCount(void) {
+	return s_ubEventCount;
+}
+
+const tEvent *eventsGet(UBYTE ubIndex) {
+	return &s_pEvents[ubIndex];
+}
+
+UWORD eventsGetFrameMask(void) {
+	return s_uwFrameMask;
+}
+
+UWORD eventsGetTotal(tEventType eType) {
+	return s_pTotals[eType];
+}
+
+void eventsEndFrame(void) {
+	for(UBYTE i = 0; i < s_ubEventCount; ++i) {
+		const tEvent *pEvent = &s_pEvents[i];
+		++s_pTotals[pEvent->ubType];
+		traceWrite(
+			TRACE_EVENT, pEvent->ubType, pEvent->ubWarrior,
+			pEvent->sPos.uwX, pEvent->sPos.uwY
+		);
+	}
+	s_ubEventCount = 0;
+	s_uwFrameMask = 0;
+}
@@ -0,0 +1,77 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_EVENT_H
+#define INCLUDE_EVENT_H
+
+#include <ace/types.h>
+
+/**
+ * @brief Gameplay events raised by simulation during the frame.
+ *
+ * Simulation only pushes events to fixed-size queue, so that it doesn't call
+ * sound or sprite code by itself. Consumers read whole queue once per frame,
+ * after simulation is done, and eventsEndFrame() clears it for next one.
+ * Same-type events of one frame can be collapsed with eventsGetFrameMask().
+ */
+
+#define EVENT_WARRIOR_NONE 0xFF
+
+typedef enum tEventType {
+	EVENT_SPAWN,
+	EVENT_HIT, ///< Warrior's strike connected.
+	EVENT_SWING, ///< Warrior's strike missed.
+	EVENT_FALL,
+	EVENT_DEATH,
+	EVENT_CRUMBLE_START,
+	EVENT_TILE_VOID,
+	EVENT_THUNDER_STRIKE,
+	EVENT_TYPE_COUNT
+} tEventType;
+
+typedef enum tEventFlag {
+	EVENT_FLAG_PLAYER = BV(0), ///< Warrior is steered by player.
+} tEventFlag;
+
+typedef struct tEvent {
+	tUwCoordYX sPos; ///< In map coords.
+	UBYTE ubType;
+	UBYTE ubWarrior; ///< Warrior index or EVENT_WARRIOR_NONE.
+	UBYTE ubTarget; ///< Struck warrior's index for EVENT_HIT.
+	UBYTE ubFlags;
+} tEvent;
+
+/**
+ * @brief Drops queued events and clears match totals. Call on game start.
+ */
+void eventsReset(void);
+
+/**
+ * @brief Queues event for consumers. Dropped with trace record when full.
+ */
+void eventPush(
+	tEventType eType, UBYTE ubWarrior, UBYTE ubTarget, UBYTE ubFlags, tUwCoordYX sPos
+);
+
+UBYTE eventsGetCount(void);
+
+const tEvent *eventsGet(UBYTE ubIndex);
+
+/**
+ * @brief Returns mask with bit per tEventType queued in current frame.
+ */
+UWORD eventsGetFrameMask(void);
+
+/**
+ * @brief Returns count of events of given type since eventsReset().
+ */
+UWORD eventsGetTotal(tEventType eType);
+
+/**
+ * @brief Adds queued events to totals and trace, then clears the queue.
+ * Call once per frame, after all consumers.
+ */
+void eventsEndFrame(void);
+
+#endif // INCLUDE_EVENT_H
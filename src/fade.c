@@ -5,13 +5,14 @@
 #include "fade.h"
 #include <ace/utils/palette.h>
 #include <ace/managers/ptplayer.h>
+#include "mem_track.h"
 
 tFade *fadeCreate(tView *pView, const UWORD *pPaletteRef, UBYTE ubColorCount) {
 	logBlockBegin(
 		"fadeCreate(pView: %p, pPaletteRef: %p, ubColorCount: %hhu)",
 		pView, pPaletteRef, ubColorCount
 	);
-	tFade *pFade = memAllocFastClear(sizeof(*pFade));
+	tFade *pFade = memTrackAllocFastClear(MEM_TAG_DISPLAY, sizeof(*pFade));
 	pFade->eState = FADE_STATE_IDLE;
 	pFade->pView = pView;
 	fadeChangeRefPalette(pFade, pPaletteRef, ubColorCount);
@@ -20,7 +21,7 @@ tFade *fadeCreate(tView *pView, const UWORD *pPaletteRef, UBYTE ubColorCount) {
 }
 
 void fadeDestroy(tFade *pFade) {
-	memFree(pFade, sizeof(*pFade));
+	memTrackFreeFast(MEM_TAG_DISPLAY, pFade, sizeof(*pFade));
 }
 
 void fadeStart(
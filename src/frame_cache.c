@@ -0,0 +1,140 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "frame_cache.h"
+#include <ace/managers/memory.h>
+#include <ace/managers/log.h>
+#include "mem_track.h"
+
+#define NARROW_FRAME_BYTES (2 * FRAME_CACHE_FRAME_SIZE)
+#define WIDE_FRAME_BYTES (4 * FRAME_CACHE_FRAME_SIZE)
+
+static tShiftedFrame *s_pFrames;
+static UBYTE *s_pData;
+static ULONG s_ulDataSize;
+static UWORD s_uwFrameCount;
+static UBYTE s_ubPhaseCount;
+static UBYTE s_ubPhaseShift;
+
+static ULONG shiftRow(UWORD uwRow, UBYTE ubShift) {
+	return ((ULONG)uwRow << 16) >> ubShift;
+}
+
+static void frameWriteShifted(
+	const UWORD *pSrc, UBYTE *pDst, UBYTE ubDepth, UBYTE ubShift,
+	UBYTE ubWordOffset, UBYTE ubWidth
+) {
+	UWORD *pOut = (UWORD*)pDst;
+	for(UWORD uwRow = 0; uwRow < FRAME_CACHE_FRAME_SIZE * ubDepth; ++uwRow) {
+		ULONG ulShifted = shiftRow(pSrc[uwRow], ubShift);
+		if(ubWidth == 32) {
+			*(pOut++) = ulShifted >> 16;
+			*(pOut++) = ulShifted;
+		}
+		else {
+			*(pOut++) = ubWordOffset ? ulShifted : ulShifted >> 16;
+		}
+	}
+}
+
+void frameCacheCreate(
+	const tBitMap *pFrames, const tBitMap *pMasks, UBYTE ubPhaseCount
+) {
+	logBlockBegin(
+		"frameCacheCreate(pFrames: %p, pMasks: %p, ubPhaseCount: %hhu)",
+		pFrames, pMasks, ubPhaseCount
+	);
+	UBYTE ubDepth = pFrames->Depth;
+	UWORD uwBytesPerFrame = (FRAME_CACHE_FRAME_SIZE / 8) * FRAME_CACHE_FRAME_SIZE * ubDepth;
+	s_uwFrameCount = pFrames->Rows / FRAME_CACHE_FRAME_SIZE;
+	s_ubPhaseCount = ubPhaseCount;
+	s_ubPhaseShift = 0;
+	while((16 >> s_ubPhaseShift) > ubPhaseCount) {
+		++s_ubPhaseShift;
+	}
+	s_pFrames = memTrackAllocFast(
+		MEM_TAG_ASSETS, sizeof(tShiftedFrame) * s_uwFrameCount * ubPhaseCount
+	);
+
+	// First pass: find out which shifted frames fit in a single word
+	s_ulDataSize = 0;
+	for(UWORD uwFrame = 0; uwFrame < s_uwFrameCount; ++uwFrame) {
+		const UWORD *pMask = (UWORD*)&pMasks->Planes[0][uwFrame * uwBytesPerFrame];
+		UWORD uwMaskSum = 0;
+		for(UWORD uwRow = 0; uwRow < FRAME_CACHE_FRAME_SIZE * ubDepth; ++uwRow) {
+			uwMaskSum |= pMask[uwRow];
+		}
+
+		tShiftedFrame *pShifted = &s_pFrames[uwFrame * ubPhaseCount];
+		for(UBYTE ubPhase = 0; ubPhase < ubPhaseCount; ++ubPhase, ++pShifted) {
+			ULONG ulMaskSum = shiftRow(uwMaskSum, ubPhase << s_ubPhaseShift);
+			if(!(ulMaskSum & 0xFFFF)) {
+				pShifted->ubWidth = 16;
+				pShifted->ubWordOffset = 0;
+			}
+			else if(!(ulMaskSum >> 16)) {
+				pShifted->ubWidth = 16;
+				pShifted->ubWordOffset = 1;
+			}
+			else {
+				pShifted->ubWidth = 32;
+				pShifted->ubWordOffset = 0;
+			}
+			if(ubPhase) {
+				s_ulDataSize += 2 * ubDepth * (
+					pShifted->ubWidth == 16 ? NARROW_FRAME_BYTES : WIDE_FRAME_BYTES
+				);
+			}
+		}
+	}
+
+	// Second pass: fill the data, phase 0 is the original frame
+	s_pData = memTrackAllocChip(MEM_TAG_ASSETS, s_ulDataSize);
+	UBYTE *pData = s_pData;
+	for(UWORD uwFrame = 0; uwFrame < s_uwFrameCount; ++uwFrame) {
+		ULONG ulSrcOffs = uwFrame * uwBytesPerFrame;
+		tShiftedFrame *pShifted = &s_pFrames[uwFrame * ubPhaseCount];
+		pShifted->pBitmap = &pFrames->Planes[0][ulSrcOffs];
+		pShifted->pMask = &pMasks->Planes[0][ulSrcOffs];
+		++pShifted;
+
+		for(UBYTE ubPhase = 1; ubPhase < ubPhaseCount; ++ubPhase, ++pShifted) {
+			UWORD uwSize = ubDepth * (
+				pShifted->ubWidth == 16 ? NARROW_FRAME_BYTES : WIDE_FRAME_BYTES
+			);
+			UBYTE ubShift = ubPhase << s_ubPhaseShift;
+			pShifted->pBitmap = pData;
+			frameWriteShifted(
+				(UWORD*)&pFrames->Planes[0][ulSrcOffs], pData, ubDepth, ubShift,
+				pShifted->ubWordOffset, pShifted->ubWidth
+			);
+			pData += uwSize;
+			pShifted->pMask = pData;
+			frameWriteShifted(
+				(UWORD*)&pMasks->Planes[0][ulSrcOffs], pData, ubDepth, ubShift,
+				pShifted->ubWordOffset, pShifted->ubWidth
+			);
+			pData += uwSize;
+		}
+	}
+
+	logWrite(
+		"Cached %hu frames in %hhu phases, %lu bytes of CHIP\n",
+		s_uwFrameCount, ubPhaseCount, s_ulDataSize
+	);
+	logBlockEnd("frameCacheCreate()");
+}
+
+void frameCacheDestroy(void) {
+	memTrackFreeChip(MEM_TAG_ASSETS, s_pData, s_ulDataSize);
+	memTrackFreeFast(
+		MEM_TAG_ASSETS, s_pFrames,
+		sizeof(tShiftedFrame) * s_uwFrameCount * s_ubPhaseCount
+	);
+}
+
+const tShiftedFrame *frameCacheGet(UWORD uwFrameIndex, UWORD uwX) {
+	UBYTE ubPhase = (uwX & 15) >> s_ubPhaseShift;
+	return &s_pFrames[uwFrameIndex * s_ubPhaseCount + ubPhase];
+}
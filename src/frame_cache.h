@@ -0,0 +1,43 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_FRAME_CACHE_H
+#define INCLUDE_FRAME_CACHE_H
+
+#include <ace/utils/bitmap.h>
+
+/**
+ * @brief Pre-shifted copies of 16x16 interleaved bob frames.
+ *
+ * Blitting a 16px bob at unaligned X costs two words per line. Each frame is
+ * pre-shifted for every phase and if shifted frame content fits in a single
+ * word, it's stored 16px wide so that the bob can be blitted one word wide.
+ * X position gets quantized to 16 / phase count pixels.
+ */
+
+#define FRAME_CACHE_FRAME_SIZE 16
+
+typedef struct tShiftedFrame {
+	UBYTE *pBitmap;
+	UBYTE *pMask;
+	UBYTE ubWordOffset; ///< Words to skip from aligned position.
+	UBYTE ubWidth; ///< 16 if frame fits in single word, 32 otherwise.
+} tShiftedFrame;
+
+/**
+ * @brief Generates shifted frames from given frame sheet.
+ *
+ * @param pFrames Interleaved bitmap with 16x16 frames stacked vertically.
+ * @param pMasks Mask for pFrames, in the same layout.
+ * @param ubPhaseCount Shift phase count: 2, 4 or 8.
+ */
+void frameCacheCreate(
+	const tBitMap *pFrames, const tBitMap *pMasks, UBYTE ubPhaseCount
+);
+
+void frameCacheDestroy(void);
+
+const tShiftedFrame *frameCacheGet(UWORD uwFrameIndex, UWORD uwX);
+
+#endif // INCLUDE_FRAME_CACHE_H
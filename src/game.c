@@ -16,6 +16,15 @@
 #include "sfx.h"
 #include "menu.h"
 #include "debug.h"
+#include "scheduler.h"
+#include "trace.h"
+#include "mem_track.h"
+#include "input.h"
+#include "latency.h"
+#include "event.h"
+#include "rng.h"
+#include "telemetry.h"
+#include "debug_overlay.h"
 
 #define GAME_CRUMBLE_COOLDOWN 1
 #define GAME_COUNTDOWN_COOLDOWN 50
@@ -30,20 +39,61 @@ typedef enum tCountdownPhase {
 	COUNTDOWN_PHASE_COUNT,
 } tCountdownPhase;
 
-static tSimpleBufferManager *s_pVpManager;
+static tScrollBufferManager *s_pVpManager;
 #if defined(ACE_BOB_PRISTINE_BUFFER)
 static tBitMap *s_pPristineBuffer;
 #endif
 static tBob s_sBobCountdown;
 static tBob s_sBobFight;
 static tCountdownPhase s_eCountdownPhase;
-static UBYTE s_ubCountdownCooldown;
-static UBYTE s_ubCrumbleCooldown;
-static UBYTE s_ubGameStopCooldown;
+static UBYTE s_isCrumbling;
+static UBYTE s_isGameStopScheduled;
+static UBYTE s_isGameStopDue;
+static tRngState s_sRngStart; ///< From before map selection and spawn shuffle.
+
+static void onCrumbleStart(void *pData) {
+	s_isCrumbling = 1;
+	tileCrumbleStart();
+}
+
+static void onGameStop(void *pData) {
+	s_isGameStopDue = 1;
+}
+
+static void onCountdownStep(void *pData) {
+	--s_eCountdownPhase;
+	if(s_eCountdownPhase > COUNTDOWN_PHASE_FIGHT) {
+		UWORD uwBytesPerFrame = g_pCountdownFrames->BytesPerRow * s_sBobCountdown.uwHeight;
+		ULONG ulFrameOffset = uwBytesPerFrame * (4 - s_eCountdownPhase);
+		bobSetFrame(
+			&s_sBobCountdown, &g_pCountdownFrames->Planes[0][ulFrameOffset],
+			&g_pCountdownMask->Planes[0][ulFrameOffset]
+		);
+		sfxRequest(
+			g_pSfxCountdown[s_eCountdownPhase - COUNTDOWN_PHASE_1],
+			SFX_PRIORITY_COUNTDOWN
+		);
+	}
+	else if(s_eCountdownPhase == COUNTDOWN_PHASE_FIGHT) {
+		sfxRequest(g_pSfxCountdownFight, SFX_PRIORITY_COUNTDOWN);
+	}
+
+	if(s_eCountdownPhase == COUNTDOWN_PHASE_OFF) {
+		warriorsEnableMove(1);
+		schedulerAdd(GAME_CRUMBLE_COOLDOWN, onCrumbleStart, 0);
+	}
+	else {
+		schedulerAdd(GAME_COUNTDOWN_COOLDOWN, onCountdownStep, 0);
+	}
+}
 
 static void gameGsCreate(void) {
+	// Streams carry on from previous match - whole match follows from that
+	rngStateGet(&s_sRngStart);
+	schedulerReset();
 	tilesInit();
 	s_pVpManager = displayGetManager();
+	memTrackScopeBegin(MEM_TAG_GAME);
 #if defined(ACE_BOB_PRISTINE_BUFFER)
 	s_pPristineBuffer = bitmapCreate(
 		bitmapGetByteWidth(s_pVpManager->pBack) * 8,
@@ -57,9 +107,19 @@ static void gameGsCreate(void) {
 #if defined(ACE_BOB_PRISTINE_BUFFER)
 		s_pPristineBuffer,
 #endif
-		512
+		s_pVpManager->uwBmAvailHeight
 	);
+	memTrackScopeEnd();
+	memTrackScopeBegin(MEM_TAG_WARRIOR);
 	warriorsCreate(menuIsExtraEnemiesEnabled());
+	memTrackScopeEnd();
+	memTrackScopeBegin(MEM_TAG_GAME);
+	telemetryMatchBegin(&s_sRngStart);
+	debugOverlayCreate();
+	memTrackScopeEnd();
+	// Telemetry got the spawns, for the rest warriors disabled on start didn't
+	// die in the match
+	eventsReset();
 
 	UBYTE ubCountdownWidth = bitmapGetByteWidth(g_pCountdownFrames) * 8;
 	UBYTE ubFightWidth = bitmapGetByteWidth(g_pFightBitmap) * 8;
@@ -75,14 +135,23 @@ static void gameGsCreate(void) {
 	);
 
 	s_eCountdownPhase = COUNTDOWN_PHASE_COUNT;
-	s_ubCountdownCooldown = 1;
-	s_ubCrumbleCooldown = GAME_CRUMBLE_COOLDOWN;
-	s_ubGameStopCooldown = GAME_STOP_COOLDOWN;
+	schedulerAdd(1, onCountdownStep, 0);
+	s_isCrumbling = 0;
+	s_isGameStopScheduled = 0;
+	s_isGameStopDue = 0;
 
+	memTrackScopeBegin(MEM_TAG_GAME);
 	bobReallocateBuffers();
+	memTrackScopeEnd();
+	traceDrain();
 	systemUnuse();
 
 	tilesReload();
+	tUwCoordYX sCameraTarget;
+	if(warriorsGetAliveCenter(&sCameraTarget)) {
+		displayCameraFollow(sCameraTarget, 1);
+	}
+	tilesStreamReset(s_pVpManager->pCamera->uPos.uwY);
 	tilesDrawAllOn(s_pVpManager->pBack);
 	tilesDrawAllOn(s_pVpManager->pFront);
 #if defined(ACE_BOB_PRISTINE_BUFFER)
@@ -91,6 +160,9 @@ static void gameGsCreate(void) {
 	warriorsEnableMove(0);
 	ptplayerLoadMod(g_pModCombat, g_pModSamples, 0);
 	ptplayerEnableMusic(1);
+	// Combat module plays on channels 0 and 1 only
+	sfxSetChannels(BV(2) | BV(3));
+	memTrackStateEnter(MEM_STATE_GAME);
 }
 
 static void countdownProcess(void) {
@@ -98,28 +170,14 @@ static void countdownProcess(void) {
 		return;
 	}
 
-	if(--s_ubCountdownCooldown == 0) {
-		s_ubCountdownCooldown = GAME_COUNTDOWN_COOLDOWN;
-		--s_eCountdownPhase;
-		if(s_eCountdownPhase > COUNTDOWN_PHASE_FIGHT) {
-			UWORD uwBytesPerFrame = g_pCountdownFrames->BytesPerRow * s_sBobCountdown.uwHeight;
-			ULONG ulFrameOffset = uwBytesPerFrame * (4 - s_eCountdownPhase);
-			bobSetFrame(
-				&s_sBobCountdown, &g_pCountdownFrames->Planes[0][ulFrameOffset],
-				&g_pCountdownMask->Planes[0][ulFrameOffset]
-			);
-			ptplayerSfxPlay(
-				g_pSfxCountdown[s_eCountdownPhase - COUNTDOWN_PHASE_1],
-				2, 64, SFX_PRIORITY_COUNTDOWN
-			);
-		}
-		else if(s_eCountdownPhase == COUNTDOWN_PHASE_FIGHT) {
-			ptplayerSfxPlay(g_pSfxCountdownFight, 2, 64, SFX_PRIORITY_COUNTDOWN);
-		}
-		else if(s_eCountdownPhase == COUNTDOWN_PHASE_OFF) {
-			warriorsEnableMove(1);
-		}
-	}
+	// Keep it in the middle of the screen regardless of camera position
+	const tUwCoordYX *pCameraPos = &s_pVpManager->pCamera->uPos;
+	UWORD uwScreenX = pCameraPos->uwX - DISPLAY_MARGIN_SIZE;
+	UWORD uwScreenY = pCameraPos->uwY - DISPLAY_MARGIN_SIZE;
+	s_sBobCountdown.sPos.uwX = uwScreenX + (DISPLAY_WIDTH - s_sBobCountdown.uwWidth) / 2;
+	s_sBobCountdown.sPos.uwY = uwScreenY + 100;
+	s_sBobFight.sPos.uwX = uwScreenX + (DISPLAY_WIDTH - s_sBobFight.uwWidth) / 2;
+	s_sBobFight.sPos.uwY = uwScreenY + 100;
 
 	switch(s_eCountdownPhase) {
 		case COUNTDOWN_PHASE_3:
@@ -136,16 +194,29 @@ static void countdownProcess(void) {
 }
 
 static void gameTransitToMenu(void) {
-	// Blit currently visible bitmap to backbuffer in order to mitigate flickering on bobs/crumbles
 	const UBYTE ubParts = 4;
 	UBYTE ubPartHeight = DISPLAY_HEIGHT / ubParts;
 	UWORD uwOffsY = 0;
-	for(UBYTE i = 0; i < 4; ++i) {
-		blitCopyAligned(
-			s_pVpManager->pFront, 0, uwOffsY, s_pVpManager->pBack, 0, uwOffsY,
-			DISPLAY_WIDTH, ubPartHeight
-		);
-		uwOffsY += ubPartHeight;
+	const tUwCoordYX *pCameraPos = &s_pVpManager->pCamera->uPos;
+	if(pCameraPos->uwX == DISPLAY_MARGIN_SIZE && pCameraPos->uwY == DISPLAY_MARGIN_SIZE) {
+		// Blit currently visible bitmap to backbuffer in order to mitigate flickering on bobs/crumbles
+		for(UBYTE i = 0; i < ubParts; ++i) {
+			blitCopyAligned(
+				s_pVpManager->pFront, 0, uwOffsY, s_pVpManager->pBack, 0, uwOffsY,
+				DISPLAY_WIDTH, ubPartHeight
+			);
+			uwOffsY += ubPartHeight;
+		}
+	}
+	else {
+		// Menu needs camera at its initial position, where buffers contain
+		// some other part of the map - clear it instead.
+		displayCameraReset();
+		for(UBYTE i = 0; i < ubParts; ++i) {
+			blitRect(s_pVpManager->pFront, 0, uwOffsY, DISPLAY_WIDTH, ubPartHeight, 0);
+			blitRect(s_pVpManager->pBack, 0, uwOffsY, DISPLAY_WIDTH, ubPartHeight, 0);
+			uwOffsY += ubPartHeight;
+		}
 	}
 
 	// Now that bitmaps are synchronized, go to menu
@@ -153,18 +224,22 @@ static void gameTransitToMenu(void) {
 }
 
 static void gameGsLoop(void) {
+	memTrackFrame();
 	if(keyUse(KEY_ESCAPE)) {
 		// Game canceled - go back to menu
+		telemetryMatchCancel();
 		menuSetupMain();
 		gameTransitToMenu();
 		return;
 	}
 
 	UBYTE ubAlivePlayers = warriorsGetAlivePlayerCount();
-	if(ubAlivePlayers == 1 && warriorsGetAliveCount() == 1) {
-		--s_ubGameStopCooldown;
+	if(ubAlivePlayers == 1 && warriorsGetAliveCount() == 1 && !s_isGameStopScheduled) {
+		// Let the winner enjoy the moment
+		schedulerAdd(GAME_STOP_COOLDOWN, onGameStop, 0);
+		s_isGameStopScheduled = 1;
 	}
-	if(ubAlivePlayers == 0 || s_ubGameStopCooldown == 0) {
+	if(ubAlivePlayers == 0 || s_isGameStopDue) {
 		menuSetupSummary(warriorsGetLastAliveIndex());
 		gameTransitToMenu();
 		return;
@@ -173,37 +248,53 @@ static void gameGsLoop(void) {
 	debugSetColor(0x008);
 	bobBegin(s_pVpManager->pBack);
 
+	tUwCoordYX sCameraTarget;
+	if(warriorsGetAliveCenter(&sCameraTarget)) {
+		displayCameraFollow(sCameraTarget, 0);
+	}
+	tilesStreamProcess(s_pVpManager->pBack, s_pVpManager->pCamera->uPos.uwY);
+
 	debugSetColor(0x0ff);
-	if(!s_eCountdownPhase) {
-		if(!s_ubCrumbleCooldown) {
-			tileCrumbleProcess(s_pVpManager->pBack);
+	if(s_isCrumbling) {
+		tileCrumbleProcess(s_pVpManager->pBack);
 #if defined(ACE_BOB_PRISTINE_BUFFER)
-			tileCrumbleProcess(s_pPristineBuffer);
+		tileCrumbleProcess(s_pPristineBuffer);
 #endif
-		}
-		else {
-			--s_ubCrumbleCooldown;
-		}
 	}
+	schedulerProcess();
 
 	debugSetColor(0x0f0);
+	inputProcess();
 	warriorsProcess();
 	countdownProcess();
+	sfxProcessEvents();
+	telemetryProcessEvents();
+	eventsEndFrame();
 
 	debugSetColor(0x00f);
 	bobPushingDone();
 	bobEnd();
-	// warriorsDrawLookup(s_pVpManager->pBack);
+	latencyFrameDrawn();
+	telemetryFrameEnd();
+	debugOverlayProcess();
 }
 
 static void gameGsDestroy(void) {
 	ptplayerStop();
 	systemUse();
+	memTrackScopeBegin(MEM_TAG_GAME);
+	telemetryMatchEnd(warriorsGetLastAliveIndex());
+	debugOverlayDestroy();
 	bobManagerDestroy();
 #if defined(ACE_BOB_PRISTINE_BUFFER)
 	bitmapDestroy(s_pPristineBuffer);
 #endif
+	memTrackScopeEnd();
+	memTrackScopeBegin(MEM_TAG_WARRIOR);
 	warriorsDestroy();
+	memTrackScopeEnd();
+	latencyReport();
+	traceDrain();
 }
 
 UBYTE gameIsCountdownActive(void) {
@@ -0,0 +1,109 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "input.h"
+#include <ace/managers/joy.h>
+#include <ace/managers/key.h>
+#include "latency.h"
+
+#define INPUT_JOY_PORT_COUNT (INPUT_PORT_JOY_4 + 1)
+
+// Joy direction enum is not in same order as steer enum
+static const UBYTE s_pDirToJoy[DIRECTION_COUNT] = {
+	[DIRECTION_UP] = JOY_UP,
+	[DIRECTION_DOWN] = JOY_DOWN,
+	[DIRECTION_LEFT] = JOY_LEFT,
+	[DIRECTION_RIGHT] = JOY_RIGHT,
+	[DIRECTION_FIRE] = JOY_FIRE
+};
+
+static const UBYTE s_pDirToKey[][DIRECTION_COUNT] = {
+	[INPUT_PORT_KEY_WSAD - INPUT_JOY_PORT_COUNT] = {
+		[DIRECTION_UP] = KEY_W,
+		[DIRECTION_DOWN] = KEY_S,
+		[DIRECTION_LEFT] = KEY_A,
+		[DIRECTION_RIGHT] = KEY_D,
+		[DIRECTION_FIRE] = KEY_LSHIFT
+	},
+	[INPUT_PORT_KEY_ARROWS - INPUT_JOY_PORT_COUNT] = {
+		[DIRECTION_UP] = KEY_UP,
+		[DIRECTION_DOWN] = KEY_DOWN,
+		[DIRECTION_LEFT] = KEY_LEFT,
+		[DIRECTION_RIGHT] = KEY_RIGHT,
+		[DIRECTION_FIRE] = KEY_RSHIFT
+	}
+};
+
+static UBYTE s_pHeld[INPUT_PORT_COUNT];
+static UBYTE s_pPressed[INPUT_PORT_COUNT];
+static UBYTE s_pReleased[INPUT_PORT_COUNT];
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static void inputPortLatch(tInputPort ePort, UBYTE ubHeld) {
+	UBYTE ubChanged = s_pHeld[ePort] ^ ubHeld;
+	s_pPressed[ePort] = ubChanged & ubHeld;
+	s_pReleased[ePort] = ubChanged & ~ubHeld;
+	s_pHeld[ePort] = ubHeld;
+	if(s_pPressed[ePort]) {
+		latencyInputEdge(ePort);
+	}
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void inputReset(void) {
+	for(tInputPort ePort = 0; ePort < INPUT_PORT_COUNT; ++ePort) {
+		s_pHeld[ePort] = 0;
+		s_pPressed[ePort] = 0;
+		s_pReleased[ePort] = 0;
+	}
+}
+
+void inputProcess(void) {
+	// genericProcess() read the ports at start of frame, before state's fades
+	// and drawing - read them again so that simulation gets freshest state.
+	// Keyboard state is updated by interrupt, so it's always current.
+	joyProcess();
+
+	// Manager states are read directly - it's the same as joyCheck()/keyCheck()
+	// but without a call for each of them
+	for(tInputPort ePort = INPUT_PORT_JOY_1; ePort <= INPUT_PORT_JOY_4; ++ePort) {
+		const UBYTE *pStates = &g_sJoyManager.pJoyStates[JOY1 + ePort * (JOY2 - JOY1)];
+		UBYTE ubHeld = 0;
+		for(tDirection eDir = 0; eDir < DIRECTION_COUNT; ++eDir) {
+			if(pStates[s_pDirToJoy[eDir]] != JOY_NACTIVE) {
+				ubHeld |= BV(eDir);
+			}
+		}
+		inputPortLatch(ePort, ubHeld);
+	}
+
+	for(tInputPort ePort = INPUT_PORT_KEY_WSAD; ePort <= INPUT_PORT_KEY_ARROWS; ++ePort) {
+		const UBYTE *pDirToKey = s_pDirToKey[ePort - INPUT_JOY_PORT_COUNT];
+		UBYTE ubHeld = 0;
+		for(tDirection eDir = 0; eDir < DIRECTION_COUNT; ++eDir) {
+			if(g_sKeyManager.pStates[pDirToKey[eDir]] != KEY_NACTIVE) {
+				ubHeld |= BV(eDir);
+			}
+		}
+		inputPortLatch(ePort, ubHeld);
+	}
+}
+
+tInputPort inputPortFromJoy(UBYTE ubJoy) {
+	return INPUT_PORT_JOY_1 + (ubJoy - JOY1) / (JOY2 - JOY1);
+}
+
+UBYTE inputGetHeld(tInputPort ePort) {
+	return s_pHeld[ePort];
+}
+
+UBYTE inputGetPressed(tInputPort ePort) {
+	return s_pPressed[ePort];
+}
+
+UBYTE inputGetReleased(tInputPort ePort) {
+	return s_pReleased[ePort];
+}
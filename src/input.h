@@ -0,0 +1,60 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_INPUT_H
+#define INCLUDE_INPUT_H
+
+#include <ace/types.h>
+#include "direction.h"
+
+/**
+ * @brief Per-frame snapshot of all player inputs.
+ *
+ * Ports and keys are read once per frame into masks with bit per tDirection,
+ * so that steers don't query hardware state for each direction on their own.
+ * Snapshot should be taken as late as possible before its consumers run.
+ */
+
+typedef enum tInputPort {
+	INPUT_PORT_JOY_1,
+	INPUT_PORT_JOY_2,
+	INPUT_PORT_JOY_3,
+	INPUT_PORT_JOY_4,
+	INPUT_PORT_KEY_WSAD,
+	INPUT_PORT_KEY_ARROWS,
+	INPUT_PORT_COUNT
+} tInputPort;
+
+/**
+ * @brief Clears snapshot, so that held inputs become fresh presses.
+ */
+void inputReset(void);
+
+/**
+ * @brief Re-reads joystick ports and takes snapshot of all inputs.
+ * Call once per frame, right before steers get processed.
+ */
+void inputProcess(void);
+
+/**
+ * @brief Converts ACE joy code base, e.g. JOY2, to input port.
+ */
+tInputPort inputPortFromJoy(UBYTE ubJoy);
+
+/**
+ * @brief Returns mask of directions held in current snapshot.
+ */
+UBYTE inputGetHeld(tInputPort ePort);
+
+/**
+ * @brief Returns mask of directions which got pressed since previous snapshot.
+ */
+UBYTE inputGetPressed(tInputPort ePort);
+
+/**
+ * @brief Returns mask of directions which got released since previous snapshot.
+ */
+UBYTE inputGetReleased(tInputPort ePort);
+
+#endif // INCLUDE_INPUT_H
@@ -0,0 +1,138 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "latency.h"
+
+#if defined(GAME_LATENCY_PROBE)
+
+#include <ace/macros.h>
+#include "debug.h"
+#include "display.h"
+#include "trace.h"
+
+#define LATENCY_LINES_PER_FRAME 313
+// First line of PAL display window, same as in ACE's default view
+#define LATENCY_DISPLAY_FIRST_LINE 0x2C
+// Presses which didn't cause state change by then are dropped
+#define LATENCY_EDGE_TIMEOUT 50
+
+typedef struct tLatencyProbe {
+	ULONG ulEdgeFrame;
+	UWORD uwEdgeLine;
+	UWORD uwMapY;
+	UBYTE isPending; ///< Press waiting for state change.
+	UBYTE isTagged; ///< State change waiting to be drawn.
+} tLatencyProbe;
+
+typedef struct tLatencyStats {
+	ULONG ulCount;
+	ULONG ulFramesSum;
+	ULONG ulLinesSum;
+	UWORD uwFramesMin;
+	UWORD uwFramesMax;
+	UWORD uwLinesMin;
+	UWORD uwLinesMax;
+} tLatencyStats;
+
+static ULONG s_ulFrame;
+static tLatencyProbe s_pProbes[INPUT_PORT_COUNT];
+static tLatencyStats s_sStats;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static void latencyAddSample(tInputPort ePort, UWORD uwFrames, UWORD uwLines) {
+	if(!s_sStats.ulCount) {
+		s_sStats.uwFramesMin = uwFrames;
+		s_sStats.uwFramesMax = uwFrames;
+		s_sStats.uwLinesMin = uwLines;
+		s_sStats.uwLinesMax = uwLines;
+	}
+	else {
+		s_sStats.uwFramesMin = MIN(s_sStats.uwFramesMin, uwFrames);
+		s_sStats.uwFramesMax = MAX(s_sStats.uwFramesMax, uwFrames);
+		s_sStats.uwLinesMin = MIN(s_sStats.uwLinesMin, uwLines);
+		s_sStats.uwLinesMax = MAX(s_sStats.uwLinesMax, uwLines);
+	}
+	++s_sStats.ulCount;
+	s_sStats.ulFramesSum += uwFrames;
+	s_sStats.ulLinesSum += uwLines;
+	traceWrite(TRACE_LATENCY_SAMPLE, ePort, uwFrames, uwLines);
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void latencyReset(void) {
+	for(tInputPort ePort = 0; ePort < INPUT_PORT_COUNT; ++ePort) {
+		s_pProbes[ePort].isPending = 0;
+		s_pProbes[ePort].isTagged = 0;
+	}
+	s_sStats = (tLatencyStats){0};
+}
+
+void latencyNextFrame(void) {
+	++s_ulFrame;
+}
+
+void latencyInputEdge(tInputPort ePort) {
+	tLatencyProbe *pProbe = &s_pProbes[ePort];
+	if(!debugIsEnabled() || pProbe->isTagged) {
+		return;
+	}
+	pProbe->ulEdgeFrame = s_ulFrame;
+	pProbe->uwEdgeLine = debugGetBeamLine();
+	pProbe->isPending = 1;
+}
+
+void latencyTag(tInputPort ePort, UWORD uwMapY) {
+	tLatencyProbe *pProbe = &s_pProbes[ePort];
+	if(pProbe->isPending) {
+		pProbe->isPending = 0;
+		pProbe->isTagged = 1;
+		pProbe->uwMapY = uwMapY;
+	}
+}
+
+void latencyFrameDrawn(void) {
+	// Back buffer gets displayed after next vertical blank
+	ULONG ulPhotonFrame = s_ulFrame + 1;
+	UWORD uwCameraY = displayGetManager()->pCamera->uPos.uwY;
+	for(tInputPort ePort = 0; ePort < INPUT_PORT_COUNT; ++ePort) {
+		tLatencyProbe *pProbe = &s_pProbes[ePort];
+		if(pProbe->isTagged) {
+			pProbe->isTagged = 0;
+			WORD wScreenY = CLAMP(
+				(WORD)(pProbe->uwMapY - uwCameraY), 0, SCREEN_PAL_HEIGHT - 1
+			);
+			UWORD uwFrames = ulPhotonFrame - pProbe->ulEdgeFrame;
+			UWORD uwLines = (
+				uwFrames * LATENCY_LINES_PER_FRAME +
+				LATENCY_DISPLAY_FIRST_LINE + wScreenY - pProbe->uwEdgeLine
+			);
+			latencyAddSample(ePort, uwFrames, uwLines);
+		}
+		else if(
+			pProbe->isPending &&
+			s_ulFrame - pProbe->ulEdgeFrame > LATENCY_EDGE_TIMEOUT
+		) {
+			pProbe->isPending = 0;
+		}
+	}
+}
+
+void latencyReport(void) {
+	if(!s_sStats.ulCount) {
+		return;
+	}
+	ULONG ulFramesAvg100 = (s_sStats.ulFramesSum * 100) / s_sStats.ulCount;
+	traceWrite(
+		TRACE_LATENCY_FRAMES, s_sStats.uwFramesMin, ulFramesAvg100 / 100,
+		ulFramesAvg100 % 100, s_sStats.uwFramesMax
+	);
+	traceWrite(
+		TRACE_LATENCY_LINES, s_sStats.uwLinesMin,
+		s_sStats.ulLinesSum / s_sStats.ulCount, s_sStats.uwLinesMax, s_sStats.ulCount
+	);
+}
+
+#endif // GAME_LATENCY_PROBE
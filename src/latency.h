@@ -0,0 +1,66 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_LATENCY_H
+#define INCLUDE_LATENCY_H
+
+#include <ace/types.h>
+#include "input.h"
+
+/**
+ * @brief Input-to-photon latency probe, enabled by GAME_LATENCY_PROBE.
+ *
+ * While debug mode is on, input layer stamps each press with frame number
+ * and beam line at which it got read. Warrior code tags state change caused
+ * by it and once bobs are drawn, sample is resolved: back buffer drawn in
+ * frame N is displayed from frame N+1, reaching warrior at its screen line.
+ *
+ * Samples and summary go to trace records, see src/trace_formats.h.
+ * Without GAME_LATENCY_PROBE all calls compile to nothing.
+ */
+
+#if defined(GAME_LATENCY_PROBE)
+
+/**
+ * @brief Drops pending samples and clears stats.
+ */
+void latencyReset(void);
+
+/**
+ * @brief Advances frame counter. Call at start of each frame.
+ */
+void latencyNextFrame(void);
+
+/**
+ * @brief Stamps press on given port with current frame and beam line.
+ */
+void latencyInputEdge(tInputPort ePort);
+
+/**
+ * @brief Marks pending press on port as acted upon by warrior at given map Y.
+ */
+void latencyTag(tInputPort ePort, UWORD uwMapY);
+
+/**
+ * @brief Resolves tagged samples. Call after bobs are drawn on back buffer.
+ */
+void latencyFrameDrawn(void);
+
+/**
+ * @brief Writes min/avg/max latency to trace, if there were any samples.
+ */
+void latencyReport(void);
+
+#else
+
+#define latencyReset()
+#define latencyNextFrame()
+#define latencyInputEdge(ePort)
+#define latencyTag(ePort, uwMapY)
+#define latencyFrameDrawn()
+#define latencyReport()
+
+#endif // GAME_LATENCY_PROBE
+
+#endif // INCLUDE_LATENCY_H
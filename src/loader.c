@@ -0,0 +1,249 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "loader.h"
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include <ace/utils/disk_file.h>
+#include "mem_track.h"
+#if defined(GAME_TRACKLOADER)
+#include <string.h>
+#include <exec/io.h>
+#include <devices/trackdisk.h>
+#include <proto/exec.h>
+
+#define LOADER_TRACK_SIZE (NUMSECS * TD_SECTOR)
+#define LOADER_TRACK_NONE 0xFFFF
+#define LOADER_PACK_OFFSET (2 * TD_SECTOR)
+#define LOADER_PACK_MAGIC 0x4341504B // "CAPK"
+
+typedef struct tPackEntry {
+	char szName[LOADER_NAME_SIZE];
+	ULONG ulOffset; ///< From start of the disk.
+	ULONG ulSize;
+} tPackEntry;
+
+typedef struct tTrackFile {
+	ULONG ulStart;
+	ULONG ulSize;
+	ULONG ulPos;
+} tTrackFile;
+
+static struct MsgPort s_sPort;
+static struct IOExtTD s_sIo;
+static UBYTE s_isDeviceOpen;
+static UBYTE s_isMotorOn;
+static UBYTE *s_pTrack;
+static UWORD s_uwTrackInBuffer;
+static tPackEntry *s_pEntries;
+static UWORD s_uwEntryCount;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static UBYTE trackRead(UWORD uwTrack) {
+	s_sIo.iotd_Req.io_Command = CMD_READ;
+	s_sIo.iotd_Req.io_Data = s_pTrack;
+	s_sIo.iotd_Req.io_Length = LOADER_TRACK_SIZE;
+	s_sIo.iotd_Req.io_Offset = uwTrack * LOADER_TRACK_SIZE;
+	DoIO((struct IORequest*)&s_sIo);
+	s_isMotorOn = 1;
+	if(s_sIo.iotd_Req.io_Error) {
+		logWrite("ERR: Track %hu read failed: %hhd\n", uwTrack, s_sIo.iotd_Req.io_Error);
+		s_uwTrackInBuffer = LOADER_TRACK_NONE;
+		return 0;
+	}
+	s_uwTrackInBuffer = uwTrack;
+	return 1;
+}
+
+static ULONG diskRead(ULONG ulOffset, void *pDest, ULONG ulSize) {
+	UBYTE *pDst = pDest;
+	ULONG ulDone = 0;
+	while(ulDone < ulSize) {
+		UWORD uwTrack = (ulOffset + ulDone) / LOADER_TRACK_SIZE;
+		if(uwTrack != s_uwTrackInBuffer && !trackRead(uwTrack)) {
+			break;
+		}
+		UWORD uwTrackPos = (ulOffset + ulDone) % LOADER_TRACK_SIZE;
+		ULONG ulChunk = MIN(ulSize - ulDone, (ULONG)(LOADER_TRACK_SIZE - uwTrackPos));
+		memcpy(&pDst[ulDone], &s_pTrack[uwTrackPos], ulChunk);
+		ulDone += ulChunk;
+	}
+	return ulDone;
+}
+
+static void trackFileClose(void *pData) {
+	memTrackFreeFast(MEM_TAG_LOADER, pData, sizeof(tTrackFile));
+}
+
+static ULONG trackFileRead(void *pData, void *pDest, ULONG ulSize) {
+	tTrackFile *pFile = pData;
+	ulSize = MIN(ulSize, pFile->ulSize - pFile->ulPos);
+	ULONG ulRead = diskRead(pFile->ulStart + pFile->ulPos, pDest, ulSize);
+	pFile->ulPos += ulRead;
+	return ulRead;
+}
+
+static ULONG trackFileWrite(
+	UNUSED_ARG void *pData, UNUSED_ARG const void *pSrc, UNUSED_ARG ULONG ulSize
+) {
+	return 0;
+}
+
+static ULONG trackFileSeek(void *pData, LONG lPos, WORD wMode) {
+	tTrackFile *pFile = pData;
+	if(wMode == FILE_SEEK_CURRENT) {
+		lPos += pFile->ulPos;
+	}
+	else if(wMode == FILE_SEEK_END) {
+		lPos += pFile->ulSize;
+	}
+	if(lPos < 0 || (ULONG)lPos > pFile->ulSize) {
+		return 0;
+	}
+	pFile->ulPos = lPos;
+	return 1;
+}
+
+static ULONG trackFileGetPos(void *pData) {
+	return ((tTrackFile*)pData)->ulPos;
+}
+
+static UBYTE trackFileIsEof(void *pData) {
+	tTrackFile *pFile = pData;
+	return pFile->ulPos >= pFile->ulSize;
+}
+
+static void trackFileFlush(UNUSED_ARG void *pData) {
+}
+
+static const tFileCallbacks s_sTrackFileCallbacks = {
+	.cbFileClose = trackFileClose,
+	.cbFileRead = trackFileRead,
+	.cbFileWrite = trackFileWrite,
+	.cbFileSeek = trackFileSeek,
+	.cbFileGetPos = trackFileGetPos,
+	.cbFileIsEof = trackFileIsEof,
+	.cbFileFlush = trackFileFlush,
+};
+
+static UBYTE packOpen(void) {
+	// Port set up by hand, CreateMsgPort() is not available on KS1.3
+	BYTE bSignal = AllocSignal(-1);
+	if(bSignal < 0) {
+		return 0;
+	}
+	s_sPort.mp_Node.ln_Type = NT_MSGPORT;
+	s_sPort.mp_Flags = PA_SIGNAL;
+	s_sPort.mp_SigBit = bSignal;
+	s_sPort.mp_SigTask = FindTask(0);
+	struct List *pList = &s_sPort.mp_MsgList;
+	pList->lh_Head = (struct Node*)&pList->lh_Tail;
+	pList->lh_Tail = 0;
+	pList->lh_TailPred = (struct Node*)&pList->lh_Head;
+	s_sIo.iotd_Req.io_Message.mn_ReplyPort = &s_sPort;
+	s_sIo.iotd_Req.io_Message.mn_Length = sizeof(s_sIo);
+	if(OpenDevice((CONST_STRPTR)TD_NAME, 0, (struct IORequest*)&s_sIo, 0)) {
+		FreeSignal(bSignal);
+		return 0;
+	}
+
+	// Track buffer in CHIP since trackdisk on KS1.3 DMAs straight into it
+	s_pTrack = memTrackAllocChip(MEM_TAG_LOADER, LOADER_TRACK_SIZE);
+	if(!s_pTrack) {
+		logWrite("ERR: Can't allocate track buffer\n");
+		CloseDevice((struct IORequest*)&s_sIo);
+		FreeSignal(bSignal);
+		return 0;
+	}
+	s_isDeviceOpen = 1;
+	s_uwTrackInBuffer = LOADER_TRACK_NONE;
+
+	ULONG ulMagic = 0;
+	UWORD pCounts[2] = {0};
+	diskRead(LOADER_PACK_OFFSET, &ulMagic, sizeof(ulMagic));
+	diskRead(LOADER_PACK_OFFSET + sizeof(ulMagic), pCounts, sizeof(pCounts));
+	if(ulMagic != LOADER_PACK_MAGIC || !pCounts[0]) {
+		return 0;
+	}
+	s_pEntries = memTrackAllocFast(MEM_TAG_LOADER, sizeof(tPackEntry) * pCounts[0]);
+	if(!s_pEntries) {
+		logWrite("ERR: Can't allocate %hu pack entries\n", pCounts[0]);
+		return 0;
+	}
+	s_uwEntryCount = pCounts[0];
+	diskRead(
+		LOADER_PACK_OFFSET + sizeof(ulMagic) + sizeof(pCounts),
+		s_pEntries, sizeof(tPackEntry) * s_uwEntryCount
+	);
+	return 1;
+}
+
+static void packClose(void) {
+	if(s_uwEntryCount) {
+		memTrackFreeFast(MEM_TAG_LOADER, s_pEntries, sizeof(tPackEntry) * s_uwEntryCount);
+		s_uwEntryCount = 0;
+	}
+	if(s_isDeviceOpen) {
+		loaderMotorOff();
+		CloseDevice((struct IORequest*)&s_sIo);
+		FreeSignal(s_sPort.mp_SigBit);
+		memTrackFreeChip(MEM_TAG_LOADER, s_pTrack, LOADER_TRACK_SIZE);
+		s_isDeviceOpen = 0;
+	}
+}
+
+#endif // GAME_TRACKLOADER
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void loaderCreate(void) {
+#if defined(GAME_TRACKLOADER)
+	logBlockBegin("loaderCreate()");
+	if(packOpen()) {
+		logWrite("Using trackloader, %hu files in pack\n", s_uwEntryCount);
+	}
+	else {
+		logWrite("No pack on disk, falling back to DOS\n");
+		packClose();
+	}
+	logBlockEnd("loaderCreate()");
+#endif
+}
+
+void loaderDestroy(void) {
+#if defined(GAME_TRACKLOADER)
+	packClose();
+#endif
+}
+
+tFile *loaderFileOpen(const char *szPath) {
+#if defined(GAME_TRACKLOADER)
+	for(UWORD i = 0; i < s_uwEntryCount; ++i) {
+		const tPackEntry *pEntry = &s_pEntries[i];
+		if(!strncmp(pEntry->szName, szPath, LOADER_NAME_SIZE)) {
+			tTrackFile *pTrackFile = memTrackAllocFast(MEM_TAG_LOADER, sizeof(*pTrackFile));
+			pTrackFile->ulStart = pEntry->ulOffset;
+			pTrackFile->ulSize = pEntry->ulSize;
+			pTrackFile->ulPos = 0;
+			tFile *pFile = memTrackAllocFast(MEM_TAG_LOADER, sizeof(*pFile));
+			pFile->pCallbacks = &s_sTrackFileCallbacks;
+			pFile->pData = pTrackFile;
+			return pFile;
+		}
+	}
+#endif
+	return diskFileOpen(szPath, "r");
+}
+
+void loaderMotorOff(void) {
+#if defined(GAME_TRACKLOADER)
+	if(s_isMotorOn) {
+		s_sIo.iotd_Req.io_Command = TD_MOTOR;
+		s_sIo.iotd_Req.io_Length = 0;
+		DoIO((struct IORequest*)&s_sIo);
+		s_isMotorOn = 0;
+	}
+#endif
+}
@@ -0,0 +1,46 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_LOADER_H
+#define INCLUDE_LOADER_H
+
+#include <ace/utils/file.h>
+
+/**
+ * @brief Asset file access, either through DOS or straight from floppy tracks.
+ *
+ * With GAME_TRACKLOADER, assets are looked up in a pack laid out by
+ * tools/adf_layout.c on raw tracks of boot disk, in the order they're read.
+ * Files are streamed through single track buffer, so that sequential loads
+ * read each track once, without any DOS directory lookups or seeks.
+ * Files which aren't in the pack, or when there's no pack on DF0:, are read
+ * through DOS as usual.
+ *
+ * Pack layout, big endian, starting at block 2 of the disk:
+ * - ULONG magic "CAPK", UWORD entry count, UWORD reserved,
+ * - entries: char name[LOADER_NAME_SIZE], ULONG disk offset, ULONG size,
+ * - file contents, one after another.
+ */
+
+#define LOADER_NAME_SIZE 28
+
+void loaderCreate(void);
+
+void loaderDestroy(void);
+
+/**
+ * @brief Opens asset file for reading. Close it with fileClose().
+ *
+ * @param szPath Path to file, e.g. "data/tiles.pbm".
+ * @return File handle, 0 on failure.
+ */
+tFile *loaderFileOpen(const char *szPath);
+
+/**
+ * @brief Stops floppy motor after batch of loads.
+ * Must be called before OS is disabled.
+ */
+void loaderMotorOff(void);
+
+#endif // INCLUDE_LOADER_H
@@ -0,0 +1,193 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "mem_track.h"
+#include <exec/execbase.h>
+#include <exec/memory.h>
+#include <proto/exec.h>
+#include <ace/macros.h>
+#include <ace/managers/game.h>
+#include <ace/managers/memory.h>
+#include "trace.h"
+
+typedef struct tMemUsage {
+	LONG lChip;
+	LONG lFast;
+	LONG lPeakChip;
+	LONG lPeakFast;
+} tMemUsage;
+
+static ULONG s_ulBaseFreeChip, s_ulBaseFreeFast;
+static tMemUsage s_pTagUsages[MEM_TAG_COUNT]; ///< By free memory change.
+static tMemUsage s_pTagAllocs[MEM_TAG_COUNT]; ///< By tagged allocations.
+static UWORD s_uwFrameAllocCount; ///< Tagged allocations since last frame.
+static tMemTag s_eFrameAllocTag;
+static tMemUsage s_pStateUsages[MEM_STATE_COUNT];
+static tMemState s_eState;
+static ULONG s_ulFrameFreeChip, s_ulFrameFreeFast;
+static tMemTag s_eScopeTag;
+static ULONG s_ulScopeFreeChip, s_ulScopeFreeFast;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static void memTrackGetFree(ULONG *pFreeChip, ULONG *pFreeFast) {
+	// Same as AvailMem() does, without going through OS which may be disabled
+	ULONG ulFreeChip = 0, ulFreeFast = 0;
+	for(
+		struct Node *pNode = SysBase->MemList.lh_Head; pNode->ln_Succ;
+		pNode = pNode->ln_Succ
+	) {
+		const struct MemHeader *pHeader = (struct MemHeader*)pNode;
+		if(pHeader->mh_Attributes & MEMF_CHIP) {
+			ulFreeChip += pHeader->mh_Free;
+		}
+		else {
+			ulFreeFast += pHeader->mh_Free;
+		}
+	}
+	*pFreeChip = ulFreeChip;
+	*pFreeFast = ulFreeFast;
+}
+
+static void memUsageAdd(tMemUsage *pUsage, LONG lChip, LONG lFast) {
+	pUsage->lChip += lChip;
+	pUsage->lFast += lFast;
+	pUsage->lPeakChip = MAX(pUsage->lPeakChip, pUsage->lChip);
+	pUsage->lPeakFast = MAX(pUsage->lPeakFast, pUsage->lFast);
+}
+
+static void *memTrackAdd(tMemTag eTag, void *pMem, ULONG ulSize, UBYTE isChip) {
+	if(pMem) {
+		memUsageAdd(&s_pTagAllocs[eTag], isChip ? ulSize : 0, isChip ? 0 : ulSize);
+		++s_uwFrameAllocCount;
+		s_eFrameAllocTag = eTag;
+	}
+	return pMem;
+}
+
+static void memTrackSampleState(ULONG ulFreeChip, ULONG ulFreeFast) {
+	if(s_eState < MEM_STATE_COUNT) {
+		tMemUsage *pUsage = &s_pStateUsages[s_eState];
+		pUsage->lChip = s_ulBaseFreeChip - ulFreeChip;
+		pUsage->lFast = s_ulBaseFreeFast - ulFreeFast;
+		memUsageAdd(pUsage, 0, 0);
+	}
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void memTrackCreate(void) {
+	memTrackGetFree(&s_ulBaseFreeChip, &s_ulBaseFreeFast);
+	s_eState = MEM_STATE_COUNT;
+	s_eScopeTag = MEM_TAG_COUNT;
+}
+
+void *memTrackAllocFast(tMemTag eTag, ULONG ulSize) {
+	return memTrackAdd(eTag, memAllocFast(ulSize), ulSize, 0);
+}
+
+void *memTrackAllocFastClear(tMemTag eTag, ULONG ulSize) {
+	return memTrackAdd(eTag, memAllocFastClear(ulSize), ulSize, 0);
+}
+
+void *memTrackAllocChip(tMemTag eTag, ULONG ulSize) {
+	return memTrackAdd(eTag, memAllocChip(ulSize), ulSize, 1);
+}
+
+void memTrackFreeFast(tMemTag eTag, void *pMem, ULONG ulSize) {
+	memFree(pMem, ulSize);
+	memUsageAdd(&s_pTagAllocs[eTag], 0, -(LONG)ulSize);
+}
+
+void memTrackFreeChip(tMemTag eTag, void *pMem, ULONG ulSize) {
+	memFree(pMem, ulSize);
+	memUsageAdd(&s_pTagAllocs[eTag], -(LONG)ulSize, 0);
+}
+
+void memTrackScopeBegin(tMemTag eTag) {
+	s_eScopeTag = eTag;
+	memTrackGetFree(&s_ulScopeFreeChip, &s_ulScopeFreeFast);
+}
+
+void memTrackScopeEnd(void) {
+	ULONG ulFreeChip, ulFreeFast;
+	memTrackGetFree(&ulFreeChip, &ulFreeFast);
+	if(s_eScopeTag < MEM_TAG_COUNT) {
+		memUsageAdd(
+			&s_pTagUsages[s_eScopeTag],
+			(LONG)(s_ulScopeFreeChip - ulFreeChip), (LONG)(s_ulScopeFreeFast - ulFreeFast)
+		);
+	}
+	s_eScopeTag = MEM_TAG_COUNT;
+	memTrackSampleState(ulFreeChip, ulFreeFast);
+}
+
+void memTrackStateEnter(tMemState eState) {
+	s_eState = eState;
+	s_uwFrameAllocCount = 0;
+	memTrackGetFree(&s_ulFrameFreeChip, &s_ulFrameFreeFast);
+	memTrackSampleState(s_ulFrameFreeChip, s_ulFrameFreeFast);
+}
+
+void memTrackFrame(void) {
+	if(s_uwFrameAllocCount) {
+		// Exact, catches allocations freed in the same frame too
+		traceWrite(
+			TRACE_MEM_LOOP_TAGGED_ALLOC, s_eState, s_uwFrameAllocCount,
+			s_eFrameAllocTag
+		);
+		s_uwFrameAllocCount = 0;
+#if defined(GAME_DEBUG)
+		traceDrain();
+		gameExit();
+#endif
+	}
+
+	// Secondary check, for allocations made inside ACE
+	ULONG ulFreeChip, ulFreeFast;
+	memTrackGetFree(&ulFreeChip, &ulFreeFast);
+	if(ulFreeChip < s_ulFrameFreeChip || ulFreeFast < s_ulFrameFreeFast) {
+		traceWrite(
+			TRACE_MEM_LOOP_ALLOC, s_eState,
+			ulFreeChip < s_ulFrameFreeChip ? s_ulFrameFreeChip - ulFreeChip : 0,
+			ulFreeFast < s_ulFrameFreeFast ? s_ulFrameFreeFast - ulFreeFast : 0
+		);
+#if defined(GAME_DEBUG)
+		traceDrain();
+		gameExit();
+#endif
+	}
+	s_ulFrameFreeChip = ulFreeChip;
+	s_ulFrameFreeFast = ulFreeFast;
+	memTrackSampleState(ulFreeChip, ulFreeFast);
+}
+
+void memTrackReport(void) {
+	ULONG ulPeakChip = 0;
+	for(tMemState eState = 0; eState < MEM_STATE_COUNT; ++eState) {
+		const tMemUsage *pUsage = &s_pStateUsages[eState];
+		traceWrite(TRACE_MEM_STATE_PEAK, eState, pUsage->lPeakChip, pUsage->lPeakFast);
+		ulPeakChip = MAX(ulPeakChip, (ULONG)pUsage->lPeakChip);
+	}
+	for(tMemTag eTag = 0; eTag < MEM_TAG_COUNT; ++eTag) {
+		const tMemUsage *pUsage = &s_pTagUsages[eTag];
+		traceWrite(
+			TRACE_MEM_TAG_USAGE, eTag, pUsage->lPeakChip, pUsage->lPeakFast,
+			pUsage->lChip
+		);
+	}
+	for(tMemTag eTag = 0; eTag < MEM_TAG_COUNT; ++eTag) {
+		// Anything still held is leaked, all tags are freed before this
+		const tMemUsage *pUsage = &s_pTagAllocs[eTag];
+		traceWrite(
+			TRACE_MEM_TAG_TAGGED, eTag, pUsage->lPeakChip, pUsage->lPeakFast,
+			pUsage->lChip + pUsage->lFast
+		);
+	}
+#if defined(GAME_CHIP_BUDGET)
+	if(ulPeakChip > GAME_CHIP_BUDGET) {
+		traceWrite(TRACE_MEM_CHIP_BUDGET, ulPeakChip, GAME_CHIP_BUDGET);
+	}
+#endif
+}
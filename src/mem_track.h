@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_MEM_TRACK_H
+#define INCLUDE_MEM_TRACK_H
+
+#include <ace/types.h>
+
+/**
+ * @brief Memory usage tracking per subsystem and per state.
+ *
+ * Game's own allocations go through memTrackAlloc*() and memTrackFree*(),
+ * which account them exactly under given tag. Any such allocation inside
+ * state's frame loop is reported, even if it got freed in the same frame.
+ *
+ * ACE allocates by itself too (bitmaps, bobs, views), so as a secondary check
+ * usage is also measured as change of free CHIP/FAST memory reported by exec's
+ * memory headers. Reading it is just a few longword reads, cheap enough to
+ * be done each frame.
+ *
+ * Results go to trace records, see src/trace_formats.h. Tag and state
+ * numbers there are the enum values below.
+ */
+
+typedef enum tMemTag {
+	MEM_TAG_LOADER,
+	MEM_TAG_ASSETS,
+	MEM_TAG_DISPLAY,
+	MEM_TAG_LOGO,
+	MEM_TAG_MENU,
+	MEM_TAG_GAME,
+	MEM_TAG_WARRIOR,
+	MEM_TAG_COUNT
+} tMemTag;
+
+typedef enum tMemState {
+	MEM_STATE_LOGO,
+	MEM_STATE_MENU,
+	MEM_STATE_GAME,
+	MEM_STATE_COUNT
+} tMemState;
+
+/**
+ * @brief Takes baseline of free memory. Call before anything else allocates.
+ */
+void memTrackCreate(void);
+
+void *memTrackAllocFast(tMemTag eTag, ULONG ulSize);
+
+void *memTrackAllocFastClear(tMemTag eTag, ULONG ulSize);
+
+void *memTrackAllocChip(tMemTag eTag, ULONG ulSize);
+
+/**
+ * @brief Frees memory from memTrackAllocFast*(), using the same tag.
+ */
+void memTrackFreeFast(tMemTag eTag, void *pMem, ULONG ulSize);
+
+/**
+ * @brief Frees memory from memTrackAllocChip(), using the same tag.
+ */
+void memTrackFreeChip(tMemTag eTag, void *pMem, ULONG ulSize);
+
+/**
+ * @brief Starts attributing memory usage changes to given subsystem.
+ * Scopes can't be nested.
+ */
+void memTrackScopeBegin(tMemTag eTag);
+
+void memTrackScopeEnd(void);
+
+/**
+ * @brief Marks end of state's setup, its frame loop may not allocate anymore.
+ */
+void memTrackStateEnter(tMemState eState);
+
+/**
+ * @brief Checks that nothing was allocated since last frame of current state,
+ * by tagged allocations and by free memory. Call at start of state's loop.
+ * Stops the game in GAME_DEBUG builds.
+ */
+void memTrackFrame(void);
+
+/**
+ * @brief Writes per-state peaks, per-tag usage and CHIP budget check to trace.
+ * Tagged memory still held at that point is reported as leaked.
+ */
+void memTrackReport(void);
+
+#endif // INCLUDE_MEM_TRACK_H
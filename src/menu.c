@@ -12,9 +12,13 @@
 #include "display.h"
 #include "assets.h"
 #include "menu_list.h"
+#include "text_atlas.h"
+#include "mem_track.h"
 #include "chaos_arena.h"
 #include "steer.h"
+#include "input.h"
 #include "warrior.h"
+#include "sfx.h"
 
 //---------------------------------------------------------------------- DEFINES
 
@@ -38,19 +42,9 @@ typedef enum tMenuPage {
 	MENU_PAGE_MAIN,
 	MENU_PAGE_SUMMARY,
 	MENU_PAGE_CREDITS,
+	MENU_PAGE_COUNT,
 } tMenuPage;
 
-typedef enum tSteerKind {
-	STEER_KIND_JOY1,
-	STEER_KIND_JOY2,
-	STEER_KIND_JOY3,
-	STEER_KIND_JOY4,
-	STEER_KIND_WSAD,
-	STEER_KIND_ARROWS,
-	STEER_KIND_OFF,
-	STEER_KIND_COUNT,
-} tSteerKind;
-
 //---------------------------------------------------------------- PRIVATE DECLS
 
 static void onStart(void);
@@ -66,8 +60,10 @@ static void onDrawPos(
 
 //----------------------------------------------------------------- PRIVATE VARS
 
-static tSimpleBufferManager *s_pVpManager;
+static tScrollBufferManager *s_pVpManager;
 static tBitMap *s_pMenuBitmap;
+static tBitMap *s_pPageLayers[MENU_PAGE_COUNT]; ///< Static content of pages.
+static UBYTE s_pPageLayerValid[MENU_PAGE_COUNT];
 static UBYTE s_pPlayersEnabled[PLAYER_MAX_COUNT] = {0, 0, 0, 0, 0, 0};
 static UBYTE s_ubExtraEnemies = 0;
 static UBYTE s_ubThunders = 0;
@@ -175,37 +171,31 @@ static UBYTE isAnyPlayerOn(void) {
 	return 0;
 }
 
-static void menuDrawPage(tMenuPage ePage) {
-	blitRect(s_pMenuBitmap, 0, 0, MENU_WIDTH, MENU_HEIGHT, MENU_COLOR_BG);
-	blitCopy(g_pChaos, 0, 0, s_pMenuBitmap, CHAOS_MARGIN_X, CHAOS_MARGIN_Y, 160, 160, MINTERM_COPY);
+static void menuDrawPageLayer(tMenuPage ePage, tBitMap *pLayer) {
+	blitRect(pLayer, 0, 0, MENU_WIDTH, MENU_HEIGHT, MENU_COLOR_BG);
+	blitCopy(g_pChaos, 0, 0, pLayer, CHAOS_MARGIN_X, CHAOS_MARGIN_Y, 160, 160, MINTERM_COPY);
 	UBYTE ubLineHeight = g_pFontSmall->uwHeight + 1;
 
 	if(ePage == MENU_PAGE_MAIN) {
-		menuListInit(
-			s_pMenuMainOptions, s_pMenuMainCaptions, MENU_MAIN_OPTION_COUNT,
-			g_pFontSmall, 0, 40, onUndraw, onDrawPos
-		);
-		menuListSetActiveIndex(isAnyPlayerOn() ? 0 : 255);
-
 		UWORD uwTitleWidth = bitmapGetByteWidth(g_pTitleBitmap) * 8;
 		UWORD uwTitleHeight = g_pTitleBitmap->Rows;
 		blitCopyMask(
-			g_pTitleBitmap, 0, 0, s_pMenuBitmap,
+			g_pTitleBitmap, 0, 0, pLayer,
 			(MENU_WIDTH - uwTitleWidth) / 2, 5,
 			uwTitleWidth, uwTitleHeight, g_pTitleMask->Planes[0]
 		);
 
-		fontDrawStr(
-			g_pFontSmall, s_pMenuBitmap, MENU_WIDTH - 5, 5,
+		textAtlasDraw(
+			g_pFontSmall, pLayer, MENU_WIDTH - 5, 5,
 			"v." GAME_VERSION,
-			MENU_COLOR_FOOTER, FONT_COOKIE | FONT_SHADOW | FONT_RIGHT, g_pTextBitmap
+			MENU_COLOR_FOOTER, FONT_COOKIE | FONT_SHADOW | FONT_RIGHT
 		);
 
 		UWORD uwY = MENU_HEIGHT - ubLineHeight - 5;
-		fontDrawStr(
-			g_pFontSmall, s_pMenuBitmap, MENU_WIDTH / 2, uwY,
+		textAtlasDraw(
+			g_pFontSmall, pLayer, MENU_WIDTH / 2, uwY,
 			"A game by Last Minute Creations",
-			MENU_COLOR_FOOTER, FONT_COOKIE | FONT_SHADOW | FONT_HCENTER, g_pTextBitmap
+			MENU_COLOR_FOOTER, FONT_COOKIE | FONT_SHADOW | FONT_HCENTER
 		);
 	}
 	else if(ePage == MENU_PAGE_SUMMARY) {
@@ -222,15 +212,15 @@ static void menuDrawPage(tMenuPage ePage) {
 		else {
 			stringCopy("DEFEATED", szEntry);
 		}
-		fontDrawStr(
-			g_pFontBig, s_pMenuBitmap, MENU_WIDTH / 2, 20, szEntry,
-			MENU_COLOR_TITLE, FONT_COOKIE | FONT_SHADOW | FONT_HCENTER, g_pTextBitmap
+		textAtlasDraw(
+			g_pFontBig, pLayer, MENU_WIDTH / 2, 20, szEntry,
+			MENU_COLOR_TITLE, FONT_COOKIE | FONT_SHADOW | FONT_HCENTER
 		);
 
 		UWORD uwY = 50;
-		fontDrawStr(
-			g_pFontSmall, s_pMenuBitmap, MENU_WIDTH / 2, uwY, "Scores so far:",
-			MENU_COLOR_ACTIVE, FONT_COOKIE | FONT_SHADOW | FONT_HCENTER, g_pTextBitmap
+		textAtlasDraw(
+			g_pFontSmall, pLayer, MENU_WIDTH / 2, uwY, "Scores so far:",
+			MENU_COLOR_ACTIVE, FONT_COOKIE | FONT_SHADOW | FONT_HCENTER
 		);
 		uwY += 15;
 		for(UBYTE i = 0; i < PLAYER_MAX_COUNT; ++i) {
@@ -240,32 +230,54 @@ static void menuDrawPage(tMenuPage ePage) {
 				pEnd = stringDecimalFromULong(i + 1, pEnd);
 				pEnd = stringCopy(": ", pEnd);
 				pEnd = stringDecimalFromULong(s_pScores[i], pEnd);
-				fontDrawStr(
-					g_pFontSmall, s_pMenuBitmap, MENU_WIDTH / 2, uwY, szEntry,
-					MENU_COLOR_INACTIVE, FONT_COOKIE | FONT_SHADOW | FONT_HCENTER, g_pTextBitmap
+				textAtlasDraw(
+					g_pFontSmall, pLayer, MENU_WIDTH / 2, uwY, szEntry,
+					MENU_COLOR_INACTIVE, FONT_COOKIE | FONT_SHADOW | FONT_HCENTER
 				);
 				uwY += ubLineHeight;
 			}
 		}
-
-		menuListInit(
-			s_pMenuSummaryOptions, s_pMenuSummaryCaptions, MENU_SUMMARY_OPTION_COUNT,
-			g_pFontSmall, 0, MENU_HEIGHT - 4 * ubLineHeight, onUndraw, onDrawPos
-		);
 	}
 	else { // MENU_PAGE_CREDITS
 		UWORD uwY = 5;
 		for(UBYTE ubLine = 0; ubLine < MENU_CREDITS_LINE_COUNT; ++ubLine) {
 			if(!stringIsEmpty(s_pCreditsLines[ubLine])) {
-				fontDrawStr(
-					g_pFontSmall, s_pMenuBitmap, 5, uwY, s_pCreditsLines[ubLine],
+				textAtlasDraw(
+					g_pFontSmall, pLayer, 5, uwY, s_pCreditsLines[ubLine],
 					s_pCreditsLines[ubLine][0] == ' ' ? MENU_COLOR_INACTIVE : MENU_COLOR_TITLE,
-					FONT_COOKIE | FONT_SHADOW, g_pTextBitmap
+					FONT_COOKIE | FONT_SHADOW
 				);
 			}
 			uwY += ubLineHeight;
 		}
 	}
+}
+
+static void menuDrawPage(tMenuPage ePage) {
+	// Static part is composed only when its content has changed,
+	// otherwise page switch is a single copy followed by option rows.
+	if(!s_pPageLayerValid[ePage]) {
+		menuDrawPageLayer(ePage, s_pPageLayers[ePage]);
+		s_pPageLayerValid[ePage] = 1;
+	}
+	blitCopyAligned(
+		s_pPageLayers[ePage], 0, 0, s_pMenuBitmap, 0, 0, MENU_WIDTH, MENU_HEIGHT
+	);
+
+	UBYTE ubLineHeight = g_pFontSmall->uwHeight + 1;
+	if(ePage == MENU_PAGE_MAIN) {
+		menuListInit(
+			s_pMenuMainOptions, s_pMenuMainCaptions, MENU_MAIN_OPTION_COUNT,
+			g_pFontSmall, 0, 40, onUndraw, onDrawPos
+		);
+		menuListSetActiveIndex(isAnyPlayerOn() ? 0 : 255);
+	}
+	else if(ePage == MENU_PAGE_SUMMARY) {
+		menuListInit(
+			s_pMenuSummaryOptions, s_pMenuSummaryCaptions, MENU_SUMMARY_OPTION_COUNT,
+			g_pFontSmall, 0, MENU_HEIGHT - 4 * ubLineHeight, onUndraw, onDrawPos
+		);
+	}
 
 	if(ePage != MENU_PAGE_CREDITS) {
 		menuListDraw();
@@ -325,27 +337,39 @@ static UBYTE menuProcessDrawIn(void) {
 static void menuGsCreate(void) {
 	ptplayerLoadMod(g_pModMenu, g_pModSamples, 0);
 	ptplayerEnableMusic(1);
+	// Menu module plays on channel 0 only
+	sfxSetChannels(BV(1) | BV(2) | BV(3));
 
+	memTrackScopeBegin(MEM_TAG_MENU);
 	s_pMenuBitmap = bitmapCreate(MENU_WIDTH, MENU_HEIGHT, DISPLAY_BPP, BMF_INTERLEAVED);
+	for(tMenuPage ePage = 0; ePage < MENU_PAGE_COUNT; ++ePage) {
+		s_pPageLayers[ePage] = bitmapCreate(
+			MENU_WIDTH, MENU_HEIGHT, DISPLAY_BPP, BMF_INTERLEAVED
+		);
+		s_pPageLayerValid[ePage] = 0;
+	}
+	memTrackScopeEnd();
 	systemUnuse();
 	s_pVpManager = displayGetManager();
 	UBYTE isParallel = joyIsParallelEnabled();
 
 	UBYTE ubPlayer = 0;
-	s_pMenuSteers[ubPlayer++] = steerInitFromMode(STEER_MODE_JOY_1, 0);
-	s_pMenuSteers[ubPlayer++] = steerInitFromMode(STEER_MODE_JOY_2, 0);
-	s_pMenuSteers[ubPlayer++] = steerInitFromMode(isParallel ? STEER_MODE_JOY_3 : STEER_MODE_IDLE, 0);
-	s_pMenuSteers[ubPlayer++] = steerInitFromMode(isParallel ? STEER_MODE_JOY_4 : STEER_MODE_IDLE, 0);
-	s_pMenuSteers[ubPlayer++] = steerInitFromMode(STEER_MODE_KEY_ARROWS, 0);
-	s_pMenuSteers[ubPlayer++] = steerInitFromMode(STEER_MODE_KEY_WSAD, 0);
+	s_pMenuSteers[ubPlayer++] = steerInitFromMode(STEER_MODE_JOY_1);
+	s_pMenuSteers[ubPlayer++] = steerInitFromMode(STEER_MODE_JOY_2);
+	s_pMenuSteers[ubPlayer++] = steerInitFromMode(isParallel ? STEER_MODE_JOY_3 : STEER_MODE_IDLE);
+	s_pMenuSteers[ubPlayer++] = steerInitFromMode(isParallel ? STEER_MODE_JOY_4 : STEER_MODE_IDLE);
+	s_pMenuSteers[ubPlayer++] = steerInitFromMode(STEER_MODE_KEY_ARROWS);
+	s_pMenuSteers[ubPlayer++] = steerInitFromMode(STEER_MODE_KEY_WSAD);
 
 	menuDrawPage(s_eCurrentPage);
 	s_pLastDrawEnd[0] = DISPLAY_MARGIN_SIZE;
 	s_pLastDrawEnd[1] = DISPLAY_MARGIN_SIZE;
 	s_isOdd = 0;
+	memTrackStateEnter(MEM_STATE_MENU);
 }
 
 static void menuGsLoop(void) {
+	memTrackFrame();
 	tFadeState eFadeState = displayFadeProcess();
 	if(eFadeState == FADE_STATE_EVENT_FIRED) {
 		return;
@@ -368,6 +392,7 @@ static void menuGsLoop(void) {
 
 	UBYTE isNavigatingUpDown = 0;
 	UBYTE isNavigatingToggle = 0;
+	inputProcess();
 	for(UBYTE ubPlayer = 0; ubPlayer < PLAYER_MAX_COUNT; ++ubPlayer) {
 		tSteer *pSteer = &s_pMenuSteers[ubPlayer];
 		steerProcess(pSteer);
@@ -376,7 +401,7 @@ static void menuGsLoop(void) {
 			if(steerDirUse(pSteer, DIRECTION_FIRE)) {
 				s_pPlayersEnabled[ubPlayer] = 1;
 				s_pMenuMainOptions[1 + ubPlayer].eDirty |= MENU_LIST_DIRTY_VAL_CHANGE;
-				ptplayerSfxPlay(g_pSfxSwipeHit, 3, PTPLAYER_VOLUME_MAX, 10);
+				sfxRequest(g_pSfxSwipeHit, SFX_PRIORITY_MENU_SELECT);
 				if(menuListGetActiveIndex() == 255) {
 					menuListSetActiveIndex(0);
 				}
@@ -390,7 +415,7 @@ static void menuGsLoop(void) {
 					steerDirUse(pSteer, DIRECTION_FIRE) ||
 					(!isInReplayMode && keyUse(KEY_RETURN))
 				)) {
-					ptplayerSfxPlay(g_pSfxSwipeHit, 3, PTPLAYER_VOLUME_MAX, 10);
+					sfxRequest(g_pSfxSwipeHit, SFX_PRIORITY_MENU_SELECT);
 					menuNavigateToPage(MENU_PAGE_MAIN);
 					return;
 				}
@@ -415,10 +440,10 @@ static void menuGsLoop(void) {
 					const tMenuListOption *pOption = menuListGetActiveOption();
 					if(pOption->eOptionType == MENU_LIST_OPTION_TYPE_CALLBACK) {
 						if(pOption->sOptCb.cbSelect == onExitSelected) {
-							ptplayerSfxPlay(g_pSfxNo, 3, PTPLAYER_VOLUME_MAX, 15);
+							sfxRequest(g_pSfxNo, SFX_PRIORITY_MENU_EXIT);
 						}
 						else {
-							ptplayerSfxPlay(g_pSfxSwipeHit, 3, PTPLAYER_VOLUME_MAX, 10);
+							sfxRequest(g_pSfxSwipeHit, SFX_PRIORITY_MENU_SELECT);
 						}
 						menuListEnter();
 						return;
@@ -429,10 +454,10 @@ static void menuGsLoop(void) {
 	}
 
 	if(isNavigatingToggle) {
-		ptplayerSfxPlay(g_pSfxSwipeHit, 3, PTPLAYER_VOLUME_MAX, 10);
+		sfxRequest(g_pSfxSwipeHit, SFX_PRIORITY_MENU_SELECT);
 	}
 	else if(isNavigatingUpDown) {
-		ptplayerSfxPlay(g_pSfxSwipes[0], 3, PTPLAYER_VOLUME_MAX, 5);
+		sfxRequest(g_pSfxSwipes[0], SFX_PRIORITY_MENU_MOVE);
 	}
 
 	if(s_eCurrentPage != MENU_PAGE_CREDITS) {
@@ -448,7 +473,12 @@ static void menuGsLoop(void) {
 
 static void menuGsDestroy(void) {
 	systemUse();
+	memTrackScopeBegin(MEM_TAG_MENU);
 	bitmapDestroy(s_pMenuBitmap);
+	for(tMenuPage ePage = 0; ePage < MENU_PAGE_COUNT; ++ePage) {
+		bitmapDestroy(s_pPageLayers[ePage]);
+	}
+	memTrackScopeEnd();
 	ptplayerStop();
 }
 
@@ -456,6 +486,8 @@ static void onStart(void) {
 	for(UBYTE i = 0; i < PLAYER_MAX_COUNT; ++i) {
 		s_pScores[i] = 0;
 	}
+	// Let selection sound play in full before game starts
+	sfxProcess();
 	ptplayerWaitForSfx();
 	stateChange(g_pStateMachineGame, &g_sStateGame);
 }
@@ -483,19 +515,20 @@ static void onGoToMain(void) {
 static void onUndraw(UWORD uwX, UWORD uwY, UWORD uwWidth, UWORD uwHeight) {
 	// Add 1 to height for font shadow
 	++uwHeight;
-	blitRect(s_pMenuBitmap, uwX, uwY, uwWidth, uwHeight, MENU_COLOR_BG);
-	blitCopy(g_pChaos, 0, uwY - CHAOS_MARGIN_Y, s_pMenuBitmap, CHAOS_MARGIN_X, uwY, 160, uwHeight, MINTERM_COPY);
+	blitCopy(
+		s_pPageLayers[s_eCurrentPage], uwX, uwY, s_pMenuBitmap, uwX, uwY,
+		uwWidth, uwHeight, MINTERM_COPY
+	);
 }
 
 static void onDrawPos(
 	UWORD uwX, UWORD uwY, const char *szCaption, const char *szText,
 	UBYTE isActive, UWORD *pUndrawWidth
 ) {
-	UWORD uwTextWidth = fontMeasureText(g_pFontSmall, szText).uwX;
-	fontDrawStr(
+	UWORD uwTextWidth = textAtlasDraw(
 		g_pFontSmall, s_pMenuBitmap, uwX + MENU_WIDTH / 2, uwY, szText,
 		isActive ? MENU_COLOR_ACTIVE : MENU_COLOR_INACTIVE,
-		FONT_SHADOW | FONT_COOKIE | FONT_HCENTER, g_pTextBitmap
+		FONT_SHADOW | FONT_COOKIE | FONT_HCENTER
 	);
 	*pUndrawWidth = (MENU_WIDTH + uwTextWidth) / 2;
 }
@@ -520,6 +553,7 @@ void menuSetupMain(void) {
 void menuSetupSummary(UBYTE ubWinnerIndex) {
 	s_eCurrentPage = MENU_PAGE_SUMMARY;
 	s_ubLastWinner = ubWinnerIndex;
+	s_pPageLayerValid[MENU_PAGE_SUMMARY] = 0;
 	if(
 		ubWinnerIndex == WARRIOR_LAST_ALIVE_INDEX_INVALID ||
 		!s_pPlayersEnabled[ubWinnerIndex]
@@ -0,0 +1,44 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "rng.h"
+
+static tRngState s_sState;
+
+// Per-stream seed salt so that streams don't mirror each other
+static const ULONG s_pStreamSalts[RNG_STREAM_COUNT] = {
+	[RNG_STREAM_SIMULATION] = 0x00000000,
+	[RNG_STREAM_AI] = 0x9E3779B9,
+	[RNG_STREAM_COSMETIC] = 0x7F4A7C15,
+};
+
+void rngInit(ULONG ulSeed) {
+	for(UBYTE i = 0; i < RNG_STREAM_COUNT; ++i) {
+		ULONG ulState = ulSeed ^ s_pStreamSalts[i];
+		// xorshift gets stuck on zero
+		s_sState.pStreams[i] = ulState ? ulState : s_pStreamSalts[RNG_STREAM_AI];
+	}
+}
+
+UWORD rngNext(tRngStream eStream) {
+	// xorshift32
+	ULONG ulState = s_sState.pStreams[eStream];
+	ulState ^= ulState << 13;
+	ulState ^= ulState >> 17;
+	ulState ^= ulState << 5;
+	s_sState.pStreams[eStream] = ulState;
+	return ulState >> 16;
+}
+
+UWORD rngNextMax(tRngStream eStream, UWORD uwMax) {
+	return rngNext(eStream) % (uwMax + 1);
+}
+
+void rngStateGet(tRngState *pState) {
+	*pState = s_sState;
+}
+
+void rngStateSet(const tRngState *pState) {
+	s_sState = *pState;
+}
@@ -0,0 +1,38 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_RNG_H
+#define INCLUDE_RNG_H
+
+#include <ace/types.h>
+
+/**
+ * @brief Independent random streams. Each consumer draws only from its own
+ * stream, so e.g. adding a new sound pick won't change map or AI decisions.
+ */
+typedef enum tRngStream {
+	RNG_STREAM_SIMULATION, ///< Map selection, spawn order, thunder pushes.
+	RNG_STREAM_AI, ///< AI decisions.
+	RNG_STREAM_COSMETIC, ///< Anything which doesn't affect gameplay, e.g. sfx.
+	RNG_STREAM_COUNT
+} tRngStream;
+
+typedef struct tRngState {
+	ULONG pStreams[RNG_STREAM_COUNT];
+} tRngState;
+
+void rngInit(ULONG ulSeed);
+
+UWORD rngNext(tRngStream eStream);
+
+/**
+ * @brief Returns random number in range [0, uwMax], inclusive.
+ */
+UWORD rngNextMax(tRngStream eStream, UWORD uwMax);
+
+void rngStateGet(tRngState *pState);
+
+void rngStateSet(const tRngState *pState);
+
+#endif // INCLUDE_RNG_H
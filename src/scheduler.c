@@ -0,0 +1,137 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "scheduler.h"
+#include <ace/managers/log.h>
+
+// Must be power of 2. Longer delays just stay in slot for more revolutions.
+#define SCHEDULER_SLOT_COUNT 128
+#define SCHEDULER_EVENT_MAX 64
+#define SCHEDULER_SLOT_FIRING 0xFF
+#define SCHEDULER_SLOT_FREE 0xFE
+
+typedef struct tSchedulerEntry {
+	tCbSchedulerFire cbFire;
+	void *pData;
+	ULONG ulFireTick;
+	UBYTE ubPrev;
+	UBYTE ubNext;
+	UBYTE ubSlot;
+} tSchedulerEntry;
+
+static tSchedulerEntry s_pEntries[SCHEDULER_EVENT_MAX];
+static UBYTE s_pSlotHeads[SCHEDULER_SLOT_COUNT];
+static UBYTE s_ubFreeHead;
+static ULONG s_ulTick;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static void schedulerFree(tSchedulerEvent ubEvent) {
+	s_pEntries[ubEvent].cbFire = 0;
+	s_pEntries[ubEvent].ubSlot = SCHEDULER_SLOT_FREE;
+	s_pEntries[ubEvent].ubNext = s_ubFreeHead;
+	s_ubFreeHead = ubEvent;
+}
+
+static void schedulerUnlink(tSchedulerEvent ubEvent) {
+	tSchedulerEntry *pEntry = &s_pEntries[ubEvent];
+	if(pEntry->ubPrev != SCHEDULER_EVENT_INVALID) {
+		s_pEntries[pEntry->ubPrev].ubNext = pEntry->ubNext;
+	}
+	else {
+		s_pSlotHeads[pEntry->ubSlot] = pEntry->ubNext;
+	}
+	if(pEntry->ubNext != SCHEDULER_EVENT_INVALID) {
+		s_pEntries[pEntry->ubNext].ubPrev = pEntry->ubPrev;
+	}
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void schedulerReset(void) {
+	s_ulTick = 0;
+	for(UWORD i = 0; i < SCHEDULER_SLOT_COUNT; ++i) {
+		s_pSlotHeads[i] = SCHEDULER_EVENT_INVALID;
+	}
+	s_ubFreeHead = SCHEDULER_EVENT_INVALID;
+	for(UBYTE i = SCHEDULER_EVENT_MAX; i--;) {
+		schedulerFree(i);
+	}
+}
+
+void schedulerProcess(void) {
+	++s_ulTick;
+	UBYTE ubSlot = s_ulTick & (SCHEDULER_SLOT_COUNT - 1);
+
+	// Detach due events first - callbacks may add or cancel other ones
+	UBYTE pFired[SCHEDULER_EVENT_MAX];
+	UBYTE ubFiredCount = 0;
+	UBYTE ubEvent = s_pSlotHeads[ubSlot];
+	while(ubEvent != SCHEDULER_EVENT_INVALID) {
+		tSchedulerEntry *pEntry = &s_pEntries[ubEvent];
+		UBYTE ubNext = pEntry->ubNext;
+		if(pEntry->ulFireTick == s_ulTick) {
+			schedulerUnlink(ubEvent);
+			pEntry->ubSlot = SCHEDULER_SLOT_FIRING;
+			pFired[ubFiredCount++] = ubEvent;
+		}
+		ubEvent = ubNext;
+	}
+
+	for(UBYTE i = 0; i < ubFiredCount; ++i) {
+		tSchedulerEntry *pEntry = &s_pEntries[pFired[i]];
+		tCbSchedulerFire cbFire = pEntry->cbFire;
+		void *pData = pEntry->pData;
+		schedulerFree(pFired[i]);
+		if(cbFire) {
+			cbFire(pData);
+		}
+	}
+}
+
+tSchedulerEvent schedulerAdd(UWORD uwDelay, tCbSchedulerFire cbFire, void *pData) {
+	tSchedulerEvent ubEvent = s_ubFreeHead;
+	if(ubEvent == SCHEDULER_EVENT_INVALID) {
+		logWrite("ERR: Scheduler out of free events\n");
+		return SCHEDULER_EVENT_INVALID;
+	}
+	s_ubFreeHead = s_pEntries[ubEvent].ubNext;
+
+	ULONG ulFireTick = s_ulTick + (uwDelay ? uwDelay : 1);
+	UBYTE ubSlot = ulFireTick & (SCHEDULER_SLOT_COUNT - 1);
+	tSchedulerEntry *pEntry = &s_pEntries[ubEvent];
+	pEntry->cbFire = cbFire;
+	pEntry->pData = pData;
+	pEntry->ulFireTick = ulFireTick;
+	pEntry->ubSlot = ubSlot;
+	pEntry->ubPrev = SCHEDULER_EVENT_INVALID;
+	pEntry->ubNext = s_pSlotHeads[ubSlot];
+	if(pEntry->ubNext != SCHEDULER_EVENT_INVALID) {
+		s_pEntries[pEntry->ubNext].ubPrev = ubEvent;
+	}
+	s_pSlotHeads[ubSlot] = ubEvent;
+	return ubEvent;
+}
+
+void schedulerCancel(tSchedulerEvent ubEvent) {
+	if(ubEvent == SCHEDULER_EVENT_INVALID) {
+		return;
+	}
+
+	tSchedulerEntry *pEntry = &s_pEntries[ubEvent];
+	if(pEntry->ubSlot == SCHEDULER_SLOT_FREE) {
+		return;
+	}
+	if(pEntry->ubSlot == SCHEDULER_SLOT_FIRING) {
+		// Detached already, will be freed without calling
+		pEntry->cbFire = 0;
+		return;
+	}
+	schedulerUnlink(ubEvent);
+	schedulerFree(ubEvent);
+}
+
+ULONG schedulerGetTick(void) {
+	return s_ulTick;
+}
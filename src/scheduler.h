@@ -0,0 +1,46 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_SCHEDULER_H
+#define INCLUDE_SCHEDULER_H
+
+#include <ace/types.h>
+
+#define SCHEDULER_EVENT_INVALID 0xFF
+
+/**
+ * @brief Handle of scheduled event. Becomes invalid once the event fires,
+ * so owners should forget it in their callback.
+ */
+typedef UBYTE tSchedulerEvent;
+
+typedef void (*tCbSchedulerFire)(void *pData);
+
+/**
+ * @brief Drops all events and restarts tick count. Call on game start.
+ */
+void schedulerReset(void);
+
+/**
+ * @brief Advances by one tick and fires events due on it.
+ * Only events in current wheel slot are touched.
+ */
+void schedulerProcess(void);
+
+/**
+ * @brief Schedules callback to be fired uwDelay ticks from now.
+ *
+ * @param uwDelay Tick count, at least 1.
+ * @return Event handle or SCHEDULER_EVENT_INVALID if out of free events.
+ */
+tSchedulerEvent schedulerAdd(UWORD uwDelay, tCbSchedulerFire cbFire, void *pData);
+
+/**
+ * @brief Removes event before it fires. Accepts SCHEDULER_EVENT_INVALID.
+ */
+void schedulerCancel(tSchedulerEvent ubEvent);
+
+ULONG schedulerGetTick(void);
+
+#endif // INCLUDE_SCHEDULER_H
@@ -0,0 +1,154 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "sfx.h"
+#include "assets.h"
+#include "event.h"
+#include "rng.h"
+#include "trace.h"
+
+#define SFX_VOICE_MAX 4
+#define SFX_REQUEST_MAX 8
+// PAL Paula clock over frame rate, halved since each word is two samples
+#define SFX_PERIOD_WORDS_PER_FRAME (3546895 / 50 / 2)
+
+typedef struct tSfxVoice {
+	ULONG ulStartFrame; ///< Voices started earlier get stolen first.
+	ULONG ulEndFrame;
+	UBYTE ubChannel;
+	UBYTE ubPriority;
+} tSfxVoice;
+
+typedef struct tSfxRequest {
+	const tPtplayerSfx *pSfx;
+	UBYTE ubPriority;
+} tSfxRequest;
+
+static tSfxVoice s_pVoices[SFX_VOICE_MAX];
+static UBYTE s_ubVoiceCount;
+static tSfxRequest s_pRequests[SFX_REQUEST_MAX];
+static UBYTE s_ubRequestCount;
+static ULONG s_ulFrame;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static tSfxVoice *sfxGetVoice(UBYTE ubPriority) {
+	tSfxVoice *pBest = 0;
+	for(UBYTE i = 0; i < s_ubVoiceCount; ++i) {
+		tSfxVoice *pVoice = &s_pVoices[i];
+		if(pVoice->ulEndFrame <= s_ulFrame) {
+			return pVoice;
+		}
+		if(
+			pVoice->ulStartFrame == s_ulFrame || pVoice->ubPriority > ubPriority ||
+			(pBest && pVoice->ubPriority > pBest->ubPriority)
+		) {
+			// Taken by more important request of this frame or not better than best
+			continue;
+		}
+		if(
+			!pBest || pVoice->ubPriority < pBest->ubPriority ||
+			pVoice->ulStartFrame < pBest->ulStartFrame
+		) {
+			pBest = pVoice;
+		}
+	}
+	return pBest;
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void sfxSetChannels(UBYTE ubChannelMask) {
+	s_ubVoiceCount = 0;
+	for(UBYTE ubChannel = 0; ubChannel < SFX_VOICE_MAX; ++ubChannel) {
+		if(ubChannelMask & BV(ubChannel)) {
+			tSfxVoice *pVoice = &s_pVoices[s_ubVoiceCount++];
+			pVoice->ubChannel = ubChannel;
+			pVoice->ubPriority = 0;
+			pVoice->ulStartFrame = 0;
+			pVoice->ulEndFrame = 0;
+		}
+	}
+	s_ubRequestCount = 0;
+}
+
+void sfxRequest(const tPtplayerSfx *pSfx, UBYTE ubPriority) {
+	tSfxRequest *pLowest = 0;
+	for(UBYTE i = 0; i < s_ubRequestCount; ++i) {
+		tSfxRequest *pRequest = &s_pRequests[i];
+		if(pRequest->pSfx == pSfx) {
+			pRequest->ubPriority = MAX(pRequest->ubPriority, ubPriority);
+			return;
+		}
+		if(!pLowest || pRequest->ubPriority < pLowest->ubPriority) {
+			pLowest = pRequest;
+		}
+	}
+
+	if(s_ubRequestCount < SFX_REQUEST_MAX) {
+		pLowest = &s_pRequests[s_ubRequestCount++];
+	}
+	else if(pLowest->ubPriority >= ubPriority) {
+		return;
+	}
+	pLowest->pSfx = pSfx;
+	pLowest->ubPriority = ubPriority;
+}
+
+void sfxProcess(void) {
+	++s_ulFrame;
+
+	// Most important first, so that they get the best voices
+	for(UBYTE i = 1; i < s_ubRequestCount; ++i) {
+		tSfxRequest sRequest = s_pRequests[i];
+		UBYTE j = i;
+		while(j && s_pRequests[j - 1].ubPriority < sRequest.ubPriority) {
+			s_pRequests[j] = s_pRequests[j - 1];
+			--j;
+		}
+		s_pRequests[j] = sRequest;
+	}
+
+	for(UBYTE i = 0; i < s_ubRequestCount; ++i) {
+		const tSfxRequest *pRequest = &s_pRequests[i];
+		tSfxVoice *pVoice = sfxGetVoice(pRequest->ubPriority);
+		if(!pVoice) {
+			traceWrite(TRACE_SFX_DROPPED, pRequest->pSfx, pRequest->ubPriority);
+			continue;
+		}
+		pVoice->ubPriority = pRequest->ubPriority;
+		pVoice->ulStartFrame = s_ulFrame;
+		pVoice->ulEndFrame = s_ulFrame + 1 + (
+			(ULONG)pRequest->pSfx->uwWordLength * pRequest->pSfx->uwPeriod /
+			SFX_PERIOD_WORDS_PER_FRAME
+		);
+		ptplayerSfxPlay(
+			pRequest->pSfx, pVoice->ubChannel, PTPLAYER_VOLUME_MAX, pRequest->ubPriority
+		);
+	}
+	s_ubRequestCount = 0;
+}
+
+void sfxProcessEvents(void) {
+	UWORD uwMask = eventsGetFrameMask();
+	if(!uwMask) {
+		return;
+	}
+
+	if(uwMask & BV(EVENT_SWING)) {
+		sfxRequest(g_pSfxSwipes[rngNext(RNG_STREAM_COSMETIC) & 1], SFX_PRIORITY_SWIPE);
+	}
+	if(uwMask & BV(EVENT_HIT)) {
+		sfxRequest(g_pSfxSwipeHit, SFX_PRIORITY_HIT);
+	}
+	if(uwMask & BV(EVENT_TILE_VOID)) {
+		sfxRequest(g_pSfxCrumble, SFX_PRIORITY_CRUMBLE);
+	}
+	if(uwMask & BV(EVENT_THUNDER_STRIKE)) {
+		sfxRequest(g_pSfxThunder, SFX_PRIORITY_THUNDER);
+	}
+	if(uwMask & BV(EVENT_FALL)) {
+		sfxRequest(g_pSfxNo, SFX_PRIORITY_FALL);
+	}
+}
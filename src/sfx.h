@@ -5,15 +5,52 @@
 #ifndef INCLUDE_SFX_H
 #define INCLUDE_SFX_H
 
-// Channel 3
+#include <ace/types.h>
+#include <ace/managers/ptplayer.h>
+
+/**
+ * @brief Front-end for ptplayer's SFX playback.
+ *
+ * Sounds are requested during the frame and sent to ptplayer at once by
+ * sfxProcess(). Same sample requested more than once in a frame is played
+ * once. Each one goes to free voice, or steals the lowest priority one,
+ * oldest first. Voices are the channels given by current state, which should
+ * be the ones its music module leaves idle.
+ */
+
+// Higher priority sound can steal voice of lower or equal one
 #define SFX_PRIORITY_SWIPE 3
 #define SFX_PRIORITY_HIT 5
-
-// Channel 2
 #define SFX_PRIORITY_CRUMBLE 10
 #define SFX_PRIORITY_THUNDER 15
 #define SFX_PRIORITY_FALL 20
-
 #define SFX_PRIORITY_COUNTDOWN 30
 
+// Menu sounds
+#define SFX_PRIORITY_MENU_MOVE 5
+#define SFX_PRIORITY_MENU_SELECT 10
+#define SFX_PRIORITY_MENU_EXIT 15
+
+/**
+ * @brief Sets channels used as SFX voices, one bit per Paula channel.
+ * Drops pending requests and forgets voices' state.
+ */
+void sfxSetChannels(UBYTE ubChannelMask);
+
+/**
+ * @brief Requests sound to be played at next sfxProcess().
+ */
+void sfxRequest(const tPtplayerSfx *pSfx, UBYTE ubPriority);
+
+/**
+ * @brief Assigns frame's requests to voices and starts them.
+ * Call once per frame, after state's loop.
+ */
+void sfxProcess(void);
+
+/**
+ * @brief Requests sounds for gameplay events queued in current frame.
+ */
+void sfxProcessEvents(void);
+
 #endif // INCLUDE_SFX_H
@@ -0,0 +1,170 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "sprite_mux.h"
+#include <ace/managers/sprite.h>
+#include "display.h"
+
+#define SPRITE_MUX_BOB_HEIGHT_MAX 16
+// Control words + data + blank line needed for fetching next control words
+#define SPRITE_MUX_ROWS_PER_ENTRY (1 + SPRITE_MUX_BOB_HEIGHT_MAX)
+#define SPRITE_MUX_ROWS (SPRITE_MUX_ENTRIES_MAX * SPRITE_MUX_ROWS_PER_ENTRY + 1)
+#define SPRITE_MUX_HSTART_OFFSET 128
+#define SPRITE_MUX_VSTART_OFFSET 0x2C
+#define SPRITE_MUX_DISPLAY_HEIGHT SCREEN_PAL_HEIGHT
+
+typedef struct tSpriteMuxLane {
+	tSprite *pSprites[2]; ///< Even & odd channel of attached pair.
+	tBitMap *pBuffers[2][2]; ///< [buffer][even/odd]
+	UWORD *pWrite[2]; ///< Write pos in current buffer for even/odd channel.
+	WORD wFreeFromY; ///< First screen line on which next entry may start.
+} tSpriteMuxLane;
+
+static tSpriteMuxLane s_pLanes[SPRITE_MUX_LANE_COUNT];
+static tBob *s_pEntries[SPRITE_MUX_ENTRIES_MAX];
+static UBYTE s_ubEntryCount;
+static UBYTE s_ubFallbackCount;
+static UBYTE s_ubBufferIndex;
+
+static void laneWriteEntry(tSpriteMuxLane *pLane, const tBob *pBob, WORD wX, WORD wY) {
+	UWORD uwVStart = wY + SPRITE_MUX_VSTART_OFFSET;
+	UWORD uwVStop = uwVStart + pBob->uwHeight;
+	UWORD uwHStart = wX + SPRITE_MUX_HSTART_OFFSET;
+	UWORD uwPos = ((uwVStart & 0xFF) << 8) | ((uwHStart >> 1) & 0xFF);
+	UWORD uwCtl = (
+		((uwVStop & 0xFF) << 8) | (((uwVStart >> 8) & 1) << 2) |
+		(((uwVStop >> 8) & 1) << 1) | (uwHStart & 1)
+	);
+
+	UWORD *pEven = pLane->pWrite[0];
+	UWORD *pOdd = pLane->pWrite[1];
+	*(pEven++) = uwPos;
+	*(pEven++) = uwCtl;
+	*(pOdd++) = uwPos;
+	*(pOdd++) = uwCtl | BV(7); // attach bit
+
+	// Interleaved 4bpp row: plane 0..3, planes 0-1 go to even channel
+	const UWORD *pData = (const UWORD*)pBob->pFrameData;
+	const UWORD *pMask = (const UWORD*)pBob->pMaskData;
+	for(UWORD uwRow = pBob->uwHeight; uwRow--;) {
+		*(pEven++) = *(pData++) & *(pMask++);
+		*(pEven++) = *(pData++) & *(pMask++);
+		*(pOdd++) = *(pData++) & *(pMask++);
+		*(pOdd++) = *(pData++) & *(pMask++);
+	}
+
+	pLane->pWrite[0] = pEven;
+	pLane->pWrite[1] = pOdd;
+	pLane->wFreeFromY = wY + pBob->uwHeight + 1;
+}
+
+void spriteMuxCreate(void) {
+	for(UBYTE ubLane = 0; ubLane < SPRITE_MUX_LANE_COUNT; ++ubLane) {
+		tSpriteMuxLane *pLane = &s_pLanes[ubLane];
+		for(UBYTE ubBuffer = 0; ubBuffer < 2; ++ubBuffer) {
+			for(UBYTE ubChannel = 0; ubChannel < 2; ++ubChannel) {
+				pLane->pBuffers[ubBuffer][ubChannel] = bitmapCreate(
+					16, SPRITE_MUX_ROWS, 2, BMF_CLEAR | BMF_INTERLEAVED
+				);
+			}
+		}
+
+		UBYTE ubChannel = DISPLAY_SPRITE_CHANNEL_MUX_FIRST + 2 * ubLane;
+		pLane->pSprites[0] = spriteAdd(ubChannel, pLane->pBuffers[0][0]);
+		pLane->pSprites[1] = spriteAdd(ubChannel + 1, pLane->pBuffers[0][1]);
+		spriteSetEnabled(pLane->pSprites[0], 1);
+		spriteSetEnabled(pLane->pSprites[1], 1);
+	}
+	s_ubBufferIndex = 0;
+	s_ubEntryCount = 0;
+	s_ubFallbackCount = 0;
+}
+
+void spriteMuxDestroy(void) {
+	for(UBYTE ubLane = 0; ubLane < SPRITE_MUX_LANE_COUNT; ++ubLane) {
+		tSpriteMuxLane *pLane = &s_pLanes[ubLane];
+		spriteRemove(pLane->pSprites[0]);
+		spriteRemove(pLane->pSprites[1]);
+		for(UBYTE ubBuffer = 0; ubBuffer < 2; ++ubBuffer) {
+			bitmapDestroy(pLane->pBuffers[ubBuffer][0]);
+			bitmapDestroy(pLane->pBuffers[ubBuffer][1]);
+		}
+	}
+}
+
+void spriteMuxBegin(void) {
+	s_ubEntryCount = 0;
+}
+
+void spriteMuxPush(tBob *pBob) {
+	if(s_ubEntryCount >= SPRITE_MUX_ENTRIES_MAX) {
+		bobPush(pBob);
+		return;
+	}
+
+	// Keep entries sorted by Y - list is short and mostly sorted already
+	UBYTE ubPos = s_ubEntryCount++;
+	while(ubPos && s_pEntries[ubPos - 1]->sPos.uwY > pBob->sPos.uwY) {
+		s_pEntries[ubPos] = s_pEntries[ubPos - 1];
+		--ubPos;
+	}
+	s_pEntries[ubPos] = pBob;
+}
+
+void spriteMuxEnd(void) {
+	// Write to buffers which aren't displayed right now
+	s_ubBufferIndex = !s_ubBufferIndex;
+	for(UBYTE ubLane = 0; ubLane < SPRITE_MUX_LANE_COUNT; ++ubLane) {
+		tSpriteMuxLane *pLane = &s_pLanes[ubLane];
+		pLane->pWrite[0] = (UWORD*)pLane->pBuffers[s_ubBufferIndex][0]->Planes[0];
+		pLane->pWrite[1] = (UWORD*)pLane->pBuffers[s_ubBufferIndex][1]->Planes[0];
+		pLane->wFreeFromY = 0;
+	}
+
+	s_ubFallbackCount = 0;
+	const tUwCoordYX *pCameraPos = &displayGetManager()->pCamera->uPos;
+	for(UBYTE i = 0; i < s_ubEntryCount; ++i) {
+		tBob *pBob = s_pEntries[i];
+		WORD wX = pBob->sPos.uwX - pCameraPos->uwX;
+		WORD wY = pBob->sPos.uwY - pCameraPos->uwY;
+		tSpriteMuxLane *pFreeLane = 0;
+		if(
+			wX >= 0 && wX + pBob->uwWidth <= SCREEN_PAL_WIDTH &&
+			wY >= 0 && wY + pBob->uwHeight <= SPRITE_MUX_DISPLAY_HEIGHT &&
+			pBob->uwHeight <= SPRITE_MUX_BOB_HEIGHT_MAX
+		) {
+			for(UBYTE ubLane = 0; ubLane < SPRITE_MUX_LANE_COUNT; ++ubLane) {
+				if(s_pLanes[ubLane].wFreeFromY <= wY) {
+					pFreeLane = &s_pLanes[ubLane];
+					break;
+				}
+			}
+		}
+
+		if(pFreeLane) {
+			laneWriteEntry(pFreeLane, pBob, wX, wY);
+		}
+		else {
+			// Band is full - draw it the old way
+			bobPush(pBob);
+			++s_ubFallbackCount;
+		}
+	}
+
+	for(UBYTE ubLane = 0; ubLane < SPRITE_MUX_LANE_COUNT; ++ubLane) {
+		tSpriteMuxLane *pLane = &s_pLanes[ubLane];
+		for(UBYTE ubChannel = 0; ubChannel < 2; ++ubChannel) {
+			// End of sprite chain
+			*(pLane->pWrite[ubChannel]++) = 0;
+			*(pLane->pWrite[ubChannel]++) = 0;
+			spriteSetBitmap(
+				pLane->pSprites[ubChannel], pLane->pBuffers[s_ubBufferIndex][ubChannel]
+			);
+		}
+	}
+}
+
+UBYTE spriteMuxGetFallbackCount(void) {
+	return s_ubFallbackCount;
+}
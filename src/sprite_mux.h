@@ -0,0 +1,42 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_SPRITE_MUX_H
+#define INCLUDE_SPRITE_MUX_H
+
+#include <ace/managers/bob.h>
+
+/**
+ * @brief Shows 16px-wide 4bpp bobs on attached hardware sprite pairs.
+ *
+ * Each lane is a pair of attached sprite channels. Pushed bobs are sorted by Y
+ * and assigned to the first lane which is free at given scanline, so single
+ * lane can show many bobs as long as they don't share a horizontal band.
+ * Bobs which don't fit on any lane are pushed to the bob manager instead.
+ */
+
+#define SPRITE_MUX_LANE_COUNT 2
+#define SPRITE_MUX_ENTRIES_MAX 16
+
+void spriteMuxCreate(void);
+
+void spriteMuxDestroy(void);
+
+void spriteMuxBegin(void);
+
+/**
+ * @brief Queues bob to be shown on sprites. Bob must be 16px wide and
+ * interleaved, with mask in same layout as frame data.
+ */
+void spriteMuxPush(tBob *pBob);
+
+/**
+ * @brief Assigns queued bobs to lanes and builds sprite data for next frame.
+ * Must be called between bobBegin() and bobPushingDone().
+ */
+void spriteMuxEnd(void);
+
+UBYTE spriteMuxGetFallbackCount(void);
+
+#endif // INCLUDE_SPRITE_MUX_H
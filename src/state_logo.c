@@ -14,12 +14,19 @@
 #include "menu.h"
 #include "fade.h"
 #include "chaos_arena.h"
+#include "loader.h"
+#include "mem_track.h"
 
 #define FLASH_START_FRAME_A 1
 #define FLASH_START_FRAME_C 10
 #define FLASH_START_FRAME_E 30
 #define FLASH_START_FRAME_PWR 50
 #define FLASH_RATIO_INACTIVE -1
+#define ACE_LINE_COUNT 30
+#define ACE_LINE_COLOR_COUNT 3
+#define ACE_LINE_COPPER_INSTRUCTIONS (1 + ACE_LINE_COLOR_COUNT) // WAIT + MOVEs
+// Extra WAIT for PAL lines past 255
+#define ACE_COPPER_INSTRUCTIONS (ACE_LINE_COUNT * ACE_LINE_COPPER_INSTRUCTIONS + 1)
 
 typedef enum tStateAce {
 	STATE_ACE_FADE_IN,
@@ -48,7 +55,10 @@ static tStateManager *s_pStateMachineLogo;
 static tFade *s_pFade;
 static tStateAce s_eStateAce;
 
-static tCopBlock *s_pAceBlocks[30];
+static UWORD s_uwAceCopperOffset;
+static UWORD s_pAceLineColors[ACE_LINE_COUNT][ACE_LINE_COLOR_COUNT];
+static UBYTE s_ubAceWrapLine; ///< Line preceded by PAL wrap WAIT, ACE_LINE_COUNT if none.
+static UBYTE s_ubAceCopperUpdatesLeft;
 
 static const UWORD s_pAceColors[] = {
   0xA00, 0xA00,
@@ -75,10 +85,86 @@ static BYTE s_bRatioFlashE;
 static BYTE s_bRatioFlashPwr;
 static tUwRect s_sLogoRect;
 
+static void logoCopperFill(UWORD uwY) {
+	// Fills ACE effect area of both copper lists - either with WAIT per line
+	// followed by color MOVEs, or with no-op WAITs if uwY is 0.
+	// WAIT holds only low 8 bits of line, so first line past 255 is preceded
+	// by WAIT for end of line 255. If there's none, that WAIT goes last as no-op.
+	s_ubAceWrapLine = ACE_LINE_COUNT;
+	if(uwY) {
+		for(UBYTE i = 0; i < ACE_LINE_COUNT; ++i) {
+			if(uwY + i * 2 > 0xFF) {
+				s_ubAceWrapLine = i;
+				break;
+			}
+		}
+	}
+
+	tCopBfr *pBfrs[2] = {s_pView->pCopList->pBackBfr, s_pView->pCopList->pFrontBfr};
+	for(UBYTE ubBfr = 0; ubBfr < 2; ++ubBfr) {
+		tCopCmd *pCmd = &pBfrs[ubBfr]->pList[s_uwAceCopperOffset];
+		for(UBYTE i = 0; i < ACE_LINE_COUNT; ++i) {
+			if(i == s_ubAceWrapLine) {
+				copSetWait(&pCmd->sWait, 0xDF, 0xFF);
+				++pCmd;
+			}
+			if(uwY) {
+				copSetWait(&pCmd->sWait, 0, (uwY + i * 2) & 0xFF);
+				++pCmd;
+				for(UBYTE ubColor = 0; ubColor < ACE_LINE_COLOR_COUNT; ++ubColor) {
+					copSetMove(&pCmd->sMove, &g_pCustom->color[1 + ubColor], 0x000);
+					++pCmd;
+				}
+			}
+			else {
+				for(UBYTE n = 0; n < ACE_LINE_COPPER_INSTRUCTIONS; ++n) {
+					copSetWait(&pCmd->sWait, 0, 0);
+					++pCmd;
+				}
+			}
+		}
+		if(s_ubAceWrapLine == ACE_LINE_COUNT) {
+			copSetWait(&pCmd->sWait, 0, 0);
+		}
+	}
+}
+
+static void aceLineSetColor(UBYTE ubLine, UBYTE ubColor, UWORD uwColor) {
+	if(s_pAceLineColors[ubLine][ubColor] != uwColor) {
+		s_pAceLineColors[ubLine][ubColor] = uwColor;
+		s_ubAceCopperUpdatesLeft = 2;
+	}
+}
+
+static void logoCopperUpdate(void) {
+	// Double-buffered, so same values must land in both lists
+	if(!s_ubAceCopperUpdatesLeft) {
+		return;
+	}
+	--s_ubAceCopperUpdatesLeft;
+	tCopCmd *pCmd = &s_pView->pCopList->pBackBfr->pList[s_uwAceCopperOffset];
+	for(UBYTE i = 0; i < ACE_LINE_COUNT; ++i) {
+		if(i == s_ubAceWrapLine) {
+			++pCmd; // Skip PAL wrap WAIT
+		}
+		++pCmd; // Skip WAIT
+		for(UBYTE ubColor = 0; ubColor < ACE_LINE_COLOR_COUNT; ++ubColor) {
+			pCmd->sMove.bfValue = s_pAceLineColors[i][ubColor];
+			++pCmd;
+		}
+	}
+}
+
 static void logoGsCreate(void) {
 	logBlockBegin("logoGsCreate()");
+	memTrackScopeBegin(MEM_TAG_LOGO);
 
+	// Raw copperlist: bitplane setup followed by precomputed ACE effect lines,
+	// so that color animation is just word writes without any block processing.
+	s_uwAceCopperOffset = simpleBufferGetRawCopperlistInstructionCount(3);
 	s_pView = viewCreate(0,
+		TAG_VIEW_COPLIST_MODE, VIEW_COPLIST_MODE_RAW,
+		TAG_VIEW_COPLIST_RAW_COUNT, s_uwAceCopperOffset + ACE_COPPER_INSTRUCTIONS,
 		TAG_VIEW_GLOBAL_PALETTE, 1,
 	TAG_END);
 
@@ -92,10 +178,14 @@ static void logoGsCreate(void) {
 		TAG_SIMPLEBUFFER_VPORT, s_pVp,
 		TAG_SIMPLEBUFFER_IS_DBLBUF, 0,
 		TAG_SIMPLEBUFFER_USE_X_SCROLLING, 0,
+		TAG_SIMPLEBUFFER_COPLIST_OFFSET, 0,
 	TAG_END);
+	logoCopperFill(0);
 
 	s_pFade = fadeCreate(s_pView, 0, 0);
 	s_pStateMachineLogo = stateManagerCreate();
+	memTrackScopeEnd();
+	memTrackStateEnter(MEM_STATE_LOGO);
 	stateChange(s_pStateMachineLogo, &s_sStateLogoLmc);
 
 	logBlockEnd("logoGsCreate()");
@@ -119,9 +209,11 @@ static void logoGsDestroy(void) {
 
 	systemUse();
 	logBlockBegin("logoGsDestroy()");
+	memTrackScopeBegin(MEM_TAG_LOGO);
 	stateManagerDestroy(s_pStateMachineLogo);
 	fadeDestroy(s_pFade);
 	viewDestroy(s_pView);
+	memTrackScopeEnd();
 	logBlockEnd("logoGsDestroy()");
 }
 
@@ -135,9 +227,9 @@ static void onLmcFadeOut(void)
 static void logoLmcCreate(void) {
 	systemUse();
 	UWORD pPaletteRef[32];
-	paletteLoadFromPath("data/lmc.plt", pPaletteRef, 1 << s_pVp->ubBpp);
-	tBitMap *pLogo = bitmapCreateFromPath("data/lmc.bm", 0);
-	s_pSfxLmc = ptplayerSfxCreateFromPath("data/lmc.sfx", 0);
+	paletteLoadFromFd(loaderFileOpen("data/lmc.plt"), pPaletteRef, 1 << s_pVp->ubBpp);
+	tBitMap *pLogo = bitmapCreateFromFd(loaderFileOpen("data/lmc.bm"), 0);
+	s_pSfxLmc = ptplayerSfxCreateFromFd(loaderFileOpen("data/lmc.sfx"), 0);
 	systemUnuse();
 
 	s_sLogoRect.uwWidth = bitmapGetByteWidth(pLogo) * 8;
@@ -216,17 +308,18 @@ static UWORD blendColors(UWORD uwColorSrc, UWORD uwColorDst, UBYTE ubRatio)
 }
 
 static void logoAceCreate(void) {
-	tBitMap *pLogoAce = bitmapCreateFromPath("data/ace.bm", 0);
+	tBitMap *pLogoAce = bitmapCreateFromFd(loaderFileOpen("data/ace.bm"), 0);
 	s_sLogoRect.uwWidth = bitmapGetByteWidth(pLogoAce) * 8;
 	s_sLogoRect.uwHeight = pLogoAce->Rows;
 	UWORD uwLogoOffsY = (256 - s_sLogoRect.uwHeight) / 2;
 
-	for(UBYTE i = 0; i < 30; ++i) {
-    s_pAceBlocks[i] = copBlockCreate(s_pView->pCopList, 3, 0, s_pView->ubPosY + uwLogoOffsY + i * 2);
-    copMove(s_pView->pCopList, s_pAceBlocks[i], &g_pCustom->color[1], 0x000);
-    copMove(s_pView->pCopList, s_pAceBlocks[i], &g_pCustom->color[2], 0x000);
-    copMove(s_pView->pCopList, s_pAceBlocks[i], &g_pCustom->color[3], 0x000);
-  }
+	for(UBYTE i = 0; i < ACE_LINE_COUNT; ++i) {
+		for(UBYTE ubColor = 0; ubColor < ACE_LINE_COLOR_COUNT; ++ubColor) {
+			s_pAceLineColors[i][ubColor] = 0x000;
+		}
+	}
+	s_ubAceCopperUpdatesLeft = 0;
+	logoCopperFill(s_pView->ubPosY + uwLogoOffsY);
 
 	s_uwFlashFrame = 1;
 	s_bRatioFlashA = FLASH_RATIO_INACTIVE;
@@ -234,7 +327,7 @@ static void logoAceCreate(void) {
 	s_bRatioFlashE = FLASH_RATIO_INACTIVE;
 	s_bRatioFlashPwr = FLASH_RATIO_INACTIVE;
 
-	s_pSfxAce = ptplayerSfxCreateFromPath("data/ace.sfx", 0);
+	s_pSfxAce = ptplayerSfxCreateFromFd(loaderFileOpen("data/ace.sfx"), 0);
 	systemUnuse();
 
 	blitCopy(
@@ -271,13 +364,13 @@ static void logoAceLoop(void) {
 			s_eStateAce = STATE_ACE_FADE_OUT;
 		}
 
-		for(UBYTE i = 0; i < 30; ++i) {
+		for(UBYTE i = 0; i < ACE_LINE_COUNT; ++i) {
 			if(s_bRatioFlashA != FLASH_RATIO_INACTIVE && s_bRatioFlashA < 16) {
-				s_pAceBlocks[i]->pCmds[0].sMove.bfValue = blendColors(0xFFF, s_pAceColors[i], s_bRatioFlashA);
+				aceLineSetColor(i, 0, blendColors(0xFFF, s_pAceColors[i], s_bRatioFlashA));
 			}
 
 			if(s_bRatioFlashC != FLASH_RATIO_INACTIVE && s_bRatioFlashC < 16) {
-				s_pAceBlocks[i]->pCmds[1].sMove.bfValue = blendColors(0xFFF, s_pAceColors[i], s_bRatioFlashC);
+				aceLineSetColor(i, 1, blendColors(0xFFF, s_pAceColors[i], s_bRatioFlashC));
 			}
 
 			if(i < 9) {
@@ -286,38 +379,29 @@ static void logoAceLoop(void) {
 					s_bRatioFlashPwr != FLASH_RATIO_INACTIVE ?
 					blendColors(0xFFF, s_uwColorPowered, s_bRatioFlashPwr) : 0
 				);
-				s_pAceBlocks[i]->pCmds[2].sMove.bfValue = uwColor;
+				aceLineSetColor(i, 2, uwColor);
 			}
 			else {
 				if(s_bRatioFlashE != FLASH_RATIO_INACTIVE && s_bRatioFlashE < 16) {
-					s_pAceBlocks[i]->pCmds[2].sMove.bfValue = blendColors(0xFFF, s_pAceColors[i], s_bRatioFlashE);
+					aceLineSetColor(i, 2, blendColors(0xFFF, s_pAceColors[i], s_bRatioFlashE));
 				}
 			}
-
-			s_pAceBlocks[i]->ubUpdated = 2;
-			s_pView->pCopList->ubStatus |= STATUS_UPDATE;
 		}
 	}
 	else if(s_eStateAce == STATE_ACE_FADE_OUT) {
-		for(UBYTE i = 0; i < 30; ++i) {
-			s_pAceBlocks[i]->uwCurrCount = 0;
-			copMove(
-				s_pView->pCopList, s_pAceBlocks[i], &g_pCustom->color[1],
-				blendColors(0x000, s_pAceColors[i], s_bAceFadeoutRatio)
-			);
-			copMove(
-				s_pView->pCopList, s_pAceBlocks[i], &g_pCustom->color[2],
-				blendColors(0x000, s_pAceColors[i], s_bAceFadeoutRatio)
-			);
-			copMove(
-				s_pView->pCopList, s_pAceBlocks[i], &g_pCustom->color[3],
-				blendColors(0x000, i < 9 ? s_uwColorPowered : s_pAceColors[i], s_bAceFadeoutRatio)
-			);
+		for(UBYTE i = 0; i < ACE_LINE_COUNT; ++i) {
+			UWORD uwColor = blendColors(0x000, s_pAceColors[i], s_bAceFadeoutRatio);
+			aceLineSetColor(i, 0, uwColor);
+			aceLineSetColor(i, 1, uwColor);
+			aceLineSetColor(i, 2, (
+				i < 9 ? blendColors(0x000, s_uwColorPowered, s_bAceFadeoutRatio) : uwColor
+			));
 		}
 
 		--s_bAceFadeoutRatio;
 	}
 
+	logoCopperUpdate();
 	copProcessBlocks();
 	vPortWaitForEnd(s_pVp);
 
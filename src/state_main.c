@@ -3,6 +3,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "state_main.h"
+#include <ace/managers/game.h>
 #include <ace/managers/state.h>
 #include <ace/managers/system.h>
 #include "display.h"
@@ -10,14 +11,31 @@
 #include "chaos_arena.h"
 #include "assets.h"
 #include "debug.h"
+#include "loader.h"
+#include "mem_track.h"
 
 tStateManager *g_pStateMachineGame;
+static UBYTE s_isLoaded;
 
 static void stateMainCreate(void) {
 	logBlockBegin("stateMainCreate()");
 	g_pStateMachineGame = stateManagerCreate();
-	assetsGlobalCreate();
+	memTrackScopeBegin(MEM_TAG_ASSETS);
+	s_isLoaded = assetsGlobalCreate();
+	memTrackScopeEnd();
+	if(!s_isLoaded) {
+		// Nothing to show without them - quit, destroy frees what got loaded
+		logWrite("ERR: Can't load assets, quitting\n");
+		loaderMotorOff();
+		systemUnuse();
+		gameExit();
+		logBlockEnd("stateMainCreate()");
+		return;
+	}
+	memTrackScopeBegin(MEM_TAG_DISPLAY);
 	displayCreate();
+	memTrackScopeEnd();
+	loaderMotorOff();
 	systemUnuse();
 
 	displayOn();
@@ -27,6 +45,9 @@ static void stateMainCreate(void) {
 }
 
 static void stateMainLoop(void) {
+	if(!s_isLoaded) {
+		return;
+	}
 	stateProcess(g_pStateMachineGame);
 	debugSetColor(0xf00);
 	displayProcess();
@@ -34,10 +55,18 @@ static void stateMainLoop(void) {
 
 static void stateMainDestroy(void) {
 	logBlockBegin("stateMainDestroy()");
-	displayOff();
+	if(s_isLoaded) {
+		displayOff();
+	}
 	stateManagerDestroy(g_pStateMachineGame);
-	displayDestroy();
+	if(s_isLoaded) {
+		memTrackScopeBegin(MEM_TAG_DISPLAY);
+		displayDestroy();
+		memTrackScopeEnd();
+	}
+	memTrackScopeBegin(MEM_TAG_ASSETS);
 	assetsGlobalDestroy();
+	memTrackScopeEnd();
 	logBlockEnd("stateMainDestroy()");
 }
 
@@ -3,95 +3,37 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "steer.h"
-#include <ace/managers/joy.h>
-#include <ace/managers/key.h>
 
 //------------------------------------------------------------------ PRIVATE FNS
 
-static void onJoy(tSteer *pSteer) {
-	// Joy direction enum is not in same order as steer enum
-	// There is a reason why it's ordered that way in game, so it needs remapping
-	static const UBYTE pDirToJoy[] = {
-		[DIRECTION_UP] = JOY_UP,
-		[DIRECTION_DOWN] = JOY_DOWN,
-		[DIRECTION_LEFT] = JOY_LEFT,
-		[DIRECTION_RIGHT] = JOY_RIGHT,
-		[DIRECTION_FIRE] = JOY_FIRE
-	};
-
-	UBYTE ubJoy = pSteer->ubJoy;
-
-	for(tDirection eDir = 0; eDir < DIRECTION_COUNT; ++eDir) {
-		if(joyCheck(ubJoy + pDirToJoy[eDir])) {
-			if(pSteer->pDirectionStates[eDir] == STEER_DIR_STATE_INACTIVE) {
-				pSteer->pDirectionStates[eDir] = STEER_DIR_STATE_ACTIVE;
-			}
-		}
-		else {
-			pSteer->pDirectionStates[eDir] = STEER_DIR_STATE_INACTIVE;
-		}
+static void steerLatchInput(tSteer *pSteer) {
+	UBYTE ubHeld = inputGetHeld(pSteer->ePort);
+	UBYTE ubChanged = ubHeld ^ pSteer->ubHeld;
+	if(!ubChanged) {
+		// Held directions keep their active/used state
+		return;
 	}
-}
-
-static void onKey(tSteer *pSteer) {
-	static const UBYTE pDirsWsad[] = {
-		[DIRECTION_UP] = KEY_W,
-		[DIRECTION_DOWN] = KEY_S,
-		[DIRECTION_LEFT] = KEY_A,
-		[DIRECTION_RIGHT] = KEY_D,
-		[DIRECTION_FIRE] = KEY_LSHIFT
-	};
-	static const UBYTE pDirsArrows[] = {
-		[DIRECTION_UP] = KEY_UP,
-		[DIRECTION_DOWN] = KEY_DOWN,
-		[DIRECTION_LEFT] = KEY_LEFT,
-		[DIRECTION_RIGHT] = KEY_RIGHT,
-		[DIRECTION_FIRE] = KEY_RSHIFT
-	};
-
-	const UBYTE *pDirToKey = (pSteer->eKeymap == STEER_KEYMAP_WSAD) ? pDirsWsad : pDirsArrows;
-
+	pSteer->ubHeld = ubHeld;
 	for(tDirection eDir = 0; eDir < DIRECTION_COUNT; ++eDir) {
-		if(keyCheck(pDirToKey[eDir])) {
-			if(pSteer->pDirectionStates[eDir] == STEER_DIR_STATE_INACTIVE) {
-				pSteer->pDirectionStates[eDir] = STEER_DIR_STATE_ACTIVE;
-			}
-		}
-		else {
-			pSteer->pDirectionStates[eDir] = STEER_DIR_STATE_INACTIVE;
+		if(ubChanged & BV(eDir)) {
+			pSteer->pDirectionStates[eDir] = (ubHeld & BV(eDir)) ?
+				STEER_DIR_STATE_ACTIVE : STEER_DIR_STATE_INACTIVE;
 		}
 	}
 }
 
-static void onAi(tSteer *pSteer) {
-	tAi *pAi = &pSteer->sAi;
+static void steerProcessAi(tSteer *pSteer, tAi *pAi) {
 	tDirection eDir = aiProcess(pAi);
 
-	// // Fire is a special button - can be pressed for more than one process
-	// if(pAi->isPressingFire) {
-	// 	if(pSteer->pDirectionStates[DIRECTION_FIRE] == STEER_DIR_STATE_INACTIVE) {
-	// 		logWrite("Pressing fire\n");
-	// 		pSteer->pDirectionStates[DIRECTION_FIRE] = STEER_DIR_STATE_ACTIVE;
-	// 	}
-	// }
-	// else {
-	// 	if(pSteer->pDirectionStates[DIRECTION_FIRE] != STEER_DIR_STATE_INACTIVE) {
-	// 		logWrite("Releasing fire\n");
-	// 	}
-	// 	pSteer->pDirectionStates[DIRECTION_FIRE] = STEER_DIR_STATE_INACTIVE;
-	// }
-
 	if(eDir != DIRECTION_COUNT) {
 		// Push the selected button
 		if(pSteer->pDirectionStates[eDir] == STEER_DIR_STATE_INACTIVE) {
-			// logWrite("Pressing dir %hhu\n", eDir);
 			pSteer->pDirectionStates[eDir] = STEER_DIR_STATE_ACTIVE;
 		}
 	}
 
 	// Unpress the previous action
 	if(pSteer->ePrevDirection != eDir && pSteer->ePrevDirection != DIRECTION_COUNT) {
-		// logWrite("Releasing dir %hhu\n", pAi->ePrevDir);
 		pSteer->pDirectionStates[pSteer->ePrevDirection] = STEER_DIR_STATE_INACTIVE;
 	}
 
@@ -99,13 +41,9 @@ static void onAi(tSteer *pSteer) {
 	pSteer->ePrevDirection = eDir;
 }
 
-static void onIdle(UNUSED_ARG tSteer *pSteer) {
-	// Do nothing
-}
-
 //------------------------------------------------------------------- PUBLIC FNS
 
-tSteer steerInitFromMode(tSteerMode eMode, struct tWarrior *pWarrior) {
+tSteer steerInitFromMode(tSteerMode eMode) {
 	switch(eMode) {
 		case STEER_MODE_JOY_1:
 			return steerInitJoy(JOY1);
@@ -119,8 +57,6 @@ tSteer steerInitFromMode(tSteerMode eMode, struct tWarrior *pWarrior) {
 			return steerInitKey(STEER_KEYMAP_ARROWS);
 		case STEER_MODE_KEY_WSAD:
 			return steerInitKey(STEER_KEYMAP_WSAD);
-		case STEER_MODE_AI:
-			return steerInitAi(pWarrior);
 		default:
 			return steerInitIdle();
 	}
@@ -128,48 +64,77 @@ tSteer steerInitFromMode(tSteerMode eMode, struct tWarrior *pWarrior) {
 
 tSteer steerInitJoy(UBYTE ubJoy) {
 	tSteer sSteer = {
-		.cbProcess = onJoy,
-		.ubJoy = ubJoy
+		.eKind = STEER_KIND_JOY,
+		.ePort = inputPortFromJoy(ubJoy)
 	};
 	return sSteer;
 }
 
 tSteer steerInitKey(tSteerKeymap eKeymap) {
 	tSteer sSteer = {
-		.cbProcess = onKey,
-		.eKeymap = eKeymap
-	};
-	return sSteer;
-}
-
-tSteer steerInitAi(struct tWarrior *pWarrior) {
-	tSteer sSteer = {
-		.cbProcess = onAi
+		.eKind = STEER_KIND_KEY,
+		.ePort = (eKeymap == STEER_KEYMAP_WSAD) ? INPUT_PORT_KEY_WSAD : INPUT_PORT_KEY_ARROWS
 	};
-
-	aiInit(&sSteer.sAi, pWarrior);
 	return sSteer;
 }
 
 tSteer steerInitIdle(void) {
 	tSteer sSteer = {
-		.cbProcess = onIdle
+		.eKind = STEER_KIND_IDLE
 	};
 	return sSteer;
 }
 
 void steerProcess(tSteer *pSteer) {
-	if(pSteer->cbProcess) {
-		pSteer->cbProcess(pSteer);
+	if(pSteer->eKind == STEER_KIND_JOY || pSteer->eKind == STEER_KIND_KEY) {
+		steerLatchInput(pSteer);
+	}
+}
+
+void steerSetReset(tSteerSet *pSet) {
+	pSet->ubCount = 0;
+	pSet->ubPlayerCount = 0;
+	pSet->ubAiCount = 0;
+}
+
+tSteer *steerSetAdd(tSteerSet *pSet, tSteerMode eMode, struct tWarrior *pWarrior) {
+	UBYTE ubIndex = pSet->ubCount++;
+	tSteer *pSteer = &pSet->pSteers[ubIndex];
+	if(eMode == STEER_MODE_AI) {
+		*pSteer = (tSteer){
+			.eKind = STEER_KIND_AI,
+			.ePrevDirection = DIRECTION_COUNT
+		};
+		aiInit(&pSet->pAis[pSet->ubAiCount], pWarrior);
+		pSet->pAiSteers[pSet->ubAiCount++] = ubIndex;
+	}
+	else {
+		*pSteer = steerInitFromMode(eMode);
+		if(steerIsPlayer(pSteer)) {
+			pSet->pPlayerSteers[pSet->ubPlayerCount++] = ubIndex;
+		}
+	}
+	return pSteer;
+}
+
+void steerSetProcessPlayers(tSteerSet *pSet) {
+	for(UBYTE i = 0; i < pSet->ubPlayerCount; ++i) {
+		steerLatchInput(&pSet->pSteers[pSet->pPlayerSteers[i]]);
+	}
+}
+
+void steerSetProcessAis(tSteerSet *pSet) {
+	for(UBYTE i = 0; i < pSet->ubAiCount; ++i) {
+		steerProcessAi(&pSet->pSteers[pSet->pAiSteers[i]], &pSet->pAis[i]);
 	}
 }
 
 UBYTE steerIsPlayer(const tSteer *pSteer) {
-	return (pSteer->cbProcess == onJoy || pSteer->cbProcess == onKey);
+	return (pSteer->eKind == STEER_KIND_JOY || pSteer->eKind == STEER_KIND_KEY);
 }
 
 UBYTE steerIsArrows(const tSteer *pSteer) {
-	UBYTE isArrows = (pSteer->cbProcess == onKey && pSteer->eKeymap == STEER_KEYMAP_ARROWS);
+	UBYTE isArrows = (pSteer->eKind == STEER_KIND_KEY && pSteer->ePort == INPUT_PORT_KEY_ARROWS);
 	return isArrows;
 }
 
@@ -201,12 +166,6 @@ tDirection steerGetPressedDir(const tSteer *pSteer) {
 	return DIRECTION_COUNT;
 }
 
-void steerResetAi(tSteer *pSteer) {
-	if(pSteer->cbProcess == onAi) {
-		aiInit(&pSteer->sAi, pSteer->sAi.pWarrior);
-	}
-}
-
 const char *g_pSteerModeLabels[STEER_MODE_COUNT] = {
 	"JOY 1", "JOY 2", "JOY 3", "JOY 4", "WSAD", "ARROWS", "CPU", "IDLE", "OFF"
 };
@@ -8,6 +8,7 @@
 #include <ace/managers/joy.h> // for steerInitJoy() param
 #include "direction.h"
 #include "ai.h"
+#include "input.h"
 
 typedef enum tSteerMode {
 	STEER_MODE_JOY_1,
@@ -22,9 +23,12 @@ typedef enum tSteerMode {
 	STEER_MODE_COUNT,
 } tSteerMode;
 
-struct tSteer;
-
-typedef void (*tCbSteerProcess)(struct tSteer *pSteer);
+typedef enum tSteerKind {
+	STEER_KIND_IDLE,
+	STEER_KIND_JOY,
+	STEER_KIND_KEY,
+	STEER_KIND_AI,
+} tSteerKind;
 
 typedef enum tSteerDirState {
 	STEER_DIR_STATE_INACTIVE,
@@ -38,29 +42,67 @@ typedef enum tSteerKeymap {
 } tSteerKeymap;
 
 typedef struct tSteer {
-	tCbSteerProcess cbProcess;
+	tSteerKind eKind;
 	tSteerDirState pDirectionStates[DIRECTION_COUNT];
 	union {
-		UBYTE ubJoy; ///< for joy steer
-		tSteerKeymap eKeymap; ///< for keyboard steer
 		struct {
-			tAi sAi;
-			tDirection ePrevDirection;
-		};
+			tInputPort ePort;
+			UBYTE ubHeld; ///< Snapshot mask which direction states reflect.
+		}; ///< for joy and keyboard steer
+		tDirection ePrevDirection; ///< for AI steer
 	};
 } tSteer;
 
-tSteer steerInitFromMode(tSteerMode eMode, struct tWarrior *pWarrior);
+#define STEER_SET_SIZE 12
+
+/**
+ * @brief Steers processed together, grouped by kind.
+ *
+ * Player steers are decoded from input snapshot in one pass and AI ones are
+ * run in another, so that each pass is a tight loop without indirect calls.
+ * AI state is kept in its own compact array, in the same order as AI steers.
+ */
+typedef struct tSteerSet {
+	tSteer pSteers[STEER_SET_SIZE];
+	tAi pAis[STEER_SET_SIZE];
+	UBYTE pPlayerSteers[STEER_SET_SIZE]; ///< Indices of player steers.
+	UBYTE pAiSteers[STEER_SET_SIZE]; ///< Indices of AI steers.
+	UBYTE ubCount;
+	UBYTE ubPlayerCount;
+	UBYTE ubAiCount;
+} tSteerSet;
+
+/**
+ * @brief Inits steer which doesn't need AI state. AI mode gives idle steer,
+ * use steerSetAdd() for it.
+ */
+tSteer steerInitFromMode(tSteerMode eMode);
 
 tSteer steerInitJoy(UBYTE ubJoy);
 
 tSteer steerInitKey(tSteerKeymap eKeymap);
 
-tSteer steerInitAi(struct tWarrior *pWarrior);
+tSteer steerInitIdle(void);
 
+/**
+ * @brief Updates single player steer from input snapshot, for steers living
+ * outside of steer sets.
+ */
 void steerProcess(tSteer *pSteer);
 
-tSteer steerInitIdle(void);
+void steerSetReset(tSteerSet *pSet);
+
+/**
+ * @brief Adds steer of given mode to set.
+ *
+ * @param pWarrior Warrior controlled by steer, used by AI.
+ * @return Pointer to steer, valid until set is reset.
+ */
+tSteer *steerSetAdd(tSteerSet *pSet, tSteerMode eMode, struct tWarrior *pWarrior);
+
+void steerSetProcessPlayers(tSteerSet *pSet);
+
+void steerSetProcessAis(tSteerSet *pSet);
 
 UBYTE steerIsPlayer(const tSteer *pSteer);
 
@@ -72,8 +114,6 @@ UBYTE steerDirUse(tSteer *pSteer, tDirection eDir);
 
 tDirection steerGetPressedDir(const tSteer *pSteer);
 
-void steerResetAi(tSteer *pSteer);
-
 extern const char *g_pSteerModeLabels[STEER_MODE_COUNT];
 
 #endif // INCLUDE_STEER_H
@@ -0,0 +1,210 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "telemetry.h"
+
+#if defined(GAME_TELEMETRY)
+
+#include <ace/macros.h>
+#include <ace/managers/memory.h>
+#include <ace/utils/disk_file.h>
+#include "debug.h"
+#include "event.h"
+#include "mem_track.h"
+#include "telemetry_format.h"
+#include "tile.h"
+#include "trace.h"
+#include "warrior.h"
+
+#define TELEMETRY_PATH "telemetry.bin"
+// Few minutes of heavy fighting, 20KB
+#define TELEMETRY_RECORD_MAX 2048
+#define TELEMETRY_FRAMES_PER_SECOND 50
+
+// Fields in file order, big endian matches 68k's one
+typedef struct tTelemetryHeader {
+	ULONG ulMagic;
+	UWORD uwVersion;
+	UWORD uwRecordSize;
+	ULONG ulRecordCount;
+	ULONG ulFrames;
+	UBYTE ubMapIndex;
+	UBYTE ubMapWidth;
+	UBYTE ubMapHeight;
+	UBYTE ubWinner;
+	UBYTE ubFlags;
+	UBYTE pReserved[3];
+	ULONG pRngStart[TELEMETRY_RNG_STREAM_COUNT];
+} tTelemetryHeader;
+
+typedef struct tTelemetryRecord {
+	UWORD uwFrame;
+	UBYTE ubType;
+	UBYTE ubWarrior;
+	UBYTE ubOther;
+	UBYTE ubFlags;
+	UWORD uwX;
+	UWORD uwY;
+} tTelemetryRecord;
+
+static const UBYTE s_pEventToRecord[EVENT_TYPE_COUNT] = {
+	[EVENT_SPAWN] = TELEMETRY_RECORD_SPAWN,
+	[EVENT_HIT] = TELEMETRY_RECORD_HIT,
+	[EVENT_SWING] = TELEMETRY_RECORD_SWING,
+	[EVENT_FALL] = TELEMETRY_RECORD_FALL,
+	[EVENT_DEATH] = TELEMETRY_RECORD_DEATH,
+	[EVENT_CRUMBLE_START] = TELEMETRY_RECORD_CRUMBLE_START,
+	[EVENT_TILE_VOID] = TELEMETRY_RECORD_TILE_VOID,
+	[EVENT_THUNDER_STRIKE] = TELEMETRY_RECORD_THUNDER_STRIKE,
+};
+
+static tTelemetryHeader s_sHeader;
+static tTelemetryRecord *s_pRecords;
+static UBYTE s_ubSecondFrames;
+static ULONG s_ulSecondLinesSum;
+static UWORD s_uwSecondLineMax;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static tTelemetryRecord *telemetryAddRecord(UBYTE ubType) {
+	if(s_sHeader.ulRecordCount >= TELEMETRY_RECORD_MAX) {
+		s_sHeader.ubFlags |= TELEMETRY_MATCH_FLAG_TRUNCATED;
+		return 0;
+	}
+	tTelemetryRecord *pRecord = &s_pRecords[s_sHeader.ulRecordCount++];
+	pRecord->uwFrame = s_sHeader.ulFrames;
+	pRecord->ubType = ubType;
+	return pRecord;
+}
+
+static UBYTE telemetryAddEvent(const tEvent *pEvent) {
+	tTelemetryRecord *pRecord = telemetryAddRecord(s_pEventToRecord[pEvent->ubType]);
+	if(!pRecord) {
+		return 0;
+	}
+	pRecord->ubWarrior = pEvent->ubWarrior;
+	pRecord->ubOther = (
+		pEvent->ubType == EVENT_HIT ? pEvent->ubTarget : TELEMETRY_WARRIOR_NONE
+	);
+	pRecord->ubFlags = (
+		(pEvent->ubFlags & EVENT_FLAG_PLAYER) ? TELEMETRY_WARRIOR_FLAG_PLAYER : 0
+	);
+	pRecord->uwX = pEvent->sPos.uwX;
+	pRecord->uwY = pEvent->sPos.uwY;
+	return 1;
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void telemetryMatchBegin(const tRngState *pRngStart) {
+	s_pRecords = memTrackAllocFast(
+		MEM_TAG_GAME, TELEMETRY_RECORD_MAX * sizeof(*s_pRecords)
+	);
+	if(!s_pRecords) {
+		// Game goes on, just without recording this match
+		traceWrite(TRACE_TELEMETRY_ALLOC_FAILED);
+		return;
+	}
+	s_sHeader = (tTelemetryHeader){
+		.ulMagic = TELEMETRY_MAGIC,
+		.uwVersion = TELEMETRY_VERSION,
+		.uwRecordSize = sizeof(tTelemetryRecord),
+		.ubMapIndex = tileGetMapIndex(),
+		.ubMapWidth = tileGetMapWidth(),
+		.ubMapHeight = tileGetMapHeight(),
+		.ubWinner = TELEMETRY_WARRIOR_NONE
+	};
+	for(UBYTE i = 0; i < TELEMETRY_RNG_STREAM_COUNT; ++i) {
+		s_sHeader.pRngStart[i] = pRngStart->pStreams[i];
+	}
+	s_ubSecondFrames = 0;
+	s_ulSecondLinesSum = 0;
+	s_uwSecondLineMax = 0;
+
+	// Warriors disabled on creation spawn and die right away - they aren't
+	// part of the match, so neither is recorded
+	UBYTE ubEventCount = eventsGetCount();
+	UWORD uwDeadMask = 0;
+	for(UBYTE i = 0; i < ubEventCount; ++i) {
+		const tEvent *pEvent = eventsGet(i);
+		if(pEvent->ubType == EVENT_DEATH) {
+			uwDeadMask |= BV(pEvent->ubWarrior);
+		}
+	}
+	for(UBYTE i = 0; i < ubEventCount; ++i) {
+		const tEvent *pEvent = eventsGet(i);
+		if(pEvent->ubType == EVENT_SPAWN && !(uwDeadMask & BV(pEvent->ubWarrior))) {
+			telemetryAddEvent(pEvent);
+		}
+	}
+}
+
+void telemetryProcessEvents(void) {
+	if(!s_pRecords) {
+		return;
+	}
+	UBYTE ubEventCount = eventsGetCount();
+	for(UBYTE i = 0; i < ubEventCount; ++i) {
+		if(!telemetryAddEvent(eventsGet(i))) {
+			return;
+		}
+	}
+}
+
+void telemetryFrameEnd(void) {
+	if(!s_pRecords) {
+		return;
+	}
+	++s_sHeader.ulFrames;
+	UWORD uwLine = debugGetBeamLine();
+	s_ulSecondLinesSum += uwLine;
+	s_uwSecondLineMax = MAX(s_uwSecondLineMax, uwLine);
+	if(++s_ubSecondFrames < TELEMETRY_FRAMES_PER_SECOND) {
+		return;
+	}
+
+	tTelemetryRecord *pRecord = telemetryAddRecord(TELEMETRY_RECORD_SECOND);
+	if(pRecord) {
+		pRecord->ubWarrior = warriorsGetAliveCount();
+		pRecord->ubOther = TELEMETRY_WARRIOR_NONE;
+		pRecord->ubFlags = 0;
+		pRecord->uwX = s_ulSecondLinesSum / TELEMETRY_FRAMES_PER_SECOND;
+		pRecord->uwY = s_uwSecondLineMax;
+	}
+	s_ubSecondFrames = 0;
+	s_ulSecondLinesSum = 0;
+	s_uwSecondLineMax = 0;
+}
+
+void telemetryMatchCancel(void) {
+	s_sHeader.ubFlags |= TELEMETRY_MATCH_FLAG_CANCELLED;
+}
+
+void telemetryMatchEnd(UBYTE ubWinner) {
+	if(!s_pRecords) {
+		return;
+	}
+	if(!(s_sHeader.ubFlags & TELEMETRY_MATCH_FLAG_CANCELLED)) {
+		s_sHeader.ubWinner = ubWinner;
+	}
+	tFile *pFile = diskFileOpen(TELEMETRY_PATH, "a");
+	if(pFile) {
+		fileWrite(pFile, &s_sHeader, sizeof(s_sHeader));
+		fileWrite(pFile, s_pRecords, s_sHeader.ulRecordCount * sizeof(*s_pRecords));
+		fileClose(pFile);
+		traceWrite(
+			TRACE_TELEMETRY_WRITTEN, s_sHeader.ulRecordCount, s_sHeader.ulFrames,
+			s_sHeader.ubFlags
+		);
+	}
+	else {
+		traceWrite(TRACE_TELEMETRY_WRITE_FAILED, s_sHeader.ulRecordCount);
+	}
+	memTrackFreeFast(
+		MEM_TAG_GAME, s_pRecords, TELEMETRY_RECORD_MAX * sizeof(*s_pRecords)
+	);
+	s_pRecords = 0;
+}
+
+#endif // GAME_TELEMETRY
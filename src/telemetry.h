@@ -0,0 +1,63 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_TELEMETRY_H
+#define INCLUDE_TELEMETRY_H
+
+#include <ace/types.h>
+#include "rng.h"
+
+/**
+ * @brief Per-match telemetry, enabled by GAME_TELEMETRY.
+ *
+ * Gameplay events and per-second frame timing are stored in RAM buffer
+ * during the match. Buffer is appended to telemetry file when game state
+ * ends, never inside frame loop. File layout is in src/telemetry_format.h,
+ * tools/telemetry_analyze.c aggregates it.
+ * Without GAME_TELEMETRY all calls compile to nothing.
+ */
+
+#if defined(GAME_TELEMETRY)
+
+/**
+ * @brief Allocates buffer and records spawns of warriors taking part in match.
+ * Call after warriors are created. If there's no memory for buffer,
+ * match isn't recorded.
+ * @param pRngStart Rng state from before match setup, stored for replays.
+ */
+void telemetryMatchBegin(const tRngState *pRngStart);
+
+/**
+ * @brief Records events queued in current frame. Call before eventsEndFrame().
+ */
+void telemetryProcessEvents(void);
+
+/**
+ * @brief Samples frame end line. Call after bobs are drawn.
+ */
+void telemetryFrameEnd(void);
+
+/**
+ * @brief Marks match as cancelled, so that it's stored without a winner.
+ */
+void telemetryMatchCancel(void);
+
+/**
+ * @brief Appends match to telemetry file and frees buffer.
+ * Needs OS, so call it after systemUse().
+ * Does nothing if buffer couldn't be allocated on match begin.
+ */
+void telemetryMatchEnd(UBYTE ubWinner);
+
+#else
+
+#define telemetryMatchBegin(pRngStart)
+#define telemetryProcessEvents()
+#define telemetryFrameEnd()
+#define telemetryMatchCancel()
+#define telemetryMatchEnd(ubWinner)
+
+#endif // GAME_TELEMETRY
+
+#endif // INCLUDE_TELEMETRY_H
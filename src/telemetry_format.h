@@ -0,0 +1,61 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_TELEMETRY_FORMAT_H
+#define INCLUDE_TELEMETRY_FORMAT_H
+
+/**
+ * @brief Layout of match telemetry file, shared with tools/telemetry_analyze.c.
+ *
+ * File is a sequence of matches, each being header followed by its records.
+ * All fields are big endian.
+ *
+ * Header, TELEMETRY_HEADER_SIZE bytes:
+ * - ULONG magic, TELEMETRY_MAGIC
+ * - UWORD version, TELEMETRY_VERSION
+ * - UWORD record size, TELEMETRY_RECORD_SIZE
+ * - ULONG record count
+ * - ULONG frame count of the match
+ * - UBYTE map pattern index, map width and height in tiles
+ * - UBYTE winner index, 255 if none
+ * - UBYTE TELEMETRY_MATCH_FLAG_* bits
+ * - 3 reserved bytes
+ * - ULONG simulation, AI and cosmetic rng stream states at match start,
+ *   usable as simBench's "rng" scenario key
+ *
+ * Record, TELEMETRY_RECORD_SIZE bytes:
+ * - UWORD frame since match start, wraps after 65535
+ * - UBYTE TELEMETRY_RECORD_* type
+ * - UBYTE warrior index, 255 if none - alive warrior count for seconds
+ * - UBYTE other warrior index, 255 if none
+ * - UBYTE TELEMETRY_WARRIOR_FLAG_* bits
+ * - UWORD x, UWORD y in map pixels - avg and max frame end line for seconds
+ */
+
+#define TELEMETRY_MAGIC 0x4341544C // "CATL"
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_HEADER_SIZE 36
+#define TELEMETRY_RNG_STREAM_COUNT 3
+#define TELEMETRY_RECORD_SIZE 10
+#define TELEMETRY_WARRIOR_NONE 255
+
+#define TELEMETRY_MATCH_FLAG_TRUNCATED 1 ///< Buffer got full, later records lost.
+#define TELEMETRY_MATCH_FLAG_CANCELLED 2 ///< Left with ESC, winner is none.
+
+#define TELEMETRY_WARRIOR_FLAG_PLAYER 1
+
+typedef enum tTelemetryRecordType {
+	TELEMETRY_RECORD_SPAWN,
+	TELEMETRY_RECORD_HIT, ///< Warrior struck other one.
+	TELEMETRY_RECORD_SWING, ///< Warrior's strike missed.
+	TELEMETRY_RECORD_FALL,
+	TELEMETRY_RECORD_DEATH,
+	TELEMETRY_RECORD_CRUMBLE_START,
+	TELEMETRY_RECORD_TILE_VOID,
+	TELEMETRY_RECORD_THUNDER_STRIKE,
+	TELEMETRY_RECORD_SECOND, ///< Frame timing summary, each 50 frames.
+	TELEMETRY_RECORD_TYPE_COUNT
+} tTelemetryRecordType;
+
+#endif // INCLUDE_TELEMETRY_FORMAT_H
@@ -0,0 +1,200 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "text_atlas.h"
+#include <string.h>
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include "loader.h"
+#include "mem_track.h"
+
+#define TEXT_ATLAS_MAGIC 0x43415441 // "CATA"
+#define TEXT_ATLAS_FONT_MAX 4
+#define TEXT_CACHE_SIZE 8
+#define TEXT_CACHE_TEXT_SIZE 48
+#define TEXT_CACHE_WIDTH 320
+
+typedef struct tAtlasEntry {
+	UBYTE ubFont;
+	UBYTE ubReserved;
+	UWORD uwY;
+	UWORD uwWidth;
+	UWORD uwHash;
+	UWORD uwStringOffset;
+} tAtlasEntry;
+
+typedef struct tCacheSlot {
+	const tFont *pFont;
+	UWORD uwHash;
+	char szText[TEXT_CACHE_TEXT_SIZE];
+	tTextBitMap *pTextBitMap;
+} tCacheSlot;
+
+static tFont *s_pFonts[TEXT_ATLAS_FONT_MAX];
+static UBYTE s_ubFontCount;
+static tBitMap *s_pAtlas;
+static UWORD s_uwEntryCount;
+static UWORD s_uwStringSize;
+static tAtlasEntry *s_pEntries;
+static char *s_pStrings;
+static tBitMap *s_pEntryBitMaps;
+static tTextBitMap *s_pEntryTextBitMaps;
+
+static tCacheSlot s_pCache[TEXT_CACHE_SIZE];
+static UBYTE s_ubCacheNext;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+/**
+ * Same as textHash() in tools/text_atlas.c.
+ */
+static UWORD textAtlasHash(const char *szText) {
+	UWORD uwHash = 0;
+	while(*szText) {
+		uwHash = uwHash * 31 + (UBYTE)*(szText++);
+	}
+	return uwHash;
+}
+
+static tTextBitMap *textAtlasFind(const tFont *pFont, const char *szText, UWORD uwHash) {
+	for(UWORD i = 0; i < s_uwEntryCount; ++i) {
+		const tAtlasEntry *pEntry = &s_pEntries[i];
+		if(
+			pEntry->uwHash == uwHash && s_pFonts[pEntry->ubFont] == pFont &&
+			!strcmp(&s_pStrings[pEntry->uwStringOffset], szText)
+		) {
+			return &s_pEntryTextBitMaps[i];
+		}
+	}
+	return 0;
+}
+
+static tTextBitMap *textCacheGet(const tFont *pFont, const char *szText, UWORD uwHash) {
+	for(UBYTE i = 0; i < TEXT_CACHE_SIZE; ++i) {
+		tCacheSlot *pSlot = &s_pCache[i];
+		if(
+			pSlot->pFont == pFont && pSlot->uwHash == uwHash &&
+			!strcmp(pSlot->szText, szText)
+		) {
+			return pSlot->pTextBitMap;
+		}
+	}
+
+	// Miss - render into oldest slot
+	tCacheSlot *pSlot = &s_pCache[s_ubCacheNext];
+	s_ubCacheNext = (s_ubCacheNext + 1) % TEXT_CACHE_SIZE;
+	fontFillTextBitMap(pFont, pSlot->pTextBitMap, szText);
+	if(strlen(szText) < TEXT_CACHE_TEXT_SIZE) {
+		pSlot->pFont = pFont;
+		pSlot->uwHash = uwHash;
+		strcpy(pSlot->szText, szText);
+	}
+	else {
+		// Too long to be kept, used only this once
+		pSlot->pFont = 0;
+	}
+	return pSlot->pTextBitMap;
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void textAtlasCreate(const char *szPath, tFont * const *pFonts, UBYTE ubFontCount) {
+	logBlockBegin(
+		"textAtlasCreate(szPath: '%s', pFonts: %p, ubFontCount: %hhu)",
+		szPath, pFonts, ubFontCount
+	);
+	UWORD uwMaxHeight = 0;
+	s_ubFontCount = MIN(ubFontCount, TEXT_ATLAS_FONT_MAX);
+	for(UBYTE i = 0; i < s_ubFontCount; ++i) {
+		s_pFonts[i] = pFonts[i];
+		uwMaxHeight = MAX(uwMaxHeight, pFonts[i]->uwHeight);
+	}
+	for(UBYTE i = 0; i < TEXT_CACHE_SIZE; ++i) {
+		s_pCache[i].pFont = 0;
+		s_pCache[i].pTextBitMap = fontCreateTextBitMap(TEXT_CACHE_WIDTH, uwMaxHeight);
+	}
+	s_ubCacheNext = 0;
+	s_uwEntryCount = 0;
+
+	tFile *pFile = loaderFileOpen(szPath);
+	if(!pFile) {
+		logWrite("ERR: File doesn't exist: '%s'\n", szPath);
+		logBlockEnd("textAtlasCreate()");
+		return;
+	}
+
+	ULONG ulMagic;
+	UWORD uwWidth, uwHeight, uwEntryCount;
+	fileRead(pFile, &ulMagic, sizeof(ulMagic));
+	fileRead(pFile, &uwWidth, sizeof(uwWidth));
+	fileRead(pFile, &uwHeight, sizeof(uwHeight));
+	fileRead(pFile, &uwEntryCount, sizeof(uwEntryCount));
+	fileRead(pFile, &s_uwStringSize, sizeof(s_uwStringSize));
+	if(ulMagic != TEXT_ATLAS_MAGIC || !uwEntryCount) {
+		logWrite("ERR: Not a text atlas: '%s'\n", szPath);
+		fileClose(pFile);
+		logBlockEnd("textAtlasCreate()");
+		return;
+	}
+
+	s_pEntries = memTrackAllocFast(MEM_TAG_ASSETS, sizeof(tAtlasEntry) * uwEntryCount);
+	fileRead(pFile, s_pEntries, sizeof(tAtlasEntry) * uwEntryCount);
+	s_pStrings = memTrackAllocFast(MEM_TAG_ASSETS, s_uwStringSize);
+	fileRead(pFile, s_pStrings, s_uwStringSize);
+	s_pAtlas = bitmapCreate(uwWidth, uwHeight, 1, 0);
+	fileRead(pFile, s_pAtlas->Planes[0], s_pAtlas->BytesPerRow * uwHeight);
+	fileClose(pFile);
+
+	// Each entry gets bitmap header pointing at its rows in atlas plane,
+	// so that it can be passed straight to fontDrawTextBitMap().
+	s_pEntryBitMaps = memTrackAllocFast(MEM_TAG_ASSETS, sizeof(tBitMap) * uwEntryCount);
+	s_pEntryTextBitMaps = memTrackAllocFast(
+		MEM_TAG_ASSETS, sizeof(tTextBitMap) * uwEntryCount
+	);
+	for(UWORD i = 0; i < uwEntryCount; ++i) {
+		const tAtlasEntry *pEntry = &s_pEntries[i];
+		UWORD uwEntryHeight = (
+			pEntry->ubFont < s_ubFontCount ? s_pFonts[pEntry->ubFont]->uwHeight : 0
+		);
+		tBitMap *pBitMap = &s_pEntryBitMaps[i];
+		*pBitMap = *s_pAtlas;
+		pBitMap->Planes[0] = &s_pAtlas->Planes[0][pEntry->uwY * s_pAtlas->BytesPerRow];
+		pBitMap->Rows = uwEntryHeight;
+		s_pEntryTextBitMaps[i].pBitMap = pBitMap;
+		s_pEntryTextBitMaps[i].uwActualWidth = pEntry->uwWidth;
+		s_pEntryTextBitMaps[i].uwActualHeight = uwEntryHeight;
+	}
+	s_uwEntryCount = uwEntryCount;
+	logWrite("Loaded %hu strings, %hux%hu\n", uwEntryCount, uwWidth, uwHeight);
+	logBlockEnd("textAtlasCreate()");
+}
+
+void textAtlasDestroy(void) {
+	for(UBYTE i = 0; i < TEXT_CACHE_SIZE; ++i) {
+		fontDestroyTextBitMap(s_pCache[i].pTextBitMap);
+	}
+	if(s_uwEntryCount) {
+		memTrackFreeFast(
+			MEM_TAG_ASSETS, s_pEntryTextBitMaps, sizeof(tTextBitMap) * s_uwEntryCount
+		);
+		memTrackFreeFast(MEM_TAG_ASSETS, s_pEntryBitMaps, sizeof(tBitMap) * s_uwEntryCount);
+		bitmapDestroy(s_pAtlas);
+		memTrackFreeFast(MEM_TAG_ASSETS, s_pStrings, s_uwStringSize);
+		memTrackFreeFast(MEM_TAG_ASSETS, s_pEntries, sizeof(tAtlasEntry) * s_uwEntryCount);
+		s_uwEntryCount = 0;
+	}
+}
+
+UWORD textAtlasDraw(
+	const tFont *pFont, tBitMap *pDest, UWORD uwX, UWORD uwY,
+	const char *szText, UBYTE ubColor, UBYTE ubFlags
+) {
+	UWORD uwHash = textAtlasHash(szText);
+	tTextBitMap *pTextBitMap = textAtlasFind(pFont, szText, uwHash);
+	if(!pTextBitMap) {
+		pTextBitMap = textCacheGet(pFont, szText, uwHash);
+	}
+	fontDrawTextBitMap(pDest, pTextBitMap, uwX, uwY, ubColor, ubFlags);
+	return pTextBitMap->uwActualWidth;
+}
@@ -0,0 +1,41 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_TEXT_ATLAS_H
+#define INCLUDE_TEXT_ATLAS_H
+
+#include <ace/utils/font.h>
+
+/**
+ * @brief Text drawing with strings pre-rendered at build time.
+ *
+ * Constant strings are rendered by tools/text_atlas.c into single plane,
+ * so drawing them skips glyph blits and measuring - it's only the final
+ * fontDrawTextBitMap() from atlas rectangle. Any other string is rendered into
+ * small cache of text bitmaps, so redrawing recent dynamic strings (scores,
+ * option values) costs the same as atlas ones.
+ */
+
+/**
+ * @brief Loads text atlas.
+ *
+ * @param szPath Path to atlas file.
+ * @param pFonts Fonts in order of indices used in atlas source.
+ * @param ubFontCount Number of fonts in pFonts.
+ */
+void textAtlasCreate(const char *szPath, tFont * const *pFonts, UBYTE ubFontCount);
+
+void textAtlasDestroy(void);
+
+/**
+ * @brief Draws text, same as fontDrawStr() does.
+ *
+ * @return Width of drawn text, as returned by fontMeasureText().
+ */
+UWORD textAtlasDraw(
+	const tFont *pFont, tBitMap *pDest, UWORD uwX, UWORD uwY,
+	const char *szText, UBYTE ubColor, UBYTE ubFlags
+);
+
+#endif // INCLUDE_TEXT_ATLAS_H
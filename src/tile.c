@@ -7,19 +7,23 @@
 #include <ace/types.h>
 #include <ace/generic/screen.h>
 #include <ace/managers/blit.h>
-#include <ace/managers/rand.h>
+#include <ace/managers/log.h>
 #include "assets.h"
-#include "chaos_arena.h"
 #include "display.h"
-#include "sfx.h"
+#include "event.h"
+#include "rng.h"
+#include "scheduler.h"
+#include "trace.h"
 
-#define TILE_WIDTH (DISPLAY_WIDTH / MAP_TILE_SIZE)
-#define TILE_HEIGHT (DISPLAY_HEIGHT / MAP_TILE_SIZE)
 #define SPAWNS_MAX 30
-#define CRUMBLES_MAX 10
 #define CRUMBLE_COOLDOWN 1
 #define CRUMBLE_ADD_COOLDOWN 15
-#define TILE_QUEUE_SIZE (CRUMBLES_MAX * 2)
+#define TILE_QUEUE_SIZE (TILE_CRUMBLES_MAX * 2)
+#define TILE_STREAM_QUEUE_SIZE 8
+// Tiles drawn per frame when streaming rows, keeps the cost independent of map size.
+#define TILE_STREAM_TILES_PER_FRAME 8
+#define TILE_STREAM_BUFFER_COUNT 2
+#define TILE_ROW_BIT(x) (1UL << (x))
 
 typedef enum tTile {
 	TILE_VOID,
@@ -39,153 +43,226 @@ typedef struct tCrumble {
 	tTile *pTile;
 	UBYTE ubTileX;
 	UBYTE ubTileY;
-	UBYTE ubCooldown;
+	tSchedulerEvent ubStepEvent;
 } tCrumble;
 
 typedef struct tTileDrawQueueEntry {
-	UWORD uwX;
-	UWORD uwY;
-	UWORD uwTileOffset;
-	UWORD uwTileOffsetAbove;
-	UWORD uwTileOffsetBelow;
+	UBYTE ubTileX;
+	UBYTE ubTileY;
 	UBYTE ubDrawCount;
 } tTileDrawQueueEntry;
 
+/**
+ * @brief Map row which came into the buffer and needs to be drawn on it.
+ * Each back buffer has its own progress since only one is drawn per frame.
+ */
+typedef struct tTileStreamEntry {
+	UBYTE ubTileY;
+	UBYTE pNextX[TILE_STREAM_BUFFER_COUNT];
+} tTileStreamEntry;
+
 typedef struct tTileCrumbleOrderEntry {
 	tUbCoordYX sPos;
 	UWORD uwSortOrder;
 } tTileCrumbleOrderEntry;
 
-static tTile s_pTilesSourceXy[TILE_WIDTH][TILE_HEIGHT];
-static tTile s_pTilesXy[TILE_WIDTH][TILE_HEIGHT];
-static tCrumble s_pCrumbleList[CRUMBLES_MAX];
+typedef struct tMapPattern {
+	UBYTE ubWidth;
+	UBYTE ubHeight;
+	const char * const *pRowsYx;
+} tMapPattern;
+
+static tTile s_pTilesSourceXy[MAP_TILE_WIDTH_MAX][MAP_TILE_HEIGHT_MAX];
+static tTile s_pTilesXy[MAP_TILE_WIDTH_MAX][MAP_TILE_HEIGHT_MAX];
+static UBYTE s_ubMapWidth;
+static UBYTE s_ubMapHeight;
+static UBYTE s_ubMapIndex; ///< Of map pattern picked by tilesInit().
+// Bit X set if tile X in row is solid, mirrors s_pTilesXy for quick queries.
+static ULONG s_pSolidRows[MAP_TILE_HEIGHT_MAX];
+static tCrumble s_pCrumbleList[TILE_CRUMBLES_MAX];
 static tUwCoordYX s_pSpawns[SPAWNS_MAX];
 static UBYTE s_ubSpawnCount;
 static UBYTE s_ubActiveCrumbles;
-static UBYTE s_ubCrumbleAddCooldown;
+static tSchedulerEvent s_ubCrumbleAddEvent;
+static UBYTE s_isCrumbleStepAllowed;
 
 static tTileDrawQueueEntry s_pTileRedrawQueue[TILE_QUEUE_SIZE];
 static UBYTE s_ubRedrawPushPos;
 static UBYTE s_ubRedrawPopPos;
-static tTileCrumbleOrderEntry s_pTileCrumbleOrder[TILE_WIDTH * TILE_HEIGHT];
+static tTileCrumbleOrderEntry s_pTileCrumbleOrder[MAP_TILE_WIDTH_MAX * MAP_TILE_HEIGHT_MAX];
 
 static UWORD s_uwTileCount;
 static UWORD s_uwCurrentTileCrumble;
 
+// Buffer is a ring of tile rows - map row Y is drawn at buffer row Y % count.
+static UBYTE s_ubBufferRowCount;
+static UBYTE s_ubBufferTopRow;
+static UBYTE s_ubStreamBufferIndex;
+static tTileStreamEntry s_pStreamQueue[TILE_STREAM_QUEUE_SIZE];
+static UBYTE s_ubStreamPushPos;
+static UBYTE s_ubStreamPopPos;
+
 /**
- * @brief The easy to read tile layout.
+ * @brief The easy to read tile layouts, one string per tile row.
  * Note that indices are reversed here, but the ascii is in correct order.
  */
-static const char s_pMapPatternsYx[3][TILE_HEIGHT][TILE_WIDTH + 1] = {
-	{
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@....@..b..c..@....@@",
-		"@@.a..@........@..d.@@",
-		"@@@@@.@@@@..@@@@.@@@@@",
-		"@@@@@....@..@....@@@@@",
-		"@@...@...@..@...@...@@",
-		"@@.l.....@..@.....j.@@",
-		"@@...m...@..@...k...@@",
-		"@@...@...@..@...@...@@",
-		"@@@@@....@..@....@@@@@",
-		"@@@@@.@@@@..@@@@.@@@@@",
-		"@@.e..@........@..f.@@",
-		"@@....@..h..g..@....@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@"
-	},
-	{
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@..................@@",
-		"@@.a...j....f..k..b.@@",
-		"@@..................@@",
-		"@@.....@@@@@@@@.....@@",
-		"@@....@@@@@@@@@@..o.@@",
-		"@@.g.@@@@@@@@@@@@...@@",
-		"@@...@@@@@@@@@@@@.h.@@",
-		"@@.n..@@@@@@@@@@....@@",
-		"@@.....@@@@@@@@.....@@",
-		"@@..................@@",
-		"@@.d..m...e....l..c.@@",
-		"@@..................@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@"
-	},
-	{
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@.....L......J.....@@",
-		"@@.1......9.......3.@@",
-		"@@....@@@....@@@....@@",
-		"@@.G..@@@..5.@@@..D.@@",
-		"@@....@@@....@@@....@@",
-		"@@.....B...M......8.@@",
-		"@@.7......N...C.....@@",
-		"@@....@@@....@@@....@@",
-		"@@.E..@@@.6..@@@..F.@@",
-		"@@....@@@....@@@....@@",
-		"@@.4.......A......2.@@",
-		"@@.....H......K.....@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@",
-		"@@@@@@@@@@@@@@@@@@@@@@"
-	}
+static const char * const s_pMapPillarsYx[] = {
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@....@..b..c..@....@@",
+	"@@.a..@........@..d.@@",
+	"@@@@@.@@@@..@@@@.@@@@@",
+	"@@@@@....@..@....@@@@@",
+	"@@...@...@..@...@...@@",
+	"@@.l.....@..@.....j.@@",
+	"@@...m...@..@...k...@@",
+	"@@...@...@..@...@...@@",
+	"@@@@@....@..@....@@@@@",
+	"@@@@@.@@@@..@@@@.@@@@@",
+	"@@.e..@........@..f.@@",
+	"@@....@..h..g..@....@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@"
+};
+
+static const char * const s_pMapRingYx[] = {
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@..................@@",
+	"@@.a...j....f..k..b.@@",
+	"@@..................@@",
+	"@@.....@@@@@@@@.....@@",
+	"@@....@@@@@@@@@@..o.@@",
+	"@@.g.@@@@@@@@@@@@...@@",
+	"@@...@@@@@@@@@@@@.h.@@",
+	"@@.n..@@@@@@@@@@....@@",
+	"@@.....@@@@@@@@.....@@",
+	"@@..................@@",
+	"@@.d..m...e....l..c.@@",
+	"@@..................@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@"
+};
+
+static const char * const s_pMapBlocksYx[] = {
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@.....L......J.....@@",
+	"@@.1......9.......3.@@",
+	"@@....@@@....@@@....@@",
+	"@@.G..@@@..5.@@@..D.@@",
+	"@@....@@@....@@@....@@",
+	"@@.....B...M......8.@@",
+	"@@.7......N...C.....@@",
+	"@@....@@@....@@@....@@",
+	"@@.E..@@@.6..@@@..F.@@",
+	"@@....@@@....@@@....@@",
+	"@@.4.......A......2.@@",
+	"@@.....H......K.....@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@"
+};
+
+static const char * const s_pMapIslandsYx[] = {
+	"@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@",
+	"@@............@@@@............@@",
+	"@@..a.........@@@@..e.........@@",
+	"@@.........b..@@@@..........f.@@",
+	"@@............................@@",
+	"@@....@@@..............@@@....@@",
+	"@@....@@@.....@@@@.....@@@....@@",
+	"@@............@@@@............@@",
+	"@@............@@@@............@@",
+	"@@.c........d.@@@@.g........h.@@",
+	"@@............@@@@............@@",
+	"@@@@..@@@@@..@@@@@@..@@@@@..@@@@",
+	"@@@@..@@@@@..@@@@@@..@@@@@..@@@@",
+	"@@@@..@@@@@..@@@@@@..@@@@@..@@@@",
+	"@@@@..@@@.....@@@@.....@@@..@@@@",
+	"@@@@..@@@.....@@@@.....@@@..@@@@",
+	"@@@@..@@@..............@@@..@@@@",
+	"@@@@..@@@.q....s.......@@@..@@@@",
+	"@@@@u.@@@............r.@@@.v@@@@",
+	"@@@@..@@@.......t......@@@..@@@@",
+	"@@@@..@@@.....@@@@.....@@@..@@@@",
+	"@@@@..@@@.....@@@@.....@@@..@@@@",
+	"@@@@..@@@@@..@@@@@@..@@@@@..@@@@",
+	"@@@@..@@@@@..@@@@@@..@@@@@..@@@@",
+	"@@@@..@@@@@..@@@@@@..@@@@@..@@@@",
+	"@@............@@@@............@@",
+	"@@..i.........@@@@..m.........@@",
+	"@@..........j.@@@@.........n..@@",
+	"@@............@@@@............@@",
+	"@@....@@@..............@@@....@@",
+	"@@....@@@..............@@@....@@",
+	"@@............@@@@............@@",
+	"@@............@@@@............@@",
+	"@@.k.......l..@@@@.o........p.@@",
+	"@@............@@@@............@@",
+	"@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@",
+	"@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@"
+};
+
+static const tMapPattern s_pMapPatterns[] = {
+	{.ubWidth = 22, .ubHeight = 18, .pRowsYx = s_pMapPillarsYx},
+	{.ubWidth = 22, .ubHeight = 18, .pRowsYx = s_pMapRingYx},
+	{.ubWidth = 22, .ubHeight = 18, .pRowsYx = s_pMapBlocksYx},
+	{.ubWidth = 32, .ubHeight = 40, .pRowsYx = s_pMapIslandsYx},
 };
 
 //------------------------------------------------------------------ PRIVATE FNS
 
-static void tileQueueReset(void) {
-	for(UBYTE i = 0; i < TILE_QUEUE_SIZE; ++i) {
-		s_pTileRedrawQueue[i].ubDrawCount = 0;
+static tTile tileGetAt(UBYTE ubTileX, UBYTE ubTileY) {
+	if(ubTileX >= s_ubMapWidth || ubTileY >= s_ubMapHeight) {
+		return TILE_VOID;
 	}
+	return s_pTilesXy[ubTileX][ubTileY];
 }
 
-static void tileQueueAddEntry(UBYTE ubTileX, UBYTE ubTileY, tTile eTile) {
-	s_pTilesXy[ubTileX][ubTileY] = eTile;
-	tTileDrawQueueEntry *pEntry = &s_pTileRedrawQueue[s_ubRedrawPushPos];
-	pEntry->uwTileOffset = eTile * MAP_FULL_TILE_HEIGHT;
-	pEntry->uwTileOffsetAbove = s_pTilesXy[ubTileX][ubTileY - 1] * MAP_FULL_TILE_HEIGHT + MAP_TILE_SIZE;
-	pEntry->uwTileOffsetBelow = s_pTilesXy[ubTileX][ubTileY + 1] * MAP_FULL_TILE_HEIGHT;
-	pEntry->uwX = ubTileX * MAP_TILE_SIZE;
-	pEntry->uwY = ubTileY * MAP_TILE_SIZE;
-#if defined(ACE_BOB_PRISTINE_BUFFER)
-	pEntry->ubDrawCount = 4; // + 2x pristine buffer
-#else
-	pEntry->ubDrawCount = 2;
-#endif
+static UBYTE tileIsRowOnBuffer(UBYTE ubTileY) {
+	return (
+		s_ubBufferTopRow <= ubTileY && ubTileY < s_ubMapHeight &&
+		ubTileY < s_ubBufferTopRow + s_ubBufferRowCount
+	);
+}
 
-	if(++s_ubRedrawPushPos == TILE_QUEUE_SIZE) {
-		s_ubRedrawPushPos = 0;
-	}
-	if(s_ubRedrawPushPos == s_ubRedrawPopPos) {
-		logWrite("ERR: Ring buffer overflow");
-	}
+static UWORD tileGetBufferY(UBYTE ubTileY) {
+	return (ubTileY % s_ubBufferRowCount) * MAP_TILE_SIZE;
 }
 
-static void tileQueueProcess(tBitMap *pBuffer) {
-	tTileDrawQueueEntry *pEntry = &s_pTileRedrawQueue[s_ubRedrawPopPos];
-	if(pEntry->ubDrawCount == 0) {
-		return;
-	}
+static UBYTE tileGetBufferTopRowForCamera(UWORD uwCameraY) {
+	WORD wTopRow = uwCameraY / MAP_TILE_SIZE - DISPLAY_TILE_MARGIN;
+	WORD wTopRowMax = MAX(0, s_ubMapHeight - s_ubBufferRowCount);
+	return CLAMP(wTopRow, 0, wTopRowMax);
+}
 
+static void tileDrawOn(tBitMap *pBuffer, UBYTE ubTileX, UBYTE ubTileY) {
 	// Draw side part of the tile above masked with the tile: D=AB+!AC
 	// A - current tile mask
 	// B - current tile
 	// C - above tile
 	// D - destination buffer
 	UWORD uwWidthWords = 1;
-	ULONG ulCurrOffs = g_pTileset->BytesPerRow * pEntry->uwTileOffset;
-	ULONG ulAboveOffs = g_pTileset->BytesPerRow * (pEntry->uwTileOffsetAbove);
-	ULONG ulDstOffs = pBuffer->BytesPerRow * pEntry->uwY + (pEntry->uwX / 8);
+	ULONG ulCurrOffs = g_pTileset->BytesPerRow * (
+		tileGetAt(ubTileX, ubTileY) * MAP_FULL_TILE_HEIGHT
+	);
+	ULONG ulAboveOffs = g_pTileset->BytesPerRow * (
+		tileGetAt(ubTileX, ubTileY - 1) * MAP_FULL_TILE_HEIGHT + MAP_TILE_SIZE
+	);
+	ULONG ulDstOffs = (
+		pBuffer->BytesPerRow * tileGetBufferY(ubTileY) + ubTileX * (MAP_TILE_SIZE / 8)
+	);
 	WORD wTileModulo = 0;
-	WORD wDstModulo = (DISPLAY_WIDTH / 8) - (uwWidthWords * 2);
+	WORD wDstModulo = bitmapGetByteWidth(pBuffer) - (uwWidthWords * 2);
 	WORD wHeight = MAP_TILE_SIDE_HEIGHT * DISPLAY_BPP;
 
 	blitWait(); // Don't modify registers when other blit is in progress
@@ -199,10 +276,10 @@ static void tileQueueProcess(tBitMap *pBuffer) {
 	g_pCustom->bltcmod = wTileModulo;
 	g_pCustom->bltdmod = wDstModulo;
 
-	g_pCustom->bltapt = (UBYTE*)((ULONG)g_pTilesetMask->Planes[0] + ulCurrOffs);
-	g_pCustom->bltbpt = (UBYTE*)((ULONG)g_pTileset->Planes[0] + ulCurrOffs);
-	g_pCustom->bltcpt = (UBYTE*)((ULONG)g_pTileset->Planes[0] + ulAboveOffs);
-	g_pCustom->bltdpt = (UBYTE*)((ULONG)pBuffer->Planes[0] + ulDstOffs);
+	g_pCustom->bltapt = &g_pTilesetMask->Planes[0][ulCurrOffs];
+	g_pCustom->bltbpt = &g_pTileset->Planes[0][ulCurrOffs];
+	g_pCustom->bltcpt = &g_pTileset->Planes[0][ulAboveOffs];
+	g_pCustom->bltdpt = &pBuffer->Planes[0][ulDstOffs];
 	g_pCustom->bltsize = (wHeight << 6) | uwWidthWords;
 
 	// Draw remaining part of current tile, without side part
@@ -211,15 +288,64 @@ static void tileQueueProcess(tBitMap *pBuffer) {
 	g_pCustom->bltcon0 = USEB|USED | MINTERM_B;
 	g_pCustom->bltsize = (wHeight << 6) | uwWidthWords;
 
+	// Below row's slot in buffer ring may belong to the other row - if so,
+	// the side part will be drawn along with the below row when it gets in.
+	if(!tileIsRowOnBuffer(ubTileY + 1)) {
+		return;
+	}
+
 	// Draw side part of current tile masked with tile below
 	// Mask is for below-tile (C), so minterm is reversed: D=AC+!AB
 	wHeight = MAP_TILE_SIDE_HEIGHT * DISPLAY_BPP;
-	ULONG ulBelowOffs = g_pTileset->BytesPerRow * pEntry->uwTileOffsetBelow;
+	ULONG ulBelowOffs = g_pTileset->BytesPerRow * (
+		tileGetAt(ubTileX, ubTileY + 1) * MAP_FULL_TILE_HEIGHT
+	);
+	ulDstOffs = (
+		pBuffer->BytesPerRow * tileGetBufferY(ubTileY + 1) + ubTileX * (MAP_TILE_SIZE / 8)
+	);
 	blitWait(); // Don't modify registers when other blit is in progress
 	g_pCustom->bltcon0 = USEA|USEB|USEC|USED | MINTERM_REVERSE_COOKIE;
-	g_pCustom->bltapt = (UBYTE*)((ULONG)g_pTilesetMask->Planes[0] + ulBelowOffs);
-	g_pCustom->bltcpt = (UBYTE*)((ULONG)g_pTileset->Planes[0] + ulBelowOffs);
+	g_pCustom->bltapt = &g_pTilesetMask->Planes[0][ulBelowOffs];
+	g_pCustom->bltcpt = &g_pTileset->Planes[0][ulBelowOffs];
+	g_pCustom->bltdpt = &pBuffer->Planes[0][ulDstOffs];
 	g_pCustom->bltsize = (wHeight << 6) | uwWidthWords;
+}
+
+static void tileQueueReset(void) {
+	for(UBYTE i = 0; i < TILE_QUEUE_SIZE; ++i) {
+		s_pTileRedrawQueue[i].ubDrawCount = 0;
+	}
+}
+
+static void tileQueueAddEntry(UBYTE ubTileX, UBYTE ubTileY, tTile eTile) {
+	s_pTilesXy[ubTileX][ubTileY] = eTile;
+	tTileDrawQueueEntry *pEntry = &s_pTileRedrawQueue[s_ubRedrawPushPos];
+	pEntry->ubTileX = ubTileX;
+	pEntry->ubTileY = ubTileY;
+#if defined(ACE_BOB_PRISTINE_BUFFER)
+	pEntry->ubDrawCount = 4; // + 2x pristine buffer
+#else
+	pEntry->ubDrawCount = 2;
+#endif
+
+	if(++s_ubRedrawPushPos == TILE_QUEUE_SIZE) {
+		s_ubRedrawPushPos = 0;
+	}
+	if(s_ubRedrawPushPos == s_ubRedrawPopPos) {
+		traceWrite(TRACE_TILE_QUEUE_OVERFLOW);
+	}
+}
+
+static void tileQueueProcess(tBitMap *pBuffer) {
+	tTileDrawQueueEntry *pEntry = &s_pTileRedrawQueue[s_ubRedrawPopPos];
+	if(pEntry->ubDrawCount == 0) {
+		return;
+	}
+
+	// Off-buffer tiles will be drawn in their current state when streamed in
+	if(tileIsRowOnBuffer(pEntry->ubTileY)) {
+		tileDrawOn(pBuffer, pEntry->ubTileX, pEntry->ubTileY);
+	}
 
 	if(--pEntry->ubDrawCount == 0) {
 		if(++s_ubRedrawPopPos == TILE_QUEUE_SIZE) {
@@ -237,12 +363,78 @@ static UBYTE tileQueueHasSpace(void) {
 	return s_ubRedrawPopPos == s_ubRedrawPushPos;
 }
 
+static void tileStreamPushRow(UBYTE ubTileY) {
+	tTileStreamEntry *pEntry = &s_pStreamQueue[s_ubStreamPushPos];
+	pEntry->ubTileY = ubTileY;
+	for(UBYTE i = 0; i < TILE_STREAM_BUFFER_COUNT; ++i) {
+		pEntry->pNextX[i] = 0;
+	}
+
+	if(++s_ubStreamPushPos == TILE_STREAM_QUEUE_SIZE) {
+		s_ubStreamPushPos = 0;
+	}
+	if(s_ubStreamPushPos == s_ubStreamPopPos) {
+		traceWrite(TRACE_TILE_STREAM_OVERFLOW);
+	}
+}
+
+static UBYTE tileStreamIsEntryDone(const tTileStreamEntry *pEntry) {
+	for(UBYTE i = 0; i < TILE_STREAM_BUFFER_COUNT; ++i) {
+		if(pEntry->pNextX[i] < s_ubMapWidth) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static inline UBYTE tileGetSolidTriple(ULONG ulRow, UBYTE ubCenterX) {
+	// Bits of tiles at X-1, X, X+1 - tiles outside map are void anyway
+	if(ubCenterX == 0) {
+		return (ulRow << 1) & 0b111;
+	}
+	return (ulRow >> (ubCenterX - 1)) & 0b111;
+}
+
+static inline tUwCoordYX tileGetCenterPos(UBYTE ubTileX, UBYTE ubTileY) {
+	return (tUwCoordYX){
+		.uwX = ubTileX * MAP_TILE_SIZE + MAP_TILE_SIZE / 2,
+		.uwY = ubTileY * MAP_TILE_SIZE + MAP_TILE_SIZE / 2
+	};
+}
+
 static int onTileCrumbleSort(const void *pLhs, const void *pRhs) {
 	const tTileCrumbleOrderEntry *pLhsCoord = (tTileCrumbleOrderEntry*)pLhs;
 	const tTileCrumbleOrderEntry *pRhsCoord = (tTileCrumbleOrderEntry*)pRhs;
 	return pRhsCoord->uwSortOrder - pLhsCoord->uwSortOrder;
 }
 
+static void onCrumbleStep(void *pData) {
+	tCrumble *pCrumble = pData;
+	pCrumble->ubStepEvent = SCHEDULER_EVENT_INVALID;
+	if(!s_isCrumbleStepAllowed) {
+		// Redraw queue is busy, retry on next tick
+		pCrumble->ubStepEvent = schedulerAdd(1, onCrumbleStep, pCrumble);
+		return;
+	}
+
+	--*pCrumble->pTile;
+	UBYTE ubTileX = pCrumble->ubTileX;
+	UBYTE ubTileY = pCrumble->ubTileY;
+	if(!*pCrumble->pTile) {
+		pCrumble->pTile = 0;
+		s_pSolidRows[ubTileY] &= ~TILE_ROW_BIT(ubTileX);
+		eventPush(
+			EVENT_TILE_VOID, EVENT_WARRIOR_NONE, EVENT_WARRIOR_NONE, 0,
+			tileGetCenterPos(ubTileX, ubTileY)
+		);
+	}
+	else {
+		pCrumble->ubStepEvent = schedulerAdd(CRUMBLE_COOLDOWN, onCrumbleStep, pCrumble);
+	}
+
+	tileQueueAddEntry(ubTileX, ubTileY, s_pTilesXy[ubTileX][ubTileY]);
+}
+
 static void tileCrumbleAddNext(void) {
 	if(s_uwCurrentTileCrumble >= s_uwTileCount) {
 		return;
@@ -254,38 +446,59 @@ static void tileCrumbleAddNext(void) {
 		return;
 	}
 
-	for(UBYTE i = 0; i < CRUMBLES_MAX; ++i) {
+	for(UBYTE i = 0; i < TILE_CRUMBLES_MAX; ++i) {
 		if(!s_pCrumbleList[i].pTile) {
 			s_pCrumbleList[i].pTile = pTile;
-			s_pCrumbleList[i].ubCooldown = CRUMBLE_COOLDOWN;
 			s_pCrumbleList[i].ubTileX = sPos.ubX;
 			s_pCrumbleList[i].ubTileY = sPos.ubY;
+			s_pCrumbleList[i].ubStepEvent = schedulerAdd(
+				CRUMBLE_COOLDOWN, onCrumbleStep, &s_pCrumbleList[i]
+			);
 			++s_ubActiveCrumbles;
 			++s_uwCurrentTileCrumble;
+			eventPush(
+				EVENT_CRUMBLE_START, EVENT_WARRIOR_NONE, EVENT_WARRIOR_NONE, 0,
+				tileGetCenterPos(sPos.ubX, sPos.ubY)
+			);
 			return;
 		}
 	}
 }
 
+static void onCrumbleAdd(void *pData) {
+	tileCrumbleAddNext();
+	s_ubCrumbleAddEvent = schedulerAdd(CRUMBLE_ADD_COOLDOWN, onCrumbleAdd, 0);
+}
+
 //------------------------------------------------------------------- PUBLIC FNS
 
 void tilesInit(void) {
-	UBYTE ubMapIndex = randUwMax(&g_sRandManager, 2);
+	s_ubMapIndex = rngNextMax(RNG_STREAM_SIMULATION, ARRAY_SIZE(s_pMapPatterns) - 1);
+	const tMapPattern *pMap = &s_pMapPatterns[s_ubMapIndex];
+	s_ubMapWidth = pMap->ubWidth;
+	s_ubMapHeight = pMap->ubHeight;
+	UWORD uwMapCenterX = (s_ubMapWidth * MAP_TILE_SIZE) / 2;
+	UWORD uwMapCenterY = (s_ubMapHeight * MAP_TILE_SIZE) / 2;
 	s_ubSpawnCount = 0;
 	s_uwTileCount = 0;
-	for(UBYTE ubY = 0; ubY < TILE_HEIGHT; ++ubY) {
-		for(UBYTE ubX = 0; ubX < TILE_WIDTH; ++ubX) {
-			s_pTilesSourceXy[ubX][ubY] = (
-				s_pMapPatternsYx[ubMapIndex][ubY][ubX] == '@' ? TILE_VOID : TILE_FLOOR1
-			);
+	for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH_MAX; ++ubX) {
+		for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT_MAX; ++ubY) {
+			s_pTilesSourceXy[ubX][ubY] = TILE_VOID;
+		}
+	}
+
+	for(UBYTE ubY = 0; ubY < s_ubMapHeight; ++ubY) {
+		for(UBYTE ubX = 0; ubX < s_ubMapWidth; ++ubX) {
+			char cTile = pMap->pRowsYx[ubY][ubX];
+			s_pTilesSourceXy[ubX][ubY] = (cTile == '@' ? TILE_VOID : TILE_FLOOR1);
 
-			if(s_pMapPatternsYx[ubMapIndex][ubY][ubX] != '@' && s_pMapPatternsYx[ubMapIndex][ubY][ubX] != '.') {
+			if(cTile != '@' && cTile != '.') {
 				s_pSpawns[s_ubSpawnCount++] = (tUwCoordYX){
 					.uwX = ubX * MAP_TILE_SIZE + (MAP_TILE_SIZE / 2),
 					.uwY = ubY * MAP_TILE_SIZE + (MAP_TILE_SIZE / 2)
 				};
-				logWrite(
-					"Loaded spawn at %hhu,%hhu: %hu,%hu\n", ubX, ubY,
+				traceWrite(
+					TRACE_TILE_SPAWN, ubX, ubY,
 					s_pSpawns[s_ubSpawnCount-1].uwX, s_pSpawns[s_ubSpawnCount-1].uwY
 				);
 			}
@@ -294,77 +507,139 @@ void tilesInit(void) {
 				s_pTileCrumbleOrder[s_uwTileCount++] = (tTileCrumbleOrderEntry){
 					.sPos = {.ubX = ubX, .ubY = ubY},
 					.uwSortOrder = (
-						ABS(DISPLAY_WIDTH / 2 - ((ubX * MAP_TILE_SIZE) + HALF_TILE_SIZE)) +
-						ABS(DISPLAY_HEIGHT / 2 - ((ubY * MAP_TILE_SIZE) + HALF_TILE_SIZE))
+						ABS(uwMapCenterX - ((ubX * MAP_TILE_SIZE) + HALF_TILE_SIZE)) +
+						ABS(uwMapCenterY - ((ubY * MAP_TILE_SIZE) + HALF_TILE_SIZE))
 					)
 				};
 			}
 		}
 	}
 
-	logWrite("Loaded %hhu spawn points\n", s_ubSpawnCount);
+	traceWrite(TRACE_TILE_MAP, s_ubMapWidth, s_ubMapHeight, s_ubSpawnCount);
 
 	qsort(
 		s_pTileCrumbleOrder, s_uwTileCount, sizeof(s_pTileCrumbleOrder[0]),
 		onTileCrumbleSort
 	);
-	logWrite("Tiles: %hu\n", s_uwTileCount);
+	traceWrite(TRACE_TILE_COUNT, s_uwTileCount);
 }
 
 void tilesReload(void) {
 	s_uwCurrentTileCrumble = 0;
-	s_ubCrumbleAddCooldown = CRUMBLE_ADD_COOLDOWN;
+	s_ubCrumbleAddEvent = SCHEDULER_EVENT_INVALID;
+	s_isCrumbleStepAllowed = 0;
 
 	const tTile *pBegin = &s_pTilesSourceXy[0][0];
-	const tTile *pEnd = &s_pTilesSourceXy[TILE_WIDTH - 1][TILE_HEIGHT - 1 + 1];
+	const tTile *pEnd = &s_pTilesSourceXy[MAP_TILE_WIDTH_MAX - 1][MAP_TILE_HEIGHT_MAX - 1 + 1];
 	tTile *pDestination = &s_pTilesXy[0][0];
 	for(const tTile *pTile = pBegin; pTile != pEnd; ++pTile) {
 		*(pDestination++) = *pTile;
 	}
 
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT_MAX; ++ubY) {
+		ULONG ulRow = 0;
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH_MAX; ++ubX) {
+			if(s_pTilesXy[ubX][ubY] != TILE_VOID) {
+				ulRow |= TILE_ROW_BIT(ubX);
+			}
+		}
+		s_pSolidRows[ubY] = ulRow;
+	}
+
 	s_ubRedrawPushPos = 0;
 	s_ubRedrawPopPos = 0;
 	s_ubActiveCrumbles = 0;
-	for(UBYTE i = 0; i < CRUMBLES_MAX; ++i) {
+	for(UBYTE i = 0; i < TILE_CRUMBLES_MAX; ++i) {
 		s_pCrumbleList[i].pTile = 0;
+		s_pCrumbleList[i].ubStepEvent = SCHEDULER_EVENT_INVALID;
 	}
 	tileQueueReset();
 }
 
-void tileCrumbleProcess(tBitMap *pBuffer) {
-	if(--s_ubCrumbleAddCooldown == 0) {
-		tileCrumbleAddNext();
-		s_ubCrumbleAddCooldown = CRUMBLE_ADD_COOLDOWN;
+void tileCrumbleStart(void) {
+	if(s_ubCrumbleAddEvent == SCHEDULER_EVENT_INVALID) {
+		s_ubCrumbleAddEvent = schedulerAdd(CRUMBLE_ADD_COOLDOWN, onCrumbleAdd, 0);
 	}
+}
 
+void tileCrumbleProcess(tBitMap *pBuffer) {
 	tileQueueProcess(pBuffer);
-	if(!tileQueueHasSpace()) {
-		return;
+	// Crumble steps scheduled on this tick are fired after this
+	s_isCrumbleStepAllowed = tileQueueHasSpace();
+}
+
+void tilesStreamReset(UWORD uwCameraY) {
+	UWORD uwBufferHeight = displayGetManager()->uwBmAvailHeight;
+	if(uwBufferHeight % MAP_TILE_SIZE) {
+		logWrite("ERR: Buffer height %hu not aligned to tile size\n", uwBufferHeight);
 	}
+	s_ubBufferRowCount = uwBufferHeight / MAP_TILE_SIZE;
+	s_ubBufferTopRow = tileGetBufferTopRowForCamera(uwCameraY);
+	s_ubStreamPushPos = 0;
+	s_ubStreamPopPos = 0;
+	s_ubStreamBufferIndex = 0;
+}
 
-	tCrumble *pCrumble = &s_pCrumbleList[0];
-	for(UBYTE i = 0; i < CRUMBLES_MAX; ++i, ++pCrumble) {
-		if(!pCrumble->pTile) {
+void tilesStreamProcess(tBitMap *pBuffer, UWORD uwCameraY) {
+	UBYTE ubTopRow = tileGetBufferTopRowForCamera(uwCameraY);
+	if(ubTopRow > s_ubBufferTopRow) {
+		// Rows came in at the bottom, taking ring slots of ones gone at the top
+		UBYTE ubFirst = MAX(s_ubBufferTopRow + s_ubBufferRowCount, ubTopRow);
+		for(UBYTE ubY = ubFirst; ubY < ubTopRow + s_ubBufferRowCount; ++ubY) {
+			tileStreamPushRow(ubY);
+		}
+	}
+	else if(ubTopRow < s_ubBufferTopRow) {
+		UBYTE ubEnd = MIN(s_ubBufferTopRow, ubTopRow + s_ubBufferRowCount);
+		for(UBYTE ubY = ubTopRow; ubY < ubEnd; ++ubY) {
+			tileStreamPushRow(ubY);
+		}
+	}
+	s_ubBufferTopRow = ubTopRow;
+
+	UBYTE ubTilesLeft = TILE_STREAM_TILES_PER_FRAME;
+	for(
+		UBYTE ubPos = s_ubStreamPopPos; ubPos != s_ubStreamPushPos && ubTilesLeft;
+		ubPos = (ubPos + 1) % TILE_STREAM_QUEUE_SIZE
+	) {
+		tTileStreamEntry *pEntry = &s_pStreamQueue[ubPos];
+		UBYTE *pNextX = &pEntry->pNextX[s_ubStreamBufferIndex];
+		if(!tileIsRowOnBuffer(pEntry->ubTileY)) {
+			// Camera went back before the row got drawn
+			*pNextX = s_ubMapWidth;
 			continue;
 		}
-		if(--pCrumble->ubCooldown == 0) {
-			--*pCrumble->pTile;
-
-			if(!*pCrumble->pTile) {
-				pCrumble->pTile = 0;
-				ptplayerSfxPlay(g_pSfxCrumble, 2, 64, SFX_PRIORITY_CRUMBLE);
-			}
+		while(*pNextX < s_ubMapWidth && ubTilesLeft) {
+			tileDrawOn(pBuffer, *pNextX, pEntry->ubTileY);
+			++*pNextX;
+			--ubTilesLeft;
+		}
+	}
 
-			pCrumble->ubCooldown = CRUMBLE_COOLDOWN;
-			tileQueueAddEntry(pCrumble->ubTileX, pCrumble->ubTileY, *pCrumble->pTile);
+	while(
+		s_ubStreamPopPos != s_ubStreamPushPos &&
+		tileStreamIsEntryDone(&s_pStreamQueue[s_ubStreamPopPos])
+	) {
+		if(++s_ubStreamPopPos == TILE_STREAM_QUEUE_SIZE) {
+			s_ubStreamPopPos = 0;
 		}
 	}
+
+	if(++s_ubStreamBufferIndex == TILE_STREAM_BUFFER_COUNT) {
+		s_ubStreamBufferIndex = 0;
+	}
+}
+
+UBYTE tileIsAreaOnBuffer(UWORD uwY, UWORD uwHeight) {
+	UWORD uwBufferTop = s_ubBufferTopRow * MAP_TILE_SIZE;
+	UWORD uwBufferBottom = uwBufferTop + s_ubBufferRowCount * MAP_TILE_SIZE;
+	return uwBufferTop <= uwY && uwY + uwHeight <= uwBufferBottom;
 }
 
 void tileShuffleSpawns(void) {
 	for(UBYTE ubShuffle = 0; ubShuffle < 50; ++ubShuffle) {
-		UBYTE ubA = randUwMax(&g_sRandManager, s_ubSpawnCount - 1);
-		UBYTE ubB = randUwMax(&g_sRandManager, s_ubSpawnCount - 1);
+		UBYTE ubA = rngNextMax(RNG_STREAM_SIMULATION, s_ubSpawnCount - 1);
+		UBYTE ubB = rngNextMax(RNG_STREAM_SIMULATION, s_ubSpawnCount - 1);
 
 		if(ubA == ubB) {
 			continue;
@@ -381,25 +656,110 @@ const tUwCoordYX *tileGetSpawn(UBYTE ubIndex) {
 }
 
 void tilesDrawAllOn(tBitMap *pDestination) {
-	for(UBYTE ubX = 0; ubX < TILE_WIDTH; ++ubX) {
-		for(UBYTE ubY = 1; ubY < TILE_HEIGHT - 1; ++ubY) {
-			// Draw side part of the tile above without mask
-			blitCopyAligned(
-				g_pTileset, 0, s_pTilesXy[ubX][ubY - 1] * MAP_FULL_TILE_HEIGHT + MAP_TILE_SIZE,
-				pDestination, ubX * MAP_TILE_SIZE, ubY * MAP_TILE_SIZE, MAP_TILE_SIZE,
-				MAP_TILE_SIDE_HEIGHT
-			);
-			// Draw current tile and its side part with mask
-			blitCopyMask(
-				g_pTileset, 0, s_pTilesXy[ubX][ubY] * MAP_FULL_TILE_HEIGHT, pDestination,
-				ubX * MAP_TILE_SIZE, ubY * MAP_TILE_SIZE, MAP_TILE_SIZE,
-				MAP_FULL_TILE_HEIGHT, g_pTilesetMask->Planes[0]
-			);
-			// Drawing tile beneath isn't needed here since all tiles are drawn in top to bottom order.
+	// Only rows currently on buffer - the rest gets streamed in as camera moves
+	UBYTE ubEndY = MIN(s_ubMapHeight, s_ubBufferTopRow + s_ubBufferRowCount);
+	for(UBYTE ubY = s_ubBufferTopRow; ubY < ubEndY; ++ubY) {
+		for(UBYTE ubX = 0; ubX < s_ubMapWidth; ++ubX) {
+			tileDrawOn(pDestination, ubX, ubY);
 		}
 	}
 }
 
 UBYTE tileIsSolid(UBYTE ubTileX, UBYTE ubTileY) {
-	return s_pTilesXy[ubTileX][ubTileY] != TILE_VOID;
+	return (s_pSolidRows[ubTileY] >> ubTileX) & 1;
+}
+
+UBYTE tileIsAreaSupported(UWORD uwX, UWORD uwY, UWORD uwWidth, UWORD uwHeight) {
+	UBYTE ubFirstX = uwX / MAP_TILE_SIZE;
+	UBYTE ubLastX = (uwX + uwWidth - 1) / MAP_TILE_SIZE;
+	UBYTE ubFirstY = uwY / MAP_TILE_SIZE;
+	UBYTE ubLastY = (uwY + uwHeight - 1) / MAP_TILE_SIZE;
+	if(ubLastX >= MAP_TILE_WIDTH_MAX || ubLastY >= MAP_TILE_HEIGHT_MAX) {
+		return 0;
+	}
+
+	// Bits ubFirstX..ubLastX, overflow for ubLastX = 31 wraps to the right value
+	ULONG ulMask = (TILE_ROW_BIT(ubLastX) << 1) - TILE_ROW_BIT(ubFirstX);
+	for(UBYTE ubY = ubFirstY; ubY <= ubLastY; ++ubY) {
+		if((s_pSolidRows[ubY] & ulMask) != ulMask) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+UBYTE tileGetVoidDistanceInRow(UBYTE ubTileX, UBYTE ubTileY, BYTE bDirection) {
+	ULONG ulVoids = ~s_pSolidRows[ubTileY];
+	if(ulVoids & TILE_ROW_BIT(ubTileX)) {
+		return 0;
+	}
+
+	if(bDirection > 0) {
+		ulVoids &= ~((TILE_ROW_BIT(ubTileX) << 1) - 1);
+		if(!ulVoids) {
+			return TILE_DISTANCE_NONE;
+		}
+		return __builtin_ctz((unsigned int)ulVoids) - ubTileX;
+	}
+
+	ulVoids &= TILE_ROW_BIT(ubTileX) - 1;
+	if(!ulVoids) {
+		return TILE_DISTANCE_NONE;
+	}
+	return ubTileX - (31 - __builtin_clz((unsigned int)ulVoids));
+}
+
+UBYTE tileGetVoidDistanceInColumn(UBYTE ubTileX, UBYTE ubTileY, BYTE bDirection) {
+	ULONG ulBit = TILE_ROW_BIT(ubTileX);
+	UBYTE ubDistance = 0;
+	for(WORD wY = ubTileY; 0 <= wY && wY < MAP_TILE_HEIGHT_MAX; wY += bDirection) {
+		if(!(s_pSolidRows[wY] & ulBit)) {
+			return ubDistance;
+		}
+		++ubDistance;
+	}
+	return TILE_DISTANCE_NONE;
+}
+
+UBYTE tileCountSolidNeighbours(UBYTE ubTileX, UBYTE ubTileY) {
+	static const UBYTE pBitCount[8] = {0, 1, 1, 2, 1, 2, 2, 3};
+	UBYTE ubCount = pBitCount[tileGetSolidTriple(s_pSolidRows[ubTileY], ubTileX) & 0b101];
+	if(ubTileY > 0) {
+		ubCount += pBitCount[tileGetSolidTriple(s_pSolidRows[ubTileY - 1], ubTileX)];
+	}
+	if(ubTileY < MAP_TILE_HEIGHT_MAX - 1) {
+		ubCount += pBitCount[tileGetSolidTriple(s_pSolidRows[ubTileY + 1], ubTileX)];
+	}
+	return ubCount;
+}
+
+UBYTE tileGetMapWidth(void) {
+	return s_ubMapWidth;
+}
+
+UBYTE tileGetMapHeight(void) {
+	return s_ubMapHeight;
+}
+
+UBYTE tileGetCrumbles(tUbCoordYX *pTiles) {
+	UBYTE ubCount = 0;
+	for(UBYTE i = 0; i < TILE_CRUMBLES_MAX; ++i) {
+		if(s_pCrumbleList[i].pTile) {
+			pTiles[ubCount].ubX = s_pCrumbleList[i].ubTileX;
+			pTiles[ubCount].ubY = s_pCrumbleList[i].ubTileY;
+			++ubCount;
+		}
+	}
+	return ubCount;
+}
+
+UBYTE tileGetRedrawQueueDepth(void) {
+	if(s_ubRedrawPushPos >= s_ubRedrawPopPos) {
+		return s_ubRedrawPushPos - s_ubRedrawPopPos;
+	}
+	return s_ubRedrawPushPos + TILE_QUEUE_SIZE - s_ubRedrawPopPos;
+}
+
+UBYTE tileGetMapIndex(void) {
+	return s_ubMapIndex;
 }
@@ -11,6 +11,10 @@
 #define MAP_TILE_SIDE_HEIGHT 4
 #define MAP_FULL_TILE_HEIGHT (MAP_TILE_SIZE + MAP_TILE_SIDE_HEIGHT)
 #define HALF_TILE_SIZE (MAP_TILE_SIZE / 2)
+#define MAP_TILE_WIDTH_MAX 32
+#define MAP_TILE_HEIGHT_MAX 40 // Solidity rows are ULONG bitmasks, so max width is 32
+#define TILE_CRUMBLES_MAX 10
+#define TILE_DISTANCE_NONE 0xFF
 
 void tilesInit(void);
 
@@ -18,12 +22,65 @@ void tilesDrawAllOn(tBitMap *pDestination);
 
 UBYTE tileIsSolid(UBYTE ubTileX, UBYTE ubTileY);
 
+/**
+ * @brief Checks if all tiles under given map pixel area are solid.
+ */
+UBYTE tileIsAreaSupported(UWORD uwX, UWORD uwY, UWORD uwWidth, UWORD uwHeight);
+
+/**
+ * @brief Returns number of solid tiles from given one to the nearest void
+ * in given direction (-1 or 1), or TILE_DISTANCE_NONE if there's none.
+ */
+UBYTE tileGetVoidDistanceInRow(UBYTE ubTileX, UBYTE ubTileY, BYTE bDirection);
+
+UBYTE tileGetVoidDistanceInColumn(UBYTE ubTileX, UBYTE ubTileY, BYTE bDirection);
+
+UBYTE tileCountSolidNeighbours(UBYTE ubTileX, UBYTE ubTileY);
+
 void tileShuffleSpawns(void);
 
 const tUwCoordYX *tileGetSpawn(UBYTE ubIndex);
 
+/**
+ * @brief Starts periodic adding of crumbling tiles, driven by scheduler.
+ */
+void tileCrumbleStart(void);
+
+/**
+ * @brief Draws pending tile changes. Call before schedulerProcess() so that
+ * crumble steps know if the redraw queue is free.
+ */
 void tileCrumbleProcess(tBitMap *pBuffer);
 
 void tilesReload(void);
 
+/**
+ * @brief Sets which map rows are on the display buffer for given camera pos.
+ * Call before tilesDrawAllOn() when starting the game.
+ */
+void tilesStreamReset(UWORD uwCameraY);
+
+/**
+ * @brief Queues rows exposed by camera movement and draws a fixed amount
+ * of their tiles on the buffer. Call once per frame on the back buffer.
+ */
+void tilesStreamProcess(tBitMap *pBuffer, UWORD uwCameraY);
+
+UBYTE tileIsAreaOnBuffer(UWORD uwY, UWORD uwHeight);
+
+UBYTE tileGetMapWidth(void);
+
+UBYTE tileGetMapHeight(void);
+
+UBYTE tileGetMapIndex(void);
+
+/**
+ * @brief Fills pTiles with positions of tiles crumbling right now.
+ *
+ * @return Number of positions written, at most TILE_CRUMBLES_MAX.
+ */
+UBYTE tileGetCrumbles(tUbCoordYX *pTiles);
+
+UBYTE tileGetRedrawQueueDepth(void);
+
 #endif // INCLUDE_TILE_H
@@ -0,0 +1,92 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "trace.h"
+#include <ace/managers/log.h>
+
+#define TRACE_RECORD_COUNT 64 // Must be power of 2
+
+typedef struct tTraceRecord {
+	UWORD uwId;
+	UWORD uwFrame;
+	ULONG pArgs[TRACE_ARG_COUNT];
+} tTraceRecord;
+
+/**
+ * @brief Ring buffer, laid out so that it can be found in memory dumps.
+ * Layout must match tools/trace_decode.c.
+ */
+typedef struct tTraceRing {
+	ULONG ulMagic;
+	UWORD uwRecordCount;
+	UWORD uwRecordSize;
+	ULONG ulWritten; ///< Total records written, ring index is its lower bits.
+	tTraceRecord pRecords[TRACE_RECORD_COUNT];
+} tTraceRing;
+
+typedef struct tTraceFormat {
+	UBYTE ubLevel;
+	const char *szFormat;
+} tTraceFormat;
+
+#define TRACE_FORMAT_ENTRY(eId, eLevel, szFormat) {TRACE_LEVEL_##eLevel, szFormat},
+static const tTraceFormat s_pFormats[TRACE_ID_COUNT] = {
+	TRACE_FORMATS(TRACE_FORMAT_ENTRY)
+};
+#undef TRACE_FORMAT_ENTRY
+
+static const char * const s_pLevelPrefixes[] = {"", "ERR: ", "WARN: ", "", "DBG: "};
+
+static tTraceRing s_sRing = {
+	.ulMagic = TRACE_MAGIC,
+	.uwRecordCount = TRACE_RECORD_COUNT,
+	.uwRecordSize = sizeof(tTraceRecord),
+	.ulWritten = 0
+};
+static ULONG s_ulDrained;
+static UWORD s_uwFrame;
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void traceAdd(tTraceId eId, ULONG ulArg0, ULONG ulArg1, ULONG ulArg2, ULONG ulArg3) {
+	tTraceRecord *pRecord = &s_sRing.pRecords[
+		s_sRing.ulWritten & (TRACE_RECORD_COUNT - 1)
+	];
+	pRecord->uwId = eId;
+	pRecord->uwFrame = s_uwFrame;
+	pRecord->pArgs[0] = ulArg0;
+	pRecord->pArgs[1] = ulArg1;
+	pRecord->pArgs[2] = ulArg2;
+	pRecord->pArgs[3] = ulArg3;
+	++s_sRing.ulWritten;
+}
+
+void traceNextFrame(void) {
+	++s_uwFrame;
+}
+
+void traceDrain(void) {
+	ULONG ulWritten = s_sRing.ulWritten;
+	if(ulWritten - s_ulDrained > TRACE_RECORD_COUNT) {
+		logWrite(
+			"ERR: %lu trace records overwritten before drain\n",
+			ulWritten - s_ulDrained - TRACE_RECORD_COUNT
+		);
+		s_ulDrained = ulWritten - TRACE_RECORD_COUNT;
+	}
+
+	while(s_ulDrained != ulWritten) {
+		const tTraceRecord *pRecord = &s_sRing.pRecords[
+			s_ulDrained & (TRACE_RECORD_COUNT - 1)
+		];
+		const tTraceFormat *pFormat = &s_pFormats[pRecord->uwId];
+		logWrite("[%hu] %s", pRecord->uwFrame, s_pLevelPrefixes[pFormat->ubLevel]);
+		logWrite(
+			pFormat->szFormat, pRecord->pArgs[0], pRecord->pArgs[1],
+			pRecord->pArgs[2], pRecord->pArgs[3]
+		);
+		logWrite("\n");
+		++s_ulDrained;
+	}
+}
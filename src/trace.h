@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_TRACE_H
+#define INCLUDE_TRACE_H
+
+#include <ace/types.h>
+#include "trace_formats.h"
+
+/**
+ * @brief Cheap diagnostics for code running inside frame loop.
+ *
+ * traceWrite() stores format id and raw args as fixed-size record in a ring
+ * buffer, without any text formatting. Records are turned into text by
+ * traceDrain(), which goes to ACE log and should be called outside of frame
+ * loop, or by tools/trace_decode.c from memory dump of running game.
+ *
+ * Records with level above GAME_TRACE_LEVEL are compiled out, together with
+ * evaluation of their args.
+ */
+
+#if !defined(GAME_TRACE_LEVEL)
+#define GAME_TRACE_LEVEL TRACE_LEVEL_INFO
+#endif
+
+#define TRACE_FORMAT_LEVEL(eId, eLevel, szFormat) eId##_LEVEL = TRACE_LEVEL_##eLevel,
+enum {
+	TRACE_FORMATS(TRACE_FORMAT_LEVEL)
+};
+#undef TRACE_FORMAT_LEVEL
+
+/**
+ * @brief Adds trace record, e.g. traceWrite(TRACE_TILE_COUNT, uwTileCount).
+ * Args are cast to ULONG, missing ones are zeroed.
+ */
+#define traceWrite(...) traceWriteArgs(__VA_ARGS__, 0, 0, 0, 0, 0)
+
+#define traceWriteArgs(eId, a, b, c, d, ...) do { \
+	if(eId##_LEVEL <= GAME_TRACE_LEVEL) { \
+		traceAdd(eId, (ULONG)(a), (ULONG)(b), (ULONG)(c), (ULONG)(d)); \
+	} \
+} while(0)
+
+void traceAdd(tTraceId eId, ULONG ulArg0, ULONG ulArg1, ULONG ulArg2, ULONG ulArg3);
+
+/**
+ * @brief Advances frame number stored in following records.
+ */
+void traceNextFrame(void);
+
+/**
+ * @brief Writes records added since last call to ACE log.
+ * Formats text, so don't call it inside frame loop.
+ */
+void traceDrain(void);
+
+#endif // INCLUDE_TRACE_H
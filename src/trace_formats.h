@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_TRACE_FORMATS_H
+#define INCLUDE_TRACE_FORMATS_H
+
+/**
+ * @brief Trace record formats: id, level and printf-style text.
+ *
+ * All args are stored as ULONGs, so use %lu/%lx. Up to TRACE_ARG_COUNT args.
+ * Shared with tools/trace_decode.c, so keep it free of ACE includes.
+ * Append new entries at the end, so that older dumps still decode properly.
+ */
+#define TRACE_FORMATS(X) \
+	X(TRACE_WARRIOR_OUT_OF_BOUNDS, ERROR, "warrior %lx bob out of bounds") \
+	X(TRACE_WARRIOR_LOOKUP_ERASE, ERROR, "Erasing other warrior %lx") \
+	X(TRACE_WARRIOR_LOOKUP_OVERWRITE, ERROR, "Overwriting other warrior %lx in lookup with %lx") \
+	X(TRACE_WARRIOR_LOOKUP_FALL, ERROR, "Clearing warrior %lx when falling %lx") \
+	X(TRACE_WARRIOR_SPAWN, INFO, "Spawned warrior %lx at %lu,%lu") \
+	X(TRACE_TILE_QUEUE_OVERFLOW, ERROR, "Ring buffer overflow") \
+	X(TRACE_TILE_STREAM_OVERFLOW, ERROR, "Stream queue overflow") \
+	X(TRACE_TILE_SPAWN, DEBUG, "Loaded spawn at %lu,%lu: %lu,%lu") \
+	X(TRACE_TILE_MAP, INFO, "Loaded %lux%lu map, %lu spawn points") \
+	X(TRACE_TILE_COUNT, INFO, "Tiles: %lu") \
+	X(TRACE_MEM_LOOP_ALLOC, ERROR, "State %lu allocated in frame loop: chip %lu, fast %lu") \
+	X(TRACE_MEM_LOOP_TAGGED_ALLOC, ERROR, "State %lu made %lu allocs in frame loop, last tag %lu") \
+	X(TRACE_MEM_STATE_PEAK, INFO, "State %lu peak use: chip %lu, fast %lu") \
+	X(TRACE_MEM_TAG_USAGE, INFO, "Tag %lu peak use: chip %lu, fast %lu, chip held %lu") \
+	X(TRACE_MEM_TAG_TAGGED, INFO, "Tag %lu tagged peak: chip %lu, fast %lu, leaked %lu") \
+	X(TRACE_MEM_CHIP_BUDGET, ERROR, "Chip peak use %lu over budget of %lu") \
+	X(TRACE_LATENCY_SAMPLE, DEBUG, "Port %lu input to photon: %lu frames, %lu lines") \
+	X(TRACE_LATENCY_FRAMES, INFO, "Input latency frames: min %lu, avg %lu.%02lu, max %lu") \
+	X(TRACE_LATENCY_LINES, INFO, "Input latency lines: min %lu, avg %lu, max %lu, %lu samples") \
+	X(TRACE_EVENT_QUEUE_OVERFLOW, ERROR, "Event queue overflow, dropped type %lu") \
+	X(TRACE_EVENT, DEBUG, "Event %lu, warrior %lu at %lu,%lu") \
+	X(TRACE_SFX_DROPPED, DEBUG, "No voice for sfx %lx, priority %lu") \
+	X(TRACE_TELEMETRY_WRITTEN, INFO, "Telemetry: %lu records, %lu frames, flags %lu") \
+	X(TRACE_TELEMETRY_WRITE_FAILED, ERROR, "Telemetry: can't open file, %lu records lost") \
+	X(TRACE_TELEMETRY_ALLOC_FAILED, ERROR, "Telemetry: no memory for buffer, match not recorded")
+
+#define TRACE_LEVEL_NONE 0
+#define TRACE_LEVEL_ERROR 1
+#define TRACE_LEVEL_WARN 2
+#define TRACE_LEVEL_INFO 3
+#define TRACE_LEVEL_DEBUG 4
+
+#define TRACE_MAGIC 0x43415452 // "CATR"
+#define TRACE_ARG_COUNT 4
+
+#define TRACE_FORMAT_ID(eId, eLevel, szFormat) eId,
+typedef enum tTraceId {
+	TRACE_FORMATS(TRACE_FORMAT_ID)
+	TRACE_ID_COUNT
+} tTraceId;
+#undef TRACE_FORMAT_ID
+
+#endif // INCLUDE_TRACE_FORMATS_H
@@ -3,14 +3,24 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "warrior.h"
+#include <ace/managers/blit.h>
 #include <ace/managers/key.h>
+#include <ace/managers/memory.h>
 #include <ace/managers/sprite.h>
 #include "chaos_arena.h"
 #include "assets.h"
 #include "display.h"
 #include "tile.h"
 #include "menu.h"
-#include "sfx.h"
+#include "rng.h"
+#include "sprite_mux.h"
+#include "frame_cache.h"
+#include "trace.h"
+#include "event.h"
+#include "latency.h"
+#include "mem_track.h"
+#include "warrior_anim.h" // generated from res/warrior.anim
+#include "warrior_frames.h" // generated by frameDedup
 
 //---------------------------------------------------------------------- DEFINES
 
@@ -19,33 +29,32 @@
 #define WARRIOR_FRAME_WIDTH 16
 #define WARRIOR_FRAME_HEIGHT 16
 #define BYTES_PER_FRAME ((WARRIOR_FRAME_WIDTH / 8) * WARRIOR_FRAME_HEIGHT * DISPLAY_BPP)
-#define MAX_ANIM_FRAMES 4
-#define FRAME_COOLDOWN 5
 #define DIR_ID(dX, dY) ((dX + 1) | ((dY + 1) << 2))
 #define BOB_OFFSET_X (WARRIOR_FRAME_WIDTH / 2)
 #define BOB_OFFSET_Y (WARRIOR_FRAME_HEIGHT)
+#if defined(GAME_WARRIOR_SHIFT_PHASES)
+// Shifted frames may take two words
+#define BOB_WIDTH (2 * WARRIOR_FRAME_WIDTH)
+#else
+#define BOB_WIDTH WARRIOR_FRAME_WIDTH
+#endif
 #define WARRIOR_PUSH_DELTA 2
 #define THUNDER_ACTIVATE_COOLDOWN 100
 #define THUNDER_COLOR_COOLDOWN 3
 
 // Must be power of 2!
-#define LOOKUP_TILE_SIZE 8
+#define LOOKUP_TILE_SIZE WARRIOR_LOOKUP_CELL_SIZE
 
-#define LOOKUP_TILE_WIDTH (DISPLAY_WIDTH / LOOKUP_TILE_SIZE)
-#define LOOKUP_TILE_HEIGHT (DISPLAY_HEIGHT / LOOKUP_TILE_SIZE)
+#define LOOKUP_TILE_WIDTH (MAP_TILE_WIDTH_MAX * MAP_TILE_SIZE / LOOKUP_TILE_SIZE)
+#define LOOKUP_TILE_HEIGHT (MAP_TILE_HEIGHT_MAX * MAP_TILE_SIZE / LOOKUP_TILE_SIZE)
 
 //------------------------------------------------------------------------ TYPES
 
-typedef struct tFrameOffsets {
-	UBYTE *pBitmap;
-	UBYTE *pMask;
-} tFrameOffsets;
-
 typedef struct tThunder {
-	tUwCoordYX sAttackPos; ///< In viewport coords
-	UBYTE ubActivateCooldown;
+	tUwCoordYX sAttackPos; ///< In map coords
+	tSchedulerEvent ubActivateEvent;
 	UBYTE ubCurrentColor;
-	UBYTE ubColorCooldown;
+	tSchedulerEvent ubColorEvent;
 	UBYTE ubNextFrame;
 	tSprite *pSpriteThunder;
 	tSprite *pSpriteCross;
@@ -54,8 +63,8 @@ typedef struct tThunder {
 //----------------------------------------------------------------- PRIVATE VARS
 
 static tWarrior *s_pWarriors[WARRIOR_COUNT];
+static tSteerSet s_sSteers;
 static tWarrior *s_pWarriorLookup[LOOKUP_TILE_WIDTH][LOOKUP_TILE_HEIGHT];
-static tFrameOffsets s_pFrameOffsets[ANIM_DIRECTION_COUNT][ANIM_COUNT][MAX_ANIM_FRAMES];
 static tThunder s_sThunder;
 
 static const tAnimDirection s_pDirIdToAnimDir[] = {
@@ -81,17 +90,11 @@ static const tBCoordYX s_pAnimDirToAttackDelta[ANIM_DIRECTION_COUNT] = {
 	[ANIM_DIRECTION_SW] = {.bX = -LOOKUP_TILE_SIZE, .bY = LOOKUP_TILE_SIZE},
 };
 
-static const UBYTE s_pFrameCountForAnim[ANIM_COUNT] = {
-	[ANIM_IDLE] = 2,
-	[ANIM_WALK] = 3,
-	[ANIM_ATTACK] = 4,
-	[ANIM_HURT] = 3,
-	[ANIM_FALLING] = 1,
-};
-
 static UBYTE s_ubAliveCount;
 static UBYTE s_ubAlivePlayerCount;
 static UBYTE s_isMoveEnabled;
+static UWORD s_uwMapWidth; ///< In pixels
+static UWORD s_uwMapHeight; ///< In pixels
 
 //------------------------------------------------------------------ PUBLIC VARS
 
@@ -108,37 +111,16 @@ const tBCoordYX g_pAnimDirToPushDelta[ANIM_DIRECTION_COUNT] = {
 
 //------------------------------------------------------------------ PRIVATE FNS
 
-static inline UBYTE getFrameCountForAnim(tAnim eAnim) {
-	return s_pFrameCountForAnim[eAnim];
+static inline const tAnimFrameDef *warriorGetAnimFrame(const tWarrior *pWarrior) {
+	return &s_pAnimFrames[s_pAnimDefs[pWarrior->eAnim].ubFirstFrame + pWarrior->ubAnimFrame];
 }
 
-static void initFrameOffsets(void) {
-	ULONG ulByteOffs = 0;
-	for(tAnimDirection eDir = 0; eDir < ANIM_DIRECTION_COUNT; ++eDir) {
-		for(tAnim eAnim = 0; eAnim < ANIM_COUNT; ++eAnim) {
-			if(eAnim == ANIM_FALLING) {
-				continue;
-			}
-
-			UBYTE ubFramesInAnim = getFrameCountForAnim(eAnim);
-			for(UBYTE ubFrame = 0; ubFrame < ubFramesInAnim; ++ubFrame) {
-				if(eAnim == ANIM_WALK && ubFrame == 2) {
-					continue;
-				}
-				s_pFrameOffsets[eDir][eAnim][ubFrame] = (tFrameOffsets) {
-					.pBitmap = &g_pWarriorFrames->Planes[0][ulByteOffs],
-					.pMask = &g_pWarriorMasks->Planes[0][ulByteOffs]
-				};
-				ulByteOffs += BYTES_PER_FRAME;
-			}
-		}
-	}
-
-	for(tAnimDirection eDir = 0; eDir < ANIM_DIRECTION_COUNT; ++eDir) {
-		s_pFrameOffsets[eDir][ANIM_FALLING][0] = s_pFrameOffsets[eDir][ANIM_HURT][2];
-		s_pFrameOffsets[eDir][ANIM_WALK][2] = s_pFrameOffsets[eDir][ANIM_WALK][1];
-		s_pFrameOffsets[eDir][ANIM_WALK][1] = s_pFrameOffsets[eDir][ANIM_IDLE][1];
-	}
+static inline UWORD warriorGetFrameIndex(const tWarrior *pWarrior) {
+	// Sheet frame index to loaded one, with duplicates and mirrors resolved
+	return s_pWarriorFrameIndex[
+		pWarrior->eDirection * ANIM_SHEET_FRAMES_PER_DIRECTION +
+		warriorGetAnimFrame(pWarrior)->ubSheetFrame
+	];
 }
 
 static void resetWarriorLookup(void) {
@@ -178,11 +160,27 @@ static void warriorUpdateBobPosition(tWarrior *pWarrior) {
 	pWarrior->sBob.sPos.uwX = pWarrior->sPos.uwX - BOB_OFFSET_X;
 	pWarrior->sBob.sPos.uwY = pWarrior->sPos.uwY - BOB_OFFSET_Y;
 
-	if (pWarrior->sBob.sPos.uwX > DISPLAY_WIDTH || pWarrior->sBob.sPos.uwY > DISPLAY_HEIGHT) {
-		logWrite("ERR: warrior %p bob out of bounds", pWarrior);
+	if (pWarrior->sBob.sPos.uwX > s_uwMapWidth || pWarrior->sBob.sPos.uwY > s_uwMapHeight) {
+		traceWrite(TRACE_WARRIOR_OUT_OF_BOUNDS, pWarrior);
 	}
 }
 
+#if defined(GAME_WARRIOR_SHIFT_PHASES)
+static void warriorApplyShiftedFrame(tWarrior *pWarrior) {
+	UWORD uwFrameIndex = warriorGetFrameIndex(pWarrior);
+	UWORD uwX = pWarrior->sPos.uwX - BOB_OFFSET_X;
+	const tShiftedFrame *pFrame = frameCacheGet(uwFrameIndex, uwX);
+
+	// Shift is already in frame data, so blit at word-aligned position
+	pWarrior->sBob.sPos.uwX = (uwX & ~15) + pFrame->ubWordOffset * 16;
+	if(pWarrior->sBob.uwWidth != pFrame->ubWidth) {
+		// Recalculates blit size and modulos, which bobInit() did for BOB_WIDTH
+		bobSetWidth(&pWarrior->sBob, pFrame->ubWidth);
+	}
+	bobSetFrame(&pWarrior->sBob, pFrame->pBitmap, pFrame->pMask);
+}
+#endif
+
 static void warriorTryMoveBy(tWarrior *pWarrior, BYTE bDeltaX, BYTE bDeltaY) {
 	if(!s_isMoveEnabled) {
 		return;
@@ -196,7 +194,7 @@ static void warriorTryMoveBy(tWarrior *pWarrior, BYTE bDeltaX, BYTE bDeltaY) {
 		tUwCoordYX sOldPos = {.ulYX = pWarrior->sPos.ulYX};
 		pWarrior->sPos.uwX += bDeltaX;
 		UBYTE isColliding = (bDeltaX > 0 ?
-			pWarrior->sPos.uwX >= DISPLAY_WIDTH - BOB_OFFSET_X :
+			pWarrior->sPos.uwX >= s_uwMapWidth - BOB_OFFSET_X :
 			pWarrior->sPos.uwX <= BOB_OFFSET_X
 		);
 
@@ -228,7 +226,7 @@ static void warriorTryMoveBy(tWarrior *pWarrior, BYTE bDeltaX, BYTE bDeltaY) {
 		tUwCoordYX sOldPos = {.ulYX = pWarrior->sPos.ulYX};
 		pWarrior->sPos.uwY += bDeltaY;
 		UBYTE isColliding = (bDeltaY > 0 ?
-			pWarrior->sPos.uwY >= DISPLAY_HEIGHT - BOB_OFFSET_Y :
+			pWarrior->sPos.uwY >= s_uwMapHeight - BOB_OFFSET_Y :
 			pWarrior->sPos.uwY <= BOB_OFFSET_Y
 		);
 
@@ -264,9 +262,8 @@ static void warriorTryMoveBy(tWarrior *pWarrior, BYTE bDeltaX, BYTE bDeltaY) {
 			s_pWarriorLookup[ubOldLookupX][ubOldLookupY] &&
 			s_pWarriorLookup[ubOldLookupX][ubOldLookupY] != pWarrior
 		) {
-			logWrite(
-				"ERR: Erasing other warrior %p\n",
-				s_pWarriorLookup[ubOldLookupX][ubOldLookupY]
+			traceWrite(
+				TRACE_WARRIOR_LOOKUP_ERASE, s_pWarriorLookup[ubOldLookupX][ubOldLookupY]
 			);
 		}
 		s_pWarriorLookup[ubOldLookupX][ubOldLookupY] = 0;
@@ -274,8 +271,8 @@ static void warriorTryMoveBy(tWarrior *pWarrior, BYTE bDeltaX, BYTE bDeltaY) {
 		UBYTE ubNewLookupX = pWarrior->sPos.uwX / LOOKUP_TILE_SIZE;
 		UBYTE ubNewLookupY = pWarrior->sPos.uwY / LOOKUP_TILE_SIZE;
 		if(s_pWarriorLookup[ubNewLookupX][ubNewLookupY]) {
-			logWrite(
-				"ERR: Overwriting other warrior %p in lookup with %p\n",
+			traceWrite(
+				TRACE_WARRIOR_LOOKUP_OVERWRITE,
 				s_pWarriorLookup[ubNewLookupX][ubNewLookupY], pWarrior
 			);
 		}
@@ -283,36 +280,75 @@ static void warriorTryMoveBy(tWarrior *pWarrior, BYTE bDeltaX, BYTE bDeltaY) {
 	}
 }
 
+static void warriorPushEvent(
+	const tWarrior *pWarrior, tEventType eType, UBYTE ubTarget
+) {
+	UBYTE ubFlags = steerIsPlayer(pWarrior->pSteer) ? EVENT_FLAG_PLAYER : 0;
+	eventPush(eType, pWarrior->ubIndex, ubTarget, ubFlags, pWarrior->sPos);
+}
+
+static void onWarriorFrame(void *pData) {
+	tWarrior *pWarrior = pData;
+	pWarrior->ubFrameEvent = SCHEDULER_EVENT_INVALID;
+	if(pWarrior->isDead) {
+		return;
+	}
+
+	if (++pWarrior->ubAnimFrame >= s_pAnimDefs[pWarrior->eAnim].ubFrameCount) {
+		pWarrior->ubAnimFrame = 0;
+	}
+	ULONG ulOffset = warriorGetFrameIndex(pWarrior) * BYTES_PER_FRAME;
+	bobSetFrame(
+		&pWarrior->sBob, &g_pWarriorFrames->Planes[0][ulOffset],
+		&g_pWarriorMasks->Planes[0][ulOffset]
+	);
+	pWarrior->ubFrameEvent = schedulerAdd(
+		warriorGetAnimFrame(pWarrior)->ubDuration, onWarriorFrame, pWarrior
+	);
+}
+
 static void warriorAdd(
 	tWarrior *pWarrior, UWORD uwSpawnX, UWORD uwSpawnY, tSteerMode eSteerMode,
 	UBYTE ubIndex
 ) {
 	pWarrior->sPos = (tUwCoordYX){.uwX = uwSpawnX, .uwY = uwSpawnY};
 	bobInit(
-		&pWarrior->sBob, WARRIOR_FRAME_WIDTH, WARRIOR_FRAME_HEIGHT, 1,
+		&pWarrior->sBob, BOB_WIDTH, WARRIOR_FRAME_HEIGHT, 1,
 		g_pWarriorFrames->Planes[0], g_pWarriorMasks->Planes[0],
 		pWarrior->sPos.uwX - BOB_OFFSET_X, pWarrior->sPos.uwY - BOB_OFFSET_Y
 	);
 	pWarrior->ubAnimFrame = 0;
-	pWarrior->ubFrameCooldown = FRAME_COOLDOWN;
 	pWarrior->ubStunCooldown = 0;
 	pWarrior->isDead = 0;
 	pWarrior->eAnim = ANIM_IDLE;
+	pWarrior->ubFrameEvent = schedulerAdd(
+		warriorGetAnimFrame(pWarrior)->ubDuration, onWarriorFrame, pWarrior
+	);
 	pWarrior->eDirection = ANIM_DIRECTION_S;
-	pWarrior->sSteer = steerInitFromMode(eSteerMode, pWarrior);
+	pWarrior->pSteer = steerSetAdd(&s_sSteers, eSteerMode, pWarrior);
 	pWarrior->ubIndex = ubIndex;
 	s_pWarriorLookup[uwSpawnX / LOOKUP_TILE_SIZE][uwSpawnY / LOOKUP_TILE_SIZE] = pWarrior;
 	++s_ubAliveCount;
-	if(steerIsPlayer(&pWarrior->sSteer)) {
+	if(steerIsPlayer(pWarrior->pSteer)) {
 		++s_ubAlivePlayerCount;
 	}
-	logWrite("Spawned warrior %p at %hu,%hu", pWarrior, uwSpawnX, uwSpawnY);
+	traceWrite(TRACE_WARRIOR_SPAWN, pWarrior, uwSpawnX, uwSpawnY);
+	warriorPushEvent(pWarrior, EVENT_SPAWN, EVENT_WARRIOR_NONE);
 }
 
 static void warriorSetAnim(tWarrior *pWarrior, tAnim eAnim) {
+#if defined(GAME_LATENCY_PROBE)
+	// Guarded, so that release builds don't pay for steerIsPlayer() call
+	if((eAnim == ANIM_ATTACK || eAnim == ANIM_WALK) && steerIsPlayer(pWarrior->pSteer)) {
+		latencyTag(pWarrior->pSteer->ePort, pWarrior->sPos.uwY - BOB_OFFSET_Y);
+	}
+#endif
 	pWarrior->eAnim = eAnim;
 	pWarrior->ubAnimFrame = 0;
-	pWarrior->ubFrameCooldown = FRAME_COOLDOWN;
+	schedulerCancel(pWarrior->ubFrameEvent);
+	pWarrior->ubFrameEvent = schedulerAdd(
+		warriorGetAnimFrame(pWarrior)->ubDuration, onWarriorFrame, pWarrior
+	);
 }
 
 static void warriorSetAnimOnce(tWarrior *pWarrior, tAnim eAnim) {
@@ -321,14 +357,16 @@ static void warriorSetAnimOnce(tWarrior *pWarrior, tAnim eAnim) {
 	}
 }
 
-static UBYTE warriorStrike(const tWarrior *pWarrior) {
+static void warriorStrike(const tWarrior *pWarrior) {
 	tWarrior *pTarget = warriorGetStrikeTarget(pWarrior, pWarrior->eDirection);
 	if(pTarget) {
 		warriorSetAnim(pTarget, ANIM_HURT);
 		pTarget->sPushDelta = g_pAnimDirToPushDelta[pWarrior->eDirection];
-		return 1;
+		warriorPushEvent(pWarrior, EVENT_HIT, pTarget->ubIndex);
+	}
+	else {
+		warriorPushEvent(pWarrior, EVENT_SWING, EVENT_WARRIOR_NONE);
 	}
-	return 0;
 }
 
 static UBYTE warriorIsInAir(const tWarrior *pWarrior) {
@@ -347,19 +385,83 @@ static UBYTE warriorIsInAir(const tWarrior *pWarrior) {
 	return 1;
 }
 
+static void onThunderColor(void *pData) {
+	s_sThunder.ubColorEvent = SCHEDULER_EVENT_INVALID;
+	if(++s_sThunder.ubCurrentColor < 8) {
+		displaySetThunderColor(s_sThunder.ubCurrentColor);
+		s_sThunder.ubColorEvent = schedulerAdd(THUNDER_COLOR_COOLDOWN, onThunderColor, 0);
+	}
+	else {
+		spriteSetEnabled(s_sThunder.pSpriteThunder, 0);
+	}
+}
+
+static void onThunderActivate(void *pData) {
+	s_sThunder.ubActivateEvent = schedulerAdd(
+		THUNDER_ACTIVATE_COOLDOWN, onThunderActivate, 0
+	);
+	warriorAttackWithLightning(s_sThunder.sAttackPos);
+	eventPush(
+		EVENT_THUNDER_STRIKE, EVENT_WARRIOR_NONE, EVENT_WARRIOR_NONE, 0,
+		s_sThunder.sAttackPos
+	);
+}
+
+static void thunderShowStrike(tUwCoordYX sAttackPos) {
+	const tUwCoordYX *pCameraPos = &displayGetManager()->pCamera->uPos;
+	spriteSetEnabled(s_sThunder.pSpriteThunder, 1);
+	spriteSetBitmap(s_sThunder.pSpriteThunder, g_pFramesThunder[s_sThunder.ubNextFrame]);
+	s_sThunder.ubNextFrame = !s_sThunder.ubNextFrame;
+	s_sThunder.pSpriteThunder->wX = sAttackPos.uwX - pCameraPos->uwX - 8;
+	s_sThunder.pSpriteThunder->wY = 0;
+	spriteSetHeight(
+		s_sThunder.pSpriteThunder,
+		CLAMP(sAttackPos.uwY - pCameraPos->uwY, 1, SCREEN_PAL_HEIGHT)
+	);
+	s_sThunder.ubCurrentColor = 0;
+	displaySetThunderColor(0);
+	schedulerCancel(s_sThunder.ubColorEvent);
+	s_sThunder.ubColorEvent = schedulerAdd(THUNDER_COLOR_COOLDOWN, onThunderColor, 0);
+}
+
+static void thunderProcessEvents(void) {
+	// Sprite side of simulation's events
+	UBYTE ubEventCount = eventsGetCount();
+	for(UBYTE i = 0; i < ubEventCount; ++i) {
+		const tEvent *pEvent = eventsGet(i);
+		if(
+			pEvent->ubType == EVENT_DEATH && (pEvent->ubFlags & EVENT_FLAG_PLAYER) &&
+			menuAreThundersEnabled()
+		) {
+			spriteSetEnabled(s_sThunder.pSpriteCross, 1);
+		}
+		else if(pEvent->ubType == EVENT_THUNDER_STRIKE) {
+			thunderShowStrike(pEvent->sPos);
+		}
+	}
+}
+
 static void warriorKill(tWarrior *pWarrior) {
 	pWarrior->isDead = 1;
+	schedulerCancel(pWarrior->ubFrameEvent);
+	pWarrior->ubFrameEvent = SCHEDULER_EVENT_INVALID;
 	--s_ubAliveCount;
-	if (steerIsPlayer(&pWarrior->sSteer)) {
+	warriorPushEvent(pWarrior, EVENT_DEATH, EVENT_WARRIOR_NONE);
+	if (steerIsPlayer(pWarrior->pSteer)) {
 		--s_ubAlivePlayerCount;
 		if(menuAreThundersEnabled()) {
-			spriteSetEnabled(s_sThunder.pSpriteCross, 1);
+			if(s_sThunder.ubActivateEvent == SCHEDULER_EVENT_INVALID) {
+				s_sThunder.ubActivateEvent = schedulerAdd(
+					THUNDER_ACTIVATE_COOLDOWN, onThunderActivate, 0
+				);
+			}
 		}
 	}
 }
 
 static void warriorProcessState(tWarrior *pWarrior) {
-	if(pWarrior->eAnim == ANIM_FALLING) {
+	UBYTE ubFlags = warriorGetAnimFrame(pWarrior)->ubFlags;
+	if(ubFlags & ANIM_FLAG_FALL) {
 		pWarrior->sPos.uwY += 4;
 		warriorUpdateBobPosition(pWarrior);
 		WORD wBobTop = pWarrior->sBob.sPos.uwY;
@@ -374,44 +476,32 @@ static void warriorProcessState(tWarrior *pWarrior) {
 				pWarrior->sBob.uwHeight = wNewSize;
 			}
 		}
-		if(pWarrior->sPos.uwY >= DISPLAY_HEIGHT - 16) {
+		if(pWarrior->sPos.uwY >= s_uwMapHeight - 16) {
 			warriorKill(pWarrior);
 		}
 		return;
 	}
 
-	if(pWarrior->eAnim == ANIM_HURT && pWarrior->ubAnimFrame != getFrameCountForAnim(ANIM_HURT) - 1) {
-		// Pushback
-		warriorTryMoveBy(pWarrior, pWarrior->sPushDelta.bX, pWarrior->sPushDelta.bY);
-		return;
-	}
-
-	if(pWarrior->eAnim == ANIM_ATTACK && pWarrior->ubAnimFrame != getFrameCountForAnim(ANIM_ATTACK) - 1) {
+	if(ubFlags & ANIM_FLAG_PUSH) {
+		// Pushback when hurt, lunge when attacking
 		warriorTryMoveBy(pWarrior, pWarrior->sPushDelta.bX, pWarrior->sPushDelta.bY);
-		if(pWarrior->ubAnimFrame == getFrameCountForAnim(ANIM_ATTACK) - 2) {
+		if(ubFlags & ANIM_FLAG_STRIKE) {
 			// Do the actual hit
-			UBYTE isHit = warriorStrike(pWarrior);
-			if(isHit) {
-				ptplayerSfxPlay(g_pSfxSwipeHit, 3, 64, SFX_PRIORITY_HIT);
-			}
-			else {
-				ptplayerSfxPlay(g_pSfxSwipes[randUw(&g_sRandManager) & 1], 3, 64, SFX_PRIORITY_SWIPE);
-			}
+			warriorStrike(pWarrior);
 		}
 		return;
 	}
 
 	if(warriorIsInAir(pWarrior)) {
 		warriorSetAnim(pWarrior, ANIM_FALLING);
-		ptplayerSfxPlay(g_pSfxNo, 2, 64, SFX_PRIORITY_FALL);
+		warriorPushEvent(pWarrior, EVENT_FALL, EVENT_WARRIOR_NONE);
 
 		// stop collision of warrior
 		UBYTE ubTileX = pWarrior->sPos.uwX / LOOKUP_TILE_SIZE;
 		UBYTE ubTileY = pWarrior->sPos.uwY / LOOKUP_TILE_SIZE;
 		if(s_pWarriorLookup[ubTileX][ubTileY] != pWarrior) {
-			logWrite(
-				"ERR: Clearing warrior %p when falling %p",
-				s_pWarriorLookup[ubTileX][ubTileY], pWarrior
+			traceWrite(
+				TRACE_WARRIOR_LOOKUP_FALL, s_pWarriorLookup[ubTileX][ubTileY], pWarrior
 			);
 		}
 
@@ -419,7 +509,7 @@ static void warriorProcessState(tWarrior *pWarrior) {
 		return;
 	}
 
-	if(steerDirCheck(&pWarrior->sSteer, DIRECTION_FIRE)) {
+	if(steerDirCheck(pWarrior->pSteer, DIRECTION_FIRE)) {
 		// Start swinging
 		warriorSetAnim(pWarrior, ANIM_ATTACK);
 		pWarrior->sPushDelta = g_pAnimDirToPushDelta[pWarrior->eDirection];
@@ -427,16 +517,16 @@ static void warriorProcessState(tWarrior *pWarrior) {
 	}
 
 	BYTE bDeltaX = 0, bDeltaY = 0;
-	if (steerDirCheck(&pWarrior->sSteer, DIRECTION_UP)) {
+	if (steerDirCheck(pWarrior->pSteer, DIRECTION_UP)) {
 		--bDeltaY;
 	}
-	if (steerDirCheck(&pWarrior->sSteer, DIRECTION_DOWN)) {
+	if (steerDirCheck(pWarrior->pSteer, DIRECTION_DOWN)) {
 		++bDeltaY;
 	}
-	if (steerDirCheck(&pWarrior->sSteer, DIRECTION_LEFT)) {
+	if (steerDirCheck(pWarrior->pSteer, DIRECTION_LEFT)) {
 		--bDeltaX;
 	}
-	if (steerDirCheck(&pWarrior->sSteer, DIRECTION_RIGHT)) {
+	if (steerDirCheck(pWarrior->pSteer, DIRECTION_RIGHT)) {
 		++bDeltaX;
 	}
 
@@ -451,8 +541,7 @@ static void warriorProcessState(tWarrior *pWarrior) {
 	}
 }
 
-static void thunderProcessInput(tSteer *pSteer) {
-	steerProcess(pSteer);
+static void thunderProcessInput(const tSteer *pSteer) {
 	BYTE bDx = 0, bDy = 0;
 	if(steerDirCheck(pSteer, DIRECTION_LEFT)) {
 		bDx -= 1;
@@ -470,65 +559,87 @@ static void thunderProcessInput(tSteer *pSteer) {
 	if(bDx) {
 		s_sThunder.sAttackPos.uwX = CLAMP(
 			s_sThunder.sAttackPos.uwX + bDx,
-			DISPLAY_MARGIN_SIZE, DISPLAY_WIDTH - DISPLAY_MARGIN_SIZE
+			DISPLAY_MARGIN_SIZE, s_uwMapWidth - DISPLAY_MARGIN_SIZE
 		);
 	}
 	if(bDy) {
 		s_sThunder.sAttackPos.uwY = CLAMP(
 			s_sThunder.sAttackPos.uwY + bDy,
-			DISPLAY_MARGIN_SIZE, DISPLAY_HEIGHT - DISPLAY_MARGIN_SIZE
+			DISPLAY_MARGIN_SIZE, s_uwMapHeight - DISPLAY_MARGIN_SIZE
 		);
 	}
 }
 
 static void warriorProcess(tWarrior *pWarrior) {
 	if(pWarrior->isDead) {
-		if(steerIsPlayer(&pWarrior->sSteer)) {
-			thunderProcessInput(&pWarrior->sSteer);
+		if(steerIsPlayer(pWarrior->pSteer)) {
+			thunderProcessInput(pWarrior->pSteer);
 		}
 		return;
 	}
 
-	steerProcess(&pWarrior->sSteer);
 	warriorProcessState(pWarrior);
 
-	--pWarrior->ubFrameCooldown;
-	if (!pWarrior->ubFrameCooldown) {
-		if (++pWarrior->ubAnimFrame >= getFrameCountForAnim(pWarrior->eAnim)) {
-			pWarrior->ubAnimFrame = 0;
-		}
-		pWarrior->ubFrameCooldown = FRAME_COOLDOWN;
-		tFrameOffsets *pOffsets = &s_pFrameOffsets[pWarrior->eDirection][pWarrior->eAnim][pWarrior->ubAnimFrame];
-		bobSetFrame(&pWarrior->sBob, pOffsets->pBitmap, pOffsets->pMask);
-	}
-
-	if(!pWarrior->isDead) {
+	// Bobs outside of buffer rows would wrap over other part of the map
+	if(
+		!pWarrior->isDead &&
+		tileIsAreaOnBuffer(pWarrior->sBob.sPos.uwY, pWarrior->sBob.uwHeight)
+	) {
+#if defined(GAME_WARRIOR_SPRITES)
+		spriteMuxPush(&pWarrior->sBob);
+#elif defined(GAME_WARRIOR_SHIFT_PHASES)
+		warriorApplyShiftedFrame(pWarrior);
 		bobPush(&pWarrior->sBob);
+#else
+		bobPush(&pWarrior->sBob);
+#endif
 	}
 }
 
 //------------------------------------------------------------------- PUBLIC FNS
 
-void warriorsDrawLookup(tBitMap *pBuffer) {
-	for(UBYTE ubY = 0; ubY < LOOKUP_TILE_HEIGHT; ++ubY) {
-		for(UBYTE ubX = 0; ubX < LOOKUP_TILE_WIDTH; ++ubX) {
-			if (s_pWarriorLookup[ubX][ubY]) {
-				blitRect(
-					pBuffer, ubX * LOOKUP_TILE_SIZE, ubY * LOOKUP_TILE_SIZE,
-					LOOKUP_TILE_SIZE, LOOKUP_TILE_SIZE, 6
-				);
+void warriorsGetLookupRow(UBYTE ubLookupY, UWORD *pRow) {
+	UBYTE ubWidth = s_uwMapWidth / LOOKUP_TILE_SIZE;
+	for(UBYTE ubX = 0; ubX < LOOKUP_TILE_WIDTH; ubX += 16) {
+		UWORD uwBits = 0;
+		for(UBYTE ubBit = 0; ubBit < 16; ++ubBit) {
+			uwBits <<= 1;
+			if(ubX + ubBit < ubWidth && s_pWarriorLookup[ubX + ubBit][ubLookupY]) {
+				uwBits |= 1;
 			}
 		}
+		*(pRow++) = uwBits;
 	}
 }
 
+UBYTE warriorsGetAiIntents(tUwCoordYX *pIntents) {
+	UBYTE ubCount = 0;
+	for(UBYTE i = 0; i < s_sSteers.ubAiCount; ++i) {
+		const tAi *pAi = &s_sSteers.pAis[i];
+		if(pAi->pWarrior->isDead) {
+			continue;
+		}
+		tAnimDirection eDirection = (
+			pAi->eState == AI_STATE_ATTACKING ?
+			pAi->eNextAttackDirection : pAi->eNextMovementDirection
+		);
+		const tBCoordYX *pDelta = &s_pAnimDirToAttackDelta[eDirection];
+		pIntents[ubCount].uwX = pAi->pWarrior->sPos.uwX + pDelta->bX;
+		pIntents[ubCount].uwY = pAi->pWarrior->sPos.uwY + pDelta->bY;
+		++ubCount;
+	}
+	return ubCount;
+}
+
 void warriorsCreate(UBYTE isExtraEnemiesEnabled) {
-	initFrameOffsets();
 	resetWarriorLookup();
 	tileShuffleSpawns();
 	s_ubAliveCount = 0;
 	s_ubAlivePlayerCount = 0;
 	s_isMoveEnabled = 0;
+	steerSetReset(&s_sSteers);
+	s_uwMapWidth = tileGetMapWidth() * MAP_TILE_SIZE;
+	s_uwMapHeight = tileGetMapHeight() * MAP_TILE_SIZE;
 
 	UBYTE ubPlayers = 0;
 	for(UBYTE i = 0; i < WARRIOR_COUNT; ++i) {
@@ -543,7 +654,7 @@ void warriorsCreate(UBYTE isExtraEnemiesEnabled) {
 	}
 
 	for(UBYTE i = 0; i < WARRIOR_COUNT; ++i) {
-		s_pWarriors[i] = memAllocFast(sizeof(*s_pWarriors[i]));
+		s_pWarriors[i] = memTrackAllocFast(MEM_TAG_WARRIOR, sizeof(*s_pWarriors[i]));
 		const tUwCoordYX *pSpawn = tileGetSpawn(i);
 		tSteerMode eSteerMode = menuGetSteerModeForPlayer(i);
 		warriorAdd(s_pWarriors[i], pSpawn->uwX, pSpawn->uwY, eSteerMode, i);
@@ -564,49 +675,37 @@ void warriorsCreate(UBYTE isExtraEnemiesEnabled) {
 	spriteSetEnabled(s_sThunder.pSpriteThunder, 0);
 	spriteSetEnabled(s_sThunder.pSpriteCross, 0);
 	s_sThunder.sAttackPos.ulYX = (tUwCoordYX){
-		.uwX = DISPLAY_WIDTH / 2, .uwY = DISPLAY_HEIGHT / 2
+		.uwX = s_uwMapWidth / 2, .uwY = s_uwMapHeight / 2
 	}.ulYX;
-	s_sThunder.ubActivateCooldown = THUNDER_ACTIVATE_COOLDOWN;
+	s_sThunder.ubActivateEvent = SCHEDULER_EVENT_INVALID;
 	s_sThunder.ubCurrentColor = 0;
-	s_sThunder.ubColorCooldown = 0;
+	s_sThunder.ubColorEvent = SCHEDULER_EVENT_INVALID;
 	s_sThunder.ubNextFrame = 0;
+#if defined(GAME_WARRIOR_SPRITES)
+	spriteMuxCreate();
+#endif
 }
 
 void warriorsProcess(void) {
+	// All steers first, each kind in its own pass
+	steerSetProcessPlayers(&s_sSteers);
+	steerSetProcessAis(&s_sSteers);
 
+#if defined(GAME_WARRIOR_SPRITES)
+	spriteMuxBegin();
+#endif
 	for(UBYTE i = 0; i < WARRIOR_COUNT; ++i) {
 		warriorProcess(s_pWarriors[i]);
 	}
+#if defined(GAME_WARRIOR_SPRITES)
+	spriteMuxEnd();
+#endif
 
+	thunderProcessEvents();
 	if(s_sThunder.pSpriteCross->isEnabled) {
-		if(s_sThunder.ubColorCooldown) {
-			if(--s_sThunder.ubColorCooldown == 0) {
-				if(++s_sThunder.ubCurrentColor < 8) {
-					s_sThunder.ubColorCooldown = THUNDER_COLOR_COOLDOWN;
-					displaySetThunderColor(s_sThunder.ubCurrentColor);
-				}
-				else {
-					spriteSetEnabled(s_sThunder.pSpriteThunder, 0);
-				}
-			}
-		}
-		if(--s_sThunder.ubActivateCooldown == 0) {
-			spriteSetEnabled(s_sThunder.pSpriteThunder, 1);
-			spriteSetBitmap(s_sThunder.pSpriteThunder, g_pFramesThunder[s_sThunder.ubNextFrame]);
-			s_sThunder.ubNextFrame = !s_sThunder.ubNextFrame;
-			s_sThunder.pSpriteThunder->wX = s_sThunder.sAttackPos.uwX - DISPLAY_MARGIN_SIZE - 8;
-			s_sThunder.pSpriteThunder->wY = 0;
-			spriteSetHeight(s_sThunder.pSpriteThunder, s_sThunder.sAttackPos.uwY - DISPLAY_MARGIN_SIZE);
-			s_sThunder.ubActivateCooldown = THUNDER_ACTIVATE_COOLDOWN;
-			warriorAttackWithLightning(s_sThunder.sAttackPos);
-			s_sThunder.ubCurrentColor = 0;
-			displaySetThunderColor(0);
-			s_sThunder.ubColorCooldown = THUNDER_COLOR_COOLDOWN;
-			ptplayerSfxPlay(g_pSfxThunder, 2, 64, SFX_PRIORITY_THUNDER);
-		}
-
-		s_sThunder.pSpriteCross->wX = s_sThunder.sAttackPos.uwX - DISPLAY_MARGIN_SIZE - 8;
-		s_sThunder.pSpriteCross->wY = s_sThunder.sAttackPos.uwY - DISPLAY_MARGIN_SIZE - 8;
+		const tUwCoordYX *pCameraPos = &displayGetManager()->pCamera->uPos;
+		s_sThunder.pSpriteCross->wX = s_sThunder.sAttackPos.uwX - pCameraPos->uwX - 8;
+		s_sThunder.pSpriteCross->wY = s_sThunder.sAttackPos.uwY - pCameraPos->uwY - 8;
 		spriteRequestMetadataUpdate(s_sThunder.pSpriteCross);
 	}
 
@@ -626,10 +725,13 @@ void warriorsProcess(void) {
 
 void warriorsDestroy(void) {
 	for(UBYTE i = 0; i < WARRIOR_COUNT; ++i) {
-		memFree(s_pWarriors[i], sizeof(*s_pWarriors[i]));
+		memTrackFreeFast(MEM_TAG_WARRIOR, s_pWarriors[i], sizeof(*s_pWarriors[i]));
 	}
 	spriteRemove(s_sThunder.pSpriteThunder);
 	spriteRemove(s_sThunder.pSpriteCross);
+#if defined(GAME_WARRIOR_SPRITES)
+	spriteMuxDestroy();
+#endif
 }
 
 UBYTE warriorsGetAliveCount(void) {
@@ -640,6 +742,28 @@ UBYTE warriorsGetAlivePlayerCount(void) {
 	return s_ubAlivePlayerCount;
 }
 
+UBYTE warriorsGetAliveCenter(tUwCoordYX *pCenter) {
+	UWORD uwMinX = 0xFFFF, uwMaxX = 0, uwMinY = 0xFFFF, uwMaxY = 0;
+	UBYTE isAnyAlive = 0;
+	for(UBYTE i = 0; i < WARRIOR_COUNT; ++i) {
+		const tWarrior *pWarrior = s_pWarriors[i];
+		if(pWarrior->isDead) {
+			continue;
+		}
+		isAnyAlive = 1;
+		uwMinX = MIN(uwMinX, pWarrior->sPos.uwX);
+		uwMaxX = MAX(uwMaxX, pWarrior->sPos.uwX);
+		uwMinY = MIN(uwMinY, pWarrior->sPos.uwY);
+		uwMaxY = MAX(uwMaxY, pWarrior->sPos.uwY);
+	}
+
+	if(isAnyAlive) {
+		pCenter->uwX = (uwMinX + uwMaxX) / 2;
+		pCenter->uwY = (uwMinY + uwMaxY) / 2;
+	}
+	return isAnyAlive;
+}
+
 UBYTE warriorsGetLastAliveIndex(void) {
 	for(UBYTE i = 0; i < WARRIOR_COUNT; ++i) {
 		if(!s_pWarriors[i]->isDead && s_pWarriors[i]->ubIndex < PLAYER_MAX_COUNT) {
@@ -659,28 +783,28 @@ void warriorAttackWithLightning(tUwCoordYX sAttackPos) {
 	pTarget = warriorGetNearPos(sAttackPos.uwX, 0, sAttackPos.uwY, 0);
 	if(pTarget && isPositionCollidingWithWarrior(sAttackPos, pTarget)) {
 		warriorSetAnim(pTarget, ANIM_HURT);
-		pTarget->sPushDelta = g_pAnimDirToPushDelta[randUw(&g_sRandManager) & 7];
+		pTarget->sPushDelta = g_pAnimDirToPushDelta[rngNext(RNG_STREAM_SIMULATION) & 7];
 		return;
 	}
 
 	pTarget = warriorGetNearPos(sAttackPos.uwX, 1, sAttackPos.uwY, 0);
 	if(pTarget && isPositionCollidingWithWarrior(sAttackPos, pTarget)) {
 		warriorSetAnim(pTarget, ANIM_HURT);
-		pTarget->sPushDelta = g_pAnimDirToPushDelta[randUw(&g_sRandManager) & 7];
+		pTarget->sPushDelta = g_pAnimDirToPushDelta[rngNext(RNG_STREAM_SIMULATION) & 7];
 		return;
 	}
 
 	pTarget = warriorGetNearPos(sAttackPos.uwX, 0, sAttackPos.uwY, 1);
 	if(pTarget && isPositionCollidingWithWarrior(sAttackPos, pTarget)) {
 		warriorSetAnim(pTarget, ANIM_HURT);
-		pTarget->sPushDelta = g_pAnimDirToPushDelta[randUw(&g_sRandManager) & 7];
+		pTarget->sPushDelta = g_pAnimDirToPushDelta[rngNext(RNG_STREAM_SIMULATION) & 7];
 		return;
 	}
 
 	pTarget = warriorGetNearPos(sAttackPos.uwX, 1, sAttackPos.uwY, 1);
 	if(pTarget && isPositionCollidingWithWarrior(sAttackPos, pTarget)) {
 		warriorSetAnim(pTarget, ANIM_HURT);
-		pTarget->sPushDelta = g_pAnimDirToPushDelta[randUw(&g_sRandManager) & 7];
+		pTarget->sPushDelta = g_pAnimDirToPushDelta[rngNext(RNG_STREAM_SIMULATION) & 7];
 		return;
 	}
 }
@@ -8,20 +8,22 @@
 #include <ace/managers/bob.h>
 #include "steer.h"
 #include "anim.h"
+#include "scheduler.h"
 
 #define WARRIOR_LAST_ALIVE_INDEX_INVALID 255
+#define WARRIOR_LOOKUP_CELL_SIZE 8
 
 typedef struct tWarrior {
 	tUwCoordYX sPos;
 	tBob sBob;
 	UBYTE ubAnimFrame;
-	UBYTE ubFrameCooldown;
+	tSchedulerEvent ubFrameEvent;
 	UBYTE ubStunCooldown;
 	UBYTE isDead;
 	UBYTE ubIndex;
 	tAnim eAnim;
 	tAnimDirection eDirection;
-	tSteer sSteer;
+	tSteer *pSteer; ///< Lives in warrior module's steer set.
 	tBCoordYX sPushDelta;
 } tWarrior;
 
@@ -33,7 +35,18 @@ void warriorsProcess(void);
 
 void warriorsDestroy(void);
 
-void warriorsDrawLookup(tBitMap *pBuffer);
+/**
+ * @brief Fills pRow with bit per lookup cell of given row, MSB first,
+ * set where some warrior is registered. Row has word per 16 cells of max map width.
+ */
+void warriorsGetLookupRow(UBYTE ubLookupY, UWORD *pRow);
+
+/**
+ * @brief Gets map positions which alive AI warriors move towards or strike at.
+ *
+ * @return Number of positions written, at most STEER_SET_SIZE.
+ */
+UBYTE warriorsGetAiIntents(tUwCoordYX *pIntents);
 
 UBYTE warriorsGetAliveCount(void);
 
@@ -42,6 +55,9 @@ UBYTE warriorsGetAlivePlayerCount(void);
 // number is zero-based
 UBYTE warriorsGetLastAliveIndex(void);
 
+// center of area spanned by alive warriors, returns 0 if there are none
+UBYTE warriorsGetAliveCenter(tUwCoordYX *pCenter);
+
 void warriorsEnableMove(UBYTE isEnabled);
 
 void warriorAttackWithLightning(tUwCoordYX sAttackPos);
@@ -0,0 +1,461 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Lays out asset files on raw tracks of DOS ADF in the order the game reads
+ * them, for the trackloader in src/loader.c. Pack starts at block 2 and its
+ * blocks are marked as used in the DOS bitmap so that the disk stays valid.
+ *
+ * Usage:
+ *   adfLayout build base.adf out.adf rootDir file [file ...]
+ *     Puts files (paths relative to rootDir) on base.adf, in given order.
+ *   adfLayout verify out.adf rootDir file [file ...]
+ *     Checks pack contents and order, simulates trackloader reads.
+ *   adfLayout dos dos.adf file [file ...]
+ *     Simulates reading same files through DOS from regular ADF.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitmap_file.h"
+
+#define ADF_BLOCK_SIZE 512
+#define ADF_BLOCK_COUNT 1760
+#define ADF_SIZE (ADF_BLOCK_SIZE * ADF_BLOCK_COUNT)
+#define ADF_BLOCKS_PER_TRACK 11
+#define ADF_TRACKS_PER_CYLINDER 2
+#define ADF_ROOT_BLOCK 880
+#define ADF_HASH_SIZE 72
+#define ADF_LONGS_PER_BLOCK (ADF_BLOCK_SIZE / 4)
+
+// Long indices in root/header blocks
+#define ADF_LONG_HIGH_SEQ 2
+#define ADF_LONG_HASH_TABLE 6
+#define ADF_LONG_BM_PAGES 79
+#define ADF_LONG_BYTE_SIZE 81
+#define ADF_LONG_HASH_CHAIN 124
+#define ADF_LONG_EXTENSION 126
+#define ADF_NAME_OFFSET 432
+#define ADF_OFS_DATA_SIZE 488
+#define ADF_DOS_TYPE_FFS_BIT 1
+
+#define PACK_MAGIC 0x4341504B // "CAPK"
+#define PACK_FIRST_BLOCK 2
+#define PACK_NAME_SIZE 28 // Keep in sync with LOADER_NAME_SIZE
+#define PACK_HEADER_SIZE 8
+#define PACK_ENTRY_SIZE (PACK_NAME_SIZE + 8)
+
+// Drive timings for the estimate: full revolution per track read, step and settle
+#define MS_PER_TRACK_READ 200
+#define MS_PER_STEP 3
+#define MS_PER_SETTLE 15
+
+typedef struct tReadSim {
+	int lCachedTrack;
+	int lCylinder;
+	unsigned int uiTrackReads;
+	unsigned int uiSeeks;
+	unsigned int uiSteps;
+} tReadSim;
+
+static uint32_t readBeLong(const uint8_t *pSrc) {
+	return ((uint32_t)readBeWord(pSrc) << 16) | readBeWord(&pSrc[2]);
+}
+
+static void writeBeLong(uint8_t *pDst, uint32_t ulValue) {
+	writeBeWord(&pDst[0], ulValue >> 16);
+	writeBeWord(&pDst[2], ulValue & 0xFFFF);
+}
+
+static uint8_t *adfGetBlock(uint8_t *pAdf, uint32_t ulBlock) {
+	return &pAdf[ulBlock * ADF_BLOCK_SIZE];
+}
+
+static uint32_t blockGetLong(const uint8_t *pBlock, int lIndex) {
+	return readBeLong(&pBlock[lIndex * 4]);
+}
+
+static void blockUpdateChecksum(uint8_t *pBlock, int lChecksumLong) {
+	writeBeLong(&pBlock[lChecksumLong * 4], 0);
+	uint32_t ulSum = 0;
+	for(int i = 0; i < ADF_LONGS_PER_BLOCK; ++i) {
+		ulSum += blockGetLong(pBlock, i);
+	}
+	writeBeLong(&pBlock[lChecksumLong * 4], -ulSum);
+}
+
+static uint8_t *fileReadAll(const char *szPath, size_t *pSize) {
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szPath);
+		return 0;
+	}
+	fseek(pFile, 0, SEEK_END);
+	*pSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	uint8_t *pData = malloc(*pSize ? *pSize : 1);
+	if(*pSize && fread(pData, *pSize, 1, pFile) != 1) {
+		fprintf(stderr, "ERR: Can't read '%s'\n", szPath);
+		free(pData);
+		pData = 0;
+	}
+	fclose(pFile);
+	return pData;
+}
+
+static uint8_t *adfLoad(const char *szPath) {
+	size_t ulSize;
+	uint8_t *pAdf = fileReadAll(szPath, &ulSize);
+	if(pAdf && ulSize != ADF_SIZE) {
+		fprintf(stderr, "ERR: '%s' is not a DD ADF\n", szPath);
+		free(pAdf);
+		pAdf = 0;
+	}
+	return pAdf;
+}
+
+//----------------------------------------------------------------- DOS BITMAP
+
+static uint8_t *adfGetBitmapBlock(uint8_t *pAdf) {
+	const uint8_t *pRoot = adfGetBlock(pAdf, ADF_ROOT_BLOCK);
+	uint32_t ulBmBlock = blockGetLong(pRoot, ADF_LONG_BM_PAGES);
+	if(!ulBmBlock || ulBmBlock >= ADF_BLOCK_COUNT) {
+		return 0;
+	}
+	return adfGetBlock(pAdf, ulBmBlock);
+}
+
+static int bitmapIsFree(const uint8_t *pBm, uint32_t ulBlock) {
+	uint32_t ulBit = ulBlock - 2;
+	return (blockGetLong(pBm, 1 + ulBit / 32) >> (ulBit % 32)) & 1;
+}
+
+static void bitmapSetUsed(uint8_t *pBm, uint32_t ulBlock) {
+	uint32_t ulBit = ulBlock - 2;
+	uint8_t *pLong = &pBm[(1 + ulBit / 32) * 4];
+	writeBeLong(pLong, readBeLong(pLong) & ~(1u << (ulBit % 32)));
+}
+
+//------------------------------------------------------------------- READ SIM
+
+static void simInit(tReadSim *pSim) {
+	memset(pSim, 0, sizeof(*pSim));
+	pSim->lCachedTrack = -1;
+}
+
+static void simReadBlock(tReadSim *pSim, uint32_t ulBlock) {
+	// trackdisk.device reads and caches whole tracks
+	int lTrack = ulBlock / ADF_BLOCKS_PER_TRACK;
+	if(lTrack == pSim->lCachedTrack) {
+		return;
+	}
+	int lCylinder = lTrack / ADF_TRACKS_PER_CYLINDER;
+	if(lCylinder != pSim->lCylinder) {
+		++pSim->uiSeeks;
+		pSim->uiSteps += abs(lCylinder - pSim->lCylinder);
+		pSim->lCylinder = lCylinder;
+	}
+	pSim->lCachedTrack = lTrack;
+	++pSim->uiTrackReads;
+}
+
+static void simPrint(const tReadSim *pSim, const char *szName) {
+	unsigned int uiMs = (
+		pSim->uiTrackReads * MS_PER_TRACK_READ + pSim->uiSteps * MS_PER_STEP +
+		pSim->uiSeeks * MS_PER_SETTLE
+	);
+	printf(
+		"%s: %u track reads, %u seeks, %u cylinder steps, ~%u ms\n",
+		szName, pSim->uiTrackReads, pSim->uiSeeks, pSim->uiSteps, uiMs
+	);
+}
+
+//---------------------------------------------------------------------- BUILD
+
+static int cmdBuild(int lArgCount, char *pArgs[]) {
+	const char *szBase = pArgs[0], *szOut = pArgs[1], *szRoot = pArgs[2];
+	int lFileCount = lArgCount - 3;
+	char **pNames = &pArgs[3];
+
+	uint8_t *pAdf = adfLoad(szBase);
+	if(!pAdf) {
+		return 0;
+	}
+	uint8_t *pBm = adfGetBitmapBlock(pAdf);
+	if(!pBm) {
+		fprintf(stderr, "ERR: No DOS bitmap on '%s'\n", szBase);
+		free(pAdf);
+		return 0;
+	}
+
+	uint32_t ulOffset = PACK_FIRST_BLOCK * ADF_BLOCK_SIZE;
+	uint32_t ulDataOffset = ulOffset + PACK_HEADER_SIZE + lFileCount * PACK_ENTRY_SIZE;
+	uint8_t *pHeader = &pAdf[ulOffset];
+	writeBeLong(&pHeader[0], PACK_MAGIC);
+	writeBeWord(&pHeader[4], lFileCount);
+	writeBeWord(&pHeader[6], 0);
+
+	int isOk = 1;
+	for(int i = 0; isOk && i < lFileCount; ++i) {
+		if(strlen(pNames[i]) >= PACK_NAME_SIZE) {
+			fprintf(stderr, "ERR: Name too long: '%s'\n", pNames[i]);
+			isOk = 0;
+			break;
+		}
+		char szPath[1024];
+		snprintf(szPath, sizeof(szPath), "%s/%s", szRoot, pNames[i]);
+		size_t ulSize;
+		uint8_t *pData = fileReadAll(szPath, &ulSize);
+		if(!pData) {
+			isOk = 0;
+			break;
+		}
+		if(ulDataOffset + ulSize > ADF_ROOT_BLOCK * ADF_BLOCK_SIZE) {
+			fprintf(stderr, "ERR: Pack doesn't fit before root block at '%s'\n", pNames[i]);
+			isOk = 0;
+		}
+		else {
+			uint8_t *pEntry = &pHeader[PACK_HEADER_SIZE + i * PACK_ENTRY_SIZE];
+			memset(pEntry, 0, PACK_NAME_SIZE);
+			memcpy(pEntry, pNames[i], strlen(pNames[i]));
+			writeBeLong(&pEntry[PACK_NAME_SIZE], ulDataOffset);
+			writeBeLong(&pEntry[PACK_NAME_SIZE + 4], ulSize);
+			memcpy(&pAdf[ulDataOffset], pData, ulSize);
+			ulDataOffset += ulSize;
+		}
+		free(pData);
+	}
+
+	// Pack blocks must be free on base disk, then they're taken away from DOS
+	uint32_t ulEndBlock = (ulDataOffset + ADF_BLOCK_SIZE - 1) / ADF_BLOCK_SIZE;
+	for(uint32_t ulBlock = PACK_FIRST_BLOCK; isOk && ulBlock < ulEndBlock; ++ulBlock) {
+		if(!bitmapIsFree(pBm, ulBlock)) {
+			fprintf(stderr, "ERR: Block %u is used by DOS, can't place pack\n", ulBlock);
+			isOk = 0;
+		}
+		bitmapSetUsed(pBm, ulBlock);
+	}
+	if(isOk) {
+		blockUpdateChecksum(pBm, 0);
+		FILE *pFile = fopen(szOut, "wb");
+		isOk = pFile && fwrite(pAdf, ADF_SIZE, 1, pFile) == 1;
+		if(pFile) {
+			fclose(pFile);
+		}
+		if(!isOk) {
+			fprintf(stderr, "ERR: Can't write '%s'\n", szOut);
+		}
+		else {
+			printf(
+				"Packed %d files, %u bytes in blocks %d..%u\n", lFileCount,
+				ulDataOffset - PACK_FIRST_BLOCK * ADF_BLOCK_SIZE, PACK_FIRST_BLOCK,
+				ulEndBlock - 1
+			);
+		}
+	}
+	free(pAdf);
+	return isOk;
+}
+
+//--------------------------------------------------------------------- VERIFY
+
+static int cmdVerify(int lArgCount, char *pArgs[]) {
+	const char *szAdf = pArgs[0], *szRoot = pArgs[1];
+	int lFileCount = lArgCount - 2;
+	char **pNames = &pArgs[2];
+
+	uint8_t *pAdf = adfLoad(szAdf);
+	if(!pAdf) {
+		return 0;
+	}
+	const uint8_t *pHeader = &pAdf[PACK_FIRST_BLOCK * ADF_BLOCK_SIZE];
+	if(readBeLong(pHeader) != PACK_MAGIC) {
+		fprintf(stderr, "ERR: No pack on '%s'\n", szAdf);
+		free(pAdf);
+		return 0;
+	}
+	int lEntryCount = readBeWord(&pHeader[4]);
+	int isOk = 1;
+	if(lEntryCount != lFileCount) {
+		fprintf(stderr, "ERR: Pack has %d files, expected %d\n", lEntryCount, lFileCount);
+		isOk = 0;
+	}
+
+	uint8_t *pBm = adfGetBitmapBlock(pAdf);
+	tReadSim sSim;
+	simInit(&sSim);
+	// Loader reads pack directory first
+	uint32_t ulExpectedOffset = PACK_FIRST_BLOCK * ADF_BLOCK_SIZE;
+	uint32_t ulDirEnd = ulExpectedOffset + PACK_HEADER_SIZE + lEntryCount * PACK_ENTRY_SIZE;
+	for(uint32_t ulPos = ulExpectedOffset; ulPos < ulDirEnd; ulPos += ADF_BLOCK_SIZE) {
+		simReadBlock(&sSim, ulPos / ADF_BLOCK_SIZE);
+	}
+	ulExpectedOffset = ulDirEnd;
+
+	for(int i = 0; isOk && i < lEntryCount; ++i) {
+		const uint8_t *pEntry = &pHeader[PACK_HEADER_SIZE + i * PACK_ENTRY_SIZE];
+		char szName[PACK_NAME_SIZE + 1] = {0};
+		memcpy(szName, pEntry, PACK_NAME_SIZE);
+		uint32_t ulOffset = readBeLong(&pEntry[PACK_NAME_SIZE]);
+		uint32_t ulSize = readBeLong(&pEntry[PACK_NAME_SIZE + 4]);
+		if(strcmp(szName, pNames[i])) {
+			fprintf(stderr, "ERR: Entry %d is '%s', expected '%s'\n", i, szName, pNames[i]);
+			isOk = 0;
+			break;
+		}
+		if(ulOffset != ulExpectedOffset) {
+			fprintf(stderr, "ERR: '%s' is not contiguous with previous file\n", szName);
+			isOk = 0;
+		}
+
+		char szPath[1024];
+		snprintf(szPath, sizeof(szPath), "%s/%s", szRoot, pNames[i]);
+		size_t ulFileSize;
+		uint8_t *pData = fileReadAll(szPath, &ulFileSize);
+		if(!pData || ulFileSize != ulSize || memcmp(pData, &pAdf[ulOffset], ulSize)) {
+			fprintf(stderr, "ERR: '%s' contents differ from '%s'\n", szName, szPath);
+			isOk = 0;
+		}
+		free(pData);
+
+		for(uint32_t ulBlock = ulOffset / ADF_BLOCK_SIZE; ulBlock * ADF_BLOCK_SIZE < ulOffset + ulSize; ++ulBlock) {
+			if(pBm && bitmapIsFree(pBm, ulBlock)) {
+				fprintf(stderr, "ERR: Block %u of '%s' is free in DOS bitmap\n", ulBlock, szName);
+				isOk = 0;
+				break;
+			}
+			simReadBlock(&sSim, ulBlock);
+		}
+		ulExpectedOffset = ulOffset + ulSize;
+	}
+
+	if(isOk) {
+		simPrint(&sSim, "trackloader");
+	}
+	free(pAdf);
+	return isOk;
+}
+
+//------------------------------------------------------------------------ DOS
+
+static uint32_t dosHash(const char *szName) {
+	uint32_t ulHash = strlen(szName);
+	for(const char *pChar = szName; *pChar; ++pChar) {
+		ulHash = (ulHash * 13 + toupper((unsigned char)*pChar)) & 0x7FF;
+	}
+	return ulHash % ADF_HASH_SIZE;
+}
+
+static int dosNameEquals(const uint8_t *pBlock, const char *szName, size_t ulLength) {
+	const uint8_t *pBstr = &pBlock[ADF_NAME_OFFSET];
+	if(pBstr[0] != ulLength) {
+		return 0;
+	}
+	for(size_t i = 0; i < ulLength; ++i) {
+		if(toupper(pBstr[1 + i]) != toupper((unsigned char)szName[i])) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static uint32_t dosFind(
+	uint8_t *pAdf, uint32_t ulDirBlock, const char *szName, size_t ulLength
+) {
+	char szPart[32] = {0};
+	memcpy(szPart, szName, ulLength < sizeof(szPart) ? ulLength : sizeof(szPart) - 1);
+	uint32_t ulBlock = blockGetLong(
+		adfGetBlock(pAdf, ulDirBlock), ADF_LONG_HASH_TABLE + dosHash(szPart)
+	);
+	while(ulBlock && ulBlock < ADF_BLOCK_COUNT) {
+		const uint8_t *pBlock = adfGetBlock(pAdf, ulBlock);
+		if(dosNameEquals(pBlock, szName, ulLength)) {
+			return ulBlock;
+		}
+		ulBlock = blockGetLong(pBlock, ADF_LONG_HASH_CHAIN);
+	}
+	return 0;
+}
+
+static int dosSimFile(uint8_t *pAdf, const char *szPath, int isFfs, tReadSim *pSim) {
+	// Directory blocks are assumed to stay in filesystem buffers, only file
+	// header, extension and data blocks are counted
+	uint32_t ulBlock = ADF_ROOT_BLOCK;
+	const char *szPart = szPath;
+	for(;;) {
+		const char *szSlash = strchr(szPart, '/');
+		size_t ulLength = szSlash ? (size_t)(szSlash - szPart) : strlen(szPart);
+		ulBlock = dosFind(pAdf, ulBlock, szPart, ulLength);
+		if(!ulBlock) {
+			fprintf(stderr, "ERR: '%s' not found\n", szPath);
+			return 0;
+		}
+		if(!szSlash) {
+			break;
+		}
+		szPart = szSlash + 1;
+	}
+
+	uint32_t ulSize = blockGetLong(adfGetBlock(pAdf, ulBlock), ADF_LONG_BYTE_SIZE);
+	uint32_t ulBlockPayload = isFfs ? ADF_BLOCK_SIZE : ADF_OFS_DATA_SIZE;
+	uint32_t ulDataBlocks = (ulSize + ulBlockPayload - 1) / ulBlockPayload;
+	uint32_t ulHeader = ulBlock;
+	while(ulDataBlocks && ulHeader && ulHeader < ADF_BLOCK_COUNT) {
+		const uint8_t *pHeader = adfGetBlock(pAdf, ulHeader);
+		simReadBlock(pSim, ulHeader);
+		uint32_t ulCount = blockGetLong(pHeader, ADF_LONG_HIGH_SEQ);
+		// Data block pointers are stored backwards, from the end of the table
+		for(uint32_t i = 0; i < ulCount && ulDataBlocks; ++i, --ulDataBlocks) {
+			simReadBlock(pSim, blockGetLong(pHeader, ADF_LONG_HASH_TABLE + ADF_HASH_SIZE - 1 - i));
+		}
+		ulHeader = blockGetLong(pHeader, ADF_LONG_EXTENSION);
+	}
+	return 1;
+}
+
+static int cmdDos(int lArgCount, char *pArgs[]) {
+	uint8_t *pAdf = adfLoad(pArgs[0]);
+	if(!pAdf) {
+		return 0;
+	}
+	int isFfs = pAdf[3] & ADF_DOS_TYPE_FFS_BIT;
+	tReadSim sSim;
+	simInit(&sSim);
+	int isOk = 1;
+	for(int i = 1; isOk && i < lArgCount; ++i) {
+		isOk = dosSimFile(pAdf, pArgs[i], isFfs, &sSim);
+	}
+	if(isOk) {
+		simPrint(&sSim, isFfs ? "dos (FFS)" : "dos (OFS)");
+	}
+	free(pAdf);
+	return isOk;
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	int isOk;
+	if(lArgCount >= 6 && !strcmp(pArgs[1], "build")) {
+		isOk = cmdBuild(lArgCount - 2, &pArgs[2]);
+	}
+	else if(lArgCount >= 5 && !strcmp(pArgs[1], "verify")) {
+		isOk = cmdVerify(lArgCount - 2, &pArgs[2]);
+	}
+	else if(lArgCount >= 4 && !strcmp(pArgs[1], "dos")) {
+		isOk = cmdDos(lArgCount - 2, &pArgs[2]);
+	}
+	else {
+		fprintf(
+			stderr,
+			"Usage:\n"
+			"\t%s build base.adf out.adf rootDir file [file ...]\n"
+			"\t%s verify out.adf rootDir file [file ...]\n"
+			"\t%s dos dos.adf file [file ...]\n",
+			pArgs[0], pArgs[0], pArgs[0]
+		);
+		return EXIT_FAILURE;
+	}
+	return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
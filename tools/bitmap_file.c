@@ -0,0 +1,86 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "bitmap_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int bitmapFileLoad(const char *szPath, tBitmapFile *pBitmap) {
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szPath);
+		return 0;
+	}
+
+	uint8_t pHeader[BITMAP_FILE_HEADER_SIZE];
+	if(fread(pHeader, sizeof(pHeader), 1, pFile) != 1) {
+		fprintf(stderr, "ERR: Can't read header of '%s'\n", szPath);
+		fclose(pFile);
+		return 0;
+	}
+	pBitmap->uwWidth = readBeWord(&pHeader[0]);
+	pBitmap->uwHeight = readBeWord(&pHeader[2]);
+	pBitmap->ubDepth = pHeader[4];
+	pBitmap->ubVersion = pHeader[5];
+	pBitmap->ubFlags = pHeader[6];
+	pBitmap->uwBytesPerRow = ((pBitmap->uwWidth + 15) / 16) * 2;
+
+	size_t ulSize = (size_t)pBitmap->uwBytesPerRow * pBitmap->uwHeight * pBitmap->ubDepth;
+	uint8_t *pRaw = malloc(ulSize);
+	if(fread(pRaw, ulSize, 1, pFile) != 1) {
+		fprintf(stderr, "ERR: Truncated data in '%s'\n", szPath);
+		free(pRaw);
+		fclose(pFile);
+		return 0;
+	}
+	fclose(pFile);
+
+	if(pBitmap->ubFlags & BITMAP_FILE_FLAG_INTERLEAVED) {
+		pBitmap->pData = pRaw;
+	}
+	else {
+		// Convert plane-by-plane layout to interleaved one
+		pBitmap->pData = malloc(ulSize);
+		size_t ulPlaneSize = (size_t)pBitmap->uwBytesPerRow * pBitmap->uwHeight;
+		for(uint8_t ubPlane = 0; ubPlane < pBitmap->ubDepth; ++ubPlane) {
+			for(uint16_t uwRow = 0; uwRow < pBitmap->uwHeight; ++uwRow) {
+				memcpy(
+					bitmapFileGetRow(pBitmap, uwRow, ubPlane),
+					&pRaw[ubPlane * ulPlaneSize + uwRow * pBitmap->uwBytesPerRow],
+					pBitmap->uwBytesPerRow
+				);
+			}
+		}
+		free(pRaw);
+	}
+	return 1;
+}
+
+int bitmapFileSave(const char *szPath, const tBitmapFile *pBitmap) {
+	FILE *pFile = fopen(szPath, "wb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s' for writing\n", szPath);
+		return 0;
+	}
+
+	uint8_t pHeader[BITMAP_FILE_HEADER_SIZE] = {0};
+	writeBeWord(&pHeader[0], pBitmap->uwWidth);
+	writeBeWord(&pHeader[2], pBitmap->uwHeight);
+	pHeader[4] = pBitmap->ubDepth;
+	pHeader[5] = pBitmap->ubVersion;
+	pHeader[6] = pBitmap->ubFlags | BITMAP_FILE_FLAG_INTERLEAVED;
+	size_t ulSize = (size_t)pBitmap->uwBytesPerRow * pBitmap->uwHeight * pBitmap->ubDepth;
+	int isOk = (
+		fwrite(pHeader, sizeof(pHeader), 1, pFile) == 1 &&
+		fwrite(pBitmap->pData, ulSize, 1, pFile) == 1
+	);
+	fclose(pFile);
+	return isOk;
+}
+
+void bitmapFileFree(tBitmapFile *pBitmap) {
+	free(pBitmap->pData);
+	pBitmap->pData = 0;
+}
@@ -0,0 +1,50 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_TOOLS_BITMAP_FILE_H
+#define INCLUDE_TOOLS_BITMAP_FILE_H
+
+#include <stdint.h>
+
+#define BITMAP_FILE_FLAG_INTERLEAVED 1
+#define BITMAP_FILE_HEADER_SIZE 9
+
+/**
+ * @brief ACE .bm file contents, as produced by bitmap_conv.
+ * Data is always kept interleaved: each row holds all planes one by one.
+ */
+typedef struct tBitmapFile {
+	uint16_t uwWidth;
+	uint16_t uwHeight;
+	uint8_t ubDepth;
+	uint8_t ubVersion;
+	uint8_t ubFlags;
+	uint16_t uwBytesPerRow; ///< For single plane.
+	uint8_t *pData;
+} tBitmapFile;
+
+int bitmapFileLoad(const char *szPath, tBitmapFile *pBitmap);
+
+int bitmapFileSave(const char *szPath, const tBitmapFile *pBitmap);
+
+void bitmapFileFree(tBitmapFile *pBitmap);
+
+static inline uint8_t *bitmapFileGetRow(
+	const tBitmapFile *pBitmap, uint16_t uwRow, uint8_t ubPlane
+) {
+	return &pBitmap->pData[
+		(uwRow * pBitmap->ubDepth + ubPlane) * pBitmap->uwBytesPerRow
+	];
+}
+
+static inline uint16_t readBeWord(const uint8_t *pSrc) {
+	return (pSrc[0] << 8) | pSrc[1];
+}
+
+static inline void writeBeWord(uint8_t *pDst, uint16_t uwValue) {
+	pDst[0] = uwValue >> 8;
+	pDst[1] = uwValue & 0xFF;
+}
+
+#endif // INCLUDE_TOOLS_BITMAP_FILE_H
@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Packs .bm file into planar RLE container read by src/bitmap_pack.c.
+ *
+ * Usage: bitmapPack in.bm out.pbm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bitmap_pack_file.h"
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 3) {
+		fprintf(stderr, "Usage: %s in.bm out.pbm\n", pArgs[0]);
+		return EXIT_FAILURE;
+	}
+
+	tBitmapFile sBitmap;
+	if(!bitmapFileLoad(pArgs[1], &sBitmap)) {
+		return EXIT_FAILURE;
+	}
+
+	tBitmapPack sPack;
+	bitmapPackCreate(&sBitmap, &sPack);
+	int isOk = bitmapPackSave(pArgs[2], &sPack);
+	if(isOk) {
+		size_t ulRawSize = BITMAP_FILE_HEADER_SIZE +
+			(size_t)sBitmap.uwBytesPerRow * sBitmap.uwHeight * sBitmap.ubDepth;
+		printf(
+			"%s: %zu -> %zu bytes, methods:", pArgs[1], ulRawSize,
+			bitmapPackGetSize(&sPack)
+		);
+		for(uint8_t ubPlane = 0; ubPlane < sPack.ubDepth; ++ubPlane) {
+			printf(" %hhu", sPack.pPlanes[ubPlane].ubMethod);
+		}
+		printf("\n");
+	}
+
+	bitmapPackFree(&sPack);
+	bitmapFileFree(&sBitmap);
+	return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,127 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Reports packed bitmap ratio, host decode speed and estimated 68000 decode
+ * time compared to floppy read time saved by smaller file.
+ *
+ * Usage: bitmapPackBench file.bm [file.bm ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bitmap_pack_file.h"
+
+#define HOST_ITERATIONS 200
+
+// PAL 68000 clock and ideal DD floppy throughput: 11 sectors per revolution
+#define CPU_HZ 7093790.0
+#define FLOPPY_BYTES_PER_SEC (11 * 512 * 5.0)
+
+// Rough cycle costs of src/bitmap_pack.c inner loops on plain 68000
+#define CYCLES_PER_CONTROL 50
+#define CYCLES_PER_LITERAL 24
+#define CYCLES_PER_RUN_BYTE 16
+#define CYCLES_PER_DELTA_BYTE 16
+#define CYCLES_PER_ROW 40
+
+static double estimateCycles(const tBitmapPack *pPack, uint16_t uwBytesPerRow) {
+	double fCycles = 0;
+	size_t ulPlaneSize = (size_t)uwBytesPerRow * pPack->uwHeight;
+	for(uint8_t ubPlane = 0; ubPlane < pPack->ubDepth; ++ubPlane) {
+		const tBitmapPackPlane *pPlane = &pPack->pPlanes[ubPlane];
+		fCycles += (double)CYCLES_PER_ROW * pPack->uwHeight;
+		if(pPlane->ubMethod & BITMAP_PACK_METHOD_DELTA) {
+			fCycles += (double)CYCLES_PER_DELTA_BYTE * ulPlaneSize;
+		}
+		if(!(pPlane->ubMethod & BITMAP_PACK_METHOD_RLE)) {
+			fCycles += (double)CYCLES_PER_LITERAL * ulPlaneSize;
+			continue;
+		}
+		for(size_t i = 0; i < pPlane->ulSize;) {
+			uint8_t ubCtl = pPlane->pData[i++];
+			fCycles += CYCLES_PER_CONTROL;
+			if(ubCtl < 128) {
+				fCycles += CYCLES_PER_LITERAL * (ubCtl + 1);
+				i += ubCtl + 1;
+			}
+			else if(ubCtl > 128) {
+				fCycles += CYCLES_PER_RUN_BYTE * (257 - ubCtl);
+				++i;
+			}
+		}
+	}
+	return fCycles;
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 2) {
+		fprintf(stderr, "Usage: %s file.bm [file.bm ...]\n", pArgs[0]);
+		return EXIT_FAILURE;
+	}
+
+	printf(
+		"%-24s | %7s | %7s | %5s | %9s | %10s | %10s\n", "file", "raw", "packed",
+		"ratio", "host MB/s", "68k decode", "read saved"
+	);
+	int isOk = 1;
+	size_t ulRawTotal = 0, ulPackedTotal = 0;
+	double fDecodeTotal = 0;
+	for(int i = 1; i < lArgCount; ++i) {
+		tBitmapFile sBitmap;
+		if(!bitmapFileLoad(pArgs[i], &sBitmap)) {
+			isOk = 0;
+			continue;
+		}
+		size_t ulDataSize = (size_t)sBitmap.uwBytesPerRow * sBitmap.uwHeight * sBitmap.ubDepth;
+		size_t ulRawSize = BITMAP_FILE_HEADER_SIZE + ulDataSize;
+
+		tBitmapPack sPack;
+		bitmapPackCreate(&sBitmap, &sPack);
+		size_t ulPackedSize = bitmapPackGetSize(&sPack);
+
+		tBitmapFile sOut = sBitmap;
+		sOut.pData = malloc(ulDataSize);
+		clock_t llStart = clock();
+		for(int lIter = 0; lIter < HOST_ITERATIONS; ++lIter) {
+			if(!bitmapPackUnpack(&sPack, &sOut)) {
+				break;
+			}
+		}
+		double fHostSec = (double)(clock() - llStart) / CLOCKS_PER_SEC;
+		if(memcmp(sOut.pData, sBitmap.pData, ulDataSize)) {
+			fprintf(stderr, "ERR: Round trip mismatch for '%s'\n", pArgs[i]);
+			isOk = 0;
+		}
+
+		double fDecodeMs = 1000 * estimateCycles(&sPack, sBitmap.uwBytesPerRow) / CPU_HZ;
+		double fSavedMs = 1000 * (ulRawSize - (double)ulPackedSize) / FLOPPY_BYTES_PER_SEC;
+		const char *szName = strrchr(pArgs[i], '/');
+		printf(
+			"%-24s | %7zu | %7zu | %4.0f%% | %9.1f | %8.1fms | %8.1fms%s\n",
+			szName ? szName + 1 : pArgs[i], ulRawSize, ulPackedSize,
+			100.0 * ulPackedSize / ulRawSize,
+			fHostSec > 0 ? (ulDataSize * HOST_ITERATIONS) / fHostSec / 1e6 : 0,
+			fDecodeMs, fSavedMs, fDecodeMs < fSavedMs ? "" : " (slower than raw)"
+		);
+		ulRawTotal += ulRawSize;
+		ulPackedTotal += ulPackedSize;
+		fDecodeTotal += fDecodeMs;
+
+		free(sOut.pData);
+		bitmapPackFree(&sPack);
+		bitmapFileFree(&sBitmap);
+	}
+
+	if(ulRawTotal) {
+		printf(
+			"\ntotal: %zu -> %zu bytes, floppy read %.0fms -> %.0fms + %.0fms decode\n",
+			ulRawTotal, ulPackedTotal, 1000 * ulRawTotal / FLOPPY_BYTES_PER_SEC,
+			1000 * ulPackedTotal / FLOPPY_BYTES_PER_SEC, fDecodeTotal
+		);
+	}
+	return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
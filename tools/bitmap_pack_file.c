@@ -0,0 +1,211 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "bitmap_pack_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RLE_RUN_MIN 3
+#define RLE_LENGTH_MAX 128
+
+static void writeBeLong(uint8_t *pDst, uint32_t ulValue) {
+	writeBeWord(&pDst[0], ulValue >> 16);
+	writeBeWord(&pDst[2], ulValue & 0xFFFF);
+}
+
+static size_t getPlaneSize(const tBitmapFile *pBitmap) {
+	return (size_t)pBitmap->uwBytesPerRow * pBitmap->uwHeight;
+}
+
+static void planeRead(
+	const tBitmapFile *pBitmap, uint8_t ubPlane, int isDelta, uint8_t *pDst
+) {
+	for(uint16_t uwRow = 0; uwRow < pBitmap->uwHeight; ++uwRow) {
+		const uint8_t *pRow = bitmapFileGetRow(pBitmap, uwRow, ubPlane);
+		const uint8_t *pPrev = isDelta ? bitmapFileGetRow(pBitmap, uwRow, ubPlane - 1) : 0;
+		for(uint16_t i = 0; i < pBitmap->uwBytesPerRow; ++i) {
+			*(pDst++) = isDelta ? pRow[i] ^ pPrev[i] : pRow[i];
+		}
+	}
+}
+
+static size_t rlePack(const uint8_t *pSrc, size_t ulSize, uint8_t *pDst) {
+	// PackBits: n < 128 copies n + 1 literals, n > 128 repeats next byte 257 - n times
+	size_t ulOut = 0;
+	size_t ulPos = 0;
+	while(ulPos < ulSize) {
+		size_t ulRun = 1;
+		while(
+			ulPos + ulRun < ulSize && ulRun < RLE_LENGTH_MAX &&
+			pSrc[ulPos + ulRun] == pSrc[ulPos]
+		) {
+			++ulRun;
+		}
+		if(ulRun >= RLE_RUN_MIN) {
+			pDst[ulOut++] = 257 - ulRun;
+			pDst[ulOut++] = pSrc[ulPos];
+			ulPos += ulRun;
+			continue;
+		}
+
+		// Gather literals until next worthwhile run
+		size_t ulStart = ulPos;
+		while(ulPos < ulSize && ulPos - ulStart < RLE_LENGTH_MAX) {
+			if(
+				ulPos + RLE_RUN_MIN <= ulSize &&
+				pSrc[ulPos] == pSrc[ulPos + 1] && pSrc[ulPos] == pSrc[ulPos + 2]
+			) {
+				break;
+			}
+			++ulPos;
+		}
+		pDst[ulOut++] = ulPos - ulStart - 1;
+		memcpy(&pDst[ulOut], &pSrc[ulStart], ulPos - ulStart);
+		ulOut += ulPos - ulStart;
+	}
+	return ulOut;
+}
+
+static int rleUnpack(
+	const uint8_t *pSrc, size_t ulSize, uint8_t *pDst, size_t ulDstSize
+) {
+	const uint8_t *pEnd = pSrc + ulSize;
+	size_t ulOut = 0;
+	while(pSrc < pEnd) {
+		uint8_t ubCtl = *(pSrc++);
+		if(ubCtl < 128) {
+			size_t ulCount = ubCtl + 1;
+			if(pSrc + ulCount > pEnd || ulOut + ulCount > ulDstSize) {
+				return 0;
+			}
+			memcpy(&pDst[ulOut], pSrc, ulCount);
+			pSrc += ulCount;
+			ulOut += ulCount;
+		}
+		else if(ubCtl > 128) {
+			size_t ulCount = 257 - ubCtl;
+			if(pSrc >= pEnd || ulOut + ulCount > ulDstSize) {
+				return 0;
+			}
+			memset(&pDst[ulOut], *(pSrc++), ulCount);
+			ulOut += ulCount;
+		}
+	}
+	return ulOut == ulDstSize;
+}
+
+void bitmapPackCreate(const tBitmapFile *pBitmap, tBitmapPack *pPack) {
+	memset(pPack, 0, sizeof(*pPack));
+	pPack->uwWidth = pBitmap->uwWidth;
+	pPack->uwHeight = pBitmap->uwHeight;
+	pPack->ubDepth = pBitmap->ubDepth;
+	pPack->ubFlags = (
+		(pBitmap->ubFlags & BITMAP_FILE_FLAG_INTERLEAVED) ?
+		BITMAP_PACK_FLAG_INTERLEAVED : 0
+	);
+
+	size_t ulPlaneSize = getPlaneSize(pBitmap);
+	uint8_t *pStream = malloc(ulPlaneSize);
+	// PackBits worst case: one control byte per 128 literals
+	uint8_t *pPacked = malloc(ulPlaneSize + ulPlaneSize / RLE_LENGTH_MAX + 1);
+	for(uint8_t ubPlane = 0; ubPlane < pBitmap->ubDepth; ++ubPlane) {
+		tBitmapPackPlane *pPlane = &pPack->pPlanes[ubPlane];
+		pPlane->ulSize = SIZE_MAX;
+		uint8_t ubMethodCount = ubPlane ? 4 : 2;
+		for(uint8_t ubMethod = 0; ubMethod < ubMethodCount; ++ubMethod) {
+			planeRead(pBitmap, ubPlane, ubMethod & BITMAP_PACK_METHOD_DELTA, pStream);
+			const uint8_t *pOut = pStream;
+			size_t ulSize = ulPlaneSize;
+			if(ubMethod & BITMAP_PACK_METHOD_RLE) {
+				ulSize = rlePack(pStream, ulPlaneSize, pPacked);
+				pOut = pPacked;
+			}
+			if(ulSize < pPlane->ulSize) {
+				free(pPlane->pData);
+				pPlane->pData = malloc(ulSize ? ulSize : 1);
+				memcpy(pPlane->pData, pOut, ulSize);
+				pPlane->ulSize = ulSize;
+				pPlane->ubMethod = ubMethod;
+			}
+		}
+	}
+	free(pStream);
+	free(pPacked);
+}
+
+int bitmapPackUnpack(const tBitmapPack *pPack, tBitmapFile *pBitmap) {
+	size_t ulPlaneSize = getPlaneSize(pBitmap);
+	uint8_t *pStream = malloc(ulPlaneSize);
+	int isOk = 1;
+	for(uint8_t ubPlane = 0; isOk && ubPlane < pPack->ubDepth; ++ubPlane) {
+		const tBitmapPackPlane *pPlane = &pPack->pPlanes[ubPlane];
+		if(pPlane->ubMethod & BITMAP_PACK_METHOD_RLE) {
+			isOk = rleUnpack(pPlane->pData, pPlane->ulSize, pStream, ulPlaneSize);
+		}
+		else if(pPlane->ulSize == ulPlaneSize) {
+			memcpy(pStream, pPlane->pData, ulPlaneSize);
+		}
+		else {
+			isOk = 0;
+		}
+
+		const uint8_t *pSrc = pStream;
+		int isDelta = pPlane->ubMethod & BITMAP_PACK_METHOD_DELTA;
+		for(uint16_t uwRow = 0; isOk && uwRow < pBitmap->uwHeight; ++uwRow) {
+			uint8_t *pRow = bitmapFileGetRow(pBitmap, uwRow, ubPlane);
+			const uint8_t *pPrev = isDelta ? bitmapFileGetRow(pBitmap, uwRow, ubPlane - 1) : 0;
+			for(uint16_t i = 0; i < pBitmap->uwBytesPerRow; ++i) {
+				pRow[i] = isDelta ? *(pSrc++) ^ pPrev[i] : *(pSrc++);
+			}
+		}
+	}
+	free(pStream);
+	return isOk;
+}
+
+size_t bitmapPackGetSize(const tBitmapPack *pPack) {
+	size_t ulSize = BITMAP_PACK_HEADER_SIZE;
+	for(uint8_t ubPlane = 0; ubPlane < pPack->ubDepth; ++ubPlane) {
+		ulSize += BITMAP_PACK_PLANE_HEADER_SIZE + pPack->pPlanes[ubPlane].ulSize;
+	}
+	return ulSize;
+}
+
+int bitmapPackSave(const char *szPath, const tBitmapPack *pPack) {
+	FILE *pFile = fopen(szPath, "wb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s' for writing\n", szPath);
+		return 0;
+	}
+
+	uint8_t pHeader[BITMAP_PACK_HEADER_SIZE];
+	writeBeLong(&pHeader[0], BITMAP_PACK_MAGIC);
+	writeBeWord(&pHeader[4], pPack->uwWidth);
+	writeBeWord(&pHeader[6], pPack->uwHeight);
+	pHeader[8] = pPack->ubDepth;
+	pHeader[9] = pPack->ubFlags;
+	int isOk = fwrite(pHeader, sizeof(pHeader), 1, pFile) == 1;
+
+	// Plane headers go first so that game can read all data in one go
+	for(uint8_t ubPlane = 0; isOk && ubPlane < pPack->ubDepth; ++ubPlane) {
+		const tBitmapPackPlane *pPlane = &pPack->pPlanes[ubPlane];
+		uint8_t pPlaneHeader[BITMAP_PACK_PLANE_HEADER_SIZE] = {pPlane->ubMethod, 0};
+		writeBeLong(&pPlaneHeader[2], pPlane->ulSize);
+		isOk = fwrite(pPlaneHeader, sizeof(pPlaneHeader), 1, pFile) == 1;
+	}
+	for(uint8_t ubPlane = 0; isOk && ubPlane < pPack->ubDepth; ++ubPlane) {
+		const tBitmapPackPlane *pPlane = &pPack->pPlanes[ubPlane];
+		isOk = !pPlane->ulSize || fwrite(pPlane->pData, pPlane->ulSize, 1, pFile) == 1;
+	}
+	fclose(pFile);
+	return isOk;
+}
+
+void bitmapPackFree(tBitmapPack *pPack) {
+	for(uint8_t ubPlane = 0; ubPlane < pPack->ubDepth; ++ubPlane) {
+		free(pPack->pPlanes[ubPlane].pData);
+		pPack->pPlanes[ubPlane].pData = 0;
+	}
+}
@@ -0,0 +1,57 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_TOOLS_BITMAP_PACK_FILE_H
+#define INCLUDE_TOOLS_BITMAP_PACK_FILE_H
+
+/**
+ * Host side of packed bitmap container, see src/bitmap_pack.h for layout.
+ * Must be kept in sync with game's decoder.
+ */
+
+#include <stddef.h>
+#include "bitmap_file.h"
+
+#define BITMAP_PACK_MAGIC 0x43415042 // "CAPB"
+#define BITMAP_PACK_FLAG_INTERLEAVED 1
+#define BITMAP_PACK_HEADER_SIZE 10
+#define BITMAP_PACK_PLANE_HEADER_SIZE 6
+
+#define BITMAP_PACK_METHOD_RAW 0
+#define BITMAP_PACK_METHOD_RLE 1
+#define BITMAP_PACK_METHOD_DELTA 2 ///< Plane XOR-ed with previous one.
+
+typedef struct tBitmapPackPlane {
+	uint8_t ubMethod;
+	size_t ulSize;
+	uint8_t *pData;
+} tBitmapPackPlane;
+
+typedef struct tBitmapPack {
+	uint16_t uwWidth;
+	uint16_t uwHeight;
+	uint8_t ubDepth;
+	uint8_t ubFlags;
+	tBitmapPackPlane pPlanes[8];
+} tBitmapPack;
+
+/**
+ * @brief Packs each plane of bitmap with method giving smallest output.
+ */
+void bitmapPackCreate(const tBitmapFile *pBitmap, tBitmapPack *pPack);
+
+/**
+ * @brief Unpacks given pack into already allocated bitmap of same size.
+ *
+ * @return 1 on success, 0 on malformed data.
+ */
+int bitmapPackUnpack(const tBitmapPack *pPack, tBitmapFile *pBitmap);
+
+size_t bitmapPackGetSize(const tBitmapPack *pPack);
+
+int bitmapPackSave(const char *szPath, const tBitmapPack *pPack);
+
+void bitmapPackFree(tBitmapPack *pPack);
+
+#endif // INCLUDE_TOOLS_BITMAP_PACK_FILE_H
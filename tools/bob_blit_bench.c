@@ -0,0 +1,109 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Estimates blitter cost of drawing warrior bobs with and without pre-shifted
+ * frame cache (see src/frame_cache.c), using actual warrior mask data.
+ *
+ * Usage: bobBlitBench path/to/warrior_mask.bm [bobCount]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bitmap_file.h"
+
+#define FRAME_SIZE 16
+
+// Blitter cycles per word, from HRM blitter timing table
+#define CYCLES_PER_WORD_AD 4
+#define CYCLES_PER_WORD_ABCD 8
+
+// Bob manager per bob: background save (A->D), cookie-cut draw (ABCD),
+// background restore (A->D) on next frame.
+#define CYCLES_PER_BOB_WORD (2 * CYCLES_PER_WORD_AD + CYCLES_PER_WORD_ABCD)
+
+typedef struct tConfigResult {
+	uint8_t ubPhases;
+	double fAvgWords;
+	uint32_t ulChipBytes;
+} tConfigResult;
+
+static uint16_t getFrameMaskSum(const tBitmapFile *pMask, uint16_t uwFrame) {
+	uint16_t uwSum = 0;
+	for(uint16_t uwRow = 0; uwRow < FRAME_SIZE; ++uwRow) {
+		for(uint8_t ubPlane = 0; ubPlane < pMask->ubDepth; ++ubPlane) {
+			uwSum |= readBeWord(bitmapFileGetRow(pMask, uwFrame * FRAME_SIZE + uwRow, ubPlane));
+		}
+	}
+	return uwSum;
+}
+
+static tConfigResult benchConfig(const tBitmapFile *pMask, uint8_t ubPhases) {
+	uint16_t uwFrameCount = pMask->uwHeight / FRAME_SIZE;
+	uint32_t ulWordSum = 0;
+	uint32_t ulSamples = 0;
+	uint32_t ulChipBytes = 0;
+	for(uint16_t uwFrame = 0; uwFrame < uwFrameCount; ++uwFrame) {
+		uint16_t uwMaskSum = getFrameMaskSum(pMask, uwFrame);
+		for(uint8_t ubX = 0; ubX < 16; ++ubX) {
+			uint8_t ubWords;
+			if(!ubPhases) {
+				// Plain bob: shifted blit takes extra word unless aligned
+				ubWords = ubX ? 2 : 1;
+			}
+			else {
+				uint8_t ubPhase = ubX / (16 / ubPhases);
+				uint32_t ulShifted = ((uint32_t)uwMaskSum << 16) >> (ubPhase * (16 / ubPhases));
+				ubWords = ((ulShifted & 0xFFFF) && (ulShifted >> 16)) ? 2 : 1;
+				if(ubPhase && ubX % (16 / ubPhases) == 0) {
+					// Count cache size once per phase
+					ulChipBytes += 2 * ubWords * 2 * FRAME_SIZE * pMask->ubDepth;
+				}
+			}
+			ulWordSum += ubWords;
+			++ulSamples;
+		}
+	}
+
+	tConfigResult sResult = {
+		.ubPhases = ubPhases,
+		.fAvgWords = (double)ulWordSum / ulSamples,
+		.ulChipBytes = ulChipBytes
+	};
+	return sResult;
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 2) {
+		fprintf(stderr, "Usage: %s warrior_mask.bm [bobCount]\n", pArgs[0]);
+		return EXIT_FAILURE;
+	}
+
+	tBitmapFile sMask;
+	if(!bitmapFileLoad(pArgs[1], &sMask)) {
+		return EXIT_FAILURE;
+	}
+	int lBobCount = lArgCount >= 3 ? atoi(pArgs[2]) : 12;
+	uint32_t ulLinesPerBob = FRAME_SIZE * sMask.ubDepth;
+
+	printf(
+		"%u frames, %u bpp, %d bobs\n\n", sMask.uwHeight / FRAME_SIZE,
+		sMask.ubDepth, lBobCount
+	);
+	printf("phases | avg words | cycles/bob | cycles/frame | chip cache\n");
+	static const uint8_t pPhases[] = {0, 2, 4, 8};
+	for(size_t i = 0; i < sizeof(pPhases); ++i) {
+		tConfigResult sResult = benchConfig(&sMask, pPhases[i]);
+		double fCyclesPerBob = sResult.fAvgWords * ulLinesPerBob * CYCLES_PER_BOB_WORD;
+		printf(
+			"%6s | %9.3f | %10.0f | %12.0f | %10u\n",
+			sResult.ubPhases ? (char[]){'0' + sResult.ubPhases, 0} : "off",
+			sResult.fAvgWords, fCyclesPerBob, fCyclesPerBob * lBobCount,
+			sResult.ulChipBytes
+		);
+	}
+
+	bitmapFileFree(&sMask);
+	return EXIT_SUCCESS;
+}
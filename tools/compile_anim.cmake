@@ -0,0 +1,85 @@
+# Compiles text animation description into flat C table.
+# Usage: cmake -DSOURCE=<file.anim> -DDESTINATION=<file.h> -P compile_anim.cmake
+
+if(NOT SOURCE OR NOT DESTINATION)
+	message(FATAL_ERROR "SOURCE and DESTINATION must be set")
+endif()
+
+file(STRINGS ${SOURCE} ANIM_LINES)
+set(FRAMES "")
+set(ANIMS "")
+set(FRAME_COUNT 0)
+set(SHEET_FRAME_MAX 0)
+
+foreach(LINE IN LISTS ANIM_LINES)
+	string(REGEX REPLACE "#.*$" "" LINE "${LINE}")
+	string(STRIP "${LINE}" LINE)
+	if(LINE STREQUAL "")
+		continue()
+	endif()
+
+	string(REGEX REPLACE "[ \t]+" ";" TOKENS "${LINE}")
+	list(GET TOKENS 0 ANIM_NAME)
+	list(REMOVE_AT TOKENS 0)
+	string(TOUPPER "${ANIM_NAME}" ANIM_ENUM)
+	set(FIRST_FRAME ${FRAME_COUNT})
+	list(LENGTH TOKENS ANIM_FRAME_COUNT)
+	if(ANIM_FRAME_COUNT EQUAL 0)
+		message(FATAL_ERROR "${SOURCE}: animation '${ANIM_NAME}' has no frames")
+	endif()
+
+	foreach(TOKEN IN LISTS TOKENS)
+		if(NOT TOKEN MATCHES "^([0-9]+):([0-9]+)(:([a-z,]+))?$")
+			message(FATAL_ERROR "${SOURCE}: malformed frame '${TOKEN}' in '${ANIM_NAME}'")
+		endif()
+		set(SHEET_FRAME ${CMAKE_MATCH_1})
+		set(DURATION ${CMAKE_MATCH_2})
+		set(FLAG_NAMES "${CMAKE_MATCH_4}")
+		if(DURATION EQUAL 0 OR DURATION GREATER 255)
+			message(FATAL_ERROR "${SOURCE}: duration out of range in '${ANIM_NAME}'")
+		endif()
+		if(SHEET_FRAME GREATER SHEET_FRAME_MAX)
+			set(SHEET_FRAME_MAX ${SHEET_FRAME})
+		endif()
+
+		set(FLAGS "0")
+		string(REPLACE "," ";" FLAG_NAMES "${FLAG_NAMES}")
+		foreach(FLAG_NAME IN LISTS FLAG_NAMES)
+			if(NOT FLAG_NAME MATCHES "^(push|strike|fall)$")
+				message(FATAL_ERROR "${SOURCE}: unknown flag '${FLAG_NAME}' in '${ANIM_NAME}'")
+			endif()
+			string(TOUPPER "${FLAG_NAME}" FLAG_ENUM)
+			set(FLAGS "${FLAGS} | ANIM_FLAG_${FLAG_ENUM}")
+		endforeach()
+		string(REGEX REPLACE "^0 \\| " "" FLAGS "${FLAGS}")
+
+		string(APPEND FRAMES
+			"\t{.ubSheetFrame = ${SHEET_FRAME}, .ubDuration = ${DURATION}, .ubFlags = ${FLAGS}}, // ${ANIM_NAME}\n"
+		)
+		math(EXPR FRAME_COUNT "${FRAME_COUNT} + 1")
+	endforeach()
+
+	string(APPEND ANIMS
+		"\t[ANIM_${ANIM_ENUM}] = {.ubFirstFrame = ${FIRST_FRAME}, .ubFrameCount = ${ANIM_FRAME_COUNT}},\n"
+	)
+endforeach()
+
+math(EXPR SHEET_FRAME_COUNT "${SHEET_FRAME_MAX} + 1")
+get_filename_component(SOURCE_NAME ${SOURCE} NAME)
+set(CONTENT "// Generated from ${SOURCE_NAME} by compile_anim.cmake - don't edit.
+#define ANIM_SHEET_FRAMES_PER_DIRECTION ${SHEET_FRAME_COUNT}
+
+static const tAnimFrameDef s_pAnimFrames[] = {
+${FRAMES}};
+
+static const tAnimDef s_pAnimDefs[ANIM_COUNT] = {
+${ANIMS}};
+")
+
+# Don't touch the file if nothing changed, saves needless rebuilds
+if(EXISTS ${DESTINATION})
+	file(READ ${DESTINATION} OLD_CONTENT)
+endif()
+if(NOT "${OLD_CONTENT}" STREQUAL "${CONTENT}")
+	file(WRITE ${DESTINATION} "${CONTENT}")
+endif()
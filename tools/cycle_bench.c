@@ -0,0 +1,614 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Runs simulation image on Musashi 68000 core and counts its cycles.
+ *
+ * Usage: cycleBench cycleBench.elf scenario.txt [budgetCycles]
+ *
+ * Image is built by game's CMake with GAME_CYCLE_BENCH, see
+ * tools/cycle_bench_image.c. It's linked at absolute address, so its PT_LOAD
+ * segments are copied as-is into 16MB of flat RAM and its symbols are used
+ * both to call bench steps and to attribute each instruction's cycles to
+ * function it belongs to. Functions inlined by compiler count as their callers.
+ *
+ * Scenario is a text file:
+ *   seed 0x1234       - rng seed
+ *   players 0x3       - bit per menu player (joy 1-4, arrows, wsad), rest is AI
+ *   extra 1           - extra enemies
+ *   thunders 1        - thunder attacks
+ *   frames 3000       - number of frames to run
+ *   input 250 0x2 0x0 - from frame 250: bit per ACE joy code (JOY1 + JOY_UP
+ *                       is bit 1), bit per key as in cycle_bench_image.c
+ * Lines starting with '#' are ignored, inputs must be in frame order.
+ *
+ * Counts are Musashi's 68000 timings with no wait states - chip bus contention
+ * only makes things slower, so anything over budget here is over on hardware.
+ * Returns failure if any frame exceeds budget, default being whole PAL frame.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "m68k.h"
+#include "bitmap_file.h"
+
+#define BENCH_RAM_SIZE 0x1000000
+#define BENCH_ADDR_MASK (BENCH_RAM_SIZE - 1)
+#define BENCH_VECTOR_COUNT 256
+#define BENCH_RETURN_ADDR 0x300
+#define BENCH_EXCEPTION_ADDR 0x304
+#define BENCH_RESET_ADDR 0x308
+#define BENCH_STACK_TOP 0xC00000
+#define BENCH_CALL_CYCLES_MAX 50000000UL
+#define BENCH_PAL_FRAME_CYCLES 141875 // 7.09379 MHz / 50 Hz
+#define BENCH_HISTOGRAM_BUCKETS 11 // 10% each, last one is over budget
+#define BENCH_WORST_FRAMES 10
+#define BENCH_TOP_FUNCTIONS 20
+#define BENCH_LINE_SIZE 256
+#define BENCH_INPUT_MAX 4096
+#define OPCODE_STOP 0x4E72
+#define OPCODE_NOP 0x4E71
+
+#define ELF_PT_LOAD 1
+#define ELF_SHT_SYMTAB 2
+#define ELF_STT_OBJECT 1
+#define ELF_STT_FUNC 2
+
+typedef struct tSymbol {
+	const char *szName;
+	uint32_t ulAddr;
+	uint32_t ulSize;
+	uint8_t ubType;
+	uint64_t ullCycles;
+	uint32_t ulFrameCycles;
+	uint32_t ulFrameMax;
+} tSymbol;
+
+typedef struct tInput {
+	uint32_t ulFrame;
+	uint32_t ulJoy;
+	uint16_t uwKeys;
+} tInput;
+
+typedef struct tScenario {
+	uint32_t ulSeed;
+	uint8_t ubPlayers;
+	uint8_t ubExtraEnemies;
+	uint8_t ubThunders;
+	uint32_t ulFrames;
+	uint32_t ulInputCount;
+	tInput pInputs[BENCH_INPUT_MAX];
+} tScenario;
+
+typedef struct tStep {
+	const char *szName;
+	const tSymbol *pSymbol;
+	uint64_t ullCycles;
+	uint32_t ulMax;
+	uint32_t ulMaxFrame;
+} tStep;
+
+typedef struct tFrameCost {
+	uint32_t ulFrame;
+	uint32_t ulCycles;
+} tFrameCost;
+
+static uint8_t *s_pRam;
+static uint8_t *s_pElf;
+static tSymbol *s_pSymbols;
+static uint32_t s_ulSymbolCount;
+static tSymbol **s_pFunctions; // sorted by address
+static uint32_t s_ulFunctionCount;
+static tSymbol *s_pLastFunction;
+
+// Called in order each frame, same as in gameGsLoop()
+static tStep s_pSteps[] = {
+	{.szName = "benchStreamProcess"},
+	{.szName = "benchCrumbleProcess"},
+	{.szName = "schedulerProcess"},
+	{.szName = "inputProcess"},
+	{.szName = "warriorsProcess"},
+	{.szName = "sfxProcessEvents"},
+	{.szName = "eventsEndFrame"},
+};
+#define BENCH_STEP_COUNT (sizeof(s_pSteps) / sizeof(s_pSteps[0]))
+
+//---------------------------------------------------------------------- MUSASHI
+
+unsigned int m68k_read_memory_8(unsigned int ulAddr) {
+	return s_pRam[ulAddr & BENCH_ADDR_MASK];
+}
+
+unsigned int m68k_read_memory_16(unsigned int ulAddr) {
+	return readBeWord(&s_pRam[ulAddr & BENCH_ADDR_MASK & ~1]);
+}
+
+unsigned int m68k_read_memory_32(unsigned int ulAddr) {
+	return (m68k_read_memory_16(ulAddr) << 16) | m68k_read_memory_16(ulAddr + 2);
+}
+
+void m68k_write_memory_8(unsigned int ulAddr, unsigned int ulValue) {
+	s_pRam[ulAddr & BENCH_ADDR_MASK] = ulValue;
+}
+
+void m68k_write_memory_16(unsigned int ulAddr, unsigned int ulValue) {
+	writeBeWord(&s_pRam[ulAddr & BENCH_ADDR_MASK & ~1], ulValue);
+}
+
+void m68k_write_memory_32(unsigned int ulAddr, unsigned int ulValue) {
+	m68k_write_memory_16(ulAddr, ulValue >> 16);
+	m68k_write_memory_16(ulAddr + 2, ulValue);
+}
+
+//------------------------------------------------------------------------- ELF
+
+static uint32_t readBeLong(const uint8_t *pSrc) {
+	return ((uint32_t)readBeWord(&pSrc[0]) << 16) | readBeWord(&pSrc[2]);
+}
+
+static int compareFunctions(const void *pA, const void *pB) {
+	uint32_t ulA = (*(const tSymbol * const *)pA)->ulAddr;
+	uint32_t ulB = (*(const tSymbol * const *)pB)->ulAddr;
+	return (ulA > ulB) - (ulA < ulB);
+}
+
+static int elfLoad(const char *szPath) {
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szPath);
+		return 0;
+	}
+	fseek(pFile, 0, SEEK_END);
+	size_t ulSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	s_pElf = malloc(ulSize ? ulSize : 1);
+	size_t ulRead = fread(s_pElf, 1, ulSize, pFile);
+	fclose(pFile);
+	if(
+		ulRead != ulSize || ulSize < 52 || memcmp(s_pElf, "\x7F" "ELF", 4) ||
+		s_pElf[4] != 1 || s_pElf[5] != 2 || readBeWord(&s_pElf[18]) != 4
+	) {
+		fprintf(stderr, "ERR: '%s' is not 32-bit big endian 68k ELF\n", szPath);
+		return 0;
+	}
+
+	uint32_t ulPhOffs = readBeLong(&s_pElf[28]);
+	uint32_t ulShOffs = readBeLong(&s_pElf[32]);
+	uint16_t uwPhSize = readBeWord(&s_pElf[42]);
+	uint16_t uwPhCount = readBeWord(&s_pElf[44]);
+	uint16_t uwShSize = readBeWord(&s_pElf[46]);
+	uint16_t uwShCount = readBeWord(&s_pElf[48]);
+	if(
+		ulPhOffs + (size_t)uwPhSize * uwPhCount > ulSize ||
+		ulShOffs + (size_t)uwShSize * uwShCount > ulSize
+	) {
+		fprintf(stderr, "ERR: '%s' is truncated\n", szPath);
+		return 0;
+	}
+
+	for(uint16_t i = 0; i < uwPhCount; ++i) {
+		const uint8_t *pPh = &s_pElf[ulPhOffs + i * uwPhSize];
+		if(readBeLong(&pPh[0]) != ELF_PT_LOAD) {
+			continue;
+		}
+		uint32_t ulOffs = readBeLong(&pPh[4]);
+		uint32_t ulAddr = readBeLong(&pPh[8]);
+		uint32_t ulFileSize = readBeLong(&pPh[16]);
+		uint32_t ulMemSize = readBeLong(&pPh[20]);
+		if(
+			ulAddr < BENCH_VECTOR_COUNT * 4 || ulAddr + ulMemSize > BENCH_STACK_TOP / 2 ||
+			ulOffs + ulFileSize > ulSize || ulFileSize > ulMemSize
+		) {
+			fprintf(
+				stderr, "ERR: Segment at 0x%X, size %u doesn't fit, link image at 0x400\n",
+				ulAddr, ulMemSize
+			);
+			return 0;
+		}
+		memcpy(&s_pRam[ulAddr], &s_pElf[ulOffs], ulFileSize);
+		memset(&s_pRam[ulAddr + ulFileSize], 0, ulMemSize - ulFileSize);
+	}
+
+	for(uint16_t i = 0; i < uwShCount; ++i) {
+		const uint8_t *pSh = &s_pElf[ulShOffs + i * uwShSize];
+		if(readBeLong(&pSh[4]) != ELF_SHT_SYMTAB) {
+			continue;
+		}
+		const uint8_t *pStrSh = &s_pElf[ulShOffs + readBeLong(&pSh[24]) * uwShSize];
+		const char *pStrings = (const char*)&s_pElf[readBeLong(&pStrSh[16])];
+		uint32_t ulSymOffs = readBeLong(&pSh[16]);
+		uint32_t ulSymCount = readBeLong(&pSh[20]) / 16;
+		s_pSymbols = calloc(ulSymCount, sizeof(tSymbol));
+		for(uint32_t j = 0; j < ulSymCount; ++j) {
+			const uint8_t *pSym = &s_pElf[ulSymOffs + j * 16];
+			uint8_t ubType = pSym[12] & 0xF;
+			if(ubType != ELF_STT_FUNC && ubType != ELF_STT_OBJECT) {
+				continue;
+			}
+			tSymbol *pSymbol = &s_pSymbols[s_ulSymbolCount++];
+			pSymbol->szName = &pStrings[readBeLong(&pSym[0])];
+			pSymbol->ulAddr = readBeLong(&pSym[4]);
+			pSymbol->ulSize = readBeLong(&pSym[8]);
+			pSymbol->ubType = ubType;
+		}
+	}
+	if(!s_ulSymbolCount) {
+		fprintf(stderr, "ERR: '%s' has no symbols, don't strip it\n", szPath);
+		return 0;
+	}
+
+	s_pFunctions = malloc(s_ulSymbolCount * sizeof(tSymbol*));
+	for(uint32_t i = 0; i < s_ulSymbolCount; ++i) {
+		if(s_pSymbols[i].ubType == ELF_STT_FUNC) {
+			s_pFunctions[s_ulFunctionCount++] = &s_pSymbols[i];
+		}
+	}
+	qsort(s_pFunctions, s_ulFunctionCount, sizeof(tSymbol*), compareFunctions);
+	return 1;
+}
+
+static tSymbol *symbolFind(const char *szName, uint8_t ubType) {
+	for(uint32_t i = 0; i < s_ulSymbolCount; ++i) {
+		if(s_pSymbols[i].ubType == ubType && !strcmp(s_pSymbols[i].szName, szName)) {
+			return &s_pSymbols[i];
+		}
+	}
+	fprintf(stderr, "ERR: No symbol '%s' in image\n", szName);
+	return 0;
+}
+
+static tSymbol *functionAt(uint32_t ulPc) {
+	if(
+		s_pLastFunction && ulPc >= s_pLastFunction->ulAddr &&
+		ulPc < s_pLastFunction->ulAddr + s_pLastFunction->ulSize
+	) {
+		return s_pLastFunction;
+	}
+	uint32_t ulLo = 0, ulHi = s_ulFunctionCount;
+	while(ulLo < ulHi) {
+		uint32_t ulMid = (ulLo + ulHi) / 2;
+		if(s_pFunctions[ulMid]->ulAddr <= ulPc) {
+			ulLo = ulMid + 1;
+		}
+		else {
+			ulHi = ulMid;
+		}
+	}
+	if(ulLo && ulPc < s_pFunctions[ulLo - 1]->ulAddr + s_pFunctions[ulLo - 1]->ulSize) {
+		s_pLastFunction = s_pFunctions[ulLo - 1];
+		return s_pLastFunction;
+	}
+	return 0;
+}
+
+static int variableSet(const char *szName, uint32_t ulValue) {
+	const tSymbol *pVar = symbolFind(szName, ELF_STT_OBJECT);
+	if(!pVar) {
+		return 0;
+	}
+	switch(pVar->ulSize) {
+		case 1: m68k_write_memory_8(pVar->ulAddr, ulValue); break;
+		case 2: m68k_write_memory_16(pVar->ulAddr, ulValue); break;
+		case 4: m68k_write_memory_32(pVar->ulAddr, ulValue); break;
+		default:
+			fprintf(stderr, "ERR: Unexpected size of '%s': %u\n", szName, pVar->ulSize);
+			return 0;
+	}
+	return 1;
+}
+
+//-------------------------------------------------------------------- SCENARIO
+
+static int scenarioLoad(const char *szPath, tScenario *pScenario) {
+	FILE *pFile = fopen(szPath, "r");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szPath);
+		return 0;
+	}
+	memset(pScenario, 0, sizeof(*pScenario));
+	char szLine[BENCH_LINE_SIZE];
+	uint32_t ulLine = 0;
+	int isOk = 1;
+	while(isOk && fgets(szLine, sizeof(szLine), pFile)) {
+		++ulLine;
+		char szKey[16];
+		long pValues[3];
+		int lCount = sscanf(
+			szLine, "%15s %li %li %li", szKey, &pValues[0], &pValues[1], &pValues[2]
+		);
+		if(lCount <= 0 || szKey[0] == '#') {
+			continue;
+		}
+		if(!strcmp(szKey, "seed") && lCount == 2) {
+			pScenario->ulSeed = pValues[0];
+		}
+		else if(!strcmp(szKey, "players") && lCount == 2) {
+			pScenario->ubPlayers = pValues[0];
+		}
+		else if(!strcmp(szKey, "extra") && lCount == 2) {
+			pScenario->ubExtraEnemies = pValues[0];
+		}
+		else if(!strcmp(szKey, "thunders") && lCount == 2) {
+			pScenario->ubThunders = pValues[0];
+		}
+		else if(!strcmp(szKey, "frames") && lCount == 2) {
+			pScenario->ulFrames = pValues[0];
+		}
+		else if(!strcmp(szKey, "input") && lCount == 4) {
+			tInput *pPrev = (
+				pScenario->ulInputCount ? &pScenario->pInputs[pScenario->ulInputCount - 1] : 0
+			);
+			if(pScenario->ulInputCount >= BENCH_INPUT_MAX) {
+				fprintf(stderr, "ERR: %s:%u: too many inputs\n", szPath, ulLine);
+				isOk = 0;
+			}
+			else if(pPrev && (long)pPrev->ulFrame > pValues[0]) {
+				fprintf(stderr, "ERR: %s:%u: input out of frame order\n", szPath, ulLine);
+				isOk = 0;
+			}
+			else {
+				pScenario->pInputs[pScenario->ulInputCount++] = (tInput){
+					.ulFrame = pValues[0], .ulJoy = pValues[1], .uwKeys = pValues[2]
+				};
+			}
+		}
+		else {
+			fprintf(stderr, "ERR: %s:%u: can't parse '%s'\n", szPath, ulLine, szKey);
+			isOk = 0;
+		}
+	}
+	fclose(pFile);
+	if(isOk && !pScenario->ulFrames) {
+		fprintf(stderr, "ERR: %s: no frames to run\n", szPath);
+		isOk = 0;
+	}
+	return isOk;
+}
+
+//------------------------------------------------------------------------- RUN
+
+/**
+ * Calls function at given address and runs it until it returns.
+ * @return Number of cycles spent, 0 on exception or runaway.
+ */
+static uint32_t benchCall(const tSymbol *pFunction) {
+	m68k_set_reg(M68K_REG_SP, BENCH_STACK_TOP - 4);
+	m68k_write_memory_32(BENCH_STACK_TOP - 4, BENCH_RETURN_ADDR);
+	m68k_set_reg(M68K_REG_PC, pFunction->ulAddr);
+
+	uint32_t ulCycles = 0;
+	for(;;) {
+		uint32_t ulPc = m68k_get_reg(NULL, M68K_REG_PC);
+		if(ulPc == BENCH_RETURN_ADDR) {
+			return ulCycles;
+		}
+		if(ulPc == BENCH_EXCEPTION_ADDR || ulCycles > BENCH_CALL_CYCLES_MAX) {
+			fprintf(
+				stderr, "ERR: %s in %s(), last function: %s\n",
+				ulPc == BENCH_EXCEPTION_ADDR ? "CPU exception" : "Runaway",
+				pFunction->szName, s_pLastFunction ? s_pLastFunction->szName : "?"
+			);
+			return 0;
+		}
+		// One instruction at a time, so that each gets attributed exactly
+		int lStepCycles = m68k_execute(1);
+		tSymbol *pOwner = functionAt(ulPc);
+		if(pOwner) {
+			pOwner->ullCycles += lStepCycles;
+			pOwner->ulFrameCycles += lStepCycles;
+		}
+		ulCycles += lStepCycles;
+	}
+}
+
+static int compareFrameCosts(const void *pA, const void *pB) {
+	uint32_t ulA = ((const tFrameCost*)pA)->ulCycles;
+	uint32_t ulB = ((const tFrameCost*)pB)->ulCycles;
+	return (ulA < ulB) - (ulA > ulB);
+}
+
+static int compareFunctionCycles(const void *pA, const void *pB) {
+	uint64_t ullA = (*(const tSymbol * const *)pA)->ullCycles;
+	uint64_t ullB = (*(const tSymbol * const *)pB)->ullCycles;
+	return (ullA < ullB) - (ullA > ullB);
+}
+
+static void functionsFrameEnd(void) {
+	for(uint32_t i = 0; i < s_ulFunctionCount; ++i) {
+		tSymbol *pFunction = s_pFunctions[i];
+		if(pFunction->ulFrameCycles > pFunction->ulFrameMax) {
+			pFunction->ulFrameMax = pFunction->ulFrameCycles;
+		}
+		pFunction->ulFrameCycles = 0;
+	}
+}
+
+static void printReport(
+	const tScenario *pScenario, tFrameCost *pFrames, uint32_t ulBudget
+) {
+	uint64_t ullTotal = 0;
+	uint32_t pHistogram[BENCH_HISTOGRAM_BUCKETS] = {0};
+	for(uint32_t i = 0; i < pScenario->ulFrames; ++i) {
+		ullTotal += pFrames[i].ulCycles;
+		uint32_t ulBucket = (uint32_t)((uint64_t)pFrames[i].ulCycles * 10 / ulBudget);
+		if(ulBucket >= BENCH_HISTOGRAM_BUCKETS) {
+			ulBucket = BENCH_HISTOGRAM_BUCKETS - 1;
+		}
+		++pHistogram[ulBucket];
+	}
+
+	printf("%-24s %10s %10s %8s\n", "Step", "Avg", "Max", "@Frame");
+	for(uint32_t i = 0; i < BENCH_STEP_COUNT; ++i) {
+		const tStep *pStep = &s_pSteps[i];
+		printf(
+			"%-24s %10llu %10u %8u\n", pStep->szName,
+			(unsigned long long)(pStep->ullCycles / pScenario->ulFrames),
+			pStep->ulMax, pStep->ulMaxFrame
+		);
+	}
+
+	qsort(pFrames, pScenario->ulFrames, sizeof(*pFrames), compareFrameCosts);
+	printf(
+		"%-24s %10llu %10u %8u\n", "Frame total",
+		(unsigned long long)(ullTotal / pScenario->ulFrames),
+		pFrames[0].ulCycles, pFrames[0].ulFrame
+	);
+
+	printf("\n%-32s %12s %10s %6s\n", "Function (self)", "Total", "Frame max", "Share");
+	qsort(s_pFunctions, s_ulFunctionCount, sizeof(tSymbol*), compareFunctionCycles);
+	for(uint32_t i = 0; i < s_ulFunctionCount && i < BENCH_TOP_FUNCTIONS; ++i) {
+		const tSymbol *pFunction = s_pFunctions[i];
+		if(!pFunction->ullCycles) {
+			break;
+		}
+		printf(
+			"%-32s %12llu %10u %5.1f%%\n", pFunction->szName,
+			(unsigned long long)pFunction->ullCycles, pFunction->ulFrameMax,
+			100.0 * pFunction->ullCycles / ullTotal
+		);
+	}
+
+	printf("\nWorst frames (budget %u cycles):\n", ulBudget);
+	for(uint32_t i = 0; i < pScenario->ulFrames && i < BENCH_WORST_FRAMES; ++i) {
+		printf(
+			"  frame %6u: %7u cycles, %5.1f%%\n", pFrames[i].ulFrame,
+			pFrames[i].ulCycles, 100.0 * pFrames[i].ulCycles / ulBudget
+		);
+	}
+
+	printf("\nFrame cost histogram:\n");
+	for(uint8_t i = 0; i < BENCH_HISTOGRAM_BUCKETS; ++i) {
+		if(i == BENCH_HISTOGRAM_BUCKETS - 1) {
+			printf("  over 100%%: %6u ", pHistogram[i]);
+		}
+		else {
+			printf("  %3u-%3u%%: %6u ", i * 10, (i + 1) * 10, pHistogram[i]);
+		}
+		uint32_t ulBar = (uint32_t)((uint64_t)pHistogram[i] * 50 / pScenario->ulFrames);
+		for(uint32_t j = 0; j < ulBar; ++j) {
+			putchar('#');
+		}
+		putchar('\n');
+	}
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 3) {
+		fprintf(stderr, "Usage: %s cycleBench.elf scenario.txt [budgetCycles]\n", pArgs[0]);
+		return EXIT_FAILURE;
+	}
+	uint32_t ulBudget = (lArgCount > 3) ? strtoul(pArgs[3], 0, 0) : BENCH_PAL_FRAME_CYCLES;
+	if(!ulBudget) {
+		fprintf(stderr, "ERR: Invalid budget: '%s'\n", pArgs[3]);
+		return EXIT_FAILURE;
+	}
+
+	static tScenario s_sScenario;
+	s_pRam = calloc(BENCH_RAM_SIZE, 1);
+	if(!elfLoad(pArgs[1]) || !scenarioLoad(pArgs[2], &s_sScenario)) {
+		return EXIT_FAILURE;
+	}
+
+	// Every exception lands on STOP which is never executed, same for return address
+	m68k_write_memory_32(0, BENCH_STACK_TOP);
+	m68k_write_memory_32(4, BENCH_RESET_ADDR);
+	for(uint16_t i = 2; i < BENCH_VECTOR_COUNT; ++i) {
+		m68k_write_memory_32(i * 4, BENCH_EXCEPTION_ADDR);
+	}
+	m68k_write_memory_16(BENCH_RETURN_ADDR, OPCODE_STOP);
+	m68k_write_memory_16(BENCH_RETURN_ADDR + 2, 0x2700);
+	m68k_write_memory_16(BENCH_EXCEPTION_ADDR, OPCODE_STOP);
+	m68k_write_memory_16(BENCH_EXCEPTION_ADDR + 2, 0x2700);
+	m68k_write_memory_16(BENCH_RESET_ADDR, OPCODE_NOP);
+
+	m68k_init();
+	m68k_set_cpu_type(M68K_CPU_TYPE_68000);
+	m68k_pulse_reset();
+	// Newer Musashi accounts reset cycles on first execute, keep them out of stats
+	m68k_execute(1);
+
+	const tSymbol *pCreate = symbolFind("benchCreate", ELF_STT_FUNC);
+	const tSymbol *pOutOfMemory = symbolFind("g_isBenchOutOfMemory", ELF_STT_OBJECT);
+	int isOk = (pCreate && pOutOfMemory);
+	for(uint32_t i = 0; i < BENCH_STEP_COUNT; ++i) {
+		s_pSteps[i].pSymbol = symbolFind(s_pSteps[i].szName, ELF_STT_FUNC);
+		isOk = isOk && s_pSteps[i].pSymbol;
+	}
+	isOk = (
+		isOk &&
+		variableSet("g_ulBenchSeed", s_sScenario.ulSeed) &&
+		variableSet("g_ubBenchPlayers", s_sScenario.ubPlayers) &&
+		variableSet("g_ubBenchExtraEnemies", s_sScenario.ubExtraEnemies) &&
+		variableSet("g_ubBenchThunders", s_sScenario.ubThunders) &&
+		variableSet("g_ulBenchJoy", 0) && variableSet("g_uwBenchKeys", 0)
+	);
+	if(!isOk) {
+		return EXIT_FAILURE;
+	}
+
+	uint32_t ulCreateCycles = benchCall(pCreate);
+	if(!ulCreateCycles) {
+		return EXIT_FAILURE;
+	}
+	if(m68k_read_memory_8(pOutOfMemory->ulAddr)) {
+		fprintf(stderr, "ERR: Image ran out of memory in benchCreate()\n");
+		return EXIT_FAILURE;
+	}
+	printf("benchCreate: %u cycles\n", ulCreateCycles);
+	functionsFrameEnd();
+	for(uint32_t i = 0; i < s_ulFunctionCount; ++i) {
+		// Only per-frame work goes into function stats
+		s_pFunctions[i]->ullCycles = 0;
+		s_pFunctions[i]->ulFrameMax = 0;
+	}
+
+	tFrameCost *pFrames = malloc(s_sScenario.ulFrames * sizeof(tFrameCost));
+	uint32_t ulNextInput = 0;
+	uint32_t ulOverBudget = 0;
+	for(uint32_t ulFrame = 0; ulFrame < s_sScenario.ulFrames; ++ulFrame) {
+		while(
+			ulNextInput < s_sScenario.ulInputCount &&
+			s_sScenario.pInputs[ulNextInput].ulFrame <= ulFrame
+		) {
+			const tInput *pInput = &s_sScenario.pInputs[ulNextInput++];
+			variableSet("g_ulBenchJoy", pInput->ulJoy);
+			variableSet("g_uwBenchKeys", pInput->uwKeys);
+		}
+
+		uint32_t ulFrameCycles = 0;
+		for(uint32_t i = 0; i < BENCH_STEP_COUNT; ++i) {
+			tStep *pStep = &s_pSteps[i];
+			uint32_t ulCycles = benchCall(pStep->pSymbol);
+			if(!ulCycles) {
+				fprintf(stderr, "ERR: ...at frame %u\n", ulFrame);
+				return EXIT_FAILURE;
+			}
+			pStep->ullCycles += ulCycles;
+			if(ulCycles > pStep->ulMax) {
+				pStep->ulMax = ulCycles;
+				pStep->ulMaxFrame = ulFrame;
+			}
+			ulFrameCycles += ulCycles;
+		}
+		if(m68k_read_memory_8(pOutOfMemory->ulAddr)) {
+			fprintf(stderr, "ERR: Image ran out of memory at frame %u\n", ulFrame);
+			return EXIT_FAILURE;
+		}
+		functionsFrameEnd();
+		pFrames[ulFrame] = (tFrameCost){.ulFrame = ulFrame, .ulCycles = ulFrameCycles};
+		if(ulFrameCycles > ulBudget) {
+			++ulOverBudget;
+		}
+	}
+
+	printf("%s: %u frames\n\n", pArgs[2], s_sScenario.ulFrames);
+	printReport(&s_sScenario, pFrames, ulBudget);
+	free(pFrames);
+	if(ulOverBudget) {
+		printf("\n%u frames over budget\n", ulOverBudget);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
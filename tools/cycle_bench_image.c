@@ -0,0 +1,351 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Glue for simulation image run by tools/cycle_bench.c.
+ *
+ * Cross-compiled together with warrior.c, tile.c, ai.c, steer.c and their
+ * pure-logic dependencies instead of ACE - engine and hardware calls are
+ * stubbed here, so the image runs on bare 68000 core without any chipset.
+ * Blitter register writes in tile.c land in emulated RAM at $DFF000 and are
+ * counted like any other write, but the blits themselves don't happen.
+ *
+ * Host tool sets g_*Bench* variables by their symbols and calls
+ * benchCreate() followed by bench*Process() steps each frame.
+ */
+
+#include <ace/managers/bob.h>
+#include <ace/managers/blit.h>
+#include <ace/managers/joy.h>
+#include <ace/managers/key.h>
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include <ace/managers/sprite.h>
+#include <ace/managers/ptplayer.h>
+#include <ace/utils/custom.h>
+#include <mini_std/stdlib.h>
+#include "assets.h"
+#include "display.h"
+#include "event.h"
+#include "game.h"
+#include "menu.h"
+#include "rng.h"
+#include "scheduler.h"
+#include "tile.h"
+#include "warrior.h"
+
+#define BENCH_ARENA_SIZE 32768
+#define BENCH_SPRITE_MAX 4
+#define BENCH_PLAYER_MAX 6
+#define BENCH_KEY_COUNT 10
+#define BENCH_BUFFER_HEIGHT (DISPLAY_HEIGHT + MAP_TILE_SIZE)
+// Same as in game.c: first step after a tick, then 4 phases
+#define BENCH_COUNTDOWN_TICKS (1 + 4 * 50)
+// Bitmaps are never read by CPU, so their planes may point anywhere
+#define BENCH_PLANE_ADDR 0x80000
+
+// Set by host before benchCreate()
+ULONG g_ulBenchSeed;
+UBYTE g_ubBenchPlayers; ///< Bit per menu player, same order as in menu.c.
+UBYTE g_ubBenchExtraEnemies;
+UBYTE g_ubBenchThunders;
+// Set by host before each frame
+ULONG g_ulBenchJoy; ///< Bit per ACE joy code, e.g. JOY2 + JOY_FIRE.
+UWORD g_uwBenchKeys; ///< Arrows, then WSAD, each in JOY_FIRE..JOY_RIGHT order.
+// Read by host after each call
+UBYTE g_isBenchOutOfMemory;
+
+tCustom FAR REGPTR g_pCustom = (tCustom*)0xDFF000;
+
+tBitMap *g_pWarriorFrames;
+tBitMap *g_pWarriorMasks;
+tBitMap *g_pTileset;
+tBitMap *g_pTilesetMask;
+tBitMap *g_pFramesThunder[2];
+tBitMap *g_pFramesCross;
+tPtplayerSfx *g_pSfxNo;
+tPtplayerSfx *g_pSfxSwipes[2];
+tPtplayerSfx *g_pSfxSwipeHit;
+tPtplayerSfx *g_pSfxCrumble;
+tPtplayerSfx *g_pSfxThunder;
+
+static UBYTE s_pArena[BENCH_ARENA_SIZE];
+static ULONG s_ulArenaUsed;
+static tBitMap s_sBitMap;
+static tCameraManager s_sCamera;
+static tScrollBufferManager s_sManager;
+static tSprite s_pSprites[BENCH_SPRITE_MAX];
+static UBYTE s_ubSpriteCount;
+static UBYTE s_isCountdownActive;
+static UBYTE s_isCrumbling;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static void *benchAlloc(ULONG ulSize) {
+	ulSize = (ulSize + 3) & ~3;
+	if(s_ulArenaUsed + ulSize > BENCH_ARENA_SIZE) {
+		g_isBenchOutOfMemory = 1;
+		return 0;
+	}
+	void *pMem = &s_pArena[s_ulArenaUsed];
+	s_ulArenaUsed += ulSize;
+	return pMem;
+}
+
+static void onCrumbleStart(void *pData) {
+	s_isCrumbling = 1;
+	tileCrumbleStart();
+}
+
+static void onCountdownDone(void *pData) {
+	s_isCountdownActive = 0;
+	warriorsEnableMove(1);
+	schedulerAdd(1, onCrumbleStart, 0);
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void benchCreate(void) {
+	s_sBitMap.BytesPerRow = (DISPLAY_WIDTH / 8) * DISPLAY_BPP;
+	s_sBitMap.Rows = BENCH_BUFFER_HEIGHT;
+	s_sBitMap.Depth = DISPLAY_BPP;
+	s_sBitMap.Flags = BMF_INTERLEAVED;
+	for(UBYTE i = 0; i < DISPLAY_BPP; ++i) {
+		s_sBitMap.Planes[i] = (UBYTE*)BENCH_PLANE_ADDR + i * (DISPLAY_WIDTH / 8);
+	}
+	g_pWarriorFrames = &s_sBitMap;
+	g_pWarriorMasks = &s_sBitMap;
+	g_pTileset = &s_sBitMap;
+	g_pTilesetMask = &s_sBitMap;
+	g_pFramesThunder[0] = &s_sBitMap;
+	g_pFramesThunder[1] = &s_sBitMap;
+	g_pFramesCross = &s_sBitMap;
+	s_sManager.pCamera = &s_sCamera;
+	s_sManager.pBack = &s_sBitMap;
+	s_sManager.pFront = &s_sBitMap;
+	s_sManager.uwBmAvailHeight = BENCH_BUFFER_HEIGHT;
+
+	rngInit(g_ulBenchSeed);
+	schedulerReset();
+	tilesInit();
+	warriorsCreate(g_ubBenchExtraEnemies);
+	eventsReset();
+	tilesReload();
+	tilesStreamReset(s_sCamera.uPos.uwY);
+	warriorsEnableMove(0);
+	s_isCountdownActive = 1;
+	s_isCrumbling = 0;
+	schedulerAdd(BENCH_COUNTDOWN_TICKS, onCountdownDone, 0);
+}
+
+void benchStreamProcess(void) {
+	// Camera snaps to warriors instead of easing like displayCameraFollow()
+	tUwCoordYX sCenter;
+	if(warriorsGetAliveCenter(&sCenter)) {
+		UWORD uwMaxY = tileGetMapHeight() * MAP_TILE_SIZE;
+		uwMaxY = (uwMaxY > DISPLAY_HEIGHT) ? uwMaxY - DISPLAY_HEIGHT : 0;
+		UWORD uwY = (sCenter.uwY > DISPLAY_HEIGHT / 2) ? sCenter.uwY - DISPLAY_HEIGHT / 2 : 0;
+		s_sCamera.uPos.uwY = MIN(uwY, uwMaxY);
+	}
+	tilesStreamProcess(&s_sBitMap, s_sCamera.uPos.uwY);
+}
+
+void benchCrumbleProcess(void) {
+	if(s_isCrumbling) {
+		tileCrumbleProcess(&s_sBitMap);
+	}
+}
+
+//------------------------------------------------------------------ GAME STUBS
+
+UBYTE gameIsCountdownActive(void) {
+	return s_isCountdownActive;
+}
+
+tSteerMode menuGetSteerModeForPlayer(UBYTE ubPlayerIndex) {
+	static const tSteerMode pSteersForPlayers[BENCH_PLAYER_MAX] = {
+		STEER_MODE_JOY_1, STEER_MODE_JOY_2, STEER_MODE_JOY_3, STEER_MODE_JOY_4,
+		STEER_MODE_KEY_ARROWS, STEER_MODE_KEY_WSAD
+	};
+	if(ubPlayerIndex >= BENCH_PLAYER_MAX || !(g_ubBenchPlayers & BV(ubPlayerIndex))) {
+		return STEER_MODE_AI;
+	}
+	return pSteersForPlayers[ubPlayerIndex];
+}
+
+UBYTE menuAreThundersEnabled(void) {
+	return g_ubBenchThunders;
+}
+
+tScrollBufferManager *displayGetManager(void) {
+	return &s_sManager;
+}
+
+void displaySetThunderColor(UBYTE ubColorIndex) {
+}
+
+//------------------------------------------------------------------- ACE STUBS
+
+tJoyManager g_sJoyManager;
+tKeyManager g_sKeyManager;
+
+// Called by inputProcess() each frame - feeds host's input to manager states
+void joyProcess(void) {
+	static const UBYTE pKeys[BENCH_KEY_COUNT] = {
+		KEY_RSHIFT, KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT,
+		KEY_LSHIFT, KEY_W, KEY_S, KEY_A, KEY_D
+	};
+	for(UBYTE i = 0; i < sizeof(g_sJoyManager.pJoyStates); ++i) {
+		g_sJoyManager.pJoyStates[i] = (g_ulBenchJoy & BV(i)) ? JOY_ACTIVE : JOY_NACTIVE;
+	}
+	for(UBYTE i = 0; i < BENCH_KEY_COUNT; ++i) {
+		g_sKeyManager.pStates[pKeys[i]] = (g_uwBenchKeys & BV(i)) ? KEY_ACTIVE : KEY_NACTIVE;
+	}
+}
+
+#if defined(memAllocFast)
+// Release ACE maps all allocations onto these
+void *_memAllocRls(ULONG ulSize, ULONG ulFlags) {
+	return benchAlloc(ulSize);
+}
+
+void _memFreeRls(void *pMem, ULONG ulSize) {
+}
+#else
+void *memAllocFast(ULONG ulSize) {
+	return benchAlloc(ulSize);
+}
+
+void *memAllocChip(ULONG ulSize) {
+	return benchAlloc(ulSize);
+}
+
+void memFree(void *pMem, ULONG ulSize) {
+}
+#endif
+
+#if !defined(logWrite)
+void logWrite(const char *szFormat, ...) {
+}
+
+void logBlockBegin(const char *szBlockName, ...) {
+}
+
+void logBlockEnd(const char *szBlockName) {
+}
+#endif
+
+tBitMap *bitmapCreate(UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth, UBYTE ubFlags) {
+	return &s_sBitMap;
+}
+
+void bitmapDestroy(tBitMap *pBitMap) {
+}
+
+UWORD bitmapGetByteWidth(const tBitMap *pBitMap) {
+	return DISPLAY_WIDTH / 8;
+}
+
+void blitWait(void) {
+}
+
+UBYTE blitRect(
+	tBitMap *pDst, WORD wDstX, WORD wDstY, WORD wWidth, WORD wHeight, UBYTE ubColor
+) {
+	return 1;
+}
+
+void bobInit(
+	tBob *pBob, UWORD uwWidth, UWORD uwHeight, UBYTE isUndrawRequired,
+	UBYTE *pFrameData, UBYTE *pMaskData, UWORD uwX, UWORD uwY
+) {
+	pBob->uwWidth = uwWidth;
+	pBob->uwHeight = uwHeight;
+	pBob->isUndrawRequired = isUndrawRequired;
+	pBob->pFrameData = pFrameData;
+	pBob->pMaskData = pMaskData;
+	pBob->sPos.uwX = uwX;
+	pBob->sPos.uwY = uwY;
+}
+
+void bobSetFrame(tBob *pBob, UBYTE *pFrameData, UBYTE *pMaskData) {
+	pBob->pFrameData = pFrameData;
+	pBob->pMaskData = pMaskData;
+}
+
+void bobPush(tBob *pBob) {
+}
+
+tSprite *spriteAdd(UBYTE ubSpriteIndex, tBitMap *pBitMap) {
+	tSprite *pSprite = &s_pSprites[s_ubSpriteCount++ % BENCH_SPRITE_MAX];
+	pSprite->pBitmap = pBitMap;
+	pSprite->isEnabled = 1;
+	return pSprite;
+}
+
+void spriteRemove(tSprite *pSprite) {
+}
+
+void spriteSetEnabled(tSprite *pSprite, UBYTE isEnabled) {
+	pSprite->isEnabled = isEnabled;
+}
+
+void spriteSetBitmap(tSprite *pSprite, tBitMap *pBitMap) {
+	pSprite->pBitmap = pBitMap;
+}
+
+void spriteSetHeight(tSprite *pSprite, UWORD uwHeight) {
+}
+
+void spriteRequestMetadataUpdate(tSprite *pSprite) {
+}
+
+void spriteProcess(tSprite *pSprite) {
+}
+
+void ptplayerSfxPlay(
+	const tPtplayerSfx *pSfx, BYTE bChannel, UBYTE ubVolume, UBYTE ubPriority
+) {
+}
+
+//----------------------------------------------------------------- LIBC STUBS
+
+// Image is linked without libc, so that nothing else ends up in it
+void *memset(void *pDst, int lValue, unsigned long ulSize) {
+	UBYTE *pBytes = pDst;
+	while(ulSize--) {
+		*(pBytes++) = lValue;
+	}
+	return pDst;
+}
+
+void *memcpy(void *pDst, const void *pSrc, unsigned long ulSize) {
+	UBYTE *pDstBytes = pDst;
+	const UBYTE *pSrcBytes = pSrc;
+	while(ulSize--) {
+		*(pDstBytes++) = *(pSrcBytes++);
+	}
+	return pDst;
+}
+
+void qsort(
+	void *pBase, unsigned long ulCount, unsigned long ulSize,
+	int (*cbCompare)(const void*, const void*)
+) {
+	// Only used at map init, insertion sort keeps it short
+	UBYTE *pBytes = pBase;
+	for(unsigned long i = 1; i < ulCount; ++i) {
+		for(unsigned long j = i; j && cbCompare(
+			&pBytes[(j - 1) * ulSize], &pBytes[j * ulSize]
+		) > 0; --j) {
+			UBYTE *pA = &pBytes[(j - 1) * ulSize];
+			UBYTE *pB = &pBytes[j * ulSize];
+			for(unsigned long k = 0; k < ulSize; ++k) {
+				UBYTE ubTemp = pA[k];
+				pA[k] = pB[k];
+				pB[k] = ubTemp;
+			}
+		}
+	}
+}
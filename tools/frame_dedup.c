@@ -0,0 +1,281 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Removes duplicate and horizontally mirrored 16x16 frames from bob frame
+ * sheet and its mask. Only unique frames are written out, mirrored ones are
+ * listed in generated header so that game can rebuild them at load time.
+ *
+ * Usage: frameDedup in.bm in_mask.bm out.bm out_mask.bm out.h prefix
+ *
+ * Generated header contains:
+ * - <PREFIX>_FRAME_COUNT: frame count in source sheet,
+ * - <PREFIX>_FRAME_STORED_COUNT: frames in output sheet,
+ * - <PREFIX>_FRAME_MIRRORED_COUNT: frames to be mirrored at load time,
+ * - s_p<Prefix>FrameIndex: source frame index to runtime frame index,
+ *   mirrored frames go after the stored ones,
+ * - s_p<Prefix>MirrorSources: stored frame index for each mirrored frame.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitmap_file.h"
+
+#define FRAME_SIZE 16
+#define FRAME_COUNT_MAX 255
+
+typedef enum tFrameKind {
+	FRAME_KIND_STORED,
+	FRAME_KIND_MIRRORED,
+} tFrameKind;
+
+typedef struct tFrame {
+	uint16_t *pWords; ///< Bitmap words followed by mask words.
+	tFrameKind eKind;
+	uint8_t ubRuntimeIndex;
+	uint8_t ubSource; ///< Source frame of mirror.
+} tFrame;
+
+static uint16_t reverseWord(uint16_t uwWord) {
+	uwWord = ((uwWord >> 1) & 0x5555) | ((uwWord & 0x5555) << 1);
+	uwWord = ((uwWord >> 2) & 0x3333) | ((uwWord & 0x3333) << 2);
+	uwWord = ((uwWord >> 4) & 0x0F0F) | ((uwWord & 0x0F0F) << 4);
+	return (uwWord >> 8) | (uwWord << 8);
+}
+
+static void frameRead(
+	const tBitmapFile *pBitmap, uint16_t uwFrame, uint16_t *pDst
+) {
+	for(uint16_t uwRow = 0; uwRow < FRAME_SIZE; ++uwRow) {
+		for(uint8_t ubPlane = 0; ubPlane < pBitmap->ubDepth; ++ubPlane) {
+			*(pDst++) = readBeWord(bitmapFileGetRow(
+				pBitmap, uwFrame * FRAME_SIZE + uwRow, ubPlane
+			));
+		}
+	}
+}
+
+static void frameWrite(
+	tBitmapFile *pBitmap, uint16_t uwFrame, const uint16_t *pSrc
+) {
+	for(uint16_t uwRow = 0; uwRow < FRAME_SIZE; ++uwRow) {
+		for(uint8_t ubPlane = 0; ubPlane < pBitmap->ubDepth; ++ubPlane) {
+			writeBeWord(bitmapFileGetRow(
+				pBitmap, uwFrame * FRAME_SIZE + uwRow, ubPlane
+			), *(pSrc++));
+		}
+	}
+}
+
+static int isSheetValid(const tBitmapFile *pBitmap, const char *szPath) {
+	if(pBitmap->uwWidth != FRAME_SIZE || pBitmap->uwHeight % FRAME_SIZE) {
+		fprintf(
+			stderr, "ERR: '%s' is %hux%hu, expected %d px wide stack of frames\n",
+			szPath, pBitmap->uwWidth, pBitmap->uwHeight, FRAME_SIZE
+		);
+		return 0;
+	}
+	if(pBitmap->uwHeight / FRAME_SIZE > FRAME_COUNT_MAX) {
+		fprintf(stderr, "ERR: Too many frames in '%s'\n", szPath);
+		return 0;
+	}
+	return 1;
+}
+
+static void writeTable(
+	FILE *pFile, const char *szType, const char *szName, const char *szSize,
+	const uint8_t *pValues, uint16_t uwCount
+) {
+	fprintf(pFile, "static const %s %s[%s] = {", szType, szName, szSize);
+	if(!uwCount) {
+		// Keep the table valid C, size define says there's nothing there
+		fprintf(pFile, "0");
+	}
+	for(uint16_t i = 0; i < uwCount; ++i) {
+		fprintf(pFile, "%s%hhu,", (i % 16) ? " " : "\n\t", pValues[i]);
+	}
+	fprintf(pFile, "\n};\n");
+}
+
+static int writeHeader(
+	const char *szPath, const char *szPrefix, const tFrame *pFrames,
+	uint16_t uwFrameCount, uint16_t uwStoredCount, uint16_t uwMirroredCount
+) {
+	FILE *pFile = fopen(szPath, "w");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s' for writing\n", szPath);
+		return 0;
+	}
+
+	char szUpper[64], szCamel[64];
+	size_t ulLength = strlen(szPrefix);
+	if(ulLength >= sizeof(szUpper)) {
+		ulLength = sizeof(szUpper) - 1;
+	}
+	for(size_t i = 0; i < ulLength; ++i) {
+		szUpper[i] = toupper((unsigned char)szPrefix[i]);
+		szCamel[i] = szPrefix[i];
+	}
+	szUpper[ulLength] = '\0';
+	szCamel[ulLength] = '\0';
+	szCamel[0] = toupper((unsigned char)szCamel[0]);
+
+	uint8_t pIndices[FRAME_COUNT_MAX];
+	uint8_t pSources[FRAME_COUNT_MAX];
+	for(uint16_t i = 0; i < uwFrameCount; ++i) {
+		pIndices[i] = pFrames[i].ubRuntimeIndex;
+		if(pFrames[i].eKind == FRAME_KIND_MIRRORED) {
+			pSources[pFrames[i].ubRuntimeIndex - uwStoredCount] = pFrames[i].ubSource;
+		}
+	}
+
+	char szName[96], szSize[96];
+	fprintf(pFile, "// Generated by frameDedup, do not edit\n\n");
+	fprintf(pFile, "#define %s_FRAME_COUNT %hu\n", szUpper, uwFrameCount);
+	fprintf(pFile, "#define %s_FRAME_STORED_COUNT %hu\n", szUpper, uwStoredCount);
+	fprintf(pFile, "#define %s_FRAME_MIRRORED_COUNT %hu\n\n", szUpper, uwMirroredCount);
+	snprintf(szName, sizeof(szName), "s_p%sFrameIndex", szCamel);
+	snprintf(szSize, sizeof(szSize), "%s_FRAME_COUNT", szUpper);
+	writeTable(pFile, "UBYTE", szName, szSize, pIndices, uwFrameCount);
+	fprintf(pFile, "\n");
+	snprintf(szName, sizeof(szName), "s_p%sMirrorSources", szCamel);
+	snprintf(szSize, sizeof(szSize), "%s_FRAME_MIRRORED_COUNT + 1", szUpper);
+	writeTable(pFile, "UBYTE", szName, szSize, pSources, uwMirroredCount);
+
+	int isOk = !ferror(pFile);
+	fclose(pFile);
+	return isOk;
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 7) {
+		fprintf(
+			stderr, "Usage: %s in.bm in_mask.bm out.bm out_mask.bm out.h prefix\n",
+			pArgs[0]
+		);
+		return EXIT_FAILURE;
+	}
+
+	tBitmapFile sBitmap, sMask;
+	if(!bitmapFileLoad(pArgs[1], &sBitmap)) {
+		return EXIT_FAILURE;
+	}
+	if(!bitmapFileLoad(pArgs[2], &sMask)) {
+		bitmapFileFree(&sBitmap);
+		return EXIT_FAILURE;
+	}
+	int isOk = isSheetValid(&sBitmap, pArgs[1]) && isSheetValid(&sMask, pArgs[2]);
+	if(isOk && (
+		sBitmap.uwHeight != sMask.uwHeight || sBitmap.ubDepth != sMask.ubDepth
+	)) {
+		fprintf(stderr, "ERR: Bitmap and mask layouts don't match\n");
+		isOk = 0;
+	}
+	if(!isOk) {
+		bitmapFileFree(&sBitmap);
+		bitmapFileFree(&sMask);
+		return EXIT_FAILURE;
+	}
+
+	uint16_t uwFrameCount = sBitmap.uwHeight / FRAME_SIZE;
+	size_t ulPartWords = FRAME_SIZE * sBitmap.ubDepth;
+	size_t ulFrameBytes = 2 * ulPartWords * sizeof(uint16_t);
+	tFrame *pFrames = calloc(uwFrameCount, sizeof(tFrame));
+	uint16_t *pMirror = malloc(ulFrameBytes);
+	uint16_t uwStoredCount = 0;
+	uint16_t uwMirroredCount = 0;
+	uint16_t uwDuplicateCount = 0;
+
+	// Runtime indices of mirrored frames are fixed after all stored ones are known
+	for(uint16_t uwFrame = 0; uwFrame < uwFrameCount; ++uwFrame) {
+		tFrame *pFrame = &pFrames[uwFrame];
+		pFrame->pWords = malloc(ulFrameBytes);
+		frameRead(&sBitmap, uwFrame, pFrame->pWords);
+		frameRead(&sMask, uwFrame, &pFrame->pWords[ulPartWords]);
+		for(size_t i = 0; i < 2 * ulPartWords; ++i) {
+			pMirror[i] = reverseWord(pFrame->pWords[i]);
+		}
+
+		pFrame->eKind = FRAME_KIND_STORED;
+		pFrame->ubRuntimeIndex = uwStoredCount;
+		for(uint16_t uwPrev = 0; uwPrev < uwFrame; ++uwPrev) {
+			const tFrame *pPrev = &pFrames[uwPrev];
+			if(pPrev->eKind != FRAME_KIND_STORED) {
+				continue;
+			}
+			if(!memcmp(pPrev->pWords, pFrame->pWords, ulFrameBytes)) {
+				pFrame->ubRuntimeIndex = pPrev->ubRuntimeIndex;
+				++uwDuplicateCount;
+				break;
+			}
+			if(!memcmp(pPrev->pWords, pMirror, ulFrameBytes)) {
+				pFrame->eKind = FRAME_KIND_MIRRORED;
+				pFrame->ubSource = pPrev->ubRuntimeIndex;
+				break;
+			}
+		}
+		if(pFrame->eKind == FRAME_KIND_STORED && pFrame->ubRuntimeIndex == uwStoredCount) {
+			++uwStoredCount;
+		}
+	}
+
+	// Mirrors of the same frame share single runtime copy
+	for(uint16_t uwFrame = 0; uwFrame < uwFrameCount; ++uwFrame) {
+		tFrame *pFrame = &pFrames[uwFrame];
+		if(pFrame->eKind != FRAME_KIND_MIRRORED) {
+			continue;
+		}
+		pFrame->ubRuntimeIndex = uwStoredCount + uwMirroredCount;
+		for(uint16_t uwPrev = 0; uwPrev < uwFrame; ++uwPrev) {
+			const tFrame *pPrev = &pFrames[uwPrev];
+			if(pPrev->eKind == FRAME_KIND_MIRRORED && pPrev->ubSource == pFrame->ubSource) {
+				pFrame->ubRuntimeIndex = pPrev->ubRuntimeIndex;
+				++uwDuplicateCount;
+				break;
+			}
+		}
+		if(pFrame->ubRuntimeIndex == uwStoredCount + uwMirroredCount) {
+			++uwMirroredCount;
+		}
+	}
+
+	tBitmapFile sOutBitmap = sBitmap, sOutMask = sMask;
+	sOutBitmap.uwHeight = uwStoredCount * FRAME_SIZE;
+	sOutMask.uwHeight = uwStoredCount * FRAME_SIZE;
+	sOutBitmap.pData = malloc((size_t)sOutBitmap.uwBytesPerRow * sOutBitmap.uwHeight * sOutBitmap.ubDepth);
+	sOutMask.pData = malloc((size_t)sOutMask.uwBytesPerRow * sOutMask.uwHeight * sOutMask.ubDepth);
+	for(uint16_t uwFrame = 0; uwFrame < uwFrameCount; ++uwFrame) {
+		const tFrame *pFrame = &pFrames[uwFrame];
+		if(pFrame->eKind == FRAME_KIND_STORED) {
+			// Duplicates write the same data again, harmless
+			frameWrite(&sOutBitmap, pFrame->ubRuntimeIndex, pFrame->pWords);
+			frameWrite(&sOutMask, pFrame->ubRuntimeIndex, &pFrame->pWords[ulPartWords]);
+		}
+	}
+
+	isOk = (
+		bitmapFileSave(pArgs[3], &sOutBitmap) &&
+		bitmapFileSave(pArgs[4], &sOutMask) &&
+		writeHeader(pArgs[5], pArgs[6], pFrames, uwFrameCount, uwStoredCount, uwMirroredCount)
+	);
+	if(isOk) {
+		printf(
+			"%hu frames: %hu stored, %hu mirrored at load, %hu duplicates\n",
+			uwFrameCount, uwStoredCount, uwMirroredCount, uwDuplicateCount
+		);
+	}
+
+	for(uint16_t uwFrame = 0; uwFrame < uwFrameCount; ++uwFrame) {
+		free(pFrames[uwFrame].pWords);
+	}
+	free(pFrames);
+	free(pMirror);
+	bitmapFileFree(&sOutBitmap);
+	bitmapFileFree(&sOutMask);
+	bitmapFileFree(&sBitmap);
+	bitmapFileFree(&sMask);
+	return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,11 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_GENERIC_SCREEN_H
+#define INCLUDE_HOST_ACE_GENERIC_SCREEN_H
+
+#define SCREEN_PAL_WIDTH 320
+#define SCREEN_PAL_HEIGHT 256
+
+#endif // INCLUDE_HOST_ACE_GENERIC_SCREEN_H
@@ -0,0 +1,17 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MACROS_H
+#define INCLUDE_HOST_ACE_MACROS_H
+
+#define BV(x) (1 << (x))
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define ABS(x) (((x) < 0) ? -(x) : (x))
+#define SGN(x) (((x) > 0) - ((x) < 0))
+#define CLAMP(x, lo, hi) MIN(MAX((x), (lo)), (hi))
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+#define UNUSED_ARG __attribute__((unused))
+
+#endif // INCLUDE_HOST_ACE_MACROS_H
@@ -0,0 +1,46 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_BLIT_H
+#define INCLUDE_HOST_ACE_MANAGERS_BLIT_H
+
+#include <ace/utils/bitmap.h>
+#include <ace/utils/custom.h>
+
+#define USEA 0x0800
+#define USEB 0x0400
+#define USEC 0x0200
+#define USED 0x0100
+
+#define MINTERM_A 0xF0
+#define MINTERM_B 0xCC
+#define MINTERM_C 0xAA
+#define MINTERM_COOKIE 0xCA
+#define MINTERM_REVERSE_COOKIE 0xAC
+#define MINTERM_COPY 0xC0
+
+#define BLITREVERSE 0x2
+
+void blitWait(void);
+
+UBYTE blitRect(
+	tBitMap *pDst, WORD wDstX, WORD wDstY, WORD wWidth, WORD wHeight, UBYTE ubColor
+);
+
+UBYTE blitCopy(
+	const tBitMap *pSrc, WORD wSrcX, WORD wSrcY, tBitMap *pDst, WORD wDstX, WORD wDstY,
+	WORD wWidth, WORD wHeight, UBYTE ubMinterm
+);
+
+UBYTE blitCopyAligned(
+	const tBitMap *pSrc, WORD wSrcX, WORD wSrcY, tBitMap *pDst, WORD wDstX, WORD wDstY,
+	WORD wWidth, WORD wHeight
+);
+
+UBYTE blitCopyMask(
+	const tBitMap *pSrc, WORD wSrcX, WORD wSrcY, tBitMap *pDst, WORD wDstX, WORD wDstY,
+	WORD wWidth, WORD wHeight, const UBYTE *pMsk
+);
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_BLIT_H
@@ -0,0 +1,31 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_BOB_H
+#define INCLUDE_HOST_ACE_MANAGERS_BOB_H
+
+#include <ace/utils/bitmap.h>
+
+typedef struct tBob {
+	tUwCoordYX sPos;
+	UWORD uwWidth;
+	UWORD uwHeight;
+	UBYTE isUndrawRequired;
+	UBYTE *pFrameData;
+	UBYTE *pMaskData;
+} tBob;
+
+void bobInit(
+	tBob *pBob, UWORD uwWidth, UWORD uwHeight, UBYTE isUndrawRequired,
+	UBYTE *pFrameData, UBYTE *pMaskData, UWORD uwX, UWORD uwY
+);
+
+void bobSetFrame(tBob *pBob, UBYTE *pFrameData, UBYTE *pMaskData);
+
+void bobSetWidth(tBob *pBob, UWORD uwWidth);
+
+// Only counted, bobs aren't drawn
+void bobPush(tBob *pBob);
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_BOB_H
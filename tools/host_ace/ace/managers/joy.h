@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_JOY_H
+#define INCLUDE_HOST_ACE_MANAGERS_JOY_H
+
+#include <ace/types.h>
+
+#define JOY1 0
+#define JOY2 5
+#define JOY3 10
+#define JOY4 15
+
+#define JOY_FIRE 0
+#define JOY_UP 1
+#define JOY_DOWN 2
+#define JOY_LEFT 3
+#define JOY_RIGHT 4
+
+#define JOY_NACTIVE 0
+#define JOY_USED 1
+#define JOY_ACTIVE 2
+
+/**
+ * @brief Same layout as in ACE, set it directly to feed input.
+ */
+typedef struct tJoyManager {
+	UBYTE pJoyStates[20];
+} tJoyManager;
+
+extern tJoyManager g_sJoyManager;
+
+/**
+ * @brief No hardware to read, states are only changed by the caller.
+ */
+void joyProcess(void);
+
+UBYTE joyCheck(UBYTE ubJoyCode);
+
+UBYTE joyUse(UBYTE ubJoyCode);
+
+UBYTE joyIsParallelEnabled(void);
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_JOY_H
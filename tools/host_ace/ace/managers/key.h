@@ -0,0 +1,43 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_KEY_H
+#define INCLUDE_HOST_ACE_MANAGERS_KEY_H
+
+#include <ace/types.h>
+
+// Raw Amiga keycodes, same as ACE ones
+#define KEY_W 0x11
+#define KEY_A 0x20
+#define KEY_S 0x21
+#define KEY_D 0x22
+#define KEY_SPACE 0x40
+#define KEY_RETURN 0x44
+#define KEY_ESCAPE 0x45
+#define KEY_UP 0x4C
+#define KEY_DOWN 0x4D
+#define KEY_RIGHT 0x4E
+#define KEY_LEFT 0x4F
+#define KEY_F1 0x50
+#define KEY_LSHIFT 0x60
+#define KEY_RSHIFT 0x61
+
+#define KEY_NACTIVE 0
+#define KEY_USED 1
+#define KEY_ACTIVE 2
+
+/**
+ * @brief Same layout as in ACE, set it directly to feed input.
+ */
+typedef struct tKeyManager {
+	UBYTE pStates[128];
+} tKeyManager;
+
+extern tKeyManager g_sKeyManager;
+
+UBYTE keyCheck(UBYTE ubKeyCode);
+
+UBYTE keyUse(UBYTE ubKeyCode);
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_KEY_H
@@ -0,0 +1,15 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_LOG_H
+#define INCLUDE_HOST_ACE_MANAGERS_LOG_H
+
+// Goes to stderr
+void logWrite(const char *szFormat, ...);
+
+void logBlockBegin(const char *szBlockName, ...);
+
+void logBlockEnd(const char *szBlockName);
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_LOG_H
@@ -0,0 +1,25 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_MEMORY_H
+#define INCLUDE_HOST_ACE_MANAGERS_MEMORY_H
+
+#include <ace/types.h>
+
+#define MEMF_ANY 0
+#define MEMF_CHIP 2
+#define MEMF_FAST 4
+#define MEMF_CLEAR 0x10000
+
+// All of them are counted, see hostAceGetMemStats()
+void *memAlloc(ULONG ulSize, ULONG ulFlags);
+
+void memFree(void *pMem, ULONG ulSize);
+
+#define memAllocFast(ulSize) memAlloc(ulSize, MEMF_ANY)
+#define memAllocChip(ulSize) memAlloc(ulSize, MEMF_CHIP)
+#define memAllocFastClear(ulSize) memAlloc(ulSize, MEMF_ANY | MEMF_CLEAR)
+#define memAllocChipClear(ulSize) memAlloc(ulSize, MEMF_CHIP | MEMF_CLEAR)
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_MEMORY_H
@@ -0,0 +1,27 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_PTPLAYER_H
+#define INCLUDE_HOST_ACE_MANAGERS_PTPLAYER_H
+
+#include <ace/types.h>
+
+#define PTPLAYER_VOLUME_MAX 64
+
+// Same fields as ACE's
+typedef struct tPtplayerSfx {
+	UWORD uwWordLength;
+	UWORD uwPeriod;
+	UWORD *pData;
+} tPtplayerSfx;
+
+typedef struct tPtplayerMod tPtplayerMod;
+typedef struct tPtplayerSamplePack tPtplayerSamplePack;
+
+// Silent
+void ptplayerSfxPlay(
+	const tPtplayerSfx *pSfx, BYTE bChannel, UBYTE ubVolume, UBYTE ubPriority
+);
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_PTPLAYER_H
@@ -0,0 +1,33 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_SPRITE_H
+#define INCLUDE_HOST_ACE_MANAGERS_SPRITE_H
+
+#include <ace/utils/bitmap.h>
+
+typedef struct tSprite {
+	tBitMap *pBitmap;
+	WORD wX;
+	WORD wY;
+	UWORD uwHeight;
+	UBYTE ubChannelIndex;
+	UBYTE isEnabled;
+} tSprite;
+
+tSprite *spriteAdd(UBYTE ubSpriteIndex, tBitMap *pBitMap);
+
+void spriteRemove(tSprite *pSprite);
+
+void spriteSetEnabled(tSprite *pSprite, UBYTE isEnabled);
+
+void spriteSetBitmap(tSprite *pSprite, tBitMap *pBitMap);
+
+void spriteSetHeight(tSprite *pSprite, UWORD uwHeight);
+
+void spriteRequestMetadataUpdate(tSprite *pSprite);
+
+void spriteProcess(tSprite *pSprite);
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_SPRITE_H
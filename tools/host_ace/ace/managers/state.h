@@ -0,0 +1,14 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_STATE_H
+#define INCLUDE_HOST_ACE_MANAGERS_STATE_H
+
+#include <ace/types.h>
+
+// State machines aren't run on host
+typedef struct tStateManager tStateManager;
+typedef struct tState tState;
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_STATE_H
@@ -0,0 +1,18 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_MANAGERS_VIEWPORT_SCROLLBUFFER_H
+#define INCLUDE_HOST_ACE_MANAGERS_VIEWPORT_SCROLLBUFFER_H
+
+#include <ace/utils/bitmap.h>
+#include <ace/managers/viewport/camera.h>
+
+typedef struct tScrollBufferManager {
+	tCameraManager *pCamera;
+	tBitMap *pBack;
+	tBitMap *pFront;
+	UWORD uwBmAvailHeight;
+} tScrollBufferManager;
+
+#endif // INCLUDE_HOST_ACE_MANAGERS_VIEWPORT_SCROLLBUFFER_H
@@ -0,0 +1,78 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_TYPES_H
+#define INCLUDE_HOST_ACE_TYPES_H
+
+/**
+ * @brief Host stand-in for ACE headers, just enough for game's simulation and
+ * render code to build natively. See host_ace.c.
+ */
+
+#include <stdint.h>
+#include <ace/macros.h>
+
+typedef uint8_t UBYTE;
+typedef int8_t BYTE;
+typedef uint16_t UWORD;
+typedef int16_t WORD;
+typedef uint32_t ULONG;
+typedef int32_t LONG;
+typedef void *APTR;
+
+#define FAR
+#define REGPTR volatile * const
+
+// Unions keep big endian meaning of their packed fields, e.g. ulYX sorting by Y
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+typedef union tUwCoordYX {
+	struct {
+		UWORD uwX;
+		UWORD uwY;
+	};
+	ULONG ulYX;
+} tUwCoordYX;
+
+typedef union tUbCoordYX {
+	struct {
+		UBYTE ubX;
+		UBYTE ubY;
+	};
+	UWORD uwYX;
+} tUbCoordYX;
+
+typedef union tBCoordYX {
+	struct {
+		BYTE bX;
+		BYTE bY;
+	};
+	UWORD uwYX;
+} tBCoordYX;
+#else
+typedef union tUwCoordYX {
+	struct {
+		UWORD uwY;
+		UWORD uwX;
+	};
+	ULONG ulYX;
+} tUwCoordYX;
+
+typedef union tUbCoordYX {
+	struct {
+		UBYTE ubY;
+		UBYTE ubX;
+	};
+	UWORD uwYX;
+} tUbCoordYX;
+
+typedef union tBCoordYX {
+	struct {
+		BYTE bY;
+		BYTE bX;
+	};
+	UWORD uwYX;
+} tBCoordYX;
+#endif
+
+#endif // INCLUDE_HOST_ACE_TYPES_H
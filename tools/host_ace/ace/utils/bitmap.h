@@ -0,0 +1,33 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_UTILS_BITMAP_H
+#define INCLUDE_HOST_ACE_UTILS_BITMAP_H
+
+#include <ace/types.h>
+
+#define BMF_CLEAR 1
+#define BMF_INTERLEAVED 4
+
+/**
+ * @brief Same layout rules as on Amiga: for interleaved bitmaps BytesPerRow
+ * spans all planes and Planes[i] starts at i-th plane's part of first row.
+ */
+typedef struct tBitMap {
+	UWORD BytesPerRow;
+	UWORD Rows;
+	UBYTE Flags;
+	UBYTE Depth;
+	UBYTE *Planes[8];
+} tBitMap;
+
+tBitMap *bitmapCreate(UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth, UBYTE ubFlags);
+
+void bitmapDestroy(tBitMap *pBitMap);
+
+UBYTE bitmapIsInterleaved(const tBitMap *pBitMap);
+
+UWORD bitmapGetByteWidth(const tBitMap *pBitMap);
+
+#endif // INCLUDE_HOST_ACE_UTILS_BITMAP_H
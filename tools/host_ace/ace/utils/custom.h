@@ -0,0 +1,36 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_UTILS_CUSTOM_H
+#define INCLUDE_HOST_ACE_UTILS_CUSTOM_H
+
+#include <ace/types.h>
+
+/**
+ * @brief Blitter part of custom chip registers, pointers being host ones.
+ * Blit starts on bltsize write on Amiga - here it's run by next blitWait(),
+ * which game code always calls before touching registers again.
+ */
+typedef struct tCustom {
+	UWORD bltcon0;
+	UWORD bltcon1;
+	UWORD bltafwm;
+	UWORD bltalwm;
+	UBYTE *bltcpt;
+	UBYTE *bltbpt;
+	UBYTE *bltapt;
+	UBYTE *bltdpt;
+	UWORD bltsize;
+	WORD bltcmod;
+	WORD bltbmod;
+	WORD bltamod;
+	WORD bltdmod;
+	UWORD bltcdat;
+	UWORD bltbdat;
+	UWORD bltadat;
+} tCustom;
+
+extern tCustom FAR REGPTR g_pCustom;
+
+#endif // INCLUDE_HOST_ACE_UTILS_CUSTOM_H
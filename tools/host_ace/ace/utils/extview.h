@@ -0,0 +1,13 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_UTILS_EXTVIEW_H
+#define INCLUDE_HOST_ACE_UTILS_EXTVIEW_H
+
+#include <ace/types.h>
+
+typedef struct tView tView;
+typedef struct tVPort tVPort;
+
+#endif // INCLUDE_HOST_ACE_UTILS_EXTVIEW_H
@@ -0,0 +1,160 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "blitter_model.h"
+#include <ace/managers/blit.h>
+#include <ace/managers/log.h>
+
+#define BLTCON1_LINE 0x0001
+#define BLTCON1_FILL (0x0008 | 0x0010)
+
+// DMA slots per word by used channels (A=8, B=4, C=2, D=1), HRM table 6-2
+static const UBYTE s_pSlotsPerWord[16] = {
+	2, 2, 2, 3, 3, 3, 3, 4, 2, 2, 2, 3, 3, 3, 3, 4
+};
+
+static tBlitterModelStats s_sStats;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static UWORD readWord(const UBYTE *pSrc) {
+	return (pSrc[0] << 8) | pSrc[1];
+}
+
+static void writeWord(UBYTE *pDst, UWORD uwValue) {
+	pDst[0] = uwValue >> 8;
+	pDst[1] = uwValue;
+}
+
+static UWORD minterm(UBYTE ubMinterm, UWORD uwA, UWORD uwB, UWORD uwC) {
+	UWORD uwResult = 0;
+	for(UBYTE i = 0; i < 8; ++i) {
+		if(ubMinterm & BV(i)) {
+			uwResult |= (
+				((i & 4) ? uwA : ~uwA) & ((i & 2) ? uwB : ~uwB) & ((i & 1) ? uwC : ~uwC)
+			);
+		}
+	}
+	return uwResult;
+}
+
+/**
+ * Shifter takes bits of previous word of given channel - to the right in
+ * ascending mode and to the left in descending.
+ */
+static UWORD shift(UWORD uwCurr, UWORD uwPrev, UBYTE ubShift, UBYTE isDescending) {
+	if(!ubShift) {
+		return uwCurr;
+	}
+	if(isDescending) {
+		return (UWORD)(uwCurr << ubShift) | (uwPrev >> (16 - ubShift));
+	}
+	return (uwCurr >> ubShift) | (UWORD)(uwPrev << (16 - ubShift));
+}
+
+static void getSize(const tCustom *pCustom, UWORD *pWidth, UWORD *pHeight) {
+	// Zero in either field means its max value
+	*pHeight = pCustom->bltsize >> 6;
+	*pWidth = pCustom->bltsize & 0x3F;
+	if(!*pHeight) {
+		*pHeight = 1024;
+	}
+	if(!*pWidth) {
+		*pWidth = 64;
+	}
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void blitterModelRun(tCustom *pCustom) {
+	UWORD uwWidth, uwHeight;
+	getSize(pCustom, &uwWidth, &uwHeight);
+	UWORD uwCon0 = pCustom->bltcon0;
+	UWORD uwCon1 = pCustom->bltcon1;
+	UBYTE ubUse = (uwCon0 >> 8) & 0xF;
+	ULONG ulWords = (ULONG)uwWidth * uwHeight;
+	++s_sStats.ulBlits;
+	s_sStats.ulWords += ulWords;
+	s_sStats.ulClocks += ulWords * s_pSlotsPerWord[ubUse] * BLITTER_MODEL_CLOCKS_PER_SLOT;
+	if(uwCon1 & (BLTCON1_LINE | BLTCON1_FILL)) {
+		logWrite("ERR: Line/fill blit not modelled, bltcon1: %04X\n", uwCon1);
+		++s_sStats.ulSkipped;
+		return;
+	}
+
+	UBYTE isDescending = (uwCon1 & BLITREVERSE) != 0;
+	UBYTE ubShiftA = uwCon0 >> 12;
+	UBYTE ubShiftB = uwCon1 >> 12;
+	WORD wStep = isDescending ? -2 : 2;
+	WORD wSign = isDescending ? -1 : 1;
+	UBYTE *pA = pCustom->bltapt;
+	UBYTE *pB = pCustom->bltbpt;
+	UBYTE *pC = pCustom->bltcpt;
+	UBYTE *pD = pCustom->bltdpt;
+	UWORD uwPrevA = 0, uwPrevB = 0;
+	UWORD uwA = pCustom->bltadat, uwB = pCustom->bltbdat, uwC = pCustom->bltcdat;
+	for(UWORD uwRow = 0; uwRow < uwHeight; ++uwRow) {
+		for(UWORD uwCol = 0; uwCol < uwWidth; ++uwCol) {
+			UWORD uwRawA = (ubUse & 8) ? readWord(pA) : pCustom->bltadat;
+			if(uwCol == 0) {
+				uwRawA &= pCustom->bltafwm;
+			}
+			if(uwCol == uwWidth - 1) {
+				uwRawA &= pCustom->bltalwm;
+			}
+			uwA = shift(uwRawA, uwPrevA, ubShiftA, isDescending);
+			uwPrevA = uwRawA;
+			if(ubUse & 4) {
+				UWORD uwRawB = readWord(pB);
+				uwB = shift(uwRawB, uwPrevB, ubShiftB, isDescending);
+				uwPrevB = uwRawB;
+			}
+			if(ubUse & 2) {
+				uwC = readWord(pC);
+			}
+			if(ubUse & 1) {
+				writeWord(pD, minterm(uwCon0 & 0xFF, uwA, uwB, uwC));
+			}
+			pA += (ubUse & 8) ? wStep : 0;
+			pB += (ubUse & 4) ? wStep : 0;
+			pC += (ubUse & 2) ? wStep : 0;
+			pD += (ubUse & 1) ? wStep : 0;
+		}
+		pA += (ubUse & 8) ? wSign * pCustom->bltamod : 0;
+		pB += (ubUse & 4) ? wSign * pCustom->bltbmod : 0;
+		pC += (ubUse & 2) ? wSign * pCustom->bltcmod : 0;
+		pD += (ubUse & 1) ? wSign * pCustom->bltdmod : 0;
+	}
+	pCustom->bltapt = pA;
+	pCustom->bltbpt = pB;
+	pCustom->bltcpt = pC;
+	pCustom->bltdpt = pD;
+}
+
+void blitterModelAdvance(tCustom *pCustom) {
+	UWORD uwWidth, uwHeight;
+	getSize(pCustom, &uwWidth, &uwHeight);
+	UBYTE ubUse = (pCustom->bltcon0 >> 8) & 0xF;
+	LONG lSign = (pCustom->bltcon1 & BLITREVERSE) ? -1 : 1;
+	if(ubUse & 8) {
+		pCustom->bltapt += lSign * (LONG)uwHeight * (uwWidth * 2 + pCustom->bltamod);
+	}
+	if(ubUse & 4) {
+		pCustom->bltbpt += lSign * (LONG)uwHeight * (uwWidth * 2 + pCustom->bltbmod);
+	}
+	if(ubUse & 2) {
+		pCustom->bltcpt += lSign * (LONG)uwHeight * (uwWidth * 2 + pCustom->bltcmod);
+	}
+	if(ubUse & 1) {
+		pCustom->bltdpt += lSign * (LONG)uwHeight * (uwWidth * 2 + pCustom->bltdmod);
+	}
+}
+
+void blitterModelResetStats(void) {
+	s_sStats = (tBlitterModelStats){0};
+}
+
+const tBlitterModelStats *blitterModelGetStats(void) {
+	return &s_sStats;
+}
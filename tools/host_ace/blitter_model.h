@@ -0,0 +1,39 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_BLITTER_MODEL_H
+#define INCLUDE_HOST_ACE_BLITTER_MODEL_H
+
+#include <ace/utils/custom.h>
+
+#define BLITTER_MODEL_CLOCKS_PER_SLOT 2
+#define BLITTER_MODEL_FRAME_CLOCKS 141875 // PAL 68000 clocks per frame
+
+typedef struct tBlitterModelStats {
+	ULONG ulBlits;
+	ULONG ulWords;
+	ULONG ulClocks; ///< In CPU clocks, BLITTER_MODEL_CLOCKS_PER_SLOT per DMA slot.
+	ULONG ulSkipped; ///< Line and fill mode blits, which aren't modelled.
+} tBlitterModelStats;
+
+/**
+ * @brief Executes blit programmed in registers, same as bltsize write does.
+ *
+ * Channel pointers are advanced past blitted area afterwards, like on real
+ * hardware, so that follow-up blits may reuse them. Cost is taken from HRM
+ * blitter cycle table for used channels - it assumes no bus contention.
+ */
+void blitterModelRun(tCustom *pCustom);
+
+/**
+ * @brief Advances channel pointers as blitterModelRun() would, without
+ * blitting or counting anything.
+ */
+void blitterModelAdvance(tCustom *pCustom);
+
+void blitterModelResetStats(void);
+
+const tBlitterModelStats *blitterModelGetStats(void);
+
+#endif // INCLUDE_HOST_ACE_BLITTER_MODEL_H
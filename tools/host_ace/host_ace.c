@@ -0,0 +1,402 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Host implementation of ACE subset declared in this directory's headers.
+ *
+ * Game sources compiled against it talk to tools/host_ace/blitter_model.c
+ * instead of hardware: blitter registers are plain struct fields and blit
+ * programmed in them runs on next blitWait(). ACE's blit functions are
+ * implemented by programming registers the same way, so their cost is
+ * counted too. Bitmaps have the same memory layout as on Amiga.
+ *
+ * Input comes from g_sJoyManager/g_sKeyManager states set by the tool,
+ * allocations and bob pushes are only counted, see host_ace.h.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ace/managers/blit.h>
+#include <ace/managers/bob.h>
+#include <ace/managers/joy.h>
+#include <ace/managers/key.h>
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include <ace/managers/ptplayer.h>
+#include <ace/managers/sprite.h>
+#include "blitter_model.h"
+#include "host_ace.h"
+
+static tCustom s_sCustom;
+tCustom FAR REGPTR g_pCustom = &s_sCustom;
+tJoyManager g_sJoyManager;
+tKeyManager g_sKeyManager;
+
+#define HOST_ACE_BLIT_QUEUE_SIZE 256
+
+static tCustom s_pBlitQueue[HOST_ACE_BLIT_QUEUE_SIZE];
+static UWORD s_uwBlitQueueLength;
+static UBYTE s_isBlitDeferred;
+static tHostAceMemStats s_sMemStats;
+static tHostAceBobStats s_sBobStats;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static UWORD getEdgeMask(WORD wFirstBit, WORD wEndBit, UWORD uwWord) {
+	// Bits of given word covered by [wFirstBit, wEndBit), MSB being bit 0
+	WORD wWordStart = uwWord * 16;
+	WORD wFrom = MAX(wFirstBit - wWordStart, 0);
+	WORD wTo = MIN(wEndBit - wWordStart, 16);
+	if(wFrom >= wTo) {
+		return 0;
+	}
+	return (UWORD)(0xFFFF >> wFrom) & (UWORD)(0xFFFF << (16 - wTo));
+}
+
+/**
+ * Copies area from pSrc to pDst, D = AB + !AC with B being source and A mask
+ * from pMsk in layout of pSrc, or only edge masks if it's zero.
+ * Planes are blitted in one go if both bitmaps are interleaved.
+ */
+static UBYTE blitMasked(
+	const tBitMap *pSrc, WORD wSrcX, WORD wSrcY, tBitMap *pDst, WORD wDstX, WORD wDstY,
+	WORD wWidth, WORD wHeight, const UBYTE *pMsk
+) {
+	UBYTE isOneBlit = (
+		bitmapIsInterleaved(pSrc) && bitmapIsInterleaved(pDst) &&
+		pSrc->Depth == pDst->Depth
+	);
+	UBYTE ubSrcShift = wSrcX & 15;
+	UBYTE ubDstShift = wDstX & 15;
+	UBYTE isDescending = ubDstShift < ubSrcShift;
+	UWORD uwWords = ((isDescending ? ubSrcShift : ubDstShift) + wWidth + 15) / 16;
+	UWORD uwMaskLeft = getEdgeMask(ubDstShift, ubDstShift + wWidth, 0);
+	UWORD uwMaskRight = getEdgeMask(ubDstShift, ubDstShift + wWidth, uwWords - 1);
+	UBYTE ubShift = isDescending ? ubSrcShift - ubDstShift : ubDstShift - ubSrcShift;
+	UBYTE ubBlits = isOneBlit ? 1 : MIN(pSrc->Depth, pDst->Depth);
+	UWORD uwRows = isOneBlit ? wHeight * pSrc->Depth : wHeight;
+	UWORD uwSrcStride = isOneBlit ? bitmapGetByteWidth(pSrc) : pSrc->BytesPerRow;
+	UWORD uwDstStride = isOneBlit ? bitmapGetByteWidth(pDst) : pDst->BytesPerRow;
+	// Descending blits start from last word of last row
+	UWORD uwLastRow = isDescending ? uwRows - 1 : 0;
+	UWORD uwLastWord = isDescending ? (uwWords - 1) * 2 : 0;
+
+	for(UBYTE ubPlane = 0; ubPlane < ubBlits; ++ubPlane) {
+		ULONG ulSrcOffs = (
+			(pSrc->Planes[ubPlane] - pSrc->Planes[0]) + wSrcY * pSrc->BytesPerRow +
+			(wSrcX / 16) * 2 + uwLastRow * uwSrcStride + uwLastWord
+		);
+		ULONG ulDstOffs = (
+			wDstY * pDst->BytesPerRow + (wDstX / 16) * 2 +
+			uwLastRow * uwDstStride + uwLastWord
+		);
+		blitWait();
+		g_pCustom->bltcon0 = (
+			(ubShift << 12) | (pMsk ? USEA : 0) | USEB | USEC | USED | MINTERM_COOKIE
+		);
+		g_pCustom->bltcon1 = (ubShift << 12) | (isDescending ? BLITREVERSE : 0);
+		g_pCustom->bltafwm = isDescending ? uwMaskRight : uwMaskLeft;
+		g_pCustom->bltalwm = isDescending ? uwMaskLeft : uwMaskRight;
+		g_pCustom->bltadat = 0xFFFF;
+		g_pCustom->bltamod = uwSrcStride - uwWords * 2;
+		g_pCustom->bltbmod = uwSrcStride - uwWords * 2;
+		g_pCustom->bltcmod = uwDstStride - uwWords * 2;
+		g_pCustom->bltdmod = uwDstStride - uwWords * 2;
+		g_pCustom->bltapt = pMsk ? (UBYTE*)&pMsk[ulSrcOffs] : 0;
+		g_pCustom->bltbpt = &pSrc->Planes[0][ulSrcOffs];
+		g_pCustom->bltcpt = &pDst->Planes[ubPlane][ulDstOffs];
+		g_pCustom->bltdpt = &pDst->Planes[ubPlane][ulDstOffs];
+		g_pCustom->bltsize = (uwRows << 6) | uwWords;
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+void logWrite(const char *szFormat, ...) {
+	va_list vaArgs;
+	va_start(vaArgs, szFormat);
+	vfprintf(stderr, szFormat, vaArgs);
+	va_end(vaArgs);
+}
+
+void logBlockBegin(const char *szBlockName, ...) {
+	va_list vaArgs;
+	va_start(vaArgs, szBlockName);
+	vfprintf(stderr, szBlockName, vaArgs);
+	va_end(vaArgs);
+	fprintf(stderr, " {\n");
+}
+
+void logBlockEnd(const char *szBlockName) {
+	fprintf(stderr, "} // %s\n", szBlockName);
+}
+
+void hostAceResetStats(void) {
+	s_sMemStats = (tHostAceMemStats){.ulLiveBytes = s_sMemStats.ulLiveBytes};
+	s_sMemStats.ulPeakBytes = s_sMemStats.ulLiveBytes;
+	s_sBobStats = (tHostAceBobStats){0};
+}
+
+const tHostAceMemStats *hostAceGetMemStats(void) {
+	return &s_sMemStats;
+}
+
+const tHostAceBobStats *hostAceGetBobStats(void) {
+	return &s_sBobStats;
+}
+
+void *memAlloc(ULONG ulSize, ULONG ulFlags) {
+	// Always cleared, so that runs don't depend on host's heap contents
+	void *pMem = calloc(ulSize ? ulSize : 1, 1);
+	++s_sMemStats.ulAllocs;
+	s_sMemStats.ulAllocBytes += ulSize;
+	s_sMemStats.ulLiveBytes += ulSize;
+	s_sMemStats.ulPeakBytes = MAX(s_sMemStats.ulPeakBytes, s_sMemStats.ulLiveBytes);
+	return pMem;
+}
+
+void memFree(void *pMem, ULONG ulSize) {
+	++s_sMemStats.ulFrees;
+	s_sMemStats.ulLiveBytes -= MIN(ulSize, s_sMemStats.ulLiveBytes);
+	free(pMem);
+}
+
+tBitMap *bitmapCreate(UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth, UBYTE ubFlags) {
+	tBitMap *pBitMap = memAllocFastClear(sizeof(*pBitMap));
+	UWORD uwByteWidth = ((uwWidth + 15) / 16) * 2;
+	UBYTE *pData = memAllocChipClear((ULONG)uwByteWidth * uwHeight * ubDepth);
+	pBitMap->Rows = uwHeight;
+	pBitMap->Depth = ubDepth;
+	pBitMap->Flags = ubFlags;
+	if(bitmapIsInterleaved(pBitMap)) {
+		pBitMap->BytesPerRow = uwByteWidth * ubDepth;
+		for(UBYTE i = 0; i < ubDepth; ++i) {
+			pBitMap->Planes[i] = &pData[i * uwByteWidth];
+		}
+	}
+	else {
+		pBitMap->BytesPerRow = uwByteWidth;
+		for(UBYTE i = 0; i < ubDepth; ++i) {
+			pBitMap->Planes[i] = &pData[(size_t)i * uwByteWidth * uwHeight];
+		}
+	}
+	return pBitMap;
+}
+
+void bitmapDestroy(tBitMap *pBitMap) {
+	memFree(pBitMap->Planes[0], bitmapGetByteWidth(pBitMap) * pBitMap->Rows * pBitMap->Depth);
+	memFree(pBitMap, sizeof(*pBitMap));
+}
+
+UBYTE bitmapIsInterleaved(const tBitMap *pBitMap) {
+	return (pBitMap->Flags & BMF_INTERLEAVED) && pBitMap->Depth > 1;
+}
+
+UWORD bitmapGetByteWidth(const tBitMap *pBitMap) {
+	if(bitmapIsInterleaved(pBitMap)) {
+		return pBitMap->BytesPerRow / pBitMap->Depth;
+	}
+	return pBitMap->BytesPerRow;
+}
+
+void hostAceSetBlitDeferred(UBYTE isDeferred) {
+	hostAceBlitFlush();
+	s_isBlitDeferred = isDeferred;
+}
+
+void hostAceBlitFlush(void) {
+	// Pointers in queue are the starting ones, so they're run on copies
+	for(UWORD i = 0; i < s_uwBlitQueueLength; ++i) {
+		blitterModelRun(&s_pBlitQueue[i]);
+	}
+	s_uwBlitQueueLength = 0;
+}
+
+void blitWait(void) {
+	// Zero size would be 1024x64 blit, which nothing does
+	if(!s_sCustom.bltsize) {
+		return;
+	}
+	if(s_isBlitDeferred) {
+		if(s_uwBlitQueueLength == HOST_ACE_BLIT_QUEUE_SIZE) {
+			hostAceBlitFlush();
+		}
+		s_pBlitQueue[s_uwBlitQueueLength++] = s_sCustom;
+		blitterModelAdvance(&s_sCustom);
+	}
+	else {
+		blitterModelRun(&s_sCustom);
+	}
+	s_sCustom.bltsize = 0;
+}
+
+UBYTE blitRect(
+	tBitMap *pDst, WORD wDstX, WORD wDstY, WORD wWidth, WORD wHeight, UBYTE ubColor
+) {
+	// A is fixed data with edge masks, D = A ? color : C
+	UBYTE ubShift = wDstX & 15;
+	UWORD uwWords = (ubShift + wWidth + 15) / 16;
+	for(UBYTE ubPlane = 0; ubPlane < pDst->Depth; ++ubPlane) {
+		UBYTE *pRow = &pDst->Planes[ubPlane][wDstY * pDst->BytesPerRow + (wDstX / 16) * 2];
+		blitWait();
+		g_pCustom->bltcon0 = USEC | USED | ((ubColor & BV(ubPlane)) ? 0xFA : 0x0A);
+		g_pCustom->bltcon1 = 0;
+		g_pCustom->bltafwm = getEdgeMask(ubShift, ubShift + wWidth, 0);
+		g_pCustom->bltalwm = getEdgeMask(ubShift, ubShift + wWidth, uwWords - 1);
+		g_pCustom->bltadat = 0xFFFF;
+		g_pCustom->bltcmod = pDst->BytesPerRow - uwWords * 2;
+		g_pCustom->bltdmod = pDst->BytesPerRow - uwWords * 2;
+		g_pCustom->bltcpt = pRow;
+		g_pCustom->bltdpt = pRow;
+		g_pCustom->bltsize = (wHeight << 6) | uwWords;
+	}
+	return 1;
+}
+
+UBYTE blitCopy(
+	const tBitMap *pSrc, WORD wSrcX, WORD wSrcY, tBitMap *pDst, WORD wDstX, WORD wDstY,
+	WORD wWidth, WORD wHeight, UBYTE ubMinterm
+) {
+	if(ubMinterm != MINTERM_COPY) {
+		logWrite("ERR: blitCopy() minterm %02X not modelled\n", ubMinterm);
+		return 0;
+	}
+	return blitMasked(pSrc, wSrcX, wSrcY, pDst, wDstX, wDstY, wWidth, wHeight, 0);
+}
+
+UBYTE blitCopyAligned(
+	const tBitMap *pSrc, WORD wSrcX, WORD wSrcY, tBitMap *pDst, WORD wDstX, WORD wDstY,
+	WORD wWidth, WORD wHeight
+) {
+	// Straight A->D, same as in ACE
+	UBYTE isOneBlit = (
+		bitmapIsInterleaved(pSrc) && bitmapIsInterleaved(pDst) &&
+		pSrc->Depth == pDst->Depth
+	);
+	UWORD uwWords = wWidth / 16;
+	UBYTE ubBlits = isOneBlit ? 1 : MIN(pSrc->Depth, pDst->Depth);
+	UWORD uwRows = isOneBlit ? wHeight * pSrc->Depth : wHeight;
+	UWORD uwSrcStride = isOneBlit ? bitmapGetByteWidth(pSrc) : pSrc->BytesPerRow;
+	UWORD uwDstStride = isOneBlit ? bitmapGetByteWidth(pDst) : pDst->BytesPerRow;
+	for(UBYTE ubPlane = 0; ubPlane < ubBlits; ++ubPlane) {
+		blitWait();
+		g_pCustom->bltcon0 = USEA | USED | MINTERM_A;
+		g_pCustom->bltcon1 = 0;
+		g_pCustom->bltafwm = 0xFFFF;
+		g_pCustom->bltalwm = 0xFFFF;
+		g_pCustom->bltamod = uwSrcStride - uwWords * 2;
+		g_pCustom->bltdmod = uwDstStride - uwWords * 2;
+		g_pCustom->bltapt = &pSrc->Planes[ubPlane][
+			wSrcY * pSrc->BytesPerRow + (wSrcX / 16) * 2
+		];
+		g_pCustom->bltdpt = &pDst->Planes[ubPlane][
+			wDstY * pDst->BytesPerRow + (wDstX / 16) * 2
+		];
+		g_pCustom->bltsize = (uwRows << 6) | uwWords;
+	}
+	return 1;
+}
+
+UBYTE blitCopyMask(
+	const tBitMap *pSrc, WORD wSrcX, WORD wSrcY, tBitMap *pDst, WORD wDstX, WORD wDstY,
+	WORD wWidth, WORD wHeight, const UBYTE *pMsk
+) {
+	return blitMasked(pSrc, wSrcX, wSrcY, pDst, wDstX, wDstY, wWidth, wHeight, pMsk);
+}
+
+void joyProcess(void) {
+}
+
+UBYTE joyCheck(UBYTE ubJoyCode) {
+	return g_sJoyManager.pJoyStates[ubJoyCode] != JOY_NACTIVE;
+}
+
+UBYTE joyUse(UBYTE ubJoyCode) {
+	if(g_sJoyManager.pJoyStates[ubJoyCode] == JOY_ACTIVE) {
+		g_sJoyManager.pJoyStates[ubJoyCode] = JOY_USED;
+		return 1;
+	}
+	return 0;
+}
+
+UBYTE joyIsParallelEnabled(void) {
+	return 1;
+}
+
+UBYTE keyCheck(UBYTE ubKeyCode) {
+	return g_sKeyManager.pStates[ubKeyCode] != KEY_NACTIVE;
+}
+
+UBYTE keyUse(UBYTE ubKeyCode) {
+	if(g_sKeyManager.pStates[ubKeyCode] == KEY_ACTIVE) {
+		g_sKeyManager.pStates[ubKeyCode] = KEY_USED;
+		return 1;
+	}
+	return 0;
+}
+
+void bobInit(
+	tBob *pBob, UWORD uwWidth, UWORD uwHeight, UBYTE isUndrawRequired,
+	UBYTE *pFrameData, UBYTE *pMaskData, UWORD uwX, UWORD uwY
+) {
+	pBob->uwWidth = uwWidth;
+	pBob->uwHeight = uwHeight;
+	pBob->isUndrawRequired = isUndrawRequired;
+	pBob->pFrameData = pFrameData;
+	pBob->pMaskData = pMaskData;
+	pBob->sPos.uwX = uwX;
+	pBob->sPos.uwY = uwY;
+}
+
+void bobSetFrame(tBob *pBob, UBYTE *pFrameData, UBYTE *pMaskData) {
+	pBob->pFrameData = pFrameData;
+	pBob->pMaskData = pMaskData;
+}
+
+void bobSetWidth(tBob *pBob, UWORD uwWidth) {
+	pBob->uwWidth = uwWidth;
+}
+
+void bobPush(tBob *pBob) {
+	++s_sBobStats.ulPushes;
+	s_sBobStats.ulPushedWords += ((pBob->uwWidth + 15) / 16) * pBob->uwHeight;
+}
+
+tSprite *spriteAdd(UBYTE ubSpriteIndex, tBitMap *pBitMap) {
+	tSprite *pSprite = memAllocFastClear(sizeof(*pSprite));
+	pSprite->ubChannelIndex = ubSpriteIndex;
+	pSprite->pBitmap = pBitMap;
+	pSprite->uwHeight = pBitMap->Rows;
+	pSprite->isEnabled = 1;
+	return pSprite;
+}
+
+void spriteRemove(tSprite *pSprite) {
+	memFree(pSprite, sizeof(*pSprite));
+}
+
+void spriteSetEnabled(tSprite *pSprite, UBYTE isEnabled) {
+	pSprite->isEnabled = isEnabled;
+}
+
+void spriteSetBitmap(tSprite *pSprite, tBitMap *pBitMap) {
+	pSprite->pBitmap = pBitMap;
+}
+
+void spriteSetHeight(tSprite *pSprite, UWORD uwHeight) {
+	pSprite->uwHeight = uwHeight;
+}
+
+void spriteRequestMetadataUpdate(tSprite *pSprite) {
+}
+
+void spriteProcess(tSprite *pSprite) {
+}
+
+void ptplayerSfxPlay(
+	const tPtplayerSfx *pSfx, BYTE bChannel, UBYTE ubVolume, UBYTE ubPriority
+) {
+}
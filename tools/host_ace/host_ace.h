@@ -0,0 +1,41 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_HOST_ACE_HOST_ACE_H
+#define INCLUDE_HOST_ACE_HOST_ACE_H
+
+#include <ace/types.h>
+
+/**
+ * @brief Counters of memAlloc()/memFree() and bitmaps, which use them too.
+ */
+typedef struct tHostAceMemStats {
+	ULONG ulAllocs;
+	ULONG ulFrees;
+	ULONG ulAllocBytes; ///< Sum of all allocation sizes.
+	ULONG ulLiveBytes;
+	ULONG ulPeakBytes;
+} tHostAceMemStats;
+
+typedef struct tHostAceBobStats {
+	ULONG ulPushes;
+	ULONG ulPushedWords; ///< Width in words times height, of all pushed bobs.
+} tHostAceBobStats;
+
+/**
+ * @brief Makes blitWait() only queue blits, so that timing of game code
+ * doesn't include the model. Pointers are advanced right away, queue is
+ * executed by hostAceBlitFlush() or when it gets full.
+ */
+void hostAceSetBlitDeferred(UBYTE isDeferred);
+
+void hostAceBlitFlush(void);
+
+void hostAceResetStats(void);
+
+const tHostAceMemStats *hostAceGetMemStats(void);
+
+const tHostAceBobStats *hostAceGetBobStats(void);
+
+#endif // INCLUDE_HOST_ACE_HOST_ACE_H
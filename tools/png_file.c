@@ -0,0 +1,116 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "png_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PNG_STORED_BLOCK_MAX 65535
+
+static void writeBeLong(uint8_t *pDst, uint32_t ulValue) {
+	pDst[0] = ulValue >> 24;
+	pDst[1] = (ulValue >> 16) & 0xFF;
+	pDst[2] = (ulValue >> 8) & 0xFF;
+	pDst[3] = ulValue & 0xFF;
+}
+
+static int writeChunk(
+	FILE *pFile, const char *szType, const uint8_t *pData, uint32_t ulSize
+) {
+	uint8_t pHeader[8];
+	writeBeLong(&pHeader[0], ulSize);
+	memcpy(&pHeader[4], szType, 4);
+	uint32_t ulCrc = pngCrc32(0, &pHeader[4], 4);
+	ulCrc = pngCrc32(ulCrc, pData, ulSize);
+	uint8_t pCrc[4];
+	writeBeLong(pCrc, ulCrc);
+	return (
+		fwrite(pHeader, sizeof(pHeader), 1, pFile) == 1 &&
+		(!ulSize || fwrite(pData, ulSize, 1, pFile) == 1) &&
+		fwrite(pCrc, sizeof(pCrc), 1, pFile) == 1
+	);
+}
+
+uint32_t pngCrc32(uint32_t ulCrc, const uint8_t *pData, uint32_t ulSize) {
+	ulCrc = ~ulCrc;
+	for(uint32_t i = 0; i < ulSize; ++i) {
+		ulCrc ^= pData[i];
+		for(uint8_t ubBit = 0; ubBit < 8; ++ubBit) {
+			ulCrc = (ulCrc >> 1) ^ (0xEDB88320 & -(ulCrc & 1));
+		}
+	}
+	return ~ulCrc;
+}
+
+int pngFileSaveIndexed(
+	const char *szPath, const uint8_t *pPixels, uint16_t uwWidth, uint16_t uwHeight,
+	const uint8_t *pPalette, uint16_t uwColorCount
+) {
+	// Raw scanlines, each prefixed with filter type 0
+	uint32_t ulRawSize = (uint32_t)(uwWidth + 1) * uwHeight;
+	uint8_t *pRaw = malloc(ulRawSize);
+	for(uint16_t y = 0; y < uwHeight; ++y) {
+		pRaw[y * (uwWidth + 1)] = 0;
+		memcpy(&pRaw[y * (uwWidth + 1) + 1], &pPixels[y * uwWidth], uwWidth);
+	}
+
+	// Zlib stream made of stored deflate blocks
+	uint32_t ulBlockCount = (ulRawSize + PNG_STORED_BLOCK_MAX - 1) / PNG_STORED_BLOCK_MAX;
+	uint32_t ulZlibSize = 2 + ulBlockCount * 5 + ulRawSize + 4;
+	uint8_t *pZlib = malloc(ulZlibSize);
+	uint8_t *pOut = pZlib;
+	*(pOut++) = 0x78;
+	*(pOut++) = 0x01;
+	uint32_t ulAdlerA = 1, ulAdlerB = 0;
+	for(uint32_t ulPos = 0; ulPos < ulRawSize; ulPos += PNG_STORED_BLOCK_MAX) {
+		uint16_t uwSize = (
+			ulRawSize - ulPos > PNG_STORED_BLOCK_MAX ?
+			PNG_STORED_BLOCK_MAX : ulRawSize - ulPos
+		);
+		*(pOut++) = (ulPos + uwSize == ulRawSize); // BFINAL, BTYPE 0
+		*(pOut++) = uwSize & 0xFF;
+		*(pOut++) = uwSize >> 8;
+		*(pOut++) = ~uwSize & 0xFF;
+		*(pOut++) = (uint8_t)(~uwSize >> 8);
+		memcpy(pOut, &pRaw[ulPos], uwSize);
+		pOut += uwSize;
+		for(uint16_t i = 0; i < uwSize; ++i) {
+			ulAdlerA = (ulAdlerA + pRaw[ulPos + i]) % 65521;
+			ulAdlerB = (ulAdlerB + ulAdlerA) % 65521;
+		}
+	}
+	writeBeLong(pOut, (ulAdlerB << 16) | ulAdlerA);
+	free(pRaw);
+
+	uint8_t pIhdr[13];
+	writeBeLong(&pIhdr[0], uwWidth);
+	writeBeLong(&pIhdr[4], uwHeight);
+	pIhdr[8] = 8; // bit depth
+	pIhdr[9] = 3; // indexed
+	pIhdr[10] = 0;
+	pIhdr[11] = 0;
+	pIhdr[12] = 0;
+
+	FILE *pFile = fopen(szPath, "wb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't write '%s'\n", szPath);
+		free(pZlib);
+		return 0;
+	}
+	static const uint8_t pSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	int isOk = (
+		fwrite(pSignature, sizeof(pSignature), 1, pFile) == 1 &&
+		writeChunk(pFile, "IHDR", pIhdr, sizeof(pIhdr)) &&
+		writeChunk(pFile, "PLTE", pPalette, uwColorCount * 3) &&
+		writeChunk(pFile, "IDAT", pZlib, ulZlibSize) &&
+		writeChunk(pFile, "IEND", 0, 0)
+	);
+	fclose(pFile);
+	free(pZlib);
+	if(!isOk) {
+		fprintf(stderr, "ERR: Can't write '%s'\n", szPath);
+	}
+	return isOk;
+}
@@ -0,0 +1,24 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INCLUDE_TOOLS_PNG_FILE_H
+#define INCLUDE_TOOLS_PNG_FILE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Saves 8-bit indexed image as PNG.
+ * Data isn't compressed - it's meant for eyeballing and diffing debug dumps.
+ *
+ * @param pPixels One byte per pixel, rows one after another.
+ * @param pPalette RGB triplets, uwColorCount of them.
+ */
+int pngFileSaveIndexed(
+	const char *szPath, const uint8_t *pPixels, uint16_t uwWidth, uint16_t uwHeight,
+	const uint8_t *pPalette, uint16_t uwColorCount
+);
+
+uint32_t pngCrc32(uint32_t ulCrc, const uint8_t *pData, uint32_t ulSize);
+
+#endif // INCLUDE_TOOLS_PNG_FILE_H
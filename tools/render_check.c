@@ -0,0 +1,244 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Runs game's tile drawing code on host against software blitter model.
+ *
+ * Usage: renderCheck tiles.bm tiles_mask.bm chaos_arena.pal outDir [seed] [frames]
+ *
+ * src/tile.c is compiled unmodified against tools/host_ace, draws the map
+ * on double-buffered display bitmaps and then crumbles it while the camera
+ * sweeps over the map. Buffers are dumped as PNG at start and periodically,
+ * along with their CRCs, so that rendering changes can be diffed without
+ * running an emulator. Blitter DMA cost per frame is reported at the end.
+ * Dumps show buffer as it's laid out in memory - rows are a ring, so
+ * scrolled map wraps around.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bitmap_file.h"
+#include "png_file.h"
+#include <ace/managers/blit.h>
+#include "blitter_model.h"
+#include "../src/tile.h"
+#include "../src/display.h"
+#include "../src/event.h"
+#include "../src/rng.h"
+#include "../src/scheduler.h"
+
+#define RENDER_CHECK_COLORS 256
+#define RENDER_CHECK_DUMP_INTERVAL 250
+#define RENDER_CHECK_FRAMES_DEFAULT 1500
+#define RENDER_CHECK_CAMERA_SPEED 1
+
+tBitMap *g_pTileset;
+tBitMap *g_pTilesetMask;
+
+static tCameraManager s_sCamera;
+static tScrollBufferManager s_sManager = {.pCamera = &s_sCamera};
+static uint8_t s_pPalette[RENDER_CHECK_COLORS * 3];
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static tBitMap *loadBitMap(const char *szPath) {
+	tBitmapFile sFile;
+	if(!bitmapFileLoad(szPath, &sFile)) {
+		fprintf(stderr, "ERR: Can't load '%s'\n", szPath);
+		return 0;
+	}
+	// .bm data is always interleaved, so it can be copied as-is
+	tBitMap *pBitMap = bitmapCreate(sFile.uwWidth, sFile.uwHeight, sFile.ubDepth, BMF_INTERLEAVED);
+	for(uint16_t y = 0; y < sFile.uwHeight; ++y) {
+		for(uint8_t ubPlane = 0; ubPlane < sFile.ubDepth; ++ubPlane) {
+			const uint8_t *pSrc = bitmapFileGetRow(&sFile, y, ubPlane);
+			uint8_t *pDst = &pBitMap->Planes[ubPlane][y * pBitMap->BytesPerRow];
+			for(uint16_t x = 0; x < MIN(sFile.uwBytesPerRow, bitmapGetByteWidth(pBitMap)); ++x) {
+				pDst[x] = pSrc[x];
+			}
+		}
+	}
+	bitmapFileFree(&sFile);
+	return pBitMap;
+}
+
+static int loadPalette(const char *szPath) {
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szPath);
+		return 0;
+	}
+	size_t ulRead = fread(s_pPalette, 1, sizeof(s_pPalette), pFile);
+	fclose(pFile);
+	if(ulRead < (1 << DISPLAY_BPP) * 3) {
+		fprintf(stderr, "ERR: Palette '%s' too short\n", szPath);
+		return 0;
+	}
+	return 1;
+}
+
+static uint8_t *toChunky(const tBitMap *pBitMap, uint16_t uwWidth) {
+	uint8_t *pPixels = calloc((size_t)uwWidth * pBitMap->Rows, 1);
+	for(uint16_t y = 0; y < pBitMap->Rows; ++y) {
+		for(uint16_t x = 0; x < uwWidth; ++x) {
+			uint8_t ubColor = 0;
+			for(uint8_t ubPlane = 0; ubPlane < pBitMap->Depth; ++ubPlane) {
+				uint8_t ubByte = pBitMap->Planes[ubPlane][y * pBitMap->BytesPerRow + x / 8];
+				ubColor |= ((ubByte >> (7 - (x & 7))) & 1) << ubPlane;
+			}
+			pPixels[y * uwWidth + x] = ubColor;
+		}
+	}
+	return pPixels;
+}
+
+static int dumpBuffer(const tBitMap *pBitMap, const char *szDir, const char *szName) {
+	uint16_t uwWidth = bitmapGetByteWidth(pBitMap) * 8;
+	uint8_t *pPixels = toChunky(pBitMap, uwWidth);
+	char szPath[512];
+	snprintf(szPath, sizeof(szPath), "%s/%s.png", szDir, szName);
+	int isOk = pngFileSaveIndexed(
+		szPath, pPixels, uwWidth, pBitMap->Rows, s_pPalette, 1 << pBitMap->Depth
+	);
+	printf(
+		"%s: crc %08lX\n", szName,
+		(unsigned long)pngCrc32(0, pPixels, (uint32_t)uwWidth * pBitMap->Rows)
+	);
+	free(pPixels);
+	return isOk;
+}
+
+static void printStats(const char *szWhat, const tBlitterModelStats *pStats) {
+	printf(
+		"%s: %lu blits, %lu words, %lu clocks (%lu%% of frame)\n", szWhat,
+		(unsigned long)pStats->ulBlits, (unsigned long)pStats->ulWords,
+		(unsigned long)pStats->ulClocks,
+		(unsigned long)(pStats->ulClocks * 100 / BLITTER_MODEL_FRAME_CLOCKS)
+	);
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+tScrollBufferManager *displayGetManager(void) {
+	return &s_sManager;
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 5) {
+		fprintf(
+			stderr, "Usage: %s tiles.bm tiles_mask.bm chaos_arena.pal outDir [seed] [frames]\n",
+			pArgs[0]
+		);
+		return EXIT_FAILURE;
+	}
+	const char *szOutDir = pArgs[4];
+	ULONG ulSeed = lArgCount > 5 ? strtoul(pArgs[5], 0, 0) : 1;
+	ULONG ulFrames = lArgCount > 6 ? strtoul(pArgs[6], 0, 0) : RENDER_CHECK_FRAMES_DEFAULT;
+
+	g_pTileset = loadBitMap(pArgs[1]);
+	g_pTilesetMask = loadBitMap(pArgs[2]);
+	if(!g_pTileset || !g_pTilesetMask || !loadPalette(pArgs[3])) {
+		return EXIT_FAILURE;
+	}
+	if(g_pTileset->Depth != DISPLAY_BPP || g_pTilesetMask->Depth != DISPLAY_BPP) {
+		fprintf(stderr, "ERR: Tileset and its mask must have %d planes\n", DISPLAY_BPP);
+		return EXIT_FAILURE;
+	}
+
+	s_sManager.uwBmAvailHeight = DISPLAY_HEIGHT + MAP_TILE_SIZE;
+	s_sManager.pBack = bitmapCreate(
+		DISPLAY_BOUND_WIDTH, s_sManager.uwBmAvailHeight, DISPLAY_BPP, BMF_CLEAR | BMF_INTERLEAVED
+	);
+	s_sManager.pFront = bitmapCreate(
+		DISPLAY_BOUND_WIDTH, s_sManager.uwBmAvailHeight, DISPLAY_BPP, BMF_CLEAR | BMF_INTERLEAVED
+	);
+
+	// Same order as in game's gsGameCreate()
+	rngInit(ulSeed);
+	schedulerReset();
+	tilesInit();
+	eventsReset();
+	tilesReload();
+	UWORD uwCameraMin = DISPLAY_MARGIN_SIZE;
+	WORD wCameraMax = (
+		tileGetMapHeight() * MAP_TILE_SIZE - SCREEN_PAL_HEIGHT - DISPLAY_MARGIN_SIZE
+	);
+	UWORD uwCameraMax = MAX(wCameraMax, uwCameraMin);
+	s_sCamera.uPos.uwY = uwCameraMin;
+	tilesStreamReset(s_sCamera.uPos.uwY);
+
+	blitterModelResetStats();
+	tilesDrawAllOn(s_sManager.pBack);
+	tilesDrawAllOn(s_sManager.pFront);
+	blitWait();
+	printf(
+		"Map %hhux%hhu, seed %lu, camera %hu..%hu\n", tileGetMapWidth(),
+		tileGetMapHeight(), (unsigned long)ulSeed, uwCameraMin, uwCameraMax
+	);
+	printStats("Initial draw", blitterModelGetStats());
+	if(!dumpBuffer(s_sManager.pBack, szOutDir, "initial")) {
+		return EXIT_FAILURE;
+	}
+
+	tileCrumbleStart();
+	tBlitterModelStats sTotal = {0}, sMax = {0};
+	BYTE bCameraDir = RENDER_CHECK_CAMERA_SPEED;
+	for(ULONG ulFrame = 1; ulFrame <= ulFrames; ++ulFrame) {
+		blitterModelResetStats();
+		if(
+			(bCameraDir > 0 && s_sCamera.uPos.uwY >= uwCameraMax) ||
+			(bCameraDir < 0 && s_sCamera.uPos.uwY <= uwCameraMin)
+		) {
+			bCameraDir = -bCameraDir;
+		}
+		s_sCamera.uPos.uwY = CLAMP(s_sCamera.uPos.uwY + bCameraDir, uwCameraMin, uwCameraMax);
+
+		// Same order as in game's gsGameLoop()
+		tilesStreamProcess(s_sManager.pBack, s_sCamera.uPos.uwY);
+		tileCrumbleProcess(s_sManager.pBack);
+		schedulerProcess();
+		eventsEndFrame();
+		blitWait();
+
+		const tBlitterModelStats *pStats = blitterModelGetStats();
+		sTotal.ulBlits += pStats->ulBlits;
+		sTotal.ulWords += pStats->ulWords;
+		sTotal.ulClocks += pStats->ulClocks;
+		sTotal.ulSkipped += pStats->ulSkipped;
+		sMax.ulBlits = MAX(sMax.ulBlits, pStats->ulBlits);
+		sMax.ulWords = MAX(sMax.ulWords, pStats->ulWords);
+		sMax.ulClocks = MAX(sMax.ulClocks, pStats->ulClocks);
+
+		if(!(ulFrame % RENDER_CHECK_DUMP_INTERVAL) || ulFrame == ulFrames) {
+			char szName[32];
+			snprintf(szName, sizeof(szName), "frame%05lu", (unsigned long)ulFrame);
+			if(!dumpBuffer(s_sManager.pBack, szOutDir, szName)) {
+				return EXIT_FAILURE;
+			}
+		}
+
+		tBitMap *pTmp = s_sManager.pBack;
+		s_sManager.pBack = s_sManager.pFront;
+		s_sManager.pFront = pTmp;
+	}
+
+	if(ulFrames) {
+		printf(
+			"Per frame avg: %lu blits, %lu words, %lu clocks\n",
+			(unsigned long)(sTotal.ulBlits / ulFrames), (unsigned long)(sTotal.ulWords / ulFrames),
+			(unsigned long)(sTotal.ulClocks / ulFrames)
+		);
+		printStats("Per frame max", &sMax);
+	}
+	if(sTotal.ulSkipped) {
+		fprintf(stderr, "ERR: %lu blits not modelled\n", (unsigned long)sTotal.ulSkipped);
+		return EXIT_FAILURE;
+	}
+
+	bitmapDestroy(s_sManager.pBack);
+	bitmapDestroy(s_sManager.pFront);
+	bitmapDestroy(g_pTileset);
+	bitmapDestroy(g_pTilesetMask);
+	return EXIT_SUCCESS;
+}
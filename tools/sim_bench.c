@@ -0,0 +1,962 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Native simulation benchmark, compared against stored baseline.
+ *
+ * Usage: simBench scenario.txt baseline.json [check|update] [timeTolerancePct] [runs]
+ *
+ * warrior.c, tile.c, ai.c and steer.c are compiled unmodified against
+ * tools/host_ace and run with the same step order as game's loop. Each step
+ * is timed, allocations and blitter model DMA clocks are counted. Blits are
+ * deferred to the end of frame, so that their emulation isn't timed.
+ * With SIM_BLOCK_COUNTER, game code is built with -fsanitize-coverage=trace-pc
+ * and only basic blocks it executes in each step are counted. Unlike host
+ * time, that's the same on every run, so it's what the gate relies on. Both
+ * builds share the baseline, each one checks and updates its own metrics.
+ *
+ * Scenario is the same text file as for cycleBench, with extra keys:
+ *   crumble 200 - tick at which crumbling starts, default is after countdown
+ *   rng 1 2 3   - simulation, AI and cosmetic stream states at match start,
+ *                 e.g. from telemetry, overriding ones derived from seed
+ *   menu 1      - idle menu instead of the game: six menu steers are read
+ *                 and menu bitmap is copied to back buffer each frame, like
+ *                 menuGsLoop() does when nothing happens
+ *
+ * Host time is meaningless across machines, so it's reported in units of
+ * fixed calibration workload measured around each run, and scenario is run
+ * several times keeping the fastest one to filter out noise. Even so, it
+ * swings by tens of percent between sessions on the same machine, so times
+ * are only gated when tolerance for them is given on command line, "-" or
+ * no tolerance reports them only. Baseline is a flat JSON object written by
+ * "update" mode, which keeps its tolerances:
+ *   work_tolerance_pct  - allowed growth of executed blocks of frame and steps
+ *   count_tolerance_pct - allowed growth of allocations and DMA clocks
+ * Returns failure in "check" mode if anything is over its tolerance.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ace/managers/blit.h>
+#include <ace/managers/joy.h>
+#include <ace/managers/key.h>
+#include <ace/managers/memory.h>
+#include <ace/managers/ptplayer.h>
+#include <ace/managers/sprite.h>
+#include "blitter_model.h"
+#include "host_ace.h"
+#include "../src/display.h"
+#include "../src/event.h"
+#include "../src/game.h"
+#include "../src/input.h"
+#include "../src/mem_track.h"
+#include "../src/menu.h"
+#include "../src/rng.h"
+#include "../src/scheduler.h"
+#include "../src/sfx.h"
+#include "../src/steer.h"
+#include "../src/tile.h"
+#include "../src/warrior.h"
+
+#define SIM_PLAYER_MAX 6
+#define SIM_KEY_COUNT 10
+#define SIM_INPUT_MAX 4096
+#define SIM_LINE_SIZE 256
+#define SIM_RUNS_DEFAULT 5
+// Failed check is measured again before being reported, so that a load spike
+// on host doesn't fail it
+#define SIM_CHECK_ATTEMPTS 5
+#define SIM_CALIBRATION_ITERATIONS 1024
+#define SIM_CALIBRATION_REPEATS 200
+#define SIM_WORK_TOLERANCE_DEFAULT 10.0
+#define SIM_COUNT_TOLERANCE_DEFAULT 0.0
+// Time differences below this are timer resolution and scheduling noise
+#define SIM_TIME_FLOOR_CAL 0.005
+#define SIM_BUFFER_HEIGHT (DISPLAY_HEIGHT + MAP_TILE_SIZE)
+// Same as in game.c: first step after a tick, then 4 phases
+#define SIM_COUNTDOWN_TICKS (1 + 4 * 50)
+#define SIM_MENU_WIDTH 224
+#define SIM_MENU_HEIGHT 184
+#define SIM_WARRIOR_SHEET_FRAMES 256
+#define SIM_METRIC_MAX 16
+
+typedef enum tSimStep {
+	SIM_STEP_STREAM,
+	SIM_STEP_CRUMBLE,
+	SIM_STEP_SCHEDULER,
+	SIM_STEP_WARRIORS,
+	SIM_STEP_MENU_STEERS,
+	SIM_STEP_MENU_COPY,
+	SIM_STEP_COUNT
+} tSimStep;
+
+typedef struct tInput {
+	uint32_t ulFrame;
+	uint32_t ulJoy;
+	uint16_t uwKeys;
+} tInput;
+
+typedef struct tScenario {
+	uint32_t ulSeed;
+	tRngState sRng; ///< At match start, derived from seed or given directly.
+	uint8_t isRngGiven;
+	uint8_t ubPlayers;
+	uint8_t ubExtraEnemies;
+	uint8_t ubThunders;
+	uint8_t isMenu;
+	uint32_t ulFrames;
+	uint32_t ulCrumbleTick;
+	uint32_t ulInputCount;
+	tInput pInputs[SIM_INPUT_MAX];
+} tScenario;
+
+typedef struct tStepCounters {
+	uint64_t pNs[SIM_STEP_COUNT];
+	uint64_t pBlocks[SIM_STEP_COUNT];
+} tStepCounters;
+
+typedef struct tRunResult {
+	uint64_t pStepNs[SIM_STEP_COUNT];
+	uint64_t pStepBlocks[SIM_STEP_COUNT];
+	uint64_t ullFrameBlocks;
+	uint64_t ullFrameNs;
+	uint64_t ullFrameMaxNs;
+	uint64_t ullBlitClocks;
+	uint32_t ulBlitClocksMax;
+	tHostAceMemStats sMem;
+	tHostAceBobStats sBobs;
+} tRunResult;
+
+typedef struct tMeasurement {
+	tRunResult sBest;
+	double fCalibrationNs;
+	double fFrameCal;
+	double pStepCal[SIM_STEP_COUNT];
+	uint16_t uwRuns;
+} tMeasurement;
+
+typedef enum tMetricKind {
+	METRIC_KIND_TIME,
+	METRIC_KIND_WORK,
+	METRIC_KIND_COUNT,
+} tMetricKind;
+
+typedef struct tMetric {
+	char szName[32];
+	double fValue;
+	tMetricKind eKind;
+} tMetric;
+
+static const char *s_pStepNames[SIM_STEP_COUNT] = {
+	[SIM_STEP_STREAM] = "tilesStreamProcess",
+	[SIM_STEP_CRUMBLE] = "tileCrumbleProcess",
+	[SIM_STEP_SCHEDULER] = "schedulerProcess",
+	[SIM_STEP_WARRIORS] = "warriorsProcess",
+	[SIM_STEP_MENU_STEERS] = "menuSteers",
+	[SIM_STEP_MENU_COPY] = "menuCopy",
+};
+
+// Keys in order of g_uwBenchKeys bits in tools/cycle_bench_image.c
+static const UBYTE s_pKeys[SIM_KEY_COUNT] = {
+	KEY_RSHIFT, KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT,
+	KEY_LSHIFT, KEY_W, KEY_S, KEY_A, KEY_D
+};
+
+tBitMap *g_pWarriorFrames;
+tBitMap *g_pWarriorMasks;
+tBitMap *g_pTileset;
+tBitMap *g_pTilesetMask;
+tBitMap *g_pFramesThunder[2];
+tBitMap *g_pFramesCross;
+tPtplayerSfx *g_pSfxNo;
+tPtplayerSfx *g_pSfxSwipes[2];
+tPtplayerSfx *g_pSfxSwipeHit;
+tPtplayerSfx *g_pSfxCrumble;
+tPtplayerSfx *g_pSfxThunder;
+
+static tScenario s_sScenario;
+static tCameraManager s_sCamera;
+static tScrollBufferManager s_sManager = {.pCamera = &s_sCamera};
+static UBYTE s_isCountdownActive;
+static UBYTE s_isCrumbling;
+static volatile uint32_t s_ulCalibrationSink;
+static uint64_t s_ullBlocks;
+static uint64_t s_ullStepStartNs;
+static uint64_t s_ullStepStartBlocks;
+
+//------------------------------------------------------------------- COVERAGE
+
+#if defined(SIM_BLOCK_COUNTER)
+// Called by instrumented game code on each executed basic block
+void __sanitizer_cov_trace_pc(void) {
+	++s_ullBlocks;
+}
+#endif
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static uint64_t timeNs(void) {
+	struct timespec sTime;
+	timespec_get(&sTime, TIME_UTC);
+	return (uint64_t)sTime.tv_sec * 1000000000ULL + sTime.tv_nsec;
+}
+
+static void stepBegin(void) {
+	s_ullStepStartBlocks = s_ullBlocks;
+	s_ullStepStartNs = timeNs();
+}
+
+static void stepEnd(tStepCounters *pSteps, tSimStep eStep) {
+	uint64_t ullEnd = timeNs();
+	pSteps->pNs[eStep] += ullEnd - s_ullStepStartNs;
+	pSteps->pBlocks[eStep] += s_ullBlocks - s_ullStepStartBlocks;
+}
+
+/**
+ * Integer and table work similar in mix to simulation code, fastest of
+ * several repeats. Step times are reported in multiples of it.
+ */
+static double calibrate(void) {
+	static uint8_t s_pTable[1024];
+	uint64_t ullBest = UINT64_MAX;
+	for(uint16_t uwRepeat = 0; uwRepeat < SIM_CALIBRATION_REPEATS; ++uwRepeat) {
+		uint32_t ulState = 0x1234567;
+		uint64_t ullStart = timeNs();
+		for(uint32_t i = 0; i < SIM_CALIBRATION_ITERATIONS; ++i) {
+			ulState ^= ulState << 13;
+			ulState ^= ulState >> 17;
+			ulState ^= ulState << 5;
+			uint16_t uwIndex = ulState & (sizeof(s_pTable) - 1);
+			s_pTable[uwIndex] += (ulState >> 24) > s_pTable[(uwIndex + 1) & (sizeof(s_pTable) - 1)];
+		}
+		uint64_t ullTime = timeNs() - ullStart;
+		s_ulCalibrationSink += s_pTable[ulState & (sizeof(s_pTable) - 1)];
+		if(ullTime < ullBest) {
+			ullBest = ullTime;
+		}
+	}
+	return ullBest ? (double)ullBest : 1.0;
+}
+
+static int scenarioLoad(const char *szPath, tScenario *pScenario) {
+	FILE *pFile = fopen(szPath, "r");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szPath);
+		return 0;
+	}
+	memset(pScenario, 0, sizeof(*pScenario));
+	pScenario->ulCrumbleTick = SIM_COUNTDOWN_TICKS + 1;
+	char szLine[SIM_LINE_SIZE];
+	uint32_t ulLine = 0;
+	int isOk = 1;
+	while(isOk && fgets(szLine, sizeof(szLine), pFile)) {
+		++ulLine;
+		char szKey[16];
+		long pValues[3];
+		int lCount = sscanf(
+			szLine, "%15s %li %li %li", szKey, &pValues[0], &pValues[1], &pValues[2]
+		);
+		if(lCount <= 0 || szKey[0] == '#') {
+			continue;
+		}
+		if(!strcmp(szKey, "seed") && lCount == 2) {
+			pScenario->ulSeed = pValues[0];
+		}
+		else if(!strcmp(szKey, "players") && lCount == 2) {
+			pScenario->ubPlayers = pValues[0];
+		}
+		else if(!strcmp(szKey, "extra") && lCount == 2) {
+			pScenario->ubExtraEnemies = pValues[0];
+		}
+		else if(!strcmp(szKey, "thunders") && lCount == 2) {
+			pScenario->ubThunders = pValues[0];
+		}
+		else if(!strcmp(szKey, "frames") && lCount == 2) {
+			pScenario->ulFrames = pValues[0];
+		}
+		else if(!strcmp(szKey, "rng") && lCount == RNG_STREAM_COUNT + 1) {
+			for(uint8_t i = 0; i < RNG_STREAM_COUNT; ++i) {
+				pScenario->sRng.pStreams[i] = pValues[i];
+			}
+			pScenario->isRngGiven = 1;
+		}
+		else if(!strcmp(szKey, "crumble") && lCount == 2) {
+			pScenario->ulCrumbleTick = pValues[0];
+		}
+		else if(!strcmp(szKey, "menu") && lCount == 2) {
+			pScenario->isMenu = pValues[0] != 0;
+		}
+		else if(!strcmp(szKey, "input") && lCount == 4) {
+			tInput *pPrev = (
+				pScenario->ulInputCount ? &pScenario->pInputs[pScenario->ulInputCount - 1] : 0
+			);
+			if(pScenario->ulInputCount >= SIM_INPUT_MAX) {
+				fprintf(stderr, "ERR: %s:%u: too many inputs\n", szPath, ulLine);
+				isOk = 0;
+			}
+			else if(pPrev && (long)pPrev->ulFrame > pValues[0]) {
+				fprintf(stderr, "ERR: %s:%u: input out of frame order\n", szPath, ulLine);
+				isOk = 0;
+			}
+			else {
+				pScenario->pInputs[pScenario->ulInputCount++] = (tInput){
+					.ulFrame = pValues[0], .ulJoy = pValues[1], .uwKeys = pValues[2]
+				};
+			}
+		}
+		else {
+			fprintf(stderr, "ERR: %s:%u: can't parse '%s'\n", szPath, ulLine, szKey);
+			isOk = 0;
+		}
+	}
+	fclose(pFile);
+	if(isOk && !pScenario->ulFrames) {
+		fprintf(stderr, "ERR: %s: no frames to run\n", szPath);
+		isOk = 0;
+	}
+	if(!pScenario->isRngGiven) {
+		rngInit(pScenario->ulSeed);
+		rngStateGet(&pScenario->sRng);
+	}
+	return isOk;
+}
+
+static void inputSet(uint32_t ulJoy, uint16_t uwKeys) {
+	// Same transitions as in ACE's joyProcess()/keyProcess()
+	for(UBYTE i = 0; i < sizeof(g_sJoyManager.pJoyStates); ++i) {
+		if(!(ulJoy & BV(i))) {
+			g_sJoyManager.pJoyStates[i] = JOY_NACTIVE;
+		}
+		else if(g_sJoyManager.pJoyStates[i] == JOY_NACTIVE) {
+			g_sJoyManager.pJoyStates[i] = JOY_ACTIVE;
+		}
+	}
+	for(UBYTE i = 0; i < SIM_KEY_COUNT; ++i) {
+		UBYTE *pState = &g_sKeyManager.pStates[s_pKeys[i]];
+		if(!(uwKeys & BV(i))) {
+			*pState = KEY_NACTIVE;
+		}
+		else if(*pState == KEY_NACTIVE) {
+			*pState = KEY_ACTIVE;
+		}
+	}
+}
+
+static void onCrumbleStart(void *pData) {
+	s_isCrumbling = 1;
+	tileCrumbleStart();
+}
+
+static void onCountdownDone(void *pData) {
+	s_isCountdownActive = 0;
+	warriorsEnableMove(1);
+}
+
+static void simCreateAssets(void) {
+	g_pTileset = bitmapCreate(
+		MAP_TILE_SIZE, MAP_FULL_TILE_HEIGHT * 10, DISPLAY_BPP, BMF_CLEAR | BMF_INTERLEAVED
+	);
+	g_pTilesetMask = bitmapCreate(
+		MAP_TILE_SIZE, MAP_FULL_TILE_HEIGHT * 10, DISPLAY_BPP, BMF_CLEAR | BMF_INTERLEAVED
+	);
+	// Bobs aren't drawn, frames only need to be addressable
+	g_pWarriorFrames = bitmapCreate(
+		16, 16 * SIM_WARRIOR_SHEET_FRAMES, DISPLAY_BPP, BMF_CLEAR | BMF_INTERLEAVED
+	);
+	g_pWarriorMasks = bitmapCreate(
+		16, 16 * SIM_WARRIOR_SHEET_FRAMES, DISPLAY_BPP, BMF_CLEAR | BMF_INTERLEAVED
+	);
+	g_pFramesThunder[0] = bitmapCreate(16, 256, 2, BMF_CLEAR);
+	g_pFramesThunder[1] = bitmapCreate(16, 256, 2, BMF_CLEAR);
+	g_pFramesCross = bitmapCreate(16, 16, 2, BMF_CLEAR);
+	s_sManager.uwBmAvailHeight = SIM_BUFFER_HEIGHT;
+	s_sManager.pBack = bitmapCreate(
+		DISPLAY_BOUND_WIDTH, SIM_BUFFER_HEIGHT, DISPLAY_BPP, BMF_CLEAR | BMF_INTERLEAVED
+	);
+	s_sManager.pFront = bitmapCreate(
+		DISPLAY_BOUND_WIDTH, SIM_BUFFER_HEIGHT, DISPLAY_BPP, BMF_CLEAR | BMF_INTERLEAVED
+	);
+}
+
+static void simDestroyAssets(void) {
+	bitmapDestroy(s_sManager.pBack);
+	bitmapDestroy(s_sManager.pFront);
+	bitmapDestroy(g_pFramesCross);
+	bitmapDestroy(g_pFramesThunder[1]);
+	bitmapDestroy(g_pFramesThunder[0]);
+	bitmapDestroy(g_pWarriorMasks);
+	bitmapDestroy(g_pWarriorFrames);
+	bitmapDestroy(g_pTilesetMask);
+	bitmapDestroy(g_pTileset);
+}
+
+static void simGameCreate(void) {
+	// Same order as in game's gsGameCreate()
+	// Game seeds once on boot and matches carry on from where previous one
+	// left, so each run restores stream states instead of seeding again
+	rngStateSet(&s_sScenario.sRng);
+	schedulerReset();
+	tilesInit();
+	warriorsCreate(s_sScenario.ubExtraEnemies);
+	eventsReset();
+	tilesReload();
+	s_sCamera.uPos.uwY = 0;
+	tilesStreamReset(s_sCamera.uPos.uwY);
+	tilesDrawAllOn(s_sManager.pBack);
+	tilesDrawAllOn(s_sManager.pFront);
+	blitWait();
+	warriorsEnableMove(0);
+	// Also drops sfx requests left over from previous run
+	sfxSetChannels(BV(2) | BV(3));
+	s_isCountdownActive = 1;
+	s_isCrumbling = 0;
+	schedulerAdd(SIM_COUNTDOWN_TICKS, onCountdownDone, 0);
+	schedulerAdd(s_sScenario.ulCrumbleTick, onCrumbleStart, 0);
+}
+
+static void simGameProcess(tStepCounters *pSteps) {
+	// Camera snaps to warriors instead of easing like displayCameraFollow()
+	tUwCoordYX sCenter;
+	if(warriorsGetAliveCenter(&sCenter)) {
+		UWORD uwMaxY = tileGetMapHeight() * MAP_TILE_SIZE;
+		uwMaxY = (uwMaxY > DISPLAY_HEIGHT) ? uwMaxY - DISPLAY_HEIGHT : 0;
+		UWORD uwY = (sCenter.uwY > DISPLAY_HEIGHT / 2) ? sCenter.uwY - DISPLAY_HEIGHT / 2 : 0;
+		s_sCamera.uPos.uwY = MIN(uwY, uwMaxY);
+	}
+
+	// Same order as in game's gsGameLoop()
+	stepBegin();
+	tilesStreamProcess(s_sManager.pBack, s_sCamera.uPos.uwY);
+	stepEnd(pSteps, SIM_STEP_STREAM);
+
+	stepBegin();
+	if(s_isCrumbling) {
+		tileCrumbleProcess(s_sManager.pBack);
+	}
+	stepEnd(pSteps, SIM_STEP_CRUMBLE);
+
+	stepBegin();
+	schedulerProcess();
+	stepEnd(pSteps, SIM_STEP_SCHEDULER);
+
+	// Input is latched right before warriors and their events are consumed
+	// right after them, same as in gameGsLoop()
+	stepBegin();
+	inputProcess();
+	warriorsProcess();
+	sfxProcessEvents();
+	eventsEndFrame();
+	stepEnd(pSteps, SIM_STEP_WARRIORS);
+}
+
+static void simMenuProcess(tSteer *pSteers, const tBitMap *pMenu, tStepCounters *pSteps) {
+	stepBegin();
+	inputProcess();
+	for(UBYTE i = 0; i < SIM_PLAYER_MAX; ++i) {
+		steerProcess(&pSteers[i]);
+		steerDirUse(&pSteers[i], DIRECTION_FIRE);
+	}
+	stepEnd(pSteps, SIM_STEP_MENU_STEERS);
+
+	stepBegin();
+	blitCopyAligned(
+		pMenu, 0, 0, s_sManager.pBack,
+		(DISPLAY_WIDTH - SIM_MENU_WIDTH) / 2, (DISPLAY_HEIGHT - SIM_MENU_HEIGHT) / 2,
+		SIM_MENU_WIDTH, SIM_MENU_HEIGHT
+	);
+	stepEnd(pSteps, SIM_STEP_MENU_COPY);
+}
+
+static void simRun(tRunResult *pResult) {
+	memset(pResult, 0, sizeof(*pResult));
+	memset(&g_sJoyManager, 0, sizeof(g_sJoyManager));
+	memset(&g_sKeyManager, 0, sizeof(g_sKeyManager));
+	inputReset();
+	hostAceSetBlitDeferred(1);
+	simCreateAssets();
+
+	tBitMap *pMenu = 0;
+	tSteer pMenuSteers[SIM_PLAYER_MAX];
+	if(s_sScenario.isMenu) {
+		static const tSteerMode pModes[SIM_PLAYER_MAX] = {
+			STEER_MODE_JOY_1, STEER_MODE_JOY_2, STEER_MODE_JOY_3, STEER_MODE_JOY_4,
+			STEER_MODE_KEY_ARROWS, STEER_MODE_KEY_WSAD
+		};
+		pMenu = bitmapCreate(SIM_MENU_WIDTH, SIM_MENU_HEIGHT, DISPLAY_BPP, BMF_INTERLEAVED);
+		for(UBYTE i = 0; i < SIM_PLAYER_MAX; ++i) {
+			pMenuSteers[i] = steerInitFromMode(pModes[i]);
+		}
+	}
+	else {
+		simGameCreate();
+	}
+
+	// Counted from first frame, setup allocations are expected
+	hostAceResetStats();
+	uint32_t ulNextInput = 0;
+	for(uint32_t ulFrame = 0; ulFrame < s_sScenario.ulFrames; ++ulFrame) {
+		if(
+			ulNextInput < s_sScenario.ulInputCount &&
+			s_sScenario.pInputs[ulNextInput].ulFrame <= ulFrame
+		) {
+			const tInput *pInput = &s_sScenario.pInputs[ulNextInput++];
+			inputSet(pInput->ulJoy, pInput->uwKeys);
+		}
+		else {
+			// Held inputs stop being edges
+			const tInput *pInput = ulNextInput ? &s_sScenario.pInputs[ulNextInput - 1] : 0;
+			inputSet(pInput ? pInput->ulJoy : 0, pInput ? pInput->uwKeys : 0);
+		}
+
+		blitterModelResetStats();
+		tStepCounters sSteps = {{0}};
+		if(s_sScenario.isMenu) {
+			simMenuProcess(pMenuSteers, pMenu, &sSteps);
+		}
+		else {
+			simGameProcess(&sSteps);
+		}
+		blitWait();
+		hostAceBlitFlush();
+
+		uint64_t ullFrameNs = 0;
+		for(UBYTE i = 0; i < SIM_STEP_COUNT; ++i) {
+			pResult->pStepNs[i] += sSteps.pNs[i];
+			pResult->pStepBlocks[i] += sSteps.pBlocks[i];
+			pResult->ullFrameBlocks += sSteps.pBlocks[i];
+			ullFrameNs += sSteps.pNs[i];
+		}
+		pResult->ullFrameNs += ullFrameNs;
+		pResult->ullFrameMaxNs = MAX(pResult->ullFrameMaxNs, ullFrameNs);
+		uint32_t ulBlitClocks = blitterModelGetStats()->ulClocks;
+		pResult->ullBlitClocks += ulBlitClocks;
+		pResult->ulBlitClocksMax = MAX(pResult->ulBlitClocksMax, ulBlitClocks);
+
+		tBitMap *pTmp = s_sManager.pBack;
+		s_sManager.pBack = s_sManager.pFront;
+		s_sManager.pFront = pTmp;
+	}
+	pResult->sMem = *hostAceGetMemStats();
+	pResult->sBobs = *hostAceGetBobStats();
+
+	if(s_sScenario.isMenu) {
+		bitmapDestroy(pMenu);
+	}
+	else {
+		warriorsDestroy();
+	}
+	hostAceSetBlitDeferred(0);
+	simDestroyAssets();
+}
+
+static void metricAdd(
+	tMetric *pMetrics, uint8_t *pCount, const char *szName, double fValue,
+	tMetricKind eKind
+) {
+	tMetric *pMetric = &pMetrics[(*pCount)++];
+	snprintf(pMetric->szName, sizeof(pMetric->szName), "%s", szName);
+	pMetric->fValue = fValue;
+	pMetric->eKind = eKind;
+}
+
+/**
+ * Reads number stored under given key in flat JSON object.
+ */
+static int jsonGetNumber(const char *szJson, const char *szKey, double *pValue) {
+	// Key is matched in place, only where it's quoted as a whole
+	size_t ulKeyLength = strlen(szKey);
+	const char *pPos = strstr(szJson, szKey);
+	while(pPos && (pPos == szJson || pPos[-1] != '"' || pPos[ulKeyLength] != '"')) {
+		pPos = strstr(pPos + 1, szKey);
+	}
+	if(!pPos) {
+		return 0;
+	}
+	pPos += ulKeyLength + 1;
+	while(*pPos == ' ' || *pPos == '\t' || *pPos == ':') {
+		++pPos;
+	}
+	char *pEnd;
+	*pValue = strtod(pPos, &pEnd);
+	return pEnd != pPos;
+}
+
+static char *fileReadText(const char *szPath) {
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		return 0;
+	}
+	fseek(pFile, 0, SEEK_END);
+	long lSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	char *szText = malloc(lSize + 1);
+	size_t ulRead = fread(szText, 1, lSize, pFile);
+	szText[ulRead] = '\0';
+	fclose(pFile);
+	return szText;
+}
+
+static const tMetric *metricFind(
+	const tMetric *pMetrics, uint8_t ubCount, const char *szName
+) {
+	for(uint8_t i = 0; i < ubCount; ++i) {
+		if(!strcmp(pMetrics[i].szName, szName)) {
+			return &pMetrics[i];
+		}
+	}
+	return 0;
+}
+
+/**
+ * Writes baseline with given metrics. Ones from previous baseline which this
+ * build doesn't measure are kept in place, so that both builds can update it.
+ */
+static int baselineWrite(
+	const char *szPath, const char *szScenario, const char *szOldJson,
+	const tMetric *pMetrics, uint8_t ubCount, double fWorkTolerance,
+	double fCountTolerance
+) {
+	tMetric pMerged[2 * SIM_METRIC_MAX];
+	uint8_t ubMergedCount = 0;
+	for(const char *pLine = szOldJson; pLine && *pLine; ++pLine) {
+		char szName[32];
+		double fValue;
+		if(
+			sscanf(pLine, " \"%31[^\"]\": %lf", szName, &fValue) == 2 &&
+			!strstr(szName, "_pct") && ubMergedCount < ARRAY_SIZE(pMerged)
+		) {
+			const tMetric *pNew = metricFind(pMetrics, ubCount, szName);
+			if(pNew) {
+				pMerged[ubMergedCount++] = *pNew;
+			}
+			else {
+				tMetricKind eKind = strstr(szName, "_cal") ? METRIC_KIND_TIME : METRIC_KIND_COUNT;
+				metricAdd(pMerged, &ubMergedCount, szName, fValue, eKind);
+			}
+		}
+		pLine = strchr(pLine, '\n');
+		if(!pLine) {
+			break;
+		}
+	}
+	for(uint8_t i = 0; i < ubCount; ++i) {
+		if(
+			!metricFind(pMerged, ubMergedCount, pMetrics[i].szName) &&
+			ubMergedCount < ARRAY_SIZE(pMerged)
+		) {
+			pMerged[ubMergedCount++] = pMetrics[i];
+		}
+	}
+
+	FILE *pFile = fopen(szPath, "w");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't write '%s'\n", szPath);
+		return 0;
+	}
+	fprintf(pFile, "{\n");
+	fprintf(pFile, "\t\"scenario\": \"%s\",\n", szScenario);
+	fprintf(pFile, "\t\"work_tolerance_pct\": %.1f,\n", fWorkTolerance);
+	fprintf(pFile, "\t\"count_tolerance_pct\": %.1f,\n", fCountTolerance);
+	for(uint8_t i = 0; i < ubMergedCount; ++i) {
+		fprintf(
+			pFile, "\t\"%s\": %.*f%s\n", pMerged[i].szName,
+			pMerged[i].eKind == METRIC_KIND_TIME ? 3 : 0, pMerged[i].fValue,
+			i + 1 < ubMergedCount ? "," : ""
+		);
+	}
+	fprintf(pFile, "}\n");
+	fclose(pFile);
+	return 1;
+}
+
+/**
+ * Runs scenario given number of times, merging results into measurement.
+ * Each run is normalized by calibration taken right next to it, so that host
+ * clock changes between runs cancel out. Fastest run is the least disturbed
+ * by the rest of the system.
+ */
+static void measure(tMeasurement *pMeasurement, uint8_t ubRuns) {
+	for(uint8_t ubRun = 0; ubRun < ubRuns; ++ubRun) {
+		tRunResult sResult;
+		double fCalibrationNs = calibrate();
+		simRun(&sResult);
+		fCalibrationNs = MIN(fCalibrationNs, calibrate());
+		double fFrameScale = 1.0 / (s_sScenario.ulFrames * fCalibrationNs);
+		tRunResult *pBest = &pMeasurement->sBest;
+		if(pMeasurement->uwRuns && sResult.ullFrameBlocks != pBest->ullFrameBlocks) {
+			fprintf(stderr, "WARN: Executed blocks differ between runs, simulation isn't deterministic\n");
+		}
+		if(!pMeasurement->uwRuns++) {
+			*pBest = sResult;
+			pMeasurement->fCalibrationNs = fCalibrationNs;
+			pMeasurement->fFrameCal = sResult.ullFrameNs * fFrameScale;
+			for(UBYTE i = 0; i < SIM_STEP_COUNT; ++i) {
+				pMeasurement->pStepCal[i] = sResult.pStepNs[i] * fFrameScale;
+			}
+			continue;
+		}
+		for(UBYTE i = 0; i < SIM_STEP_COUNT; ++i) {
+			pBest->pStepNs[i] = MIN(pBest->pStepNs[i], sResult.pStepNs[i]);
+			pMeasurement->pStepCal[i] = MIN(
+				pMeasurement->pStepCal[i], sResult.pStepNs[i] * fFrameScale
+			);
+		}
+		pBest->ullFrameNs = MIN(pBest->ullFrameNs, sResult.ullFrameNs);
+		pBest->ullFrameMaxNs = MIN(pBest->ullFrameMaxNs, sResult.ullFrameMaxNs);
+		pMeasurement->fFrameCal = MIN(
+			pMeasurement->fFrameCal, sResult.ullFrameNs * fFrameScale
+		);
+		pMeasurement->fCalibrationNs = MIN(pMeasurement->fCalibrationNs, fCalibrationNs);
+	}
+}
+
+/**
+ * @brief Fills metrics from measurement, times are per-frame averages in
+ * calibration units and executed blocks are totals of whole run.
+ */
+static uint8_t metricsFill(const tMeasurement *pMeasurement, tMetric *pMetrics) {
+	const tRunResult *pBest = &pMeasurement->sBest;
+	uint8_t ubMetricCount = 0;
+#if defined(SIM_BLOCK_COUNTER)
+	// Instrumentation distorts times and counts come from the plain build
+	metricAdd(
+		pMetrics, &ubMetricCount, "frame_blocks", pBest->ullFrameBlocks, METRIC_KIND_WORK
+	);
+	for(UBYTE i = 0; i < SIM_STEP_COUNT; ++i) {
+		if(pBest->pStepBlocks[i]) {
+			char szName[32];
+			snprintf(szName, sizeof(szName), "%s_blocks", s_pStepNames[i]);
+			metricAdd(
+				pMetrics, &ubMetricCount, szName, pBest->pStepBlocks[i], METRIC_KIND_WORK
+			);
+		}
+	}
+#else
+	metricAdd(
+		pMetrics, &ubMetricCount, "frame_cal", pMeasurement->fFrameCal, METRIC_KIND_TIME
+	);
+	for(UBYTE i = 0; i < SIM_STEP_COUNT; ++i) {
+		if(pBest->pStepNs[i]) {
+			char szName[32];
+			snprintf(szName, sizeof(szName), "%s_cal", s_pStepNames[i]);
+			metricAdd(
+				pMetrics, &ubMetricCount, szName, pMeasurement->pStepCal[i],
+				METRIC_KIND_TIME
+			);
+		}
+	}
+	metricAdd(pMetrics, &ubMetricCount, "allocs", pBest->sMem.ulAllocs, METRIC_KIND_COUNT);
+	metricAdd(
+		pMetrics, &ubMetricCount, "alloc_bytes", pBest->sMem.ulAllocBytes, METRIC_KIND_COUNT
+	);
+	metricAdd(
+		pMetrics, &ubMetricCount, "alloc_peak_bytes", pBest->sMem.ulPeakBytes,
+		METRIC_KIND_COUNT
+	);
+	metricAdd(
+		pMetrics, &ubMetricCount, "blit_clocks", pBest->ullBlitClocks, METRIC_KIND_COUNT
+	);
+	metricAdd(
+		pMetrics, &ubMetricCount, "blit_clocks_max", pBest->ulBlitClocksMax,
+		METRIC_KIND_COUNT
+	);
+	metricAdd(
+		pMetrics, &ubMetricCount, "bob_words", pBest->sBobs.ulPushedWords, METRIC_KIND_COUNT
+	);
+#endif
+	return ubMetricCount;
+}
+
+static void measurementPrint(const char *szScenario, const tMeasurement *pMeasurement) {
+	printf(
+		"%s: %u frames, %hu runs, calibration unit %.0f ns\n", szScenario,
+		s_sScenario.ulFrames, pMeasurement->uwRuns, pMeasurement->fCalibrationNs
+	);
+	printf(
+		"frame avg %.0f ns, max %.0f ns\n",
+		(double)pMeasurement->sBest.ullFrameNs / s_sScenario.ulFrames,
+		(double)pMeasurement->sBest.ullFrameMaxNs
+	);
+}
+
+/**
+ * @brief Compares metrics against baseline, optionally printing the table.
+ * Negative time tolerance means times are only reported.
+ * @return 1 if everything is within tolerance, otherwise 0.
+ */
+static int metricsCheck(
+	const char *szJson, const tMetric *pMetrics, uint8_t ubMetricCount,
+	double fTimeTolerance, double fWorkTolerance, double fCountTolerance, int isPrint
+) {
+	if(isPrint) {
+		printf("  %-28s %14s %14s %8s\n", "metric", "baseline", "current", "diff");
+	}
+	int isPassed = 1;
+	for(uint8_t i = 0; i < ubMetricCount; ++i) {
+		const tMetric *pMetric = &pMetrics[i];
+		double fBase;
+		if(!jsonGetNumber(szJson, pMetric->szName, &fBase)) {
+			if(isPrint) {
+				printf("  %-28s %14s %14.3f      new\n", pMetric->szName, "-", pMetric->fValue);
+			}
+			continue;
+		}
+		double fTolerance = (
+			pMetric->eKind == METRIC_KIND_TIME ? fTimeTolerance :
+			pMetric->eKind == METRIC_KIND_WORK ? fWorkTolerance : fCountTolerance
+		);
+		double fDiffPct = fBase ? (pMetric->fValue - fBase) * 100.0 / fBase : (
+			pMetric->fValue ? 100.0 : 0.0
+		);
+		double fFloor = pMetric->eKind == METRIC_KIND_TIME ? SIM_TIME_FLOOR_CAL : 1e-9;
+		int isGated = fTolerance >= 0;
+		int isOver = isGated && pMetric->fValue > fBase * (1.0 + fTolerance / 100.0) + fFloor;
+		if(isOver) {
+			isPassed = 0;
+		}
+		if(isPrint) {
+			printf(
+				"  %-28s %14.3f %14.3f %+7.1f%%%s\n", pMetric->szName, fBase,
+				pMetric->fValue, fDiffPct, isOver ? "  FAIL" : (isGated ? "" : "  info")
+			);
+		}
+	}
+	return isPassed;
+}
+
+//------------------------------------------------------------------------ STUBS
+
+UBYTE gameIsCountdownActive(void) {
+	return s_isCountdownActive;
+}
+
+tSteerMode menuGetSteerModeForPlayer(UBYTE ubPlayerIndex) {
+	static const tSteerMode pSteersForPlayers[SIM_PLAYER_MAX] = {
+		STEER_MODE_JOY_1, STEER_MODE_JOY_2, STEER_MODE_JOY_3, STEER_MODE_JOY_4,
+		STEER_MODE_KEY_ARROWS, STEER_MODE_KEY_WSAD
+	};
+	if(ubPlayerIndex >= SIM_PLAYER_MAX || !(s_sScenario.ubPlayers & BV(ubPlayerIndex))) {
+		return STEER_MODE_AI;
+	}
+	return pSteersForPlayers[ubPlayerIndex];
+}
+
+UBYTE menuAreThundersEnabled(void) {
+	return s_sScenario.ubThunders;
+}
+
+tScrollBufferManager *displayGetManager(void) {
+	return &s_sManager;
+}
+
+void displaySetThunderColor(UBYTE ubColorIndex) {
+}
+
+void *memTrackAllocFast(tMemTag eTag, ULONG ulSize) {
+	// Forwarded, so that host_ace still counts it
+	return memAllocFast(ulSize);
+}
+
+void memTrackFreeFast(tMemTag eTag, void *pMem, ULONG ulSize) {
+	memFree(pMem, ulSize);
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 3) {
+		fprintf(
+			stderr,
+			"Usage: %s scenario.txt baseline.json [check|update] [timeTolerancePct] [runs]\n",
+			pArgs[0]
+		);
+		return EXIT_FAILURE;
+	}
+	const char *szScenario = pArgs[1];
+	const char *szBaseline = pArgs[2];
+	int isUpdate = lArgCount > 3 && !strcmp(pArgs[3], "update");
+	if(lArgCount > 3 && !isUpdate && strcmp(pArgs[3], "check")) {
+		fprintf(stderr, "ERR: Unknown mode '%s'\n", pArgs[3]);
+		return EXIT_FAILURE;
+	}
+	uint8_t ubRuns = lArgCount > 5 ? atoi(pArgs[5]) : SIM_RUNS_DEFAULT;
+	if(!ubRuns) {
+		ubRuns = 1;
+	}
+	if(!scenarioLoad(szScenario, &s_sScenario)) {
+		return EXIT_FAILURE;
+	}
+
+	tMeasurement sMeasurement = {.uwRuns = 0};
+	measure(&sMeasurement, ubRuns);
+	tMetric pMetrics[SIM_METRIC_MAX];
+	uint8_t ubMetricCount = metricsFill(&sMeasurement, pMetrics);
+
+	char *szJson = fileReadText(szBaseline);
+	double fTimeTolerance = -1;
+	double fWorkTolerance = SIM_WORK_TOLERANCE_DEFAULT;
+	double fCountTolerance = SIM_COUNT_TOLERANCE_DEFAULT;
+	if(szJson) {
+		jsonGetNumber(szJson, "work_tolerance_pct", &fWorkTolerance);
+		jsonGetNumber(szJson, "count_tolerance_pct", &fCountTolerance);
+	}
+	if(lArgCount > 4 && strcmp(pArgs[4], "-")) {
+		fTimeTolerance = atof(pArgs[4]);
+	}
+	if(isUpdate) {
+		// Tolerances are kept, they're configuration rather than results
+		measurementPrint(szScenario, &sMeasurement);
+		for(uint8_t i = 0; i < ubMetricCount; ++i) {
+			printf("  %-28s %14.3f\n", pMetrics[i].szName, pMetrics[i].fValue);
+		}
+		int isWritten = baselineWrite(
+			szBaseline, szScenario, szJson, pMetrics, ubMetricCount,
+			fWorkTolerance, fCountTolerance
+		);
+		free(szJson);
+		if(!isWritten) {
+			return EXIT_FAILURE;
+		}
+		printf("Baseline written to '%s'\n", szBaseline);
+		return EXIT_SUCCESS;
+	}
+
+	if(!szJson) {
+		fprintf(stderr, "ERR: Can't open baseline '%s', run in update mode first\n", szBaseline);
+		return EXIT_FAILURE;
+	}
+	int isPassed = metricsCheck(
+		szJson, pMetrics, ubMetricCount, fTimeTolerance, fWorkTolerance, fCountTolerance, 0
+	);
+	for(
+		uint8_t ubAttempt = 1;
+		!isPassed && fTimeTolerance >= 0 && ubAttempt < SIM_CHECK_ATTEMPTS; ++ubAttempt
+	) {
+		// Counts are deterministic, only timing may improve with more runs
+		measure(&sMeasurement, ubRuns);
+		ubMetricCount = metricsFill(&sMeasurement, pMetrics);
+		isPassed = metricsCheck(
+			szJson, pMetrics, ubMetricCount, fTimeTolerance, fWorkTolerance, fCountTolerance, 0
+		);
+	}
+	measurementPrint(szScenario, &sMeasurement);
+	if(fTimeTolerance >= 0) {
+		printf("tolerance: time %.1f%%, ", fTimeTolerance);
+	}
+	else {
+		printf("tolerance: time not gated, ");
+	}
+	printf("work %.1f%%, counts %.1f%%\n\n", fWorkTolerance, fCountTolerance);
+	metricsCheck(
+		szJson, pMetrics, ubMetricCount, fTimeTolerance, fWorkTolerance, fCountTolerance, 1
+	);
+	free(szJson);
+	if(!isPassed) {
+		fprintf(stderr, "ERR: %s is slower than its baseline\n", szScenario);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,322 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Aggregates match telemetry written by src/telemetry.c.
+ *
+ * Usage: telemetryAnalyze outDir telemetry.bin [telemetry.bin...]
+ *
+ * Prints per-map statistics and saves heatmaps of falls and hits for each
+ * map as outDir/mapNN_falls.png and outDir/mapNN_hits.png, one cell per tile.
+ * Rng state at start of each match goes to outDir/replays.txt as simBench
+ * scenario lines, so that AI-only matches can be replayed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitmap_file.h"
+#include "png_file.h"
+#include "telemetry_format.h"
+
+#define ANALYZE_MAP_MAX 256
+#define ANALYZE_WINNER_MAX 6
+#define ANALYZE_TILE_SIZE 16
+#define ANALYZE_CELL_SIZE 8 // Heatmap pixels per tile
+#define ANALYZE_COLORS 256
+
+typedef enum tHeatmap {
+	HEATMAP_FALLS,
+	HEATMAP_HITS,
+	HEATMAP_COUNT
+} tHeatmap;
+
+typedef struct tMapStats {
+	uint32_t ulMatches;
+	uint32_t ulTruncated;
+	uint32_t ulCancelled;
+	uint32_t ulFrames;
+	uint32_t pRecordCounts[TELEMETRY_RECORD_TYPE_COUNT];
+	uint32_t pWins[ANALYZE_WINNER_MAX];
+	uint32_t ulNoWinner;
+	uint32_t ulSeconds;
+	uint32_t ulLineSum; ///< Of per-second averages.
+	uint16_t uwLineMax;
+	uint8_t ubWidth; ///< In tiles.
+	uint8_t ubHeight;
+	uint32_t *pHeat[HEATMAP_COUNT]; ///< Per tile, allocated on first match.
+} tMapStats;
+
+static const char * const s_pHeatmapNames[HEATMAP_COUNT] = {
+	[HEATMAP_FALLS] = "falls",
+	[HEATMAP_HITS] = "hits",
+};
+
+static tMapStats s_pMaps[ANALYZE_MAP_MAX];
+static FILE *s_pReplays;
+
+//------------------------------------------------------------------ PRIVATE FNS
+
+static uint32_t readBeLong(const uint8_t *pSrc) {
+	return ((uint32_t)readBeWord(&pSrc[0]) << 16) | readBeWord(&pSrc[2]);
+}
+
+static void heatAdd(tMapStats *pMap, tHeatmap eHeatmap, uint16_t uwX, uint16_t uwY) {
+	uint16_t uwTileX = uwX / ANALYZE_TILE_SIZE;
+	uint16_t uwTileY = uwY / ANALYZE_TILE_SIZE;
+	if(uwTileX < pMap->ubWidth && uwTileY < pMap->ubHeight) {
+		++pMap->pHeat[eHeatmap][uwTileY * pMap->ubWidth + uwTileX];
+	}
+}
+
+static void recordAdd(tMapStats *pMap, const uint8_t *pRecord) {
+	uint8_t ubType = pRecord[2];
+	uint16_t uwX = readBeWord(&pRecord[6]);
+	uint16_t uwY = readBeWord(&pRecord[8]);
+	if(ubType >= TELEMETRY_RECORD_TYPE_COUNT) {
+		return;
+	}
+	++pMap->pRecordCounts[ubType];
+	switch(ubType) {
+		case TELEMETRY_RECORD_FALL:
+			heatAdd(pMap, HEATMAP_FALLS, uwX, uwY);
+			break;
+		case TELEMETRY_RECORD_HIT:
+			heatAdd(pMap, HEATMAP_HITS, uwX, uwY);
+			break;
+		case TELEMETRY_RECORD_SECOND:
+			++pMap->ulSeconds;
+			pMap->ulLineSum += uwX;
+			if(uwY > pMap->uwLineMax) {
+				pMap->uwLineMax = uwY;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * @return Bytes taken by the match, 0 on malformed data.
+ */
+static size_t matchAdd(const uint8_t *pData, size_t ulSize) {
+	if(
+		ulSize < TELEMETRY_HEADER_SIZE || readBeLong(&pData[0]) != TELEMETRY_MAGIC ||
+		readBeWord(&pData[4]) != TELEMETRY_VERSION ||
+		readBeWord(&pData[6]) != TELEMETRY_RECORD_SIZE
+	) {
+		return 0;
+	}
+	uint32_t ulRecordCount = readBeLong(&pData[8]);
+	size_t ulMatchSize = TELEMETRY_HEADER_SIZE + (size_t)ulRecordCount * TELEMETRY_RECORD_SIZE;
+	if(ulMatchSize > ulSize) {
+		return 0;
+	}
+
+	tMapStats *pMap = &s_pMaps[pData[16]];
+	uint8_t ubWidth = pData[17];
+	uint8_t ubHeight = pData[18];
+	if(!pMap->ulMatches) {
+		pMap->ubWidth = ubWidth;
+		pMap->ubHeight = ubHeight;
+		for(tHeatmap eHeatmap = 0; eHeatmap < HEATMAP_COUNT; ++eHeatmap) {
+			pMap->pHeat[eHeatmap] = calloc((size_t)ubWidth * ubHeight + 1, sizeof(uint32_t));
+		}
+	}
+	else if(pMap->ubWidth != ubWidth || pMap->ubHeight != ubHeight) {
+		fprintf(stderr, "WARN: Map %hhu size differs between matches\n", pData[16]);
+	}
+
+	fprintf(
+		s_pReplays, "# Map %hhu, winner %hhu, %lu frames\nrng 0x%08lX 0x%08lX 0x%08lX\n",
+		pData[16], pData[19], (unsigned long)readBeLong(&pData[12]),
+		(unsigned long)readBeLong(&pData[24]), (unsigned long)readBeLong(&pData[28]),
+		(unsigned long)readBeLong(&pData[32])
+	);
+
+	++pMap->ulMatches;
+	pMap->ulFrames += readBeLong(&pData[12]);
+	uint8_t ubWinner = pData[19];
+	if(pData[20] & TELEMETRY_MATCH_FLAG_CANCELLED) {
+		++pMap->ulCancelled;
+	}
+	else if(ubWinner < ANALYZE_WINNER_MAX) {
+		++pMap->pWins[ubWinner];
+	}
+	else {
+		++pMap->ulNoWinner;
+	}
+	if(pData[20] & TELEMETRY_MATCH_FLAG_TRUNCATED) {
+		++pMap->ulTruncated;
+	}
+
+	const uint8_t *pRecords = &pData[TELEMETRY_HEADER_SIZE];
+	for(uint32_t i = 0; i < ulRecordCount; ++i) {
+		recordAdd(pMap, &pRecords[i * TELEMETRY_RECORD_SIZE]);
+	}
+	return ulMatchSize;
+}
+
+static int fileAdd(const char *szPath) {
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szPath);
+		return 0;
+	}
+	fseek(pFile, 0, SEEK_END);
+	size_t ulSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	uint8_t *pData = malloc(ulSize ? ulSize : 1);
+	size_t ulRead = fread(pData, 1, ulSize, pFile);
+	fclose(pFile);
+	if(ulRead != ulSize) {
+		fprintf(stderr, "ERR: Can't read '%s'\n", szPath);
+		free(pData);
+		return 0;
+	}
+
+	size_t ulPos = 0;
+	while(ulPos < ulSize) {
+		size_t ulMatchSize = matchAdd(&pData[ulPos], ulSize - ulPos);
+		if(!ulMatchSize) {
+			// Game may have been reset while appending
+			fprintf(
+				stderr, "WARN: '%s' malformed at offset %zu, rest skipped\n", szPath, ulPos
+			);
+			break;
+		}
+		ulPos += ulMatchSize;
+	}
+	free(pData);
+	return 1;
+}
+
+static void heatPaletteFill(uint8_t *pPalette) {
+	// Black through red and yellow to white
+	for(uint16_t i = 0; i < ANALYZE_COLORS; ++i) {
+		uint16_t uwLevel = i * 3;
+		pPalette[i * 3 + 0] = uwLevel > 255 ? 255 : uwLevel;
+		pPalette[i * 3 + 1] = uwLevel > 511 ? 255 : (uwLevel > 255 ? uwLevel - 256 : 0);
+		pPalette[i * 3 + 2] = uwLevel > 511 ? uwLevel - 512 : 0;
+	}
+}
+
+static int heatmapSave(
+	const tMapStats *pMap, tHeatmap eHeatmap, uint16_t uwMapIndex,
+	const char *szOutDir, const uint8_t *pPalette
+) {
+	const uint32_t *pHeat = pMap->pHeat[eHeatmap];
+	uint32_t ulMax = 0;
+	for(uint32_t i = 0; i < (uint32_t)pMap->ubWidth * pMap->ubHeight; ++i) {
+		if(pHeat[i] > ulMax) {
+			ulMax = pHeat[i];
+		}
+	}
+
+	uint16_t uwWidth = pMap->ubWidth * ANALYZE_CELL_SIZE;
+	uint16_t uwHeight = pMap->ubHeight * ANALYZE_CELL_SIZE;
+	uint8_t *pPixels = malloc((size_t)uwWidth * uwHeight + 1);
+	for(uint16_t y = 0; y < uwHeight; ++y) {
+		for(uint16_t x = 0; x < uwWidth; ++x) {
+			uint32_t ulHeat = pHeat[
+				(y / ANALYZE_CELL_SIZE) * pMap->ubWidth + x / ANALYZE_CELL_SIZE
+			];
+			pPixels[y * uwWidth + x] = ulMax ? (ulHeat * (ANALYZE_COLORS - 1)) / ulMax : 0;
+		}
+	}
+
+	char szPath[512];
+	snprintf(
+		szPath, sizeof(szPath), "%s/map%02hu_%s.png", szOutDir, uwMapIndex,
+		s_pHeatmapNames[eHeatmap]
+	);
+	int isOk = pngFileSaveIndexed(szPath, pPixels, uwWidth, uwHeight, pPalette, ANALYZE_COLORS);
+	if(!isOk) {
+		fprintf(stderr, "ERR: Can't save '%s'\n", szPath);
+	}
+	free(pPixels);
+	return isOk;
+}
+
+static void mapPrint(const tMapStats *pMap, uint16_t uwMapIndex) {
+	double fMatches = pMap->ulMatches;
+	const uint32_t *pCounts = pMap->pRecordCounts;
+	uint32_t ulStrikes = pCounts[TELEMETRY_RECORD_HIT] + pCounts[TELEMETRY_RECORD_SWING];
+	printf(
+		"Map %hu (%hhux%hhu): %lu matches", uwMapIndex, pMap->ubWidth, pMap->ubHeight,
+		(unsigned long)pMap->ulMatches
+	);
+	if(pMap->ulTruncated) {
+		printf(", %lu truncated", (unsigned long)pMap->ulTruncated);
+	}
+	if(pMap->ulCancelled) {
+		printf(", %lu cancelled", (unsigned long)pMap->ulCancelled);
+	}
+	printf("\n  avg length %.1fs\n", pMap->ulFrames / fMatches / 50);
+	printf(
+		"  per match: %.1f hits, %.1f misses, %.1f falls, %.1f deaths, %.1f thunders, %.1f tiles voided\n",
+		pCounts[TELEMETRY_RECORD_HIT] / fMatches, pCounts[TELEMETRY_RECORD_SWING] / fMatches,
+		pCounts[TELEMETRY_RECORD_FALL] / fMatches, pCounts[TELEMETRY_RECORD_DEATH] / fMatches,
+		pCounts[TELEMETRY_RECORD_THUNDER_STRIKE] / fMatches,
+		pCounts[TELEMETRY_RECORD_TILE_VOID] / fMatches
+	);
+	if(ulStrikes) {
+		printf("  strike accuracy %.1f%%\n", 100.0 * pCounts[TELEMETRY_RECORD_HIT] / ulStrikes);
+	}
+	printf("  wins:");
+	for(uint8_t i = 0; i < ANALYZE_WINNER_MAX; ++i) {
+		printf(" P%hhu %lu,", i + 1, (unsigned long)pMap->pWins[i]);
+	}
+	printf(" none %lu\n", (unsigned long)pMap->ulNoWinner);
+	if(pMap->ulSeconds) {
+		printf(
+			"  frame end line: avg %lu, max %hu\n",
+			(unsigned long)(pMap->ulLineSum / pMap->ulSeconds), pMap->uwLineMax
+		);
+	}
+}
+
+//------------------------------------------------------------------- PUBLIC FNS
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 3) {
+		fprintf(stderr, "Usage: %s outDir telemetry.bin [telemetry.bin...]\n", pArgs[0]);
+		return EXIT_FAILURE;
+	}
+
+	const char *szOutDir = pArgs[1];
+	char szReplaysPath[512];
+	snprintf(szReplaysPath, sizeof(szReplaysPath), "%s/replays.txt", szOutDir);
+	s_pReplays = fopen(szReplaysPath, "w");
+	if(!s_pReplays) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szReplaysPath);
+		return EXIT_FAILURE;
+	}
+	for(int i = 2; i < lArgCount; ++i) {
+		if(!fileAdd(pArgs[i])) {
+			fclose(s_pReplays);
+			return EXIT_FAILURE;
+		}
+	}
+	fclose(s_pReplays);
+
+	uint8_t pPalette[ANALYZE_COLORS * 3];
+	heatPaletteFill(pPalette);
+	int isOk = 1;
+	uint32_t ulMatches = 0;
+	for(uint16_t uwMap = 0; uwMap < ANALYZE_MAP_MAX; ++uwMap) {
+		tMapStats *pMap = &s_pMaps[uwMap];
+		if(!pMap->ulMatches) {
+			continue;
+		}
+		ulMatches += pMap->ulMatches;
+		mapPrint(pMap, uwMap);
+		for(tHeatmap eHeatmap = 0; eHeatmap < HEATMAP_COUNT; ++eHeatmap) {
+			isOk &= heatmapSave(pMap, eHeatmap, uwMap, szOutDir, pPalette);
+			free(pMap->pHeat[eHeatmap]);
+		}
+	}
+	printf("%lu matches total\n", (unsigned long)ulMatches);
+	return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,307 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Pre-renders constant strings with ACE .fnt fonts into text atlas read by
+ * src/text_atlas.c.
+ *
+ * Usage: textAtlas strings.txt out.atl font0.fnt [font1.fnt...]
+ *
+ * Each line of strings.txt is font index, single space and text till end of
+ * line, e.g. "0   Code: KaiN". Empty lines and ones starting with '#' are
+ * skipped.
+ *
+ * Output, big endian:
+ * - ULONG magic "CATA", UWORD width, UWORD height, UWORD entry count,
+ *   UWORD string data size,
+ * - entries: UBYTE font, UBYTE reserved, UWORD y, UWORD width, UWORD hash,
+ *   UWORD string offset,
+ * - string data, each one null-terminated,
+ * - single plane of width x height pixels, entries stacked one below another.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitmap_file.h"
+
+#define TEXT_ATLAS_MAGIC 0x43415441 // "CATA"
+#define TEXT_ATLAS_FONT_MAX 4
+#define TEXT_ATLAS_ENTRY_MAX 256
+#define TEXT_ATLAS_LINE_MAX 256
+
+typedef struct tFontFile {
+	uint16_t uwWidth;
+	uint16_t uwHeight;
+	uint8_t ubChars;
+	uint16_t *pOffsets;
+	uint16_t uwBytesPerRow;
+	uint8_t *pData;
+} tFontFile;
+
+typedef struct tEntry {
+	uint8_t ubFont;
+	uint16_t uwY;
+	uint16_t uwWidth;
+	uint16_t uwHash;
+	uint16_t uwStringOffset;
+	char *szText;
+} tEntry;
+
+static uint8_t *readFile(const char *szPath, size_t *pSize) {
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", szPath);
+		return 0;
+	}
+	fseek(pFile, 0, SEEK_END);
+	long lSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	uint8_t *pData = malloc(lSize ? lSize : 1);
+	if(fread(pData, 1, lSize, pFile) != (size_t)lSize) {
+		fprintf(stderr, "ERR: Can't read '%s'\n", szPath);
+		free(pData);
+		pData = 0;
+	}
+	fclose(pFile);
+	*pSize = lSize;
+	return pData;
+}
+
+static int fontFileLoad(const char *szPath, tFontFile *pFont) {
+	size_t ulSize;
+	uint8_t *pRaw = readFile(szPath, &ulSize);
+	if(!pRaw) {
+		return 0;
+	}
+	int isOk = 0;
+	if(ulSize >= 5) {
+		pFont->uwWidth = readBeWord(&pRaw[0]);
+		pFont->uwHeight = readBeWord(&pRaw[2]);
+		pFont->ubChars = pRaw[4];
+		pFont->uwBytesPerRow = ((pFont->uwWidth + 15) / 16) * 2;
+		size_t ulOffsetsSize = pFont->ubChars * sizeof(uint16_t);
+		size_t ulDataSize = (size_t)pFont->uwBytesPerRow * pFont->uwHeight;
+		if(ulSize >= 5 + ulOffsetsSize + ulDataSize) {
+			pFont->pOffsets = malloc(ulOffsetsSize);
+			for(uint16_t i = 0; i < pFont->ubChars; ++i) {
+				pFont->pOffsets[i] = readBeWord(&pRaw[5 + i * 2]);
+			}
+			pFont->pData = malloc(ulDataSize);
+			memcpy(pFont->pData, &pRaw[5 + ulOffsetsSize], ulDataSize);
+			isOk = 1;
+		}
+	}
+	if(!isOk) {
+		fprintf(stderr, "ERR: Malformed font '%s'\n", szPath);
+	}
+	free(pRaw);
+	return isOk;
+}
+
+static void fontFileFree(tFontFile *pFont) {
+	free(pFont->pOffsets);
+	free(pFont->pData);
+}
+
+static int fontFileHasGlyph(const tFontFile *pFont, uint8_t ubChar) {
+	return ubChar + 1 < pFont->ubChars;
+}
+
+static uint16_t fontFileGetGlyphWidth(const tFontFile *pFont, uint8_t ubChar) {
+	return pFont->pOffsets[ubChar + 1] - pFont->pOffsets[ubChar];
+}
+
+static int getPixel(const uint8_t *pData, uint16_t uwBytesPerRow, uint16_t uwX, uint16_t uwY) {
+	return (pData[uwY * uwBytesPerRow + uwX / 8] >> (7 - (uwX & 7))) & 1;
+}
+
+static void setPixel(uint8_t *pData, uint16_t uwBytesPerRow, uint16_t uwX, uint16_t uwY) {
+	pData[uwY * uwBytesPerRow + uwX / 8] |= 0x80 >> (uwX & 7);
+}
+
+/**
+ * Same as textAtlasHash() in src/text_atlas.c.
+ */
+static uint16_t textHash(const char *szText) {
+	uint16_t uwHash = 0;
+	while(*szText) {
+		uwHash = (uint16_t)(uwHash * 31 + (uint8_t)*(szText++));
+	}
+	return uwHash;
+}
+
+/**
+ * Same spacing as fontFillTextBitMap(): glyph followed by 1px gap.
+ */
+static uint16_t measureText(const tFontFile *pFont, const char *szText) {
+	uint16_t uwWidth = 0;
+	for(const char *p = szText; *p; ++p) {
+		uwWidth += fontFileGetGlyphWidth(pFont, (uint8_t)*p) + 1;
+	}
+	return uwWidth;
+}
+
+static void renderText(
+	const tFontFile *pFont, const char *szText, uint8_t *pDst,
+	uint16_t uwBytesPerRow, uint16_t uwY
+) {
+	uint16_t uwX = 0;
+	for(const char *p = szText; *p; ++p) {
+		uint8_t ubChar = (uint8_t)*p;
+		uint16_t uwGlyphX = pFont->pOffsets[ubChar];
+		uint16_t uwGlyphWidth = fontFileGetGlyphWidth(pFont, ubChar);
+		for(uint16_t uwRow = 0; uwRow < pFont->uwHeight; ++uwRow) {
+			for(uint16_t uwCol = 0; uwCol < uwGlyphWidth; ++uwCol) {
+				if(getPixel(pFont->pData, pFont->uwBytesPerRow, uwGlyphX + uwCol, uwRow)) {
+					setPixel(pDst, uwBytesPerRow, uwX + uwCol, uwY + uwRow);
+				}
+			}
+		}
+		uwX += uwGlyphWidth + 1;
+	}
+}
+
+static void writeBeLong(uint8_t *pDst, uint32_t ulValue) {
+	writeBeWord(&pDst[0], ulValue >> 16);
+	writeBeWord(&pDst[2], ulValue & 0xFFFF);
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 4) {
+		fprintf(
+			stderr, "Usage: %s strings.txt out.atl font0.fnt [font1.fnt...]\n",
+			pArgs[0]
+		);
+		return EXIT_FAILURE;
+	}
+
+	tFontFile pFonts[TEXT_ATLAS_FONT_MAX];
+	uint8_t ubFontCount = 0;
+	for(int i = 3; i < lArgCount; ++i) {
+		if(ubFontCount >= TEXT_ATLAS_FONT_MAX) {
+			fprintf(stderr, "ERR: Too many fonts, max %d\n", TEXT_ATLAS_FONT_MAX);
+			return EXIT_FAILURE;
+		}
+		if(!fontFileLoad(pArgs[i], &pFonts[ubFontCount])) {
+			return EXIT_FAILURE;
+		}
+		++ubFontCount;
+	}
+
+	FILE *pStrings = fopen(pArgs[1], "r");
+	if(!pStrings) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", pArgs[1]);
+		return EXIT_FAILURE;
+	}
+
+	tEntry pEntries[TEXT_ATLAS_ENTRY_MAX];
+	uint16_t uwEntryCount = 0;
+	uint16_t uwWidth = 0, uwHeight = 0, uwStringSize = 0;
+	char szLine[TEXT_ATLAS_LINE_MAX];
+	int isOk = 1;
+	for(unsigned int uiLine = 1; fgets(szLine, sizeof(szLine), pStrings); ++uiLine) {
+		szLine[strcspn(szLine, "\r\n")] = '\0';
+		if(szLine[0] == '\0' || szLine[0] == '#') {
+			continue;
+		}
+		if(szLine[0] < '0' || szLine[0] - '0' >= ubFontCount || szLine[1] != ' ') {
+			fprintf(stderr, "ERR: %s:%u: expected font index and space\n", pArgs[1], uiLine);
+			isOk = 0;
+			break;
+		}
+		if(uwEntryCount >= TEXT_ATLAS_ENTRY_MAX) {
+			fprintf(stderr, "ERR: Too many strings, max %d\n", TEXT_ATLAS_ENTRY_MAX);
+			isOk = 0;
+			break;
+		}
+		uint8_t ubFont = szLine[0] - '0';
+		const char *szText = &szLine[2];
+		for(const char *p = szText; *p; ++p) {
+			if(!fontFileHasGlyph(&pFonts[ubFont], (uint8_t)*p)) {
+				fprintf(
+					stderr, "ERR: %s:%u: no glyph for '%c' in font %hhu\n",
+					pArgs[1], uiLine, *p, ubFont
+				);
+				isOk = 0;
+			}
+		}
+		if(!isOk) {
+			break;
+		}
+
+		tEntry *pEntry = &pEntries[uwEntryCount++];
+		pEntry->ubFont = ubFont;
+		pEntry->uwY = uwHeight;
+		pEntry->uwWidth = measureText(&pFonts[ubFont], szText);
+		pEntry->uwHash = textHash(szText);
+		pEntry->uwStringOffset = uwStringSize;
+		pEntry->szText = strdup(szText);
+		uwStringSize += strlen(szText) + 1;
+		uwHeight += pFonts[ubFont].uwHeight;
+		if(pEntry->uwWidth > uwWidth) {
+			uwWidth = pEntry->uwWidth;
+		}
+	}
+	fclose(pStrings);
+
+	if(isOk && !uwEntryCount) {
+		fprintf(stderr, "ERR: No strings in '%s'\n", pArgs[1]);
+		isOk = 0;
+	}
+
+	if(isOk) {
+		// Keep string data word-aligned so that plane starts on even address
+		uwStringSize = (uwStringSize + 1) & ~1;
+		uwWidth = (uwWidth + 15) & ~15;
+		uint16_t uwBytesPerRow = uwWidth / 8;
+		size_t ulPlaneSize = (size_t)uwBytesPerRow * uwHeight;
+		size_t ulHeaderSize = 12 + uwEntryCount * 10;
+		size_t ulSize = ulHeaderSize + uwStringSize + ulPlaneSize;
+		uint8_t *pOut = calloc(ulSize, 1);
+
+		writeBeLong(&pOut[0], TEXT_ATLAS_MAGIC);
+		writeBeWord(&pOut[4], uwWidth);
+		writeBeWord(&pOut[6], uwHeight);
+		writeBeWord(&pOut[8], uwEntryCount);
+		writeBeWord(&pOut[10], uwStringSize);
+		uint8_t *pStringData = &pOut[ulHeaderSize];
+		uint8_t *pPlane = &pStringData[uwStringSize];
+		for(uint16_t i = 0; i < uwEntryCount; ++i) {
+			const tEntry *pEntry = &pEntries[i];
+			uint8_t *pDst = &pOut[12 + i * 10];
+			pDst[0] = pEntry->ubFont;
+			writeBeWord(&pDst[2], pEntry->uwY);
+			writeBeWord(&pDst[4], pEntry->uwWidth);
+			writeBeWord(&pDst[6], pEntry->uwHash);
+			writeBeWord(&pDst[8], pEntry->uwStringOffset);
+			strcpy((char*)&pStringData[pEntry->uwStringOffset], pEntry->szText);
+			renderText(&pFonts[pEntry->ubFont], pEntry->szText, pPlane, uwBytesPerRow, pEntry->uwY);
+		}
+
+		FILE *pOutFile = fopen(pArgs[2], "wb");
+		if(!pOutFile || fwrite(pOut, 1, ulSize, pOutFile) != ulSize) {
+			fprintf(stderr, "ERR: Can't write '%s'\n", pArgs[2]);
+			isOk = 0;
+		}
+		else {
+			printf(
+				"%s: %hu strings, %hux%hu atlas, %zu bytes\n", pArgs[2],
+				uwEntryCount, uwWidth, uwHeight, ulSize
+			);
+		}
+		if(pOutFile) {
+			fclose(pOutFile);
+		}
+		free(pOut);
+	}
+
+	for(uint16_t i = 0; i < uwEntryCount; ++i) {
+		free(pEntries[i].szText);
+	}
+	for(uint8_t i = 0; i < ubFontCount; ++i) {
+		fontFileFree(&pFonts[i]);
+	}
+	return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
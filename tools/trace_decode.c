@@ -0,0 +1,118 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/**
+ * Decodes trace ring buffer written by src/trace.c into text.
+ *
+ * Usage: traceDecode dump.bin
+ *
+ * Input may be any memory dump which contains the ring, e.g. saved from
+ * emulator's debugger - it's found by its magic. Records are printed oldest
+ * first.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bitmap_file.h"
+#include "trace_formats.h"
+
+#define TRACE_HEADER_SIZE 12
+#define TRACE_RECORD_SIZE (4 + 4 * TRACE_ARG_COUNT)
+
+typedef struct tTraceFormat {
+	uint8_t ubLevel;
+	const char *szFormat;
+} tTraceFormat;
+
+#define TRACE_FORMAT_ENTRY(eId, eLevel, szFormat) {TRACE_LEVEL_##eLevel, szFormat},
+static const tTraceFormat s_pFormats[TRACE_ID_COUNT] = {
+	TRACE_FORMATS(TRACE_FORMAT_ENTRY)
+};
+#undef TRACE_FORMAT_ENTRY
+
+static const char * const s_pLevelPrefixes[] = {"", "ERR: ", "WARN: ", "", "DBG: "};
+
+static uint32_t readBeLong(const uint8_t *pSrc) {
+	return ((uint32_t)readBeWord(&pSrc[0]) << 16) | readBeWord(&pSrc[2]);
+}
+
+static int isRingHeader(const uint8_t *pData, size_t ulSize, size_t ulPos) {
+	if(ulPos + TRACE_HEADER_SIZE > ulSize || readBeLong(&pData[ulPos]) != TRACE_MAGIC) {
+		return 0;
+	}
+	uint16_t uwRecordCount = readBeWord(&pData[ulPos + 4]);
+	uint16_t uwRecordSize = readBeWord(&pData[ulPos + 6]);
+	return (
+		uwRecordCount && !(uwRecordCount & (uwRecordCount - 1)) &&
+		uwRecordSize == TRACE_RECORD_SIZE &&
+		ulPos + TRACE_HEADER_SIZE + (size_t)uwRecordCount * uwRecordSize <= ulSize
+	);
+}
+
+static void printRecord(const uint8_t *pRecord) {
+	uint16_t uwId = readBeWord(&pRecord[0]);
+	uint16_t uwFrame = readBeWord(&pRecord[2]);
+	unsigned long pArgs[TRACE_ARG_COUNT];
+	for(uint8_t i = 0; i < TRACE_ARG_COUNT; ++i) {
+		pArgs[i] = readBeLong(&pRecord[4 + 4 * i]);
+	}
+	if(uwId >= TRACE_ID_COUNT) {
+		printf("[%hu] ???: unknown record id %hu\n", uwFrame, uwId);
+		return;
+	}
+	const tTraceFormat *pFormat = &s_pFormats[uwId];
+	printf("[%hu] %s", uwFrame, s_pLevelPrefixes[pFormat->ubLevel]);
+	printf(pFormat->szFormat, pArgs[0], pArgs[1], pArgs[2], pArgs[3]);
+	printf("\n");
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 2) {
+		fprintf(stderr, "Usage: %s dump.bin\n", pArgs[0]);
+		return EXIT_FAILURE;
+	}
+
+	FILE *pFile = fopen(pArgs[1], "rb");
+	if(!pFile) {
+		fprintf(stderr, "ERR: Can't open '%s'\n", pArgs[1]);
+		return EXIT_FAILURE;
+	}
+	fseek(pFile, 0, SEEK_END);
+	size_t ulSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	uint8_t *pData = malloc(ulSize ? ulSize : 1);
+	size_t ulRead = fread(pData, 1, ulSize, pFile);
+	fclose(pFile);
+	if(ulRead != ulSize) {
+		fprintf(stderr, "ERR: Can't read '%s'\n", pArgs[1]);
+		free(pData);
+		return EXIT_FAILURE;
+	}
+
+	// Ring is ULONG-aligned on 68k, but dumps may start anywhere even
+	size_t ulPos = 0;
+	while(ulPos < ulSize && !isRingHeader(pData, ulSize, ulPos)) {
+		ulPos += 2;
+	}
+	if(ulPos >= ulSize) {
+		fprintf(stderr, "ERR: No trace ring in '%s'\n", pArgs[1]);
+		free(pData);
+		return EXIT_FAILURE;
+	}
+
+	uint16_t uwRecordCount = readBeWord(&pData[ulPos + 4]);
+	uint32_t ulWritten = readBeLong(&pData[ulPos + 8]);
+	const uint8_t *pRecords = &pData[ulPos + TRACE_HEADER_SIZE];
+	uint32_t ulFirst = 0;
+	if(ulWritten > uwRecordCount) {
+		ulFirst = ulWritten - uwRecordCount;
+		printf("(%lu older records overwritten)\n", (unsigned long)ulFirst);
+	}
+	for(uint32_t i = ulFirst; i != ulWritten; ++i) {
+		printRecord(&pRecords[(i & (uwRecordCount - 1)) * TRACE_RECORD_SIZE]);
+	}
+
+	free(pData);
+	return EXIT_SUCCESS;
+}